@@ -0,0 +1,1030 @@
+// The generator is included directly so that each of its phases can be measured separately.
+#define GENERATE_PROJECT_NO_MAIN
+#include "GenerateProject.cpp"
+
+#include <cstdio>
+#include <new>
+#if defined(_WIN32)
+    #include <Psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+/// Counts of memory allocations.
+struct AllocationCounts
+{
+    /// The number of allocations.
+    uint64_t AllocationCount = 0;
+    /// The total number of bytes allocated.
+    uint64_t AllocatedBytes = 0;
+};
+
+/// Tracks all memory allocated through the global operator new, which is replaced below.
+class AllocationTracker
+{
+public:
+    /// Records an allocation.
+    /// @param[in]  size_in_bytes - The size of the allocation.
+    static void Record(const std::size_t size_in_bytes)
+    {
+        AllocationCount.fetch_add(1, std::memory_order_relaxed);
+        AllocatedBytes.fetch_add(size_in_bytes, std::memory_order_relaxed);
+    }
+
+    /// Gets the counts of all allocations made so far.
+    /// @return The allocation counts.
+    static AllocationCounts Get()
+    {
+        AllocationCounts counts;
+        counts.AllocationCount = AllocationCount.load();
+        counts.AllocatedBytes = AllocatedBytes.load();
+        return counts;
+    }
+
+private:
+    // MEMBER VARIABLES.
+    /// The number of allocations made so far.
+    static std::atomic<uint64_t> AllocationCount;
+    /// The total number of bytes allocated so far.
+    static std::atomic<uint64_t> AllocatedBytes;
+};
+
+std::atomic<uint64_t> AllocationTracker::AllocationCount(0);
+std::atomic<uint64_t> AllocationTracker::AllocatedBytes(0);
+
+// GCC can't tell that the replacement operators below pair malloc with free,
+// so it incorrectly warns about mismatched allocation functions wherever they're inlined.
+#if defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 11)
+    #pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size_in_bytes)
+{
+    AllocationTracker::Record(size_in_bytes);
+    void* memory = std::malloc(size_in_bytes ? size_in_bytes : 1);
+    if (!memory)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](std::size_t size_in_bytes)
+{
+    return operator new(size_in_bytes);
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+/// Measures the peak memory used by the process (its peak resident set size or working set).
+class PeakMemory
+{
+public:
+    /// Resets the peak to the current memory usage, if supported by the platform.  This allows measuring
+    /// the peak of a single phase of the program.  Where not supported, the peak is for the whole process.
+    static void Reset()
+    {
+#if defined(__linux__)
+        // Writing 5 to clear_refs resets the peak resident set size (VmHWM).
+        std::FILE* clear_refs_file = std::fopen("/proc/self/clear_refs", "w");
+        if (clear_refs_file)
+        {
+            std::fputs("5", clear_refs_file);
+            std::fclose(clear_refs_file);
+        }
+#endif
+    }
+
+    /// Gets the peak memory used since the last reset (or since the process started).
+    /// @return The peak memory in bytes, or zero if it couldn't be retrieved.
+    static uint64_t GetBytes()
+    {
+#if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS memory_counters;
+        bool memory_counters_retrieved = (FALSE != GetProcessMemoryInfo(GetCurrentProcess(), &memory_counters, sizeof(memory_counters)));
+        return memory_counters_retrieved ? memory_counters.PeakWorkingSetSize : 0;
+#elif defined(__linux__)
+        // READ THE PEAK FROM THE PROCESS STATUS.
+        // It's listed in kilobytes on a line like "VmHWM:     1234 kB".
+        std::FILE* status_file = std::fopen("/proc/self/status", "r");
+        if (!status_file)
+        {
+            return 0;
+        }
+        uint64_t peak_bytes = 0;
+        char line[256];
+        while (std::fgets(line, sizeof(line), status_file))
+        {
+            unsigned long long peak_kilobytes = 0;
+            bool peak_found = (1 == std::sscanf(line, "VmHWM: %llu kB", &peak_kilobytes));
+            if (peak_found)
+            {
+                const uint64_t BYTES_PER_KILOBYTE = 1024;
+                peak_bytes = peak_kilobytes * BYTES_PER_KILOBYTE;
+                break;
+            }
+        }
+        std::fclose(status_file);
+        return peak_bytes;
+#else
+        struct rusage usage;
+        bool usage_retrieved = (0 == getrusage(RUSAGE_SELF, &usage));
+        if (!usage_retrieved)
+        {
+            return 0;
+        }
+    #if defined(__APPLE__)
+        // The peak is already in bytes.
+        return static_cast<uint64_t>(usage.ru_maxrss);
+    #else
+        const uint64_t BYTES_PER_KILOBYTE = 1024;
+        return static_cast<uint64_t>(usage.ru_maxrss) * BYTES_PER_KILOBYTE;
+    #endif
+#endif
+    }
+};
+
+/// A file extension and how often it occurs in a synthetic tree.
+struct SyntheticFileExtension
+{
+    /// The extension, without the leading dot.
+    std::string Extension = "";
+    /// The relative number of files with the extension.
+    unsigned int Weight = 0;
+};
+
+/// The shape of a synthetic source tree.
+struct SyntheticTreeShape
+{
+    /// The number of levels of subfolders below the root folder.
+    unsigned int Depth = 4;
+    /// The number of subfolders in each folder above the deepest level.
+    unsigned int FanOut = 6;
+    /// The number of files in each folder.
+    unsigned int FilesPerFolder = 20;
+    /// The extensions of the files, along with how often each occurs.
+    std::vector<SyntheticFileExtension> Extensions = {};
+};
+
+/// Generates synthetic source trees to benchmark against.  Trees are generated deterministically, so the same
+/// shape always produces the same tree on every platform, and files are empty since only their names matter.
+class SyntheticTree
+{
+public:
+    /// Parses a list of file extensions and weights in the form "cpp=40,h=40,txt=20".
+    /// @param[in]  text - The text to parse.
+    /// @param[out]  extensions - The parsed extensions.
+    /// @return True if the extensions were parsed; false otherwise.
+    static bool ParseExtensions(const std::string& text, std::vector<SyntheticFileExtension>& extensions)
+    {
+        extensions.clear();
+        std::size_t item_start = 0;
+        while (item_start <= text.size())
+        {
+            // GET THE NEXT ITEM.
+            const char ITEM_SEPARATOR = ',';
+            std::size_t item_end = text.find(ITEM_SEPARATOR, item_start);
+            if (std::string::npos == item_end)
+            {
+                item_end = text.size();
+            }
+            std::string item = text.substr(item_start, item_end - item_start);
+            item_start = item_end + 1;
+
+            // READ THE EXTENSION AND ITS WEIGHT.
+            const char WEIGHT_SEPARATOR = '=';
+            std::size_t weight_separator_index = item.find(WEIGHT_SEPARATOR);
+            bool weight_provided = (std::string::npos != weight_separator_index && weight_separator_index > 0);
+            if (!weight_provided)
+            {
+                return false;
+            }
+            std::string weight_text = item.substr(weight_separator_index + 1);
+            char* weight_end = nullptr;
+            const int DECIMAL_BASE = 10;
+            unsigned long weight = std::strtoul(weight_text.c_str(), &weight_end, DECIMAL_BASE);
+            bool weight_valid = (!weight_text.empty() && '\0' == *weight_end && weight > 0);
+            if (!weight_valid)
+            {
+                return false;
+            }
+
+            SyntheticFileExtension extension;
+            extension.Extension = item.substr(0, weight_separator_index);
+            extension.Weight = static_cast<unsigned int>(weight);
+            extensions.push_back(extension);
+        }
+        return !extensions.empty();
+    }
+
+    /// Generates a synthetic tree.  Any existing files in the tree are left in place.
+    /// @param[in]  root_folder_path - The path of the root folder of the tree.
+    /// @param[in]  shape - The shape of the tree.
+    /// @return True if the tree was generated; false otherwise.
+    static bool Generate(const std::string& root_folder_path, const SyntheticTreeShape& shape)
+    {
+        unsigned int total_weight = 0;
+        for (const auto& extension : shape.Extensions)
+        {
+            total_weight += extension.Weight;
+        }
+        uint64_t file_number = 0;
+        const unsigned int ROOT_DEPTH = 0;
+        return GenerateFolder(root_folder_path, ROOT_DEPTH, shape, total_weight, file_number);
+    }
+
+    /// Creates a folder if it doesn't already exist.
+    /// @param[in]  folder_path - The path of the folder.
+    /// @return True if the folder exists; false otherwise.
+    static bool CreateFolder(const std::string& folder_path)
+    {
+        std::string native_folder_path = DirectoryListing::ToNativePath(folder_path);
+#if defined(_WIN32)
+        bool folder_exists = (FALSE != CreateDirectory(native_folder_path.c_str(), NULL)) || (ERROR_ALREADY_EXISTS == GetLastError());
+#else
+        const mode_t FOLDER_PERMISSIONS = 0755;
+        bool folder_exists = (0 == mkdir(native_folder_path.c_str(), FOLDER_PERMISSIONS)) || (EEXIST == errno);
+#endif
+        if (!folder_exists)
+        {
+            std::cerr << "Failed to create folder " << folder_path << std::endl;
+        }
+        return folder_exists;
+    }
+
+private:
+    /// Generates a folder in a synthetic tree, along with everything in it.
+    /// @param[in]  folder_path - The path of the folder.
+    /// @param[in]  depth - The depth of the folder below the root folder.
+    /// @param[in]  shape - The shape of the tree.
+    /// @param[in]  total_weight - The total weight of all file extensions.
+    /// @param[in,out]  file_number - The number of the next file to generate, which is unique within the tree.
+    /// @return True if the folder was generated; false otherwise.
+    static bool GenerateFolder(
+        const std::string& folder_path,
+        const unsigned int depth,
+        const SyntheticTreeShape& shape,
+        const unsigned int total_weight,
+        uint64_t& file_number)
+    {
+        // CREATE THE FOLDER.
+        bool folder_created = CreateFolder(folder_path);
+        if (!folder_created)
+        {
+            return false;
+        }
+
+        // CREATE THE FILES.
+        for (unsigned int file_index = 0; file_index < shape.FilesPerFolder; ++file_index, ++file_number)
+        {
+            // CHOOSE THE EXTENSION.
+            // Stepping through the weights by a large prime spreads each extension evenly throughout the tree
+            // in proportion to its weight, without depending on any platform's random number generator.
+            const uint64_t EXTENSION_STEP = 7919;
+            uint64_t weight_position = (file_number * EXTENSION_STEP) % total_weight;
+            const SyntheticFileExtension* extension = &shape.Extensions.front();
+            for (const auto& candidate_extension : shape.Extensions)
+            {
+                if (weight_position < candidate_extension.Weight)
+                {
+                    extension = &candidate_extension;
+                    break;
+                }
+                weight_position -= candidate_extension.Weight;
+            }
+
+            // CREATE THE FILE.
+            OutputFile file(folder_path + PATH_SEPARATOR + "file_" + std::to_string(file_number) + "." + extension->Extension);
+            bool file_created = (OutputFileWriteResult::FAILED != file.WriteIfChanged());
+            if (!file_created)
+            {
+                std::cerr << "Failed to create file " << file.Path << std::endl;
+                return false;
+            }
+        }
+
+        // CREATE THE SUBFOLDERS.
+        bool is_deepest_folder = (depth >= shape.Depth);
+        if (is_deepest_folder)
+        {
+            return true;
+        }
+        for (unsigned int subfolder_index = 0; subfolder_index < shape.FanOut; ++subfolder_index)
+        {
+            std::string subfolder_path = folder_path + PATH_SEPARATOR + "folder_" + std::to_string(depth + 1) + "_" + std::to_string(subfolder_index);
+            bool subfolder_generated = GenerateFolder(subfolder_path, depth + 1, shape, total_weight, file_number);
+            if (!subfolder_generated)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/// The measurements of a single phase of the program across all iterations of the benchmark.
+struct PhaseMeasurements
+{
+    /// The name of the phase.
+    std::string Name = "";
+    /// The time taken by the phase in each iteration, in milliseconds.
+    std::vector<double> Milliseconds = {};
+    /// The allocations made by the phase in the last iteration.
+    AllocationCounts Allocations = {};
+    /// The highest peak memory measured for the phase in any iteration, in bytes.
+    uint64_t PeakMemoryBytes = 0;
+    /// The size of the file generated by the phase, in bytes, or 0 if the phase doesn't generate a file.
+    uint64_t GeneratedBytes = 0;
+    /// The number of files examined by the phase, or 0 if the phase doesn't examine files.
+    uint64_t ExaminedFileCount = 0;
+};
+
+/// Measures the phases of the program.
+class PhaseTimer
+{
+public:
+    /// Measures a single run of a phase.
+    /// @param[in]  run_phase - The function that runs the phase.
+    /// @param[in,out]  phase - The measurements of the phase to add to.
+    template <typename PhaseFunction>
+    static void Measure(PhaseFunction run_phase, PhaseMeasurements& phase)
+    {
+        // RUN THE PHASE.
+        PeakMemory::Reset();
+        AllocationCounts allocations_before_phase = AllocationTracker::Get();
+        auto start_time = std::chrono::steady_clock::now();
+        run_phase();
+        auto end_time = std::chrono::steady_clock::now();
+        AllocationCounts allocations_after_phase = AllocationTracker::Get();
+
+        // RECORD THE MEASUREMENTS.
+        phase.Milliseconds.push_back(std::chrono::duration<double, std::milli>(end_time - start_time).count());
+        phase.Allocations.AllocationCount = allocations_after_phase.AllocationCount - allocations_before_phase.AllocationCount;
+        phase.Allocations.AllocatedBytes = allocations_after_phase.AllocatedBytes - allocations_before_phase.AllocatedBytes;
+        phase.PeakMemoryBytes = std::max(phase.PeakMemoryBytes, PeakMemory::GetBytes());
+    }
+};
+
+/// Measures how quickly watching a code folder (as with the program's --watch option) updates the generated files.
+/// A source file is created, renamed, and deleted in the code folder, like editors and version control tools do,
+/// and each change is timed from when the watcher first sees it (when its inotify event arrives on Linux) until
+/// the affected files have been written.  That includes waiting for the folders to be quiet (see FolderWatcher).
+class WatchWorkload
+{
+public:
+    /// Runs the workload once, measuring each kind of change.  The code folder is left as it was.
+    /// @param[in]  thread_count - The number of threads to use.  Zero uses one thread per hardware core.
+    /// @param[in]  code_folder_path - The absolute path of the code folder to watch.
+    /// @param[in]  output_folder_path - The path of the folder to generate the project in.
+    /// @param[in,out]  create_phase - The measurements of creating a file to add to.
+    /// @param[in,out]  rename_phase - The measurements of renaming a file to add to.
+    /// @param[in,out]  delete_phase - The measurements of deleting a file to add to.
+    /// @return True if the workload ran; false if an error occurred, which is reported to standard error.
+    static bool Run(
+        const unsigned int thread_count,
+        const std::string& code_folder_path,
+        const std::string& output_folder_path,
+        PhaseMeasurements& create_phase,
+        PhaseMeasurements& rename_phase,
+        PhaseMeasurements& delete_phase)
+    {
+        // GENERATE THE PROJECT IN THE OUTPUT FOLDER.
+        // The generator writes files to the current folder, so the output folder is only current until the workload finishes.
+        bool output_folder_current = ChangeCurrentFolder(output_folder_path);
+        if (!output_folder_current)
+        {
+            return false;
+        }
+        GeneratorSettings settings;
+        settings.ThreadCount = thread_count;
+        ProjectGenerator generator(settings);
+        GenerationRequest request;
+        request.SolutionName = PROJECT_NAME;
+        request.BuildScriptsNamedByProject = true;
+        RequestedProject project;
+        project.Name = PROJECT_NAME;
+        project.CodeFolderPath = code_folder_path;
+        request.Projects.push_back(project);
+        GenerationResult result;
+        bool project_generated = generator.Generate(request, result);
+        if (!project_generated)
+        {
+            ChangeCurrentFolder("..");
+            return false;
+        }
+
+        // WATCH THE CODE FOLDER.
+        FolderTree& code_folder = *generator.FindScannedCodeFolder(code_folder_path);
+        FolderWatcher folder_watcher;
+        folder_watcher.Update(code_folder);
+
+        // CREATE, RENAME, AND DELETE A SOURCE FILE.
+        std::string created_file_path = DirectoryListing::ToNativePath(code_folder_path + PATH_SEPARATOR + "watched_file.cpp");
+        std::string renamed_file_path = DirectoryListing::ToNativePath(code_folder_path + PATH_SEPARATOR + "renamed_watched_file.cpp");
+        auto create_file = [&created_file_path]()
+        {
+            std::FILE* created_file = std::fopen(created_file_path.c_str(), "w");
+            bool file_created = (nullptr != created_file);
+            if (file_created)
+            {
+                std::fclose(created_file);
+            }
+            return file_created;
+        };
+        auto rename_file = [&created_file_path, &renamed_file_path]() { return 0 == std::rename(created_file_path.c_str(), renamed_file_path.c_str()); };
+        auto delete_file = [&renamed_file_path]() { return 0 == std::remove(renamed_file_path.c_str()); };
+        bool workload_ran = (
+            MeasureUpdate(thread_count, create_file, generator, folder_watcher, code_folder, create_phase) &&
+            MeasureUpdate(thread_count, rename_file, generator, folder_watcher, code_folder, rename_phase) &&
+            MeasureUpdate(thread_count, delete_file, generator, folder_watcher, code_folder, delete_phase));
+        ChangeCurrentFolder("..");
+        return workload_ran;
+    }
+
+private:
+    /// Makes a change to the watched code folder and measures how long it takes to update the generated files.
+    /// @param[in]  thread_count - The number of threads to use.  Zero uses one thread per hardware core.
+    /// @param[in]  make_change - The function that changes the code folder, returning true if it succeeded.
+    /// @param[in,out]  generator - The generator that generated the project for the code folder.
+    /// @param[in,out]  folder_watcher - The watcher of the code folder.
+    /// @param[in,out]  code_folder - The watched code folder.
+    /// @param[in,out]  phase - The measurements of the change to add to.
+    /// @return True if the change was made and the files were updated; false otherwise.
+    template <typename ChangeFunction>
+    static bool MeasureUpdate(
+        const unsigned int thread_count,
+        ChangeFunction make_change,
+        ProjectGenerator& generator,
+        FolderWatcher& folder_watcher,
+        FolderTree& code_folder,
+        PhaseMeasurements& phase)
+    {
+        // MAKE THE CHANGE.
+        PeakMemory::Reset();
+        AllocationCounts allocations_before_change = AllocationTracker::Get();
+        bool change_made = make_change();
+        if (!change_made)
+        {
+            std::cerr << "Failed to change the watched code folder for " << phase.Name << std::endl;
+            return false;
+        }
+
+        // UPDATE THE GENERATED FILES ONCE THE CHANGE IS SEEN.
+        std::vector<uint8_t> changed_folders = folder_watcher.WaitForChanges(thread_count, code_folder);
+        FolderTreeChanges changes = folder_watcher.RescanChangedFolders(thread_count, changed_folders, code_folder);
+        GenerationResult result;
+        bool files_updated = generator.Update(changes, result);
+        auto end_time = std::chrono::steady_clock::now();
+        AllocationCounts allocations_after_change = AllocationTracker::Get();
+        if (!files_updated)
+        {
+            return false;
+        }
+
+        // RECORD THE MEASUREMENTS.
+        phase.Milliseconds.push_back(std::chrono::duration<double, std::milli>(end_time - folder_watcher.GetFirstChangeTime()).count());
+        phase.Allocations.AllocationCount = allocations_after_change.AllocationCount - allocations_before_change.AllocationCount;
+        phase.Allocations.AllocatedBytes = allocations_after_change.AllocatedBytes - allocations_before_change.AllocatedBytes;
+        phase.PeakMemoryBytes = std::max(phase.PeakMemoryBytes, PeakMemory::GetBytes());
+        return true;
+    }
+
+    /// Changes the current folder.
+    /// @param[in]  folder_path - The path of the folder to make current.
+    /// @return True if the folder was made current; false otherwise, which is reported to standard error.
+    static bool ChangeCurrentFolder(const std::string& folder_path)
+    {
+        std::string native_folder_path = DirectoryListing::ToNativePath(folder_path);
+#if defined(_WIN32)
+        bool folder_changed = (FALSE != SetCurrentDirectory(native_folder_path.c_str()));
+#else
+        bool folder_changed = (0 == chdir(native_folder_path.c_str()));
+#endif
+        if (!folder_changed)
+        {
+            std::cerr << "Failed to change the current folder to " << folder_path << std::endl;
+        }
+        return folder_changed;
+    }
+
+    /// The name of the project generated for the watched code folder.
+    static const char* const PROJECT_NAME;
+};
+
+const char* const WatchWorkload::PROJECT_NAME = "BenchmarkWatch";
+
+/// The command line arguments for the benchmark.
+class BenchmarkArguments
+{
+public:
+    /// Prints the usage information for the benchmark.
+    /// @param[in,out]  output - The stream to print to.
+    static void PrintUsage(std::ostream& output)
+    {
+        output
+            << "Usage: " << std::endl
+            << "\t Benchmark [options]" << std::endl
+            << "Options: " << std::endl
+            << "\t --tree <Folder> - The folder to generate the synthetic tree in (default: benchmark_tree)." << std::endl
+            << "\t --depth <Count> - The number of levels of subfolders (default: 4)." << std::endl
+            << "\t --fan-out <Count> - The number of subfolders per folder (default: 6)." << std::endl
+            << "\t --files-per-folder <Count> - The number of files per folder (default: 20)." << std::endl
+            << "\t --extensions <Mix> - The file extensions and their weights (default: " << DEFAULT_EXTENSIONS << ")." << std::endl
+            << "\t --skip-generation - Use the existing tree instead of generating it." << std::endl
+            << "\t --iterations <Count> - The number of times to run each phase (default: 5)." << std::endl
+            << "\t --threads <Count> - The number of threads to use (default: one per core)." << std::endl
+            << "\t --output <Path> - The file to write the JSON results to (default: standard output)." << std::endl;
+    }
+
+    /// Parses the command line arguments.  Any problems are reported to standard error.
+    /// @param[in]  argument_count - The number of command line arguments.
+    /// @param[in]  arguments - The command line arguments.
+    /// @param[out]  parsed_arguments - The parsed arguments.
+    /// @return True if the arguments were successfully parsed; false otherwise.
+    static bool Parse(const int argument_count, char* arguments[], BenchmarkArguments& parsed_arguments)
+    {
+        bool extensions_parsed = SyntheticTree::ParseExtensions(DEFAULT_EXTENSIONS, parsed_arguments.TreeShape.Extensions);
+        if (!extensions_parsed)
+        {
+            return false;
+        }
+
+        // READ EACH ARGUMENT.
+        // The first argument should be the program name/path.
+        const int FIRST_ARGUMENT_INDEX = 1;
+        for (int argument_index = FIRST_ARGUMENT_INDEX; argument_index < argument_count; ++argument_index)
+        {
+            // READ OPTIONS WITHOUT VALUES.
+            std::string argument = arguments[argument_index];
+            if ("--skip-generation" == argument)
+            {
+                parsed_arguments.SkipGeneration = true;
+                continue;
+            }
+
+            // MAKE SURE THE OPTION HAS A VALUE.
+            int value_index = argument_index + 1;
+            bool value_provided = (value_index < argument_count);
+            if (!value_provided)
+            {
+                std::cerr << "Missing value for option " << argument << std::endl;
+                return false;
+            }
+            std::string value = arguments[value_index];
+            argument_index = value_index;
+
+            // READ OPTIONS WITH TEXT VALUES.
+            if ("--tree" == argument)
+            {
+                parsed_arguments.TreePath = DirectoryListing::ToProjectPath(value);
+                continue;
+            }
+            if ("--output" == argument)
+            {
+                parsed_arguments.OutputPath = value;
+                continue;
+            }
+            if ("--extensions" == argument)
+            {
+                bool extensions_valid = SyntheticTree::ParseExtensions(value, parsed_arguments.TreeShape.Extensions);
+                if (!extensions_valid)
+                {
+                    std::cerr << "Invalid extensions: " << value << std::endl;
+                    return false;
+                }
+                continue;
+            }
+
+            // READ OPTIONS WITH NUMERIC VALUES.
+            char* value_end = nullptr;
+            const int DECIMAL_BASE = 10;
+            unsigned long number = std::strtoul(value.c_str(), &value_end, DECIMAL_BASE);
+            bool number_valid = (!value.empty() && '\0' == *value_end);
+            if (!number_valid)
+            {
+                std::cerr << "Invalid value for option " << argument << ": " << value << std::endl;
+                return false;
+            }
+            unsigned int count = static_cast<unsigned int>(number);
+            if ("--depth" == argument)
+            {
+                parsed_arguments.TreeShape.Depth = count;
+            }
+            else if ("--fan-out" == argument)
+            {
+                parsed_arguments.TreeShape.FanOut = count;
+            }
+            else if ("--files-per-folder" == argument)
+            {
+                parsed_arguments.TreeShape.FilesPerFolder = count;
+            }
+            else if ("--iterations" == argument)
+            {
+                const unsigned int MIN_ITERATION_COUNT = 1;
+                parsed_arguments.IterationCount = std::max(MIN_ITERATION_COUNT, count);
+            }
+            else if ("--threads" == argument)
+            {
+                parsed_arguments.ThreadCount = count;
+            }
+            else
+            {
+                std::cerr << "Unknown option: " << argument << std::endl;
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // MEMBER VARIABLES.
+    /// The path of the root folder of the synthetic tree.
+    std::string TreePath = "benchmark_tree";
+    /// The shape of the synthetic tree.
+    SyntheticTreeShape TreeShape = {};
+    /// True if the existing tree should be used instead of generating it.
+    bool SkipGeneration = false;
+    /// The number of times to run each phase.
+    unsigned int IterationCount = 5;
+    /// The number of threads to use.  Zero uses one thread per hardware core.
+    unsigned int ThreadCount = 0;
+    /// The path of the file to write the results to.  Empty to write them to standard output.
+    std::string OutputPath = "";
+
+private:
+    /// The default mix of file extensions, roughly resembling a typical C++ code base.
+    static const char* const DEFAULT_EXTENSIONS;
+};
+
+const char* const BenchmarkArguments::DEFAULT_EXTENSIONS = "cpp=35,h=35,hpp=5,inl=5,c=5,txt=10,md=5";
+
+/// Writes benchmark results as JSON, so that they can be compared across runs to track regressions.
+class BenchmarkResults
+{
+public:
+    /// Writes the results of the benchmark.
+    /// @param[in]  arguments - The arguments the benchmark was run with.
+    /// @param[in]  folder_count - The number of folders in the tree.
+    /// @param[in]  file_count - The number of files in the tree.
+    /// @param[in]  phases - The measurements of each phase.
+    /// @param[in,out]  file - The file to write to.
+    static void Write(
+        const BenchmarkArguments& arguments,
+        const std::size_t folder_count,
+        const std::size_t file_count,
+        const std::vector<PhaseMeasurements>& phases,
+        OutputFile& file)
+    {
+        // WRITE THE BENCHMARK CONFIGURATION.
+        std::string extensions;
+        for (const auto& extension : arguments.TreeShape.Extensions)
+        {
+            extensions += (extensions.empty() ? "" : ",") + extension.Extension + "=" + std::to_string(extension.Weight);
+        }
+        file
+            << "{\n"
+            << "  \"tree\": {\n"
+            << "    \"depth\": " << std::to_string(arguments.TreeShape.Depth) << ",\n"
+            << "    \"fan_out\": " << std::to_string(arguments.TreeShape.FanOut) << ",\n"
+            << "    \"files_per_folder\": " << std::to_string(arguments.TreeShape.FilesPerFolder) << ",\n"
+            << "    \"extensions\": \"" << extensions << "\",\n"
+            << "    \"folder_count\": " << std::to_string(folder_count) << ",\n"
+            << "    \"file_count\": " << std::to_string(file_count) << "\n"
+            << "  },\n"
+            << "  \"thread_count\": " << std::to_string(FolderScanner::ResolveThreadCount(arguments.ThreadCount)) << ",\n"
+            << "  \"iteration_count\": " << std::to_string(arguments.IterationCount) << ",\n"
+            << "  \"phases\": [\n";
+
+        // WRITE THE MEASUREMENTS FOR EACH PHASE.
+        for (std::size_t phase_index = 0; phase_index < phases.size(); ++phase_index)
+        {
+            const PhaseMeasurements& phase = phases[phase_index];
+            std::vector<double> sorted_milliseconds = phase.Milliseconds;
+            std::sort(sorted_milliseconds.begin(), sorted_milliseconds.end());
+            bool is_last_phase = (phase_index + 1 == phases.size());
+            file
+                << "    {\n"
+                << "      \"name\": \"" << phase.Name << "\",\n"
+                << "      \"min_milliseconds\": " << FormatMeasurement(sorted_milliseconds.front()) << ",\n"
+                << "      \"median_milliseconds\": " << FormatMeasurement(sorted_milliseconds[sorted_milliseconds.size() / 2]) << ",\n"
+                << "      \"max_milliseconds\": " << FormatMeasurement(sorted_milliseconds.back()) << ",\n"
+                << "      \"allocation_count\": " << std::to_string(phase.Allocations.AllocationCount) << ",\n"
+                << "      \"allocated_bytes\": " << std::to_string(phase.Allocations.AllocatedBytes) << ",\n"
+                << "      \"peak_memory_bytes\": " << std::to_string(phase.PeakMemoryBytes);
+            // The throughput of phases that generate files is computed from their fastest time.
+            bool phase_generates_file = (phase.GeneratedBytes > 0);
+            if (phase_generates_file)
+            {
+                const double BYTES_PER_GIGABYTE = 1e9;
+                const double MILLISECONDS_PER_SECOND = 1000.0;
+                double gigabytes_per_second = (phase.GeneratedBytes / BYTES_PER_GIGABYTE) / (sorted_milliseconds.front() / MILLISECONDS_PER_SECOND);
+                file
+                    << ",\n"
+                    << "      \"generated_bytes\": " << std::to_string(phase.GeneratedBytes) << ",\n"
+                    << "      \"gigabytes_per_second\": " << FormatMeasurement(gigabytes_per_second);
+            }
+            // The throughput of phases that examine files is likewise computed from their fastest time.
+            bool phase_examines_files = (phase.ExaminedFileCount > 0);
+            if (phase_examines_files)
+            {
+                const double MILLISECONDS_PER_SECOND = 1000.0;
+                double files_per_second = phase.ExaminedFileCount / (sorted_milliseconds.front() / MILLISECONDS_PER_SECOND);
+                file
+                    << ",\n"
+                    << "      \"examined_file_count\": " << std::to_string(phase.ExaminedFileCount) << ",\n"
+                    << "      \"files_per_second\": " << FormatMeasurement(files_per_second);
+            }
+            file
+                << "\n"
+                << "    }" << (is_last_phase ? "\n" : ",\n");
+        }
+
+        file
+            << "  ]\n"
+            << "}\n";
+    }
+
+private:
+    /// Formats a measurement for the results.
+    /// @param[in]  measurement - The measurement to format, such as a time in milliseconds.
+    /// @return The measurement with 3 decimal places (microsecond precision for times).
+    static std::string FormatMeasurement(const double measurement)
+    {
+        char formatted_measurement[32];
+        std::snprintf(formatted_measurement, sizeof(formatted_measurement), "%.3f", measurement);
+        return formatted_measurement;
+    }
+};
+
+/// The entry point for the benchmark.  A synthetic source tree is generated, and then each phase of the
+/// generator is run against it several times: scanning the tree, building folder paths, categorizing files,
+/// and writing each generated file.  Each phase's time, allocations, and peak memory are written as JSON.
+///
+/// The generated files are written to a "benchmark_output" folder in the current folder.  Since files are only
+/// written when their contents change, the first iteration writes them and later iterations measure regenerating
+/// an unchanged project.  Emitting the project and filters files in memory is also measured on increasing numbers
+/// of threads, to show how formatting their items scales.  Finally, the time for watching the tree to update the
+/// generated files after files are created, renamed, and deleted is measured (see WatchWorkload).
+///
+/// @param[in]  argument_count - The number of command line arguments.
+/// @param[in]  arguments - The command line arguments.
+/// @return 0 if the benchmark completed successfully; another value if an error occurred.
+int main(int argument_count, char* arguments[])
+{
+    // READ THE COMMAND LINE ARGUMENTS.
+    BenchmarkArguments benchmark_arguments;
+    bool arguments_parsed = BenchmarkArguments::Parse(argument_count, arguments, benchmark_arguments);
+    if (!arguments_parsed)
+    {
+        BenchmarkArguments::PrintUsage(std::cerr);
+        return EXIT_FAILURE;
+    }
+
+    // GENERATE THE SYNTHETIC TREE.
+    if (!benchmark_arguments.SkipGeneration)
+    {
+        bool tree_generated = SyntheticTree::Generate(benchmark_arguments.TreePath, benchmark_arguments.TreeShape);
+        if (!tree_generated)
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // CREATE THE OUTPUT FOLDER.
+    const std::string OUTPUT_FOLDER_PATH = "benchmark_output";
+    bool output_folder_created = SyntheticTree::CreateFolder(OUTPUT_FOLDER_PATH);
+    if (!output_folder_created)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // RUN EACH PHASE OF THE GENERATOR.
+    PhaseMeasurements scan_phase;
+    scan_phase.Name = "scan";
+    PhaseMeasurements build_folder_paths_phase;
+    build_folder_paths_phase.Name = "build_folder_paths";
+    PhaseMeasurements stat_files_serially_phase;
+    stat_files_serially_phase.Name = "stat_files_serially";
+    PhaseMeasurements read_file_metadata_on_threads_phase;
+    read_file_metadata_on_threads_phase.Name = "read_file_metadata_on_threads";
+    PhaseMeasurements read_file_metadata_phase;
+    read_file_metadata_phase.Name = "read_file_metadata";
+    PhaseMeasurements categorize_phase;
+    categorize_phase.Name = "categorize";
+    PhaseMeasurements write_solution_phase;
+    write_solution_phase.Name = "write_solution";
+    PhaseMeasurements write_project_phase;
+    write_project_phase.Name = "write_project";
+    PhaseMeasurements write_project_filters_phase;
+    write_project_filters_phase.Name = "write_project_filters";
+    PhaseMeasurements write_build_script_phase;
+    write_build_script_phase.Name = "write_build_script";
+    // Emitting the project and filters files (formatting them in memory, without writing them) is measured
+    // on 1, 2, 4, and so on up to the full number of threads to show how well it scales.
+    unsigned int thread_count = FolderScanner::ResolveThreadCount(benchmark_arguments.ThreadCount);
+    std::vector<unsigned int> emit_thread_counts;
+    for (unsigned int emit_thread_count = 1; emit_thread_count < thread_count; emit_thread_count *= 2)
+    {
+        emit_thread_counts.push_back(emit_thread_count);
+    }
+    emit_thread_counts.push_back(thread_count);
+    std::vector<PhaseMeasurements> emit_project_phases(emit_thread_counts.size());
+    std::vector<PhaseMeasurements> emit_project_filters_phases(emit_thread_counts.size());
+    for (std::size_t emit_phase_index = 0; emit_phase_index < emit_thread_counts.size(); ++emit_phase_index)
+    {
+        std::string thread_count_text = std::to_string(emit_thread_counts[emit_phase_index]);
+        emit_project_phases[emit_phase_index].Name = "emit_project_on_" + thread_count_text + "_threads";
+        emit_project_filters_phases[emit_phase_index].Name = "emit_project_filters_on_" + thread_count_text + "_threads";
+    }
+    PhaseMeasurements watch_create_phase;
+    watch_create_phase.Name = "watch_create";
+    PhaseMeasurements watch_rename_phase;
+    watch_rename_phase.Name = "watch_rename";
+    PhaseMeasurements watch_delete_phase;
+    watch_delete_phase.Name = "watch_delete";
+    std::size_t folder_count = 0;
+    std::size_t file_count = 0;
+    for (unsigned int iteration = 0; iteration < benchmark_arguments.IterationCount; ++iteration)
+    {
+        // SCAN THE TREE.
+        FolderTree code_folder;
+        PhaseTimer::Measure([&]() { code_folder = FolderTree::Get(benchmark_arguments.TreePath, IgnoreSettings(), benchmark_arguments.ThreadCount); }, scan_phase);
+        PhaseTimer::Measure([&]() { code_folder.BuildFolderPaths(); }, build_folder_paths_phase);
+        folder_count = code_folder.Folders.size();
+        file_count = code_folder.Files.size();
+
+        // READ THE METADATA OF EVERY FILE.
+        // Examining files one at a time on a single thread is the baseline that reading metadata in batches is compared against.
+        std::vector<uint64_t> sizes_in_bytes(file_count, 0);
+        std::vector<uint64_t> modification_times(file_count, 0);
+        PhaseTimer::Measure([&]()
+        {
+            std::string file_path;
+            for (uint32_t file_index = 0; file_index < file_count; ++file_index)
+            {
+                file_path.clear();
+                code_folder.AppendFilePath(file_index, file_path);
+                DirectoryListing::GetFileMetadata(file_path, sizes_in_bytes[file_index], modification_times[file_index]);
+            }
+        }, stat_files_serially_phase);
+        PhaseTimer::Measure([&]()
+        {
+            FileMetadataReader::ReadOnThreads(
+                benchmark_arguments.ThreadCount,
+                file_count,
+                [&code_folder](const std::size_t file_index, std::string& path) { code_folder.AppendFilePath(static_cast<uint32_t>(file_index), path); },
+                sizes_in_bytes,
+                modification_times);
+        }, read_file_metadata_on_threads_phase);
+        PhaseTimer::Measure([&]() { code_folder.ReadFileMetadata(benchmark_arguments.ThreadCount); }, read_file_metadata_phase);
+        stat_files_serially_phase.ExaminedFileCount = file_count;
+        read_file_metadata_on_threads_phase.ExaminedFileCount = file_count;
+        read_file_metadata_phase.ExaminedFileCount = file_count;
+
+        // CATEGORIZE THE FILES.
+        const std::string PROJECT_NAME = "Benchmark";
+        // The project is in a list since that's what the solution file is written from.
+        const uint32_t ROOT_FOLDER_INDEX = 0;
+        std::vector<Project> projects(1);
+        Project& project = projects.front();
+        std::vector<const Project*> solution_projects = { &project };
+        project.Name = PROJECT_NAME;
+        project.Guid = ProjectGuid::FromName(PROJECT_NAME);
+        project.CodeFolderPath = benchmark_arguments.TreePath;
+        project.BuildScriptFilename = "build.bat";
+        project.BuildCommandLine = project.BuildScriptFilename;
+        project.ProjectFolderCppFilenames = { PROJECT_NAME + CPP_FILE_EXTENSION };
+        project.CodeFolderTree = &code_folder;
+        project.CodeFolderIndex = ROOT_FOLDER_INDEX;
+        PhaseTimer::Measure([&]() { project.CodeFiles = CategorizedFileIndex::Build(code_folder, ROOT_FOLDER_INDEX); }, categorize_phase);
+
+        // WRITE EACH FILE.
+        const std::string OUTPUT_PATH_PREFIX = OUTPUT_FOLDER_PATH + PATH_SEPARATOR;
+        PhaseTimer::Measure([&]()
+        {
+            OutputFile solution_file(OUTPUT_PATH_PREFIX + PROJECT_NAME + SOLUTION_FILE_EXTENSION);
+            SolutionFile::Write(solution_projects, solution_file);
+            solution_file.WriteIfChanged();
+            write_solution_phase.GeneratedBytes = solution_file.GetSize();
+        }, write_solution_phase);
+        PhaseTimer::Measure([&]()
+        {
+            OutputFile project_file(OUTPUT_PATH_PREFIX + PROJECT_NAME + PROJECT_FILE_EXTENSION);
+            ProjectFile::Write(thread_count, project, project_file);
+            project_file.WriteIfChanged();
+            write_project_phase.GeneratedBytes = project_file.GetSize();
+        }, write_project_phase);
+        PhaseTimer::Measure([&]()
+        {
+            OutputFile project_filters_file(OUTPUT_PATH_PREFIX + PROJECT_NAME + PROJECT_FILTERS_FILE_EXTENSION);
+            ProjectFiltersFile::Write(thread_count, project, project_filters_file);
+            project_filters_file.WriteIfChanged();
+            write_project_filters_phase.GeneratedBytes = project_filters_file.GetSize();
+        }, write_project_filters_phase);
+        PhaseTimer::Measure([&]()
+        {
+            OutputFile build_script_file(OUTPUT_PATH_PREFIX + project.BuildScriptFilename);
+            BuildScriptBatchFile::Write(project, std::string(), build_script_file);
+            build_script_file.WriteIfChanged();
+            write_build_script_phase.GeneratedBytes = build_script_file.GetSize();
+        }, write_build_script_phase);
+
+        // EMIT THE PROJECT AND FILTERS FILES ON DIFFERENT NUMBERS OF THREADS.
+        for (std::size_t emit_phase_index = 0; emit_phase_index < emit_thread_counts.size(); ++emit_phase_index)
+        {
+            unsigned int emit_thread_count = emit_thread_counts[emit_phase_index];
+            PhaseMeasurements& emit_project_phase = emit_project_phases[emit_phase_index];
+            PhaseTimer::Measure([&]()
+            {
+                OutputFile project_file(OUTPUT_PATH_PREFIX + PROJECT_NAME + PROJECT_FILE_EXTENSION);
+                ProjectFile::Write(emit_thread_count, project, project_file);
+                emit_project_phase.GeneratedBytes = project_file.GetSize();
+            }, emit_project_phase);
+            PhaseMeasurements& emit_project_filters_phase = emit_project_filters_phases[emit_phase_index];
+            PhaseTimer::Measure([&]()
+            {
+                OutputFile project_filters_file(OUTPUT_PATH_PREFIX + PROJECT_NAME + PROJECT_FILTERS_FILE_EXTENSION);
+                ProjectFiltersFile::Write(emit_thread_count, project, project_filters_file);
+                emit_project_filters_phase.GeneratedBytes = project_filters_file.GetSize();
+            }, emit_project_filters_phase);
+        }
+    }
+
+    // MEASURE UPDATING THE GENERATED FILES WHILE WATCHING THE TREE.
+    // The watched project is generated in the output folder, so it needs the tree's absolute path.
+    std::string absolute_tree_path;
+    bool absolute_tree_path_retrieved = DirectoryListing::GetAbsolutePath(benchmark_arguments.TreePath, absolute_tree_path);
+    if (!absolute_tree_path_retrieved)
+    {
+        std::cerr << "Failed to get the absolute path of " << benchmark_arguments.TreePath << std::endl;
+        return EXIT_FAILURE;
+    }
+    for (unsigned int iteration = 0; iteration < benchmark_arguments.IterationCount; ++iteration)
+    {
+        bool watch_workload_ran = WatchWorkload::Run(
+            benchmark_arguments.ThreadCount,
+            absolute_tree_path,
+            OUTPUT_FOLDER_PATH,
+            watch_create_phase,
+            watch_rename_phase,
+            watch_delete_phase);
+        if (!watch_workload_ran)
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // WRITE THE RESULTS.
+    std::vector<PhaseMeasurements> phases =
+    {
+        scan_phase,
+        build_folder_paths_phase,
+        stat_files_serially_phase,
+        read_file_metadata_on_threads_phase,
+        read_file_metadata_phase,
+        categorize_phase,
+        write_solution_phase,
+        write_project_phase,
+        write_project_filters_phase,
+        write_build_script_phase
+    };
+    phases.insert(phases.end(), emit_project_phases.begin(), emit_project_phases.end());
+    phases.insert(phases.end(), emit_project_filters_phases.begin(), emit_project_filters_phases.end());
+    phases.push_back(watch_create_phase);
+    phases.push_back(watch_rename_phase);
+    phases.push_back(watch_delete_phase);
+    bool write_to_standard_output = benchmark_arguments.OutputPath.empty();
+    OutputFile results_file(write_to_standard_output ? std::string() : benchmark_arguments.OutputPath);
+    BenchmarkResults::Write(benchmark_arguments, folder_count, file_count, phases, results_file);
+    if (write_to_standard_output)
+    {
+        std::cout << results_file.Contents;
+        return EXIT_SUCCESS;
+    }
+    bool results_written = (OutputFileWriteResult::FAILED != results_file.WriteIfChanged());
+    if (!results_written)
+    {
+        std::cerr << "Failed to write " << results_file.Path << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -1,12 +1,72 @@
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
-#include <fstream>
+#include <cstring>
+#include <deque>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
-#include <Windows.h>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    // SSE2 is used to quickly scan text for characters that need escaping.
+    #define GENERATE_PROJECT_SSE2
+    #include <emmintrin.h>
+#endif
+#if defined(_WIN32)
+    // Keeps Windows.h from defining min/max macros that would conflict with std::min/std::max.
+    #define NOMINMAX
+    #include <Windows.h>
+#else
+    #include <dirent.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/socket.h>
+    #include <sys/stat.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+    #if defined(__linux__)
+        #include <poll.h>
+        #include <sys/inotify.h>
+        #include <sys/syscall.h>
+        #if defined(__has_include)
+            #if __has_include(<linux/io_uring.h>) && defined(STATX_SIZE) && defined(__NR_io_uring_setup)
+                // io_uring is used to examine many files at once (see FileMetadataReader).
+                #define GENERATE_PROJECT_IO_URING
+                #include <linux/io_uring.h>
+            #endif
+        #endif
+    #endif
+#endif
+
+#include "ProjectGenerator.h"
 
 /// The standard path separator on Windows, as used within Visual Studio project files.
 const std::string PATH_SEPARATOR = "\\";
+#if defined(_WIN32)
+/// The path separator used when passing paths to the operating system.
+const char NATIVE_PATH_SEPARATOR = '\\';
+#else
+/// The path separator used when passing paths to the operating system.
+const char NATIVE_PATH_SEPARATOR = '/';
+#endif
+/// The line ending used in all generated files, matching what Visual Studio itself writes.
+const std::string NEWLINE = "\r\n";
 /// The file extension for C++ source files.
 const std::string CPP_FILE_EXTENSION = ".cpp";
 /// The file extension for a Visual Studio solution file.
@@ -16,590 +76,14732 @@ const std::string PROJECT_FILE_EXTENSION = ".vcxproj";
 /// The file extension for a Visual Studio project filters file.
 const std::string PROJECT_FILTERS_FILE_EXTENSION = ".vcxproj.filters";
 
-/// A file on the file system.
-class File
+/// A piece of constant text, such as the fixed markup in generated files, whose length is known at compile time
+/// so that it can be appended without measuring it.  Fragments spanning several lines embed the same "\r\n"
+/// line endings as NEWLINE.
+struct TextFragment
+{
+    /// Creates a fragment from a string literal.
+    /// @param[in]  text - The string literal.
+    /// @return The fragment for the literal, not including its null terminator.
+    template <std::size_t ARRAY_SIZE>
+    static constexpr TextFragment From(const char (&text)[ARRAY_SIZE])
+    {
+        return TextFragment{ text, ARRAY_SIZE - 1 };
+    }
+
+    /// The characters in the fragment, which aren't null-terminated.
+    const char* Characters;
+    /// The number of characters in the fragment.
+    std::size_t Length;
+};
+
+/// Hashes data with XXH64 (see https://github.com/Cyan4973/xxHash), a non-cryptographic hash that mixes four
+/// independent 64-bit lanes per 32-byte stripe, so the processor works on all four at once and hashing runs at
+/// close to memory bandwidth.  The hash is stable across runs and platforms (on little-endian processors, which are
+/// all the platforms Visual Studio targets), so hashes can be saved and compared later.  Everything the program
+/// hashes uses it: the contents of code files, ignore rules, and the strings in hash tables.
+class ContentHash
 {
 public:
-    // METHODS.
-    /// Constructor.
-    /// @param[in]  relative_folder_path - The relative path to the folder containing the file.
-    ///     This path may be relative to anything, but mixing paths relative to different
-    ///     things is not recommended in the same program.
-    /// @param[in]  name - The filename.
-    explicit File(const std::string& relative_folder_path, const std::string& name) :
-        RelativeFolderPath(relative_folder_path),
-        RelativePath(),
-        Name(name)
+    /// Hashes data.
+    /// @param[in]  data - The data to hash.
+    /// @param[in]  size_in_bytes - The size of the data.
+    /// @return The hash of the data.
+    static uint64_t Hash(const char* data, const std::size_t size_in_bytes)
     {
-        // POPULATE THE RELATIVE FILEPATH.
-        if (relative_folder_path.empty())
+        // HASH EACH 32-BYTE STRIPE ACROSS FOUR LANES.
+        const uint64_t SEED = 0;
+        const char* data_end = data + size_in_bytes;
+        uint64_t hash = 0;
+        const std::size_t STRIPE_SIZE_IN_BYTES = 32;
+        if (size_in_bytes >= STRIPE_SIZE_IN_BYTES)
         {
-            // Without a relative folder path, the relative filepath is just the filename.
-            RelativePath = Name;
+            uint64_t lanes[4] = { SEED + PRIME_1 + PRIME_2, SEED + PRIME_2, SEED, SEED - PRIME_1 };
+            const char* last_stripe = data_end - STRIPE_SIZE_IN_BYTES;
+            for (; data <= last_stripe; data += STRIPE_SIZE_IN_BYTES)
+            {
+                lanes[0] = Round(lanes[0], Read64(data));
+                lanes[1] = Round(lanes[1], Read64(data + 8));
+                lanes[2] = Round(lanes[2], Read64(data + 16));
+                lanes[3] = Round(lanes[3], Read64(data + 24));
+            }
+            hash = RotateLeft(lanes[0], 1) + RotateLeft(lanes[1], 7) + RotateLeft(lanes[2], 12) + RotateLeft(lanes[3], 18);
+            for (uint64_t lane : lanes)
+            {
+                hash ^= Round(0, lane);
+                hash = hash * PRIME_1 + PRIME_4;
+            }
         }
         else
         {
-            // The full relative filepath includes the relative folder path.
-            RelativePath = RelativeFolderPath + PATH_SEPARATOR + Name;
+            hash = SEED + PRIME_5;
         }
-    }
+        hash += static_cast<uint64_t>(size_in_bytes);
 
-    /// Gets the file extension with the leading dot.
-    /// Assumes the file extension occurs after the last dot in the filename.
-    /// @return The file's extension with its leading dot.
-    std::string ExtensionWithLeadingDot() const
-    {
-        // FIND THE LAST DOT IN THE FILENAME.
-        const char FILE_EXTENSION_SEPARATOR = '.';
-        std::string::size_type last_dot = Name.find_last_of(FILE_EXTENSION_SEPARATOR);
-        bool extension_separator_found = (std::string::npos != last_dot);
-        if (extension_separator_found)
+        // HASH THE REMAINING BYTES.
+        for (; data + sizeof(uint64_t) <= data_end; data += sizeof(uint64_t))
         {
-            // RETURN THE FILE EXTENSION WITH ITS LEADING DOT.
-            std::string extension = Name.substr(last_dot);
-            return extension;
+            hash ^= Round(0, Read64(data));
+            hash = RotateLeft(hash, 27) * PRIME_1 + PRIME_4;
         }
-        else
+        if (data + sizeof(uint32_t) <= data_end)
+        {
+            uint32_t value = 0;
+            std::memcpy(&value, data, sizeof(value));
+            hash ^= static_cast<uint64_t>(value) * PRIME_1;
+            hash = RotateLeft(hash, 23) * PRIME_2 + PRIME_3;
+            data += sizeof(uint32_t);
+        }
+        for (; data < data_end; ++data)
         {
-            // Without a leading dot, assume there is no file extension.
-            const std::string NO_EXTENSION = "";
-            return NO_EXTENSION;
+            hash ^= static_cast<uint64_t>(static_cast<unsigned char>(*data)) * PRIME_5;
+            hash = RotateLeft(hash, 11) * PRIME_1;
         }
+
+        // MIX THE FINAL BITS.
+        hash ^= hash >> 33;
+        hash *= PRIME_2;
+        hash ^= hash >> 29;
+        hash *= PRIME_3;
+        hash ^= hash >> 32;
+        return hash;
     }
-    
-    // MEMBER VARIABLES.
-    /// The relative path to the folder containing the file.
-    std::string RelativeFolderPath;
-    /// The relative path to the file.
-    std::string RelativePath;
-    /// The name of the file, including any extension.
-    std::string Name;
+
+    /// Formats a hash as 16 lowercase hexadecimal digits.
+    /// @param[in]  hash - The hash to format.
+    /// @return The formatted hash.
+    static std::string ToHex(const uint64_t hash)
+    {
+        const char HEX_DIGITS[] = "0123456789abcdef";
+        const std::size_t DIGIT_COUNT = 16;
+        std::string hex(DIGIT_COUNT, '0');
+        for (std::size_t digit_index = 0; digit_index < DIGIT_COUNT; ++digit_index)
+        {
+            const unsigned int BITS_PER_DIGIT = 4;
+            unsigned int shift = static_cast<unsigned int>((DIGIT_COUNT - 1 - digit_index) * BITS_PER_DIGIT);
+            hex[digit_index] = HEX_DIGITS[(hash >> shift) & 0xF];
+        }
+        return hex;
+    }
+
+private:
+    /// Mixes 8 bytes of input into a lane.
+    /// @param[in]  lane - The lane's current value.
+    /// @param[in]  input - The input to mix in.
+    /// @return The lane's new value.
+    static uint64_t Round(uint64_t lane, const uint64_t input)
+    {
+        lane += input * PRIME_2;
+        lane = RotateLeft(lane, 31);
+        lane *= PRIME_1;
+        return lane;
+    }
+
+    /// Rotates the bits of a value left.
+    /// @param[in]  value - The value to rotate.
+    /// @param[in]  bit_count - The number of bits to rotate by, which must be between 1 and 63.
+    /// @return The rotated value.
+    static uint64_t RotateLeft(const uint64_t value, const unsigned int bit_count)
+    {
+        const unsigned int BITS_PER_VALUE = 64;
+        return (value << bit_count) | (value >> (BITS_PER_VALUE - bit_count));
+    }
+
+    /// Reads 8 bytes of data, which may not be aligned.
+    /// @param[in]  data - The data to read.
+    /// @return The value of the bytes.
+    static uint64_t Read64(const char* data)
+    {
+        uint64_t value = 0;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    /// The primes that XXH64 mixes bits with.
+    static const uint64_t PRIME_1 = 0x9E3779B185EBCA87ull;
+    static const uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4Full;
+    static const uint64_t PRIME_3 = 0x165667B19E3779F9ull;
+    static const uint64_t PRIME_4 = 0x85EBCA77C2B2AE63ull;
+    static const uint64_t PRIME_5 = 0x27D4EB2F165667C5ull;
+};
+
+const uint64_t ContentHash::PRIME_1;
+const uint64_t ContentHash::PRIME_2;
+const uint64_t ContentHash::PRIME_3;
+const uint64_t ContentHash::PRIME_4;
+const uint64_t ContentHash::PRIME_5;
+
+/// A reference to a string stored in a StringArena.
+struct StringReference
+{
+    /// The offset of the first character of the string within the arena.
+    uint32_t Offset;
+    /// The number of characters in the string.
+    uint32_t Length;
 };
 
-/// A folder on the file system.
-class Folder
+/// A single contiguous block of characters that stores each distinct string only once.
+/// Strings are referenced by offset and length rather than being separately allocated,
+/// and they are not null-terminated.
+class StringArena
 {
 public:
-    // METHODS.
-    /// Gets the folder at the specified path, with its lists of files and subfolders populated.
-    /// @param[in]  relative_path - The relative path to the folder.
-    ///     This path may be relative to anything, but mixing paths relative to different
-    ///     things is not recommended in the same program.
-    /// @return The folder at the specified path, with its lists of files and subfolders populated
-    ///     (assuming any are found).
-    static Folder Get(const std::string& relative_path)
+    /// Gets the reference for a string, adding it to the arena if it hasn't been added yet.
+    /// @param[in]  characters - The characters of the string.
+    /// @param[in]  length - The number of characters in the string.
+    /// @return The reference to the string within the arena.
+    StringReference Intern(const char* characters, const std::size_t length)
     {
-        Folder folder(relative_path);
-        
-        // FIND ALL FILES AND FOLDERS WITHIN THE CURRENT FOLDER.
-        const std::string WILDCARD = "*";
-        std::string find_all_files_and_folders = relative_path + PATH_SEPARATOR + WILDCARD;
-        
-        // This gets the initial file, which should be the current folder.
-        // Error handling could be performed here, but given the context of this program,
-        // it isn't quite worth it yet to add more complicated error handling.
-        // The only side-effects of this failing without error handling is that
-        // a folder is returned without any subfolders or files.
-        WIN32_FIND_DATA file_data;
-        HANDLE search_handle = FindFirstFile(find_all_files_and_folders.c_str(), &file_data);
-        
-        while (FindNextFile(search_handle, &file_data))
+        // GROW THE HASH TABLE IF IT IS GETTING TOO FULL.
+        // Keeping the table at most half full keeps probe sequences short.
+        const std::size_t MIN_SLOT_COUNT = 1024;
+        bool table_too_full = ((Strings.size() + 1) * 2 > Slots.size());
+        if (table_too_full)
         {
-            // ADD THE CURRENT "FILE" TO THE APPROPRIATE LIST DEPENDING ON WHETHER IT IS A FOLDER OR NOT.
-            const unsigned int FILE_ATTRIBUTE_NOT_SET = 0;
-            bool is_directory = (FILE_ATTRIBUTE_NOT_SET != (file_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY));
-            if (is_directory)
+            Rehash(std::max(MIN_SLOT_COUNT, Slots.size() * 2));
+        }
+
+        // FIND THE STRING OR AN EMPTY SLOT FOR IT.
+        std::size_t slot_mask = Slots.size() - 1;
+        std::size_t first_slot_index = static_cast<std::size_t>(ContentHash::Hash(characters, length)) & slot_mask;
+        for (std::size_t slot_index = first_slot_index;; slot_index = (slot_index + 1) & slot_mask)
+        {
+            // ADD THE STRING IF IT ISN'T ALREADY IN THE ARENA.
+            uint32_t string_index = Slots[slot_index];
+            bool slot_empty = (EMPTY_SLOT == string_index);
+            if (slot_empty)
             {
-                // CHECK IF THE CURRENT FILE IS FOR THE CURRENT OR PARENT DIRECTORIES.
-                // These entries may be found by the file finding functions.  Since we don't want to
-                // include them in the list of subfolders, they should be skipped.
-                bool is_current_directory = (std::string(file_data.cFileName) == ".");
-                bool is_parent_directory = (std::string(file_data.cFileName) == "..");
-                bool is_abbreviated_directory = (is_current_directory || is_parent_directory);
-                if (is_abbreviated_directory)
-                {
-                    continue;
-                }
-                
-                // GET AND ADD THE POPULATED SUBFOLDER.
-                std::string subfolder_path = relative_path + PATH_SEPARATOR + file_data.cFileName;
-                Folder subfolder = Get(subfolder_path);
-                folder.Subfolders.push_back(subfolder);
+                StringReference string;
+                string.Offset = static_cast<uint32_t>(Characters.size());
+                string.Length = static_cast<uint32_t>(length);
+                Characters.insert(Characters.end(), characters, characters + length);
+                Slots[slot_index] = static_cast<uint32_t>(Strings.size());
+                Strings.push_back(string);
+                return string;
             }
-            else
+
+            // CHECK IF THE STRING IN THE CURRENT SLOT MATCHES.
+            const StringReference& existing_string = Strings[string_index];
+            bool string_matches = (
+                existing_string.Length == length &&
+                0 == std::memcmp(&Characters[existing_string.Offset], characters, length));
+            if (string_matches)
             {
-                // ADD THE FILE.
-                folder.Files.emplace_back(folder.RelativePath, file_data.cFileName);
+                return existing_string;
             }
         }
-        
-        return folder;
     }
 
-    /// Constructor.  The lists of files and subfolders won't be populated.
-    /// @param[in]  relative_path - The relative path to the folder.
-    ///     This path may be relative to anything, but mixing paths relative to different
-    ///     things is not recommended in the same program.
-    explicit Folder(const std::string& relative_path) :
-        RelativePath(relative_path),
-        Subfolders(),
-        Files()
-    {}
+    /// Gets the characters of a string in the arena.
+    /// @param[in]  string - The string to get.
+    /// @return The string's characters (not null-terminated).
+    const char* GetCharacters(const StringReference& string) const
+    {
+        return Characters.data() + string.Offset;
+    }
+
+    /// Appends a string in the arena to another string.
+    /// @param[in]  string - The string to append.
+    /// @param[in,out]  destination - The string to append to.
+    void Append(const StringReference& string, std::string& destination) const
+    {
+        destination.append(GetCharacters(string), string.Length);
+    }
+
+    // MEMBER VARIABLES.
+    /// The characters of all strings in the arena.
+    std::vector<char> Characters = {};
+    /// All distinct strings in the arena, in the order they were added.
+    std::vector<StringReference> Strings = {};
+
+private:
+    /// The marker for hash table slots that don't have a string.
+    static const uint32_t EMPTY_SLOT = 0xFFFFFFFF;
 
-    /// Gets all header files in this folder and all subfolders.
-    /// @return All header files in this folder.
-    std::vector<File> GetHeaderFiles() const
+    /// Rebuilds the hash table with a new number of slots.
+    /// @param[in]  slot_count - The new number of slots.  Must be a power of 2.
+    void Rehash(const std::size_t slot_count)
     {
-        std::vector<File> header_files;
+        Slots.assign(slot_count, EMPTY_SLOT);
+        std::size_t slot_mask = slot_count - 1;
+        for (std::size_t string_index = 0; string_index < Strings.size(); ++string_index)
+        {
+            const StringReference& string = Strings[string_index];
+            std::size_t slot_index = static_cast<std::size_t>(ContentHash::Hash(GetCharacters(string), string.Length)) & slot_mask;
+            while (EMPTY_SLOT != Slots[slot_index])
+            {
+                slot_index = (slot_index + 1) & slot_mask;
+            }
+            Slots[slot_index] = static_cast<uint32_t>(string_index);
+        }
+    }
+
+    /// The open-addressing hash table of indices into the list of strings.
+    std::vector<uint32_t> Slots = {};
+};
+
+const uint32_t StringArena::EMPTY_SLOT;
 
-        // GET ALL HEADER FILES DIRECTLY IN THIS FOLDER.
-        for (const auto& file : Files)
+/// Rules for which files and folders to leave out of scans, in the same format as .gitignore files,
+/// compiled into a deterministic finite automaton (DFA) over the characters of paths.
+///
+/// Paths are matched relative to a base folder, with '/' between folder names.  Each character of a path is
+/// a single table lookup, no matter how many rules there are.  Every path within a folder starts with the
+/// folder's own path, so the state after a folder's path (and its trailing '/') can be kept while scanning,
+/// and each entry only has its own name matched from there.  As with git, the last rule matching a path
+/// decides if it's ignored, and rules starting with ! include paths that earlier rules ignored.
+///
+/// Rules combining many wildcards can need exponentially many DFA states.  Rather than building them all,
+/// rules whose DFA would have too many states are matched by simulating the nondeterministic automaton (NFA)
+/// the DFA is built from, which is slower per character but takes time and memory in proportion to the rules.
+class IgnoreRules
+{
+public:
+    /// The state once no rule can match, whatever characters follow.  Matching stops early in this state.
+    static const uint32_t NO_MATCH_STATE = 0;
+
+    /// Adds rules.  The rules must be compiled again before they're used.
+    /// @param[in]  rules_text - The rules, one per line, in the .gitignore format.
+    /// @param[in]  base_path - The path of the folder the rules are relative to, from the base folder,
+    ///     with '/' between folder names.  Empty for the base folder itself.
+    /// @param[in]  overriding - True if the rules take priority over all rules added without this flag,
+    ///     even ones added later; false if they take priority over previously added rules.
+    /// @return True if any rules were added; false if there were only blank lines and comments.
+    bool Add(const std::string& rules_text, const std::string& base_path, const bool overriding)
+    {
+        // PARSE EACH LINE.
+        std::vector<Rule> added_rules;
+        for (std::size_t line_start = 0; line_start < rules_text.size();)
         {
-            // INCLUDE THE CURRENT FILE IF IT'S A HEADER FILE.
-            const std::string HEADER_FILE_EXTENSION = ".h";
-            std::string extension = file.ExtensionWithLeadingDot();
-            bool is_header_file = (HEADER_FILE_EXTENSION == extension);
-            if (is_header_file)
+            std::size_t line_end = rules_text.find('\n', line_start);
+            if (std::string::npos == line_end)
+            {
+                line_end = rules_text.size();
+            }
+            Rule rule;
+            bool line_has_rule = Parse(rules_text.substr(line_start, line_end - line_start), base_path, rule);
+            if (line_has_rule)
             {
-                header_files.push_back(file);
+                added_rules.push_back(rule);
             }
+            line_start = line_end + 1;
         }
-        
-        // GET ALL HEADER FILES IN SUBFOLDERS.
-        for (const auto& subfolder : Subfolders)
+
+        // ADD THE RULES IN ORDER OF PRIORITY.
+        // Since the last matching rule wins, overriding rules are always kept at the end.
+        auto insertion_position = Rules.end() - static_cast<std::ptrdiff_t>(overriding ? 0 : OverridingRuleCount);
+        Rules.insert(insertion_position, added_rules.cbegin(), added_rules.cend());
+        if (overriding)
         {
-            // INCLUDE HEADER FILES IN THIS SUBFOLDER.
-            std::vector<File> subfolder_header_files = subfolder.GetHeaderFiles();
-            header_files.insert(
-                header_files.end(),
-                subfolder_header_files.cbegin(),
-                subfolder_header_files.cend());
+            OverridingRuleCount += added_rules.size();
         }
-        
-        return header_files;
+        return !added_rules.empty();
     }
-    
-    /// Gets all .cpp files in this folder and all subfolders.
-    /// @return All .cpp files in this folder.
-    std::vector<File> GetCppFiles() const
+
+    /// Compiles the rules into an automaton so that paths can be matched.
+    void Compile()
     {
-        std::vector<File> cpp_files;
+        // BUILD A NONDETERMINISTIC AUTOMATON (NFA) FOR ALL RULES.
+        // Every rule starts from the same state and ends in its own accepting state.
+        const uint32_t NFA_START_STATE = 0;
+        std::vector<NfaState> nfa_states(1);
+        std::vector<std::bitset<CHARACTER_COUNT>> character_sets;
+        auto add_state = [&nfa_states]()
+        {
+            nfa_states.emplace_back();
+            return static_cast<uint32_t>(nfa_states.size() - 1);
+        };
+        auto add_transition = [&nfa_states, &character_sets](const uint32_t from_state, const std::bitset<CHARACTER_COUNT>& characters, const uint32_t to_state)
+        {
+            nfa_states[from_state].Transitions.emplace_back(static_cast<uint32_t>(character_sets.size()), to_state);
+            character_sets.push_back(characters);
+        };
+        std::bitset<CHARACTER_COUNT> any_character;
+        any_character.set();
+        std::bitset<CHARACTER_COUNT> separator;
+        separator.set(static_cast<unsigned char>('/'));
+        std::bitset<CHARACTER_COUNT> any_character_but_separator = ~separator;
+        for (std::size_t rule_index = 0; rule_index < Rules.size(); ++rule_index)
+        {
+            uint32_t state = NFA_START_STATE;
+            for (const Token& token : Rules[rule_index].Tokens)
+            {
+                uint32_t next_state = add_state();
+                switch (token.Type)
+                {
+                    case TokenType::CHARACTER:
+                        add_transition(state, token.Characters, next_state);
+                        break;
+                    case TokenType::ANY_CHARACTERS:
+                        nfa_states[state].EpsilonTargets.push_back(next_state);
+                        add_transition(next_state, any_character_but_separator, next_state);
+                        break;
+                    case TokenType::ANY_FOLDERS:
+                    {
+                        // The next state is at the start of a folder name, and the added state is within one.
+                        uint32_t folder_name_state = add_state();
+                        nfa_states[state].EpsilonTargets.push_back(next_state);
+                        add_transition(next_state, any_character_but_separator, folder_name_state);
+                        add_transition(folder_name_state, any_character_but_separator, folder_name_state);
+                        add_transition(folder_name_state, separator, next_state);
+                        break;
+                    }
+                    case TokenType::ANYTHING:
+                        add_transition(state, any_character, next_state);
+                        add_transition(next_state, any_character, next_state);
+                        break;
+                }
+                state = next_state;
+            }
+            nfa_states[state].AcceptedRuleIndex = static_cast<uint32_t>(rule_index);
+        }
 
-        // GET ALL CPP FILES DIRECTLY IN THIS FOLDER.
-        for (const auto& file : Files)
+        // GROUP THE CHARACTERS THAT ALL TRANSITIONS TREAT THE SAME.
+        // The automaton's table then only needs a column per group of characters rather than per character.
+        std::map<std::vector<bool>, uint32_t> character_class_indices;
+        std::vector<unsigned int> class_representative_characters;
+        for (unsigned int character = 0; character < CHARACTER_COUNT; ++character)
         {
-            // INCLUDE THE CURRENT FILE IF IT'S A CPP FILE.
-            std::string extension = file.ExtensionWithLeadingDot();
-            bool is_cpp_file = (CPP_FILE_EXTENSION == extension);
-            if (is_cpp_file)
+            std::vector<bool> matching_character_sets;
+            matching_character_sets.reserve(character_sets.size());
+            for (const auto& character_set : character_sets)
+            {
+                matching_character_sets.push_back(character_set[character]);
+            }
+            auto character_class = character_class_indices.emplace(matching_character_sets, static_cast<uint32_t>(class_representative_characters.size()));
+            bool new_class = character_class.second;
+            if (new_class)
             {
-                cpp_files.push_back(file);
+                class_representative_characters.push_back(character);
             }
+            CharacterClasses[character] = static_cast<uint8_t>(character_class.first->second);
         }
-        
-        // GET ALL CPP FILES IN SUBFOLDERS.
-        for (const auto& subfolder : Subfolders)
+        CharacterClassCount = static_cast<uint32_t>(class_representative_characters.size());
+
+        // CONVERT THE NFA TO A DFA.
+        // Each DFA state is the set of NFA states that could be reached by the same characters.
+        // The empty set is added first so that it's the state where nothing can match.
+        // Rules combining many wildcards can need exponentially many DFA states, so conversion stops once there
+        // are too many, and the NFA is simulated while matching instead.
+        std::vector<uint8_t> nfa_states_reached(nfa_states.size(), 0);
+        std::vector<std::vector<uint32_t>> dfa_states = { {} };
+        std::map<std::vector<uint32_t>, uint32_t> dfa_state_indices = { { {}, NO_MATCH_STATE } };
+        std::vector<uint32_t> start_states = { NFA_START_STATE };
+        FollowEpsilonTransitions(nfa_states, nfa_states_reached, start_states);
+        StartState = static_cast<uint32_t>(dfa_states.size());
+        dfa_state_indices.emplace(start_states, StartState);
+        dfa_states.push_back(start_states);
+        Transitions.clear();
+        StateFlags.clear();
+        Simulation.reset();
+        for (std::size_t dfa_state_index = 0; dfa_state_index < dfa_states.size(); ++dfa_state_index)
         {
-            // INCLUDE CPP FILES IN THIS SUBFOLDER.
-            std::vector<File> subfolder_cpp_files = subfolder.GetCppFiles();
-            cpp_files.insert(
-                cpp_files.end(),
-                subfolder_cpp_files.cbegin(),
-                subfolder_cpp_files.cend());
+            // ADD THE TRANSITIONS FOR EACH CHARACTER CLASS.
+            // The state is copied since adding states may move it.
+            const std::vector<uint32_t> nfa_state_set = dfa_states[dfa_state_index];
+            std::vector<uint32_t> next_states;
+            for (unsigned int character : class_representative_characters)
+            {
+                Step(nfa_states, character_sets, nfa_state_set, character, nfa_states_reached, next_states);
+                auto next_dfa_state = dfa_state_indices.emplace(next_states, static_cast<uint32_t>(dfa_states.size()));
+                bool new_dfa_state = next_dfa_state.second;
+                if (new_dfa_state)
+                {
+                    dfa_states.push_back(next_states);
+                }
+                Transitions.push_back(next_dfa_state.first->second);
+            }
+
+            // SIMULATE THE NFA INSTEAD IF THE DFA HAS TOO MANY STATES.
+            bool too_many_dfa_states = (dfa_states.size() > MAX_DFA_STATE_COUNT);
+            if (too_many_dfa_states)
+            {
+                Transitions = std::vector<uint32_t>();
+                StateFlags = std::vector<uint8_t>();
+                Simulation = std::make_shared<NfaSimulation>();
+                Simulation->NfaStates = std::move(nfa_states);
+                Simulation->CharacterSets = std::move(character_sets);
+                std::vector<uint32_t> no_states;
+                AddSimulatedState(no_states);
+                StartState = AddSimulatedState(start_states);
+                return;
+            }
+
+            // DETERMINE WHAT THE STATE IGNORES.
+            StateFlags.push_back(GetStateFlags(nfa_states, nfa_state_set));
         }
-        
-        return cpp_files;
     }
 
-    /// Gets all folders in this folder and including this folder.
-    /// @return This folder and all subfolders.
-    std::vector<Folder> GetAllFolders() const
+    /// Checks if there are any rules.
+    /// @return True if there are no rules; false otherwise.
+    bool Empty() const
     {
-        // INCLUDETHIS FOLDER.
-        std::vector<Folder> all_folders = { *this };
-        
-        // INCLUDE ALL SUBFOLDERS.
-        for (const auto& subfolder : Subfolders)
-        {
-            // INCLUDE ALL SUBFOLDERS OF THIS SUBFOLDER.
-            std::vector<Folder> subfolders = subfolder.GetAllFolders();
-            all_folders.insert(
-                all_folders.end(),
-                subfolders.cbegin(),
-                subfolders.cend());
-        }
-        
-        return all_folders;
+        return Rules.empty();
+    }
+
+    /// Gets the state for matching paths from the base folder.
+    /// @return The state before any characters have been matched.
+    uint32_t GetStartState() const
+    {
+        return StartState;
     }
-    
-    /// Debug printing for a folder.
-    void DebugPrint() const
+
+    /// Matches characters of a path.
+    /// @param[in]  state - The state after the preceding characters of the path.
+    /// @param[in]  characters - The characters to match.
+    /// @param[in]  character_count - The number of characters to match.
+    /// @return The state after the characters.
+    uint32_t Advance(uint32_t state, const char* characters, const std::size_t character_count) const
     {
-        // PRINT THE FOLDER'S PATH.
-        std::cout << "RelativePath: " << RelativePath << std::endl;
-        
-        // PRINT ALL FILES IN THE ROOT OF THIS FOLDER.
-        std::cout << "Files: " << std::endl;
-        for (const auto& file : Files)
+        bool nfa_simulated = (nullptr != Simulation);
+        if (nfa_simulated)
         {
-            std::cout << "\t" << file.RelativePath << std::endl;
+            return AdvanceSimulation(state, characters, character_count);
         }
-        
-        // PRINT ALL SUBFOLDERS.
-        std::cout << "Subfolders: " << std::endl;
-        for (const auto& subfolder : Subfolders)
+        for (std::size_t character_index = 0; character_index < character_count && NO_MATCH_STATE != state; ++character_index)
         {
-            subfolder.DebugPrint();
+            uint8_t character_class = CharacterClasses[static_cast<unsigned char>(characters[character_index])];
+            state = Transitions[state * CharacterClassCount + character_class];
         }
+        return state;
     }
-    
-    /// MEMBER VARIABLES.
-    /// The relative path to the folder.
-    std::string RelativePath;
-    /// A list of subfolders within this folder.
-    std::vector<Folder> Subfolders;
-    /// A list of files in the direct root of this folder.
-    std::vector<File> Files;
-};
 
-/// A Visual Studio solution file.
-class SolutionFile
-{
-public:
-    /// Writes a Visual Studio solution file.
-    /// @param[in]  project_name - The project name for the solution file being generated.
-    /// @param[in,out]  file - The file to write to.
-    static void Write(const std::string& project_name, std::ofstream& file)
+    /// Checks if a path is ignored.
+    /// @param[in]  state - The state after all characters of the path.
+    /// @param[in]  is_directory - True if the path is for a folder; false if it is for a file.
+    /// @return True if the path is ignored; false otherwise.
+    bool IsIgnored(const uint32_t state, const bool is_directory) const
     {
-        // Re-using the same unique IDs across all solution files does not seem to cause any problems.
-        file
-            << "Microsoft Visual Studio Solution File, Format Version 12.00" << std::endl
-            << "# Visual Studio 2013" << std::endl
-            << "VisualStudioVersion = 12.0.31101.0" << std::endl
-            << "MinimumVisualStudioVersion = 10.0.40219.1" << std::endl
-            << "Project(\"{8BC9CEB8-8B4A-11D0-8D11-00A0C91BC942}\") = \"" << project_name << "\", \"" << project_name << ".vcxproj\", \"{46D99A72-17AF-4E62-809F-EECB637F6EE1}" << std::endl
-            << "EndProject" << std::endl
-            << "Global" << std::endl
-            << "    GlobalSection(SolutionConfigurationPlatforms) = preSolution" << std::endl
-            << "        CommandLineBuild|Win32 = CommandLineBuild|Win32" << std::endl
-            << "        Debug|Win32 = Debug|Win32" << std::endl
-            << "        Release|Win32 = Release|Win32" << std::endl
-            << "    EndGlobalSection" << std::endl
-            << "    GlobalSection(ProjectConfigurationPlatforms) = postSolution" << std::endl
-            << "        {46D99A72-17AF-4E62-809F-EECB637F6EE1}.CommandLineBuild|Win32.ActiveCfg = Release|Win32" << std::endl
-            << "        {46D99A72-17AF-4E62-809F-EECB637F6EE1}.CommandLineBuild|Win32.Build.0 = Release|Win32" << std::endl
-            << "        {46D99A72-17AF-4E62-809F-EECB637F6EE1}.Debug|Win32.ActiveCfg = Debug|Win32" << std::endl
-            << "        {46D99A72-17AF-4E62-809F-EECB637F6EE1}.Debug|Win32.Build.0 = Debug|Win32" << std::endl
-            << "        {46D99A72-17AF-4E62-809F-EECB637F6EE1}.Release|Win32.ActiveCfg = Release|Win32" << std::endl
-            << "        {46D99A72-17AF-4E62-809F-EECB637F6EE1}.Release|Win32.Build.0 = Release|Win32" << std::endl
-            << "    EndGlobalSection" << std::endl
-            << "    GlobalSection(SolutionProperties) = preSolution" << std::endl
-            << "        HideSolutionNode = FALSE" << std::endl
-            << "    EndGlobalSection" << std::endl
-            << "EndGlobal" << std::endl;
+        uint8_t ignored_flag = is_directory ? IGNORES_FOLDERS : IGNORES_FILES;
+        bool nfa_simulated = (nullptr != Simulation);
+        if (nfa_simulated)
+        {
+            std::lock_guard<std::mutex> lock(Simulation->StateSetMutex);
+            return (0 != (Simulation->StateFlags[state] & ignored_flag));
+        }
+        return (0 != (StateFlags[state] & ignored_flag));
     }
-};
 
-/// A Visual Studio project file.
-class ProjectFile
-{
-public:
-    /// Writes a Visual Studio project file.
-    /// @param[in]  project_name - The project name for the project file being generated.
-    /// @param[in]  header_files - The header files to include in the project file.
-    /// @param[in]  cpp_files - The .cpp files to include in the project file.
-    /// @param[in,out]  file - The file to write to.
-    static void Write(
-        const std::string& project_name, 
-        const std::vector<File>& header_files, 
-        const std::vector<File>& cpp_files, 
-        std::ofstream& file)
+private:
+    /// The number of distinct characters.
+    static const unsigned int CHARACTER_COUNT = 256;
+    /// The maximum number of states in the DFA, which keeps its table to a few megabytes at most.
+    static const std::size_t MAX_DFA_STATE_COUNT = 4096;
+    /// The flag for states where folders are ignored.
+    static const uint8_t IGNORES_FOLDERS = 0x1;
+    /// The flag for states where files are ignored.
+    static const uint8_t IGNORES_FILES = 0x2;
+
+    /// The types of tokens in a rule's pattern.
+    enum class TokenType
     {
-        // WRITE THE PART OF THE PROJECT FILE BEFORE THE HEADER FILES.
-        file
-            << "<?xml version=\"1.0\" encoding=\"utf-8\"?>" << std::endl
-            << "<Project DefaultTargets=\"Build\" ToolsVersion=\"12.0\" xmlns=\"http://schemas.microsoft.com/developer/msbuild/2003\">" << std::endl
-            << "  <ItemGroup Label=\"ProjectConfigurations\">" << std::endl
-            << "    <ProjectConfiguration Include=\"Debug|Win32\">" << std::endl
-            << "      <Configuration>Debug</Configuration>" << std::endl
-            << "      <Platform>Win32</Platform>" << std::endl
-            << "    </ProjectConfiguration>" << std::endl
-            << "    <ProjectConfiguration Include=\"Release|Win32\">" << std::endl
-            << "      <Configuration>Release</Configuration>" << std::endl
-            << "      <Platform>Win32</Platform>" << std::endl
-            << "    </ProjectConfiguration>" << std::endl
-            << "  </ItemGroup>" << std::endl
-            << "  <ItemGroup>" << std::endl;
-            
-        // WRITE THE INCLUSIONS FOR THE HEADER FILES.
-        for (const auto& header_file : header_files)
+        /// A single character from a set of characters.
+        CHARACTER,
+        /// Any number of characters within a single folder or file name (*).
+        ANY_CHARACTERS,
+        /// Any number of whole folder names, each followed by a separator (**/).
+        ANY_FOLDERS,
+        /// One or more characters of any kind, including separators (a trailing /**).
+        ANYTHING
+    };
+
+    /// A token in a rule's pattern.
+    struct Token
+    {
+        /// The type of the token.
+        TokenType Type;
+        /// The characters matched by the token, for single character tokens.
+        std::bitset<CHARACTER_COUNT> Characters;
+    };
+
+    /// A single rule.
+    struct Rule
+    {
+        /// The tokens to match, from the start of paths relative to the base folder.
+        std::vector<Token> Tokens = {};
+        /// True if the rule includes paths instead of ignoring them; false otherwise.
+        bool Negated = false;
+        /// True if the rule only matches folders; false if it also matches files.
+        bool FolderOnly = false;
+    };
+
+    /// A state in a nondeterministic automaton built from the rules.
+    struct NfaState
+    {
+        /// The marker for states that don't accept any rule.
+        static const uint32_t NO_RULE = 0xFFFFFFFF;
+
+        /// The index of each transition's character set, along with the state it goes to.
+        std::vector<std::pair<uint32_t, uint32_t>> Transitions = {};
+        /// The states reached without matching any characters.
+        std::vector<uint32_t> EpsilonTargets = {};
+        /// The index of the rule matched once this state is reached, or NO_RULE.
+        uint32_t AcceptedRuleIndex = NO_RULE;
+    };
+
+    /// A nondeterministic automaton that's simulated while matching paths, for rules whose DFA would have too many states.
+    /// Each set of NFA states reached is numbered the first time it's reached, so that it can be kept like a DFA state.
+    struct NfaSimulation
+    {
+        /// The states of the NFA.
+        std::vector<NfaState> NfaStates = {};
+        /// The character set of each transition in the NFA.
+        std::vector<std::bitset<CHARACTER_COUNT>> CharacterSets = {};
+        /// Protects the numbered sets of states, which are added to while paths are matched on any thread.
+        std::mutex StateSetMutex;
+        /// Each numbered set of NFA states.
+        std::vector<std::vector<uint32_t>> StateSets = {};
+        /// The number of each set of NFA states.
+        std::map<std::vector<uint32_t>, uint32_t> StateSetIndices = {};
+        /// Flags for what each numbered set of states ignores.
+        std::vector<uint8_t> StateFlags = {};
+    };
+
+    /// Adds the NFA states reached without matching any characters to a set of states, and sorts the set.
+    /// @param[in]  nfa_states - The states of the NFA.
+    /// @param[in,out]  nfa_states_reached - A mark for each NFA state, which must all be clear, and are cleared again.
+    /// @param[in,out]  states - The set of states, without duplicates.
+    static void FollowEpsilonTransitions(const std::vector<NfaState>& nfa_states, std::vector<uint8_t>& nfa_states_reached, std::vector<uint32_t>& states)
+    {
+        // States are marked as they're reached so that the set never contains duplicates.
+        for (uint32_t state : states)
         {
-            file << "    <ClInclude Include=\"" << header_file.RelativePath << "\" />"  << std::endl;
+            nfa_states_reached[state] = 1;
         }
-        
-        file << "  </ItemGroup>" << std::endl;
-        
-        // WRITE THE INCLUSIONS FOR THE CPP FILES.
-        file << "  <ItemGroup>" << std::endl;
-        for (const auto& cpp_file : cpp_files)
+        for (std::size_t state_index = 0; state_index < states.size(); ++state_index)
+        {
+            for (uint32_t target_state : nfa_states[states[state_index]].EpsilonTargets)
+            {
+                if (!nfa_states_reached[target_state])
+                {
+                    nfa_states_reached[target_state] = 1;
+                    states.push_back(target_state);
+                }
+            }
+        }
+        for (uint32_t state : states)
         {
-            file << "    <ClCompile Include=\"" << cpp_file.RelativePath << "\" />" << std::endl;
+            nfa_states_reached[state] = 0;
         }
-            
-        // WRITE THE REMAINDER OF THE PROJECT FILE.
-        file
-            << "  </ItemGroup>" << std::endl
-            << "  <ItemGroup>" << std::endl
-            << "    <None Include=\"build.bat\" />" << std::endl
-            << "  </ItemGroup>" << std::endl
-            << "  <PropertyGroup Label=\"Globals\">" << std::endl
-            // Re-using the same unique IDs across all project files does not seem to cause any problems.
-            << "    <ProjectGuid>{46D99A72-17AF-4E62-809F-EECB637F6EE1}</ProjectGuid>" << std::endl
-            << "    <Keyword>MakeFileProj</Keyword>" << std::endl
-            << "    <ProjectName>" << project_name << "</ProjectName>" << std::endl
-            << "  </PropertyGroup>" << std::endl
-            << "  <Import Project=\"$(VCTargetsPath)\\Microsoft.Cpp.Default.props\" />" << std::endl
-            << "  <PropertyGroup Condition=\"'$(Configuration)|$(Platform)'=='Debug|Win32'\" Label=\"Configuration\">" << std::endl
-            << "    <ConfigurationType>Makefile</ConfigurationType>" << std::endl
-            << "    <UseDebugLibraries>true</UseDebugLibraries>" << std::endl
-            << "    <PlatformToolset>v120</PlatformToolset>" << std::endl
-            << "  </PropertyGroup>" << std::endl
-            << "  <PropertyGroup Condition=\"'$(Configuration)|$(Platform)'=='Release|Win32'\" Label=\"Configuration\">" << std::endl
-            << "    <ConfigurationType>Makefile</ConfigurationType>" << std::endl
-            << "    <UseDebugLibraries>false</UseDebugLibraries>" << std::endl
-            << "    <PlatformToolset>v120</PlatformToolset>" << std::endl
-            << "  </PropertyGroup>" << std::endl
-            << "  <Import Project=\"$(VCTargetsPath)\\Microsoft.Cpp.props\" />" << std::endl
-            << "  <ImportGroup Label=\"ExtensionSettings\">" << std::endl
-            << "  </ImportGroup>" << std::endl
-            << "  <ImportGroup Label=\"PropertySheets\" Condition=\"'$(Configuration)|$(Platform)'=='Debug|Win32'\">" << std::endl
-            << "    <Import Project=\"$(UserRootDir)\\Microsoft.Cpp.$(Platform).user.props\" Condition=\"exists('$(UserRootDir)\\Microsoft.Cpp.$(Platform).user.props')\" Label=\"LocalAppDataPlatform\" />" << std::endl
-            << "  </ImportGroup>" << std::endl
-            << "  <ImportGroup Label=\"PropertySheets\" Condition=\"'$(Configuration)|$(Platform)'=='Release|Win32'\">" << std::endl
-            << "    <Import Project=\"$(UserRootDir)\\Microsoft.Cpp.$(Platform).user.props\" Condition=\"exists('$(UserRootDir)\\Microsoft.Cpp.$(Platform).user.props')\" Label=\"LocalAppDataPlatform\" />" << std::endl
-            << "  </ImportGroup>" << std::endl
-            << "  <PropertyGroup Label=\"UserMacros\" />" << std::endl
-            << "  <PropertyGroup Condition=\"'$(Configuration)|$(Platform)'=='Debug|Win32'\">" << std::endl
-            << "    <NMakeBuildCommandLine>build.bat</NMakeBuildCommandLine>" << std::endl
-            << "    <NMakeOutput>build\\" << project_name << ".exe</NMakeOutput>" << std::endl
-            << "    <NMakePreprocessorDefinitions>WIN32;_DEBUG;$(NMakePreprocessorDefinitions)</NMakePreprocessorDefinitions>" << std::endl
-            << "    <OutDir>build\\</OutDir>" << std::endl
-            << "    <IntDir>build\\</IntDir>" << std::endl
-            << "  </PropertyGroup>" << std::endl
-            << "  <PropertyGroup Condition=\"'$(Configuration)|$(Platform)'=='Release|Win32'\">" << std::endl
-            << "    <NMakeBuildCommandLine>build.bat</NMakeBuildCommandLine>" << std::endl
-            << "    <NMakeOutput>build\\" << project_name << ".exe</NMakeOutput>" << std::endl
-            << "    <NMakePreprocessorDefinitions>WIN32;NDEBUG;$(NMakePreprocessorDefinitions)</NMakePreprocessorDefinitions>" << std::endl
-            << "    <OutDir>build\\</OutDir>" << std::endl
-            << "    <IntDir>build\\</IntDir>" << std::endl
-            << "  </PropertyGroup>" << std::endl
-            << "  <ItemDefinitionGroup>" << std::endl
-            << "  </ItemDefinitionGroup>" << std::endl
-            << "  <Import Project=\"$(VCTargetsPath)\\Microsoft.Cpp.targets\" />" << std::endl
-            << "  <ImportGroup Label=\"ExtensionTargets\">" << std::endl
-            << "  </ImportGroup>" << std::endl
-            << "</Project>" << std::endl;
+        std::sort(states.begin(), states.end());
     }
-};
 
-/// A Visual Studio project filters file.
-class ProjectFiltersFile
-{
-public:
-    /// Writes a Visual Studio project filters file.
-    /// @param[in]  header_files - The header files to include in the project filters file.
-    /// @param[in]  cpp_files - The .cpp files to include in the project filters file.
-    /// @param[in]  folders - The folders to include as filters in file.
-    /// @param[in,out]  file - The file to write to.
-    static void Write(
-        const std::vector<File>& header_files, 
-        const std::vector<File>& cpp_files, 
-        const std::vector<Folder>& folders, 
-        std::ofstream& file)
+    /// Finds the set of NFA states reached from a set of states by a character.
+    /// @param[in]  nfa_states - The states of the NFA.
+    /// @param[in]  character_sets - The character set of each transition in the NFA.
+    /// @param[in]  states - The set of states to start from.
+    /// @param[in]  character - The character to match.
+    /// @param[in,out]  nfa_states_reached - A mark for each NFA state, which must all be clear, and are cleared again.
+    /// @param[out]  next_states - The set of states reached.
+    static void Step(
+        const std::vector<NfaState>& nfa_states,
+        const std::vector<std::bitset<CHARACTER_COUNT>>& character_sets,
+        const std::vector<uint32_t>& states,
+        const unsigned int character,
+        std::vector<uint8_t>& nfa_states_reached,
+        std::vector<uint32_t>& next_states)
     {
-        // WRITE THE PART OF THE FILE BEFORE THE CPP FILES.
-        file
-            << "<?xml version=\"1.0\" encoding=\"utf-8\"?>" << std::endl
-            << "<Project ToolsVersion=\"4.0\" xmlns=\"http://schemas.microsoft.com/developer/msbuild/2003\">" << std::endl
-            << "  <ItemGroup>" << std::endl;
-            
-        // WRITE THE CPP FILES.
-        for (const auto& cpp_file : cpp_files)
+        next_states.clear();
+        for (uint32_t nfa_state : states)
         {
-            file
-                << "    <ClCompile Include=\"" << cpp_file.RelativePath << "\">" << std::endl
-                << "      <Filter>" << cpp_file.RelativeFolderPath << "</Filter>" << std::endl
-                << "    </ClCompile>" << std::endl;
+            for (const auto& transition : nfa_states[nfa_state].Transitions)
+            {
+                bool transition_matches = character_sets[transition.first][character] && !nfa_states_reached[transition.second];
+                if (transition_matches)
+                {
+                    nfa_states_reached[transition.second] = 1;
+                    next_states.push_back(transition.second);
+                }
+            }
         }
-            
-        // WRITE THE PART OF THE FILE BETWEEN THE CPP FILES AND FOLDER FILTERS.
-        file
-            << "  </ItemGroup>" << std::endl
-            << "  <ItemGroup>" << std::endl
-            << "    <None Include=\"build.bat\" />" << std::endl
-            << "  </ItemGroup>" << std::endl
-            << "  <ItemGroup>" << std::endl;
-            
-        // WRITE THE FOLDER FILTERS.
-        for (const auto& folder : folders)
+        FollowEpsilonTransitions(nfa_states, nfa_states_reached, next_states);
+    }
+
+    /// Determines what a set of NFA states ignores.
+    /// @param[in]  nfa_states - The states of the NFA.
+    /// @param[in]  states - The set of states.
+    /// @return The flags for what the set of states ignores.
+    uint8_t GetStateFlags(const std::vector<NfaState>& nfa_states, const std::vector<uint32_t>& states) const
+    {
+        // Folder-only rules don't apply to files, so files can be decided by a different rule.
+        const uint32_t NO_RULE = NfaState::NO_RULE;
+        uint32_t last_folder_rule_index = NO_RULE;
+        uint32_t last_file_rule_index = NO_RULE;
+        for (uint32_t nfa_state : states)
         {
-            // Re-using the same unique IDs here does not seem to cause any problems.
-            file
-                << "    <Filter Include=\"" << folder.RelativePath << "\">" << std::endl
-                << "      <UniqueIdentifier>{96873809-db68-49b8-8a4b-a40a3c3972f6}</UniqueIdentifier>" << std::endl
-                << "    </Filter>" << std::endl;
+            uint32_t rule_index = nfa_states[nfa_state].AcceptedRuleIndex;
+            if (NO_RULE == rule_index)
+            {
+                continue;
+            }
+            bool last_folder_rule = (NO_RULE == last_folder_rule_index || rule_index > last_folder_rule_index);
+            if (last_folder_rule)
+            {
+                last_folder_rule_index = rule_index;
+            }
+            bool last_file_rule = !Rules[rule_index].FolderOnly && (NO_RULE == last_file_rule_index || rule_index > last_file_rule_index);
+            if (last_file_rule)
+            {
+                last_file_rule_index = rule_index;
+            }
         }
-        
-        file
-            << "  </ItemGroup>" << std::endl
-            << "  <ItemGroup>" << std::endl;
-            
-        // WRITE THE HEADER FILES.
-        for (const auto& header_file : header_files)
+        uint8_t state_flags = 0;
+        bool folders_ignored = (NO_RULE != last_folder_rule_index && !Rules[last_folder_rule_index].Negated);
+        if (folders_ignored)
         {
-            file
-                << "    <ClInclude Include=\"" << header_file.RelativePath << "\">" << std::endl
-                << "      <Filter>" << header_file.RelativeFolderPath << "</Filter>" << std::endl
-                << "    </ClInclude>" << std::endl;
+            state_flags |= IGNORES_FOLDERS;
         }
-         
-        // WRITE THE REMAINDER OF THE FILE.
-        file
-            << "  </ItemGroup>" << std::endl
-            << "</Project>" << std::endl;
+        bool files_ignored = (NO_RULE != last_file_rule_index && !Rules[last_file_rule_index].Negated);
+        if (files_ignored)
+        {
+            state_flags |= IGNORES_FILES;
+        }
+        return state_flags;
     }
-};
 
-/// A basic build script as a batch file for a project.
-class BuildScriptBatchFile
-{
-public:
-    /// Writes the build script batch file.
-    /// @param[in]  project_cpp_filename - The filename of .cpp file to compile to build the entire project.
-    ///     The file is used as the main file for a "unity" or "single translation unit" build.
-    /// @param[in]  code_folder - The folder containing all code files for the project.
-    ///     It's path will be added as an include path.
-    /// @param[in,out]  file - The file to write to.
-    static void Write(const std::string& project_cpp_filename, const Folder& code_folder, std::ofstream& file)
+    /// Numbers a set of NFA states for the simulated NFA, if it hasn't been numbered yet.
+    /// @param[in]  states - The set of states.
+    /// @return The number of the set of states, which is used as its state.
+    uint32_t AddSimulatedState(const std::vector<uint32_t>& states) const
     {
-        file
-            << "@ECHO off" << std::endl
-            << std::endl
-            << "REM PUT THE COMPILER IN THE PATH." << std::endl
-            << "REM This isn't necessary and may cause problems if this file is run repeatedly in a command prompt." << std::endl
-            << "REM Remove it if you'd prefer to take care of this in some other way." << std::endl
-            << "REM Change the path if you'd prefer to use a different version of the Visual Studio compiler." << std::endl
-            << "CALL \"C:\\Program Files (x86)\\Microsoft Visual Studio 12.0\\VC\\vcvarsall.bat\" x64" << std::endl
-            << std::endl
-            << "REM MOVE INTO THE BUILD DIRECTORY." << std::endl
-            << "IF NOT EXIST \"build\" MKDIR \"build\"" << std::endl
-            << "PUSHD \"build\"" << std::endl
-            << std::endl
-            << "    REM BUILD THE PROGRAM." << std::endl
-            << "    REM See https://msdn.microsoft.com/en-us/library/fwkeyyhe.aspx for compiler options." << std::endl
-            << "    REM The compiler options listed here are just one set of options and definitively don't support much variability." << std::endl
-            << "    REM Support for more variability in this build script may be added later, but feel free to not use this basic template and" << std::endl
-            << "    REM just create your own build script as needed." << std::endl
-            << "    REM /Zi - debug info" << std::endl
-            << "    REM /EHa - The exception-handling model that catches both asynchronous (structured) and synchronous (C++) exceptions." << std::endl
-            << "    REM /WX - All warnings as errors" << std::endl
-            << "    REM /W4 - Warning level 4" << std::endl
-            << "    REM /MTd - Static linking with Visual C++ lib." << std::endl
-            << "    REM /I - Additional include directories." << std::endl
-            << "    REM user32.lib and gdi32.lib - Basic Windows functions.  Remove if not needed." << std::endl
-            << "    cl.exe /Zi /EHa /WX /W4 /MTd \"..\\" << project_cpp_filename << "\" /I \"..\\" << code_folder.RelativePath << "\" user32.lib gdi32.lib" << std::endl
-            << "" << std::endl
-            << "POPD" << std::endl
-            << std::endl
-            << "@ECHO ON" << std::endl;
+        std::lock_guard<std::mutex> lock(Simulation->StateSetMutex);
+        auto state_set = Simulation->StateSetIndices.emplace(states, static_cast<uint32_t>(Simulation->StateSets.size()));
+        bool new_state_set = state_set.second;
+        if (new_state_set)
+        {
+            Simulation->StateSets.push_back(states);
+            Simulation->StateFlags.push_back(GetStateFlags(Simulation->NfaStates, states));
+        }
+        return state_set.first->second;
     }
-};
 
-/// The entry point for the Visual Studio project file generator.  The goal of this program is to make it
-/// easy to generate Visual Studio project files, given a folder of code files, that allows building
-/// a project using a simple build.bat script for a "unity" or "single translation unit" build.
-///
-/// Assuming this was compiled using the accompanying build script, the program should be run as follows:
-///     GenerateProject.exe <ProjectName> <CodeFolderRelativePath>
-///
-/// This program will then generate the following files in the current folder:
-/// - ProjectName.sln - A Visual Studio solution file containing the generated project file.
-/// - ProjectName.vcxproj - A Visual Studio project file containing all .h and .cpp files in the code folder,
-///     along with the build.bat script generated in the current folder that is used to build the project.
-/// - ProjectName.vcxproj.filters - A Visual Studio project filters file containing the files in the project file,
-///     along with the build.bat script.  Filters are added according to the folder hierarchy in the code folder.
-/// - build.bat - A basic build.bat script for building the project by building a "ProjectName.cpp" file.
-///     The code folder will be added as an additional include directory.  This is one of the most incomplete parts
-///     of this program so far.  It doesn't support a wide variety of options, so you'll likely need to
-///     make modifications (or not use it altogether).  See the generated file (or this source code) for details.
-///     IMPORTANT: THIS WILL OVERWRITE ANY BUILD.BAT FILE IN THE CURRENT DIRECTORY, SO MAKE SURE YOU DON'T
-///     USE THIS PROGRAM IF YOU HAVE A CUSTOM BUILD.BAT FILE!
-///
-/// Note that this program is still in its very early stages, and there is very little need for it
-/// to be super robust or feature rich.  The goal was to just get a program working to get the bulk
-/// of some mundane work taken care of.  Updates will be made as desired and as time permits.
-///
-/// @param[in]  argument_count - The number of command line arguments.
-/// @param[in]  arguments - The command line arguments.
-/// @return 0 if the program completed successfully; another value if an error occurred.
-int main(int argument_count, char* arguments[])
-{
-    // MAKE SURE THE REQUIRED COMMAND LINE ARGUMENTS WERE PROVIDED.
-    // The first argument should be the program name/path.
-    const unsigned int EXPECTED_ARGUMENT_COUNT = 3;
-    bool expected_arguments_provided = (EXPECTED_ARGUMENT_COUNT == argument_count);
-    if (!expected_arguments_provided)
+    /// Matches characters of a path by simulating the NFA.
+    /// @param[in]  state - The state after the preceding characters of the path.
+    /// @param[in]  characters - The characters to match.
+    /// @param[in]  character_count - The number of characters to match.
+    /// @return The state after the characters.
+    uint32_t AdvanceSimulation(const uint32_t state, const char* characters, const std::size_t character_count) const
     {
-        std::cerr << "Missing command line arguments!  Usage: "<< std::endl;
-        std::cerr << "\t GenerateProject.exe <ProjectName> <CodeFolderRelativePath>" << std::endl;
+        // GET THE SET OF NFA STATES TO START FROM.
+        if (NO_MATCH_STATE == state)
+        {
+            return NO_MATCH_STATE;
+        }
+        std::vector<uint32_t> states;
+        {
+            std::lock_guard<std::mutex> lock(Simulation->StateSetMutex);
+            states = Simulation->StateSets[state];
+        }
+
+        // MATCH EACH CHARACTER.
+        std::vector<uint8_t> nfa_states_reached(Simulation->NfaStates.size(), 0);
+        std::vector<uint32_t> next_states;
+        for (std::size_t character_index = 0; character_index < character_count && !states.empty(); ++character_index)
+        {
+            unsigned int character = static_cast<unsigned char>(characters[character_index]);
+            Step(Simulation->NfaStates, Simulation->CharacterSets, states, character, nfa_states_reached, next_states);
+            states.swap(next_states);
+        }
+        if (states.empty())
+        {
+            return NO_MATCH_STATE;
+        }
+        return AddSimulatedState(states);
     }
-    
-    // READ THE COMMAND LINE ARGUMENTS.
-    const unsigned int PROJECT_NAME_COMMAND_LINE_ARGUMENT_INDEX = 1;
-    std::string project_name = arguments[PROJECT_NAME_COMMAND_LINE_ARGUMENT_INDEX];
-    
-    const unsigned int CODE_FOLDER_PATH_COMMAND_LINE_ARGUMENT_INDEX = 2;
-    std::string code_folder_path = arguments[CODE_FOLDER_PATH_COMMAND_LINE_ARGUMENT_INDEX];
-    
-    // GET THE CODE FOLDER.
-    Folder code_folder = Folder::Get(code_folder_path);
-    code_folder.DebugPrint();
-    
-    // WRITE THE SOLUTION FILE.
-    std::string solution_filename = project_name + SOLUTION_FILE_EXTENSION;
-    std::ofstream solution_file(solution_filename);
-    SolutionFile::Write(project_name, solution_file);
-    solution_file.close();
-    
-    // GET THE CODE FILES FOR THE PROJECT.
-    std::vector<File> header_files = code_folder.GetHeaderFiles();
-    std::vector<File> cpp_files = code_folder.GetCppFiles();
-    
-    // Include the main CPP file for the project for the build script.
-    // There may be a better way to handle this, but that hasn't been
-    // too critical to think about at this stage of development.
-    const std::string IN_ROOT_CODE_FOLDER = "";
-    std::string project_cpp_filename = project_name + CPP_FILE_EXTENSION;
-    cpp_files.emplace_back(IN_ROOT_CODE_FOLDER, project_cpp_filename);
-    
-    // WRITE THE PROJECT FILE.
-    std::string project_filename = project_name + PROJECT_FILE_EXTENSION;
-    std::ofstream project_file(project_filename);
-    ProjectFile::Write(project_name, header_files, cpp_files, project_file);
-    project_file.close();
-    
-    // WRITE THE PROJECT FILTERS FILE.
-    std::vector<Folder> code_folders = code_folder.GetAllFolders();
-    std::string project_filters_filename = project_name + PROJECT_FILTERS_FILE_EXTENSION;
-    std::ofstream project_filters_file(project_filters_filename);
-    ProjectFiltersFile::Write(header_files, cpp_files, code_folders, project_filters_file);
-    project_filters_file.close();
-    
-    // WRITE THE BUILD SCRIPT FILE.
-    const std::string BUILD_SCRIPT_FILENAME = "build.bat";
-    std::ofstream build_script_file(BUILD_SCRIPT_FILENAME);
-    BuildScriptBatchFile::Write(project_cpp_filename, code_folder, build_script_file);
-    build_script_file.close();
-
-    return EXIT_SUCCESS;
-}
+
+    /// Parses a line of rules text.
+    /// @param[in]  line - The line to parse.
+    /// @param[in]  base_path - The path of the folder the rule is relative to, from the base folder.
+    /// @param[out]  rule - The parsed rule.
+    /// @return True if the line contained a rule; false if it was blank or a comment.
+    static bool Parse(std::string line, const std::string& base_path, Rule& rule)
+    {
+        // REMOVE THE LINE ENDING AND TRAILING SPACES.
+        // Trailing spaces are only kept if escaped with a backslash.
+        const char ESCAPE = '\\';
+        const char SEPARATOR = '/';
+        if (!line.empty() && '\r' == line.back())
+        {
+            line.pop_back();
+        }
+        while (!line.empty() && ' ' == line.back())
+        {
+            bool space_escaped = (line.size() >= 2 && ESCAPE == line[line.size() - 2]);
+            if (space_escaped)
+            {
+                break;
+            }
+            line.pop_back();
+        }
+
+        // SKIP BLANK LINES AND COMMENTS.
+        const char COMMENT_START = '#';
+        bool line_has_rule = (!line.empty() && COMMENT_START != line.front());
+        if (!line_has_rule)
+        {
+            return false;
+        }
+
+        // HANDLE ANY NEGATION OR TRAILING SEPARATOR.
+        // Patterns with separators anywhere else only match from the base path.  Other patterns match at any depth.
+        const char NEGATION = '!';
+        rule.Negated = (NEGATION == line.front());
+        if (rule.Negated)
+        {
+            line.erase(0, 1);
+        }
+        rule.FolderOnly = (!line.empty() && SEPARATOR == line.back());
+        if (rule.FolderOnly)
+        {
+            line.pop_back();
+        }
+        bool anchored = (std::string::npos != line.find(SEPARATOR));
+        if (!line.empty() && SEPARATOR == line.front())
+        {
+            line.erase(0, 1);
+        }
+        if (line.empty())
+        {
+            return false;
+        }
+
+        // ADD TOKENS FOR THE BASE PATH.
+        auto add_character = [&rule](const std::bitset<CHARACTER_COUNT>& characters)
+        {
+            rule.Tokens.push_back({ TokenType::CHARACTER, characters });
+        };
+        auto add_token = [&rule](const TokenType type)
+        {
+            rule.Tokens.push_back({ type, std::bitset<CHARACTER_COUNT>() });
+        };
+        if (!base_path.empty())
+        {
+            for (char character : base_path)
+            {
+                add_character(ToCharacterSet(character));
+            }
+            add_character(ToCharacterSet(SEPARATOR));
+        }
+        if (!anchored)
+        {
+            add_token(TokenType::ANY_FOLDERS);
+        }
+
+        // ADD TOKENS FOR THE PATTERN.
+        std::bitset<CHARACTER_COUNT> any_character_but_separator;
+        any_character_but_separator.set();
+        any_character_but_separator.reset(static_cast<unsigned char>(SEPARATOR));
+        for (std::size_t character_index = 0; character_index < line.size(); ++character_index)
+        {
+            char character = line[character_index];
+            bool character_escaped = (ESCAPE == character && character_index + 1 < line.size());
+            if (character_escaped)
+            {
+                ++character_index;
+                add_character(ToCharacterSet(line[character_index]));
+                continue;
+            }
+
+            // HANDLE WILDCARDS.
+            // Two or more asterisks forming a whole name match across folders; otherwise, they're like a single one.
+            const char WILDCARD = '*';
+            if (WILDCARD == character)
+            {
+                std::size_t wildcard_end_index = line.find_first_not_of(WILDCARD, character_index);
+                if (std::string::npos == wildcard_end_index)
+                {
+                    wildcard_end_index = line.size();
+                }
+                bool multiple_wildcards = (wildcard_end_index - character_index > 1);
+                bool starts_name = (0 == character_index || SEPARATOR == line[character_index - 1]);
+                bool pattern_ends = (line.size() == wildcard_end_index);
+                bool ends_name = (pattern_ends || SEPARATOR == line[wildcard_end_index]);
+                bool matches_across_folders = (multiple_wildcards && starts_name && ends_name);
+                if (matches_across_folders && pattern_ends)
+                {
+                    add_token(TokenType::ANYTHING);
+                }
+                else if (matches_across_folders)
+                {
+                    // The separator after the asterisks is part of the token.
+                    add_token(TokenType::ANY_FOLDERS);
+                    ++wildcard_end_index;
+                }
+                else
+                {
+                    add_token(TokenType::ANY_CHARACTERS);
+                }
+                character_index = wildcard_end_index - 1;
+                continue;
+            }
+            const char SINGLE_CHARACTER_WILDCARD = '?';
+            if (SINGLE_CHARACTER_WILDCARD == character)
+            {
+                add_character(any_character_but_separator);
+                continue;
+            }
+
+            // HANDLE CHARACTER RANGES.
+            // Brackets without a closing bracket are matched literally.
+            const char RANGE_START = '[';
+            if (RANGE_START == character)
+            {
+                std::bitset<CHARACTER_COUNT> range_characters;
+                std::size_t range_end_index = ParseRange(line, character_index, range_characters);
+                bool range_closed = (line.size() != range_end_index);
+                if (range_closed)
+                {
+                    add_character(range_characters & any_character_but_separator);
+                    character_index = range_end_index;
+                    continue;
+                }
+            }
+
+            add_character(ToCharacterSet(character));
+        }
+        return true;
+    }
+
+    /// Parses a range of characters in brackets, such as [a-z] or [!0-9].
+    /// @param[in]  pattern - The pattern containing the range.
+    /// @param[in]  range_start_index - The index of the opening bracket.
+    /// @param[out]  range_characters - The characters matched by the range.
+    /// @return The index of the closing bracket, or the size of the pattern if there isn't one.
+    static std::size_t ParseRange(const std::string& pattern, const std::size_t range_start_index, std::bitset<CHARACTER_COUNT>& range_characters)
+    {
+        // CHECK IF THE RANGE IS NEGATED.
+        std::size_t character_index = range_start_index + 1;
+        bool range_negated = (character_index < pattern.size() && ('!' == pattern[character_index] || '^' == pattern[character_index]));
+        if (range_negated)
+        {
+            ++character_index;
+        }
+
+        // ADD EACH CHARACTER OR SPAN OF CHARACTERS.
+        // A closing bracket right at the start is part of the range rather than ending it.
+        const char ESCAPE = '\\';
+        const char RANGE_END = ']';
+        auto read_character = [&pattern, ESCAPE](std::size_t& index)
+        {
+            bool character_escaped = (ESCAPE == pattern[index] && index + 1 < pattern.size());
+            if (character_escaped)
+            {
+                ++index;
+            }
+            return static_cast<unsigned char>(pattern[index++]);
+        };
+        std::size_t first_character_index = character_index;
+        while (character_index < pattern.size() && (first_character_index == character_index || RANGE_END != pattern[character_index]))
+        {
+            unsigned char first_character = read_character(character_index);
+            unsigned char last_character = first_character;
+            bool span_present = (character_index + 1 < pattern.size() && '-' == pattern[character_index] && RANGE_END != pattern[character_index + 1]);
+            if (span_present)
+            {
+                ++character_index;
+                last_character = read_character(character_index);
+            }
+            for (unsigned int span_character = first_character; span_character <= last_character; ++span_character)
+            {
+                range_characters |= ToCharacterSet(static_cast<char>(span_character));
+            }
+        }
+        if (range_negated)
+        {
+            range_characters.flip();
+        }
+        return std::min(character_index, pattern.size());
+    }
+
+    /// Gets the set of characters that match a character.
+    /// @param[in]  character - The character to match.
+    /// @return The set of matching characters.  On Windows, this includes both cases of letters,
+    ///     since file names aren't case sensitive there.
+    static std::bitset<CHARACTER_COUNT> ToCharacterSet(const char character)
+    {
+        std::bitset<CHARACTER_COUNT> characters;
+        characters.set(static_cast<unsigned char>(character));
+#if defined(_WIN32)
+        bool is_lowercase = ('a' <= character && character <= 'z');
+        bool is_uppercase = ('A' <= character && character <= 'Z');
+        const int CASE_OFFSET = 'a' - 'A';
+        if (is_lowercase)
+        {
+            characters.set(static_cast<unsigned char>(character - CASE_OFFSET));
+        }
+        else if (is_uppercase)
+        {
+            characters.set(static_cast<unsigned char>(character + CASE_OFFSET));
+        }
+#endif
+        return characters;
+    }
+
+    // MEMBER VARIABLES.
+    /// The rules, in increasing order of priority.
+    std::vector<Rule> Rules = {};
+    /// The number of rules at the end of the list that were added as overriding rules.
+    std::size_t OverridingRuleCount = 0;
+    /// The class of each character in the transition table.
+    uint8_t CharacterClasses[CHARACTER_COUNT] = {};
+    /// The number of character classes.
+    uint32_t CharacterClassCount = 0;
+    /// The state reached from each state for each character class, with a row per state.
+    std::vector<uint32_t> Transitions = {};
+    /// Flags for what each state ignores.
+    std::vector<uint8_t> StateFlags = {};
+    /// The state before any characters have been matched.
+    uint32_t StartState = NO_MATCH_STATE;
+    /// The simulated NFA, if the rules' DFA would have too many states; null otherwise.
+    /// Copies of the rules share it until they're compiled again.
+    std::shared_ptr<NfaSimulation> Simulation = nullptr;
+};
+
+const uint32_t IgnoreRules::NO_MATCH_STATE;
+const unsigned int IgnoreRules::CHARACTER_COUNT;
+const std::size_t IgnoreRules::MAX_DFA_STATE_COUNT;
+const uint8_t IgnoreRules::IGNORES_FOLDERS;
+const uint8_t IgnoreRules::IGNORES_FILES;
+const uint32_t IgnoreRules::NfaState::NO_RULE;
+
+/// Identifies a folder on disk no matter which path it's reached by, so that the same folder
+/// reached through symbolic links or junctions can be recognized.
+struct FolderIdentity
+{
+    /// Determines if the identity is known.  File systems never give a folder an ID of zero.
+    /// @return True if the identity is known; false otherwise.
+    bool IsKnown() const
+    {
+        const uint64_t UNKNOWN_FILE_ID = 0;
+        return UNKNOWN_FILE_ID != FileId;
+    }
+
+    /// Determines if two identities are for the same folder.
+    /// @param[in]  other - The identity to compare with.
+    /// @return True if the identities are equal; false otherwise.
+    bool operator==(const FolderIdentity& other) const
+    {
+        return (Device == other.Device) && (FileId == other.FileId);
+    }
+
+    /// The device (or volume) containing the folder.
+    uint64_t Device;
+    /// The ID of the folder within its device (its inode number on POSIX systems).
+    uint64_t FileId;
+};
+
+/// Hashes folder identities for use in unordered containers.
+struct FolderIdentityHash
+{
+    /// Hashes a folder identity.
+    /// @param[in]  identity - The identity to hash.
+    /// @return The hash of the identity.
+    std::size_t operator()(const FolderIdentity& identity) const
+    {
+        // Folders are usually on the same device, so the ID is mixed in with a multiplier to spread it out.
+        const uint64_t GOLDEN_RATIO_MULTIPLIER = 0x9E3779B97F4A7C15ull;
+        uint64_t hash = (identity.FileId * GOLDEN_RATIO_MULTIPLIER) ^ identity.Device;
+        return static_cast<std::size_t>(hash ^ (hash >> 32));
+    }
+};
+
+/// The entries found directly within a single folder while scanning.  Scanned folders only
+/// exist while scanning, after which they're flattened into a FolderTree.  Entry names are
+/// packed into a single buffer so that scanning a folder takes a fixed number of allocations
+/// regardless of how many entries it has.
+class ScannedFolder
+{
+public:
+    /// Constructor.  The folder's entries won't be populated.
+    /// @param[in]  relative_path - The relative path to the folder.
+    explicit ScannedFolder(const std::string& relative_path) :
+        RelativePath(relative_path)
+    {}
+
+    /// Adds an entry found within the folder.
+    /// @param[in]  name - The null-terminated name of the entry.
+    /// @param[in]  is_directory - True if the entry is a subfolder; false if it is a file.
+    void AddEntry(const char* name, const bool is_directory)
+    {
+        AddEntry(name, std::strlen(name), is_directory);
+    }
+
+    /// Adds an entry found within the folder.
+    /// @param[in]  name - The name of the entry.
+    /// @param[in]  name_length - The number of characters in the name.
+    /// @param[in]  is_directory - True if the entry is a subfolder; false if it is a file.
+    void AddEntry(const char* name, const std::size_t name_length, const bool is_directory)
+    {
+        uint32_t name_offset = static_cast<uint32_t>(EntryNames.size());
+        EntryNames.append(name, name_length);
+        EntryNames.push_back('\0');
+        if (is_directory)
+        {
+            SubfolderNameOffsets.push_back(name_offset);
+        }
+        else
+        {
+            FileNameOffsets.push_back(name_offset);
+        }
+    }
+
+    /// Adds a subfolder found within the folder that is a symbolic link (or junction) to a folder.
+    /// @param[in]  name - The name of the subfolder.
+    /// @param[in]  name_length - The number of characters in the name.
+    void AddLinkedSubfolder(const char* name, const std::size_t name_length)
+    {
+        const bool IS_DIRECTORY = true;
+        LinkedSubfolderNameOffsets.push_back(static_cast<uint32_t>(EntryNames.size()));
+        AddEntry(name, name_length, IS_DIRECTORY);
+    }
+
+    /// Gets the name of an entry in the folder.
+    /// @param[in]  name_offset - The offset of the entry's name.
+    /// @return The null-terminated name of the entry.
+    const char* GetEntryName(const uint32_t name_offset) const
+    {
+        return EntryNames.c_str() + name_offset;
+    }
+
+    /// Determines if a subfolder is a link to a folder.
+    /// @param[in]  name_offset - The offset of the subfolder's name.
+    /// @return True if the subfolder is a link; false otherwise.
+    bool IsLinkedSubfolder(const uint32_t name_offset) const
+    {
+        // Names are added in order, so their offsets are sorted.
+        return std::binary_search(LinkedSubfolderNameOffsets.cbegin(), LinkedSubfolderNameOffsets.cend(), name_offset);
+    }
+
+    // MEMBER VARIABLES.
+    /// The marker for folders that weren't in a previous scan.
+    static const uint32_t NOT_PREVIOUSLY_SCANNED = 0xFFFFFFFF;
+
+    /// The relative path to the folder.
+    std::string RelativePath;
+    /// The time the folder's entries were last modified, in the file system's native units.
+    uint64_t ModificationTime = 0;
+    /// The folder's identity on disk, if known.
+    FolderIdentity Identity = {};
+    /// True if the folder is a link to another folder; false otherwise.
+    bool IsLink = false;
+    /// True if the folder's entries were copied from the same folder reached by another path; false if they were listed.
+    bool IsAlias = false;
+    /// True if the folder was left out after it was created, such as for a link leading back to a folder
+    /// containing it; false otherwise.  Left out folders are skipped when the scanned folders are flattened.
+    bool LeftOut = false;
+    /// The folder containing this folder, or null for the root folder.
+    const ScannedFolder* Parent = nullptr;
+    /// The folder reached by another path whose entries this folder has, if it's an alias; null otherwise.
+    const ScannedFolder* AliasedFolder = nullptr;
+    /// The index of the same folder in the tree from a previous scan, if it was in the previous scan.
+    uint32_t PreviousFolderIndex = NOT_PREVIOUSLY_SCANNED;
+    /// The rules for which of the folder's entries to ignore, or null if nothing is ignored.
+    const IgnoreRules* ApplicableIgnoreRules = nullptr;
+    /// The state of the ignore rules after matching the folder's path.
+    uint32_t IgnoreRulesState = IgnoreRules::NO_MATCH_STATE;
+    /// The null-terminated names of all entries in the folder.
+    std::string EntryNames = "";
+    /// The offsets of the names of files in the folder.
+    std::vector<uint32_t> FileNameOffsets = {};
+    /// The offsets of the names of subfolders in the folder.
+    std::vector<uint32_t> SubfolderNameOffsets = {};
+    /// The offsets of the names of subfolders that are links, in order.  Ignored subfolders aren't removed from these.
+    std::vector<uint32_t> LinkedSubfolderNameOffsets = {};
+    /// The scanned subfolders, in the same order as their names.
+    std::vector<ScannedFolder> Subfolders = {};
+};
+
+const uint32_t ScannedFolder::NOT_PREVIOUSLY_SCANNED;
+
+/// Text encoded as UTF-8, as produced when reading escaped characters from JSON and XML.
+class Utf8Text
+{
+public:
+    /// Appends a character to text, encoded as UTF-8.
+    /// @param[in]  code_point - The Unicode code point of the character.
+    /// @param[in,out]  text - The text to append to.
+    static void Append(const uint32_t code_point, std::string& text)
+    {
+        const uint32_t MAX_ONE_BYTE_CODE_POINT = 0x7F;
+        const uint32_t MAX_TWO_BYTE_CODE_POINT = 0x7FF;
+        const uint32_t MAX_THREE_BYTE_CODE_POINT = 0xFFFF;
+        if (code_point <= MAX_ONE_BYTE_CODE_POINT)
+        {
+            text.push_back(static_cast<char>(code_point));
+        }
+        else if (code_point <= MAX_TWO_BYTE_CODE_POINT)
+        {
+            text.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+            text.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+        }
+        else if (code_point <= MAX_THREE_BYTE_CODE_POINT)
+        {
+            text.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+            text.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+            text.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+        }
+        else
+        {
+            text.push_back(static_cast<char>(0xF0 | ((code_point >> 18) & 0x07)));
+            text.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+            text.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+            text.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+        }
+    }
+};
+
+/// A value read from JSON text (see https://www.json.org), such as a request sent to the server (see GeneratorServer).
+/// Only small messages are expected, so values are simply nested objects, and object members are kept in order
+/// and found by searching through them.
+class JsonValue
+{
+public:
+    /// The types of JSON values.
+    enum class Type
+    {
+        /// null.
+        NULL_VALUE,
+        /// true or false (see Boolean).
+        BOOLEAN,
+        /// A number (see Number).
+        NUMBER,
+        /// A string (see String).
+        STRING,
+        /// An array (see Elements).
+        ARRAY,
+        /// An object (see Members).
+        OBJECT
+    };
+
+    /// Parses JSON text.
+    /// @param[in]  text - The text to parse, which must contain a single value (with optional surrounding whitespace).
+    /// @param[out]  value - The parsed value.
+    /// @return True if the text was valid JSON; false otherwise.
+    static bool Parse(const std::string& text, JsonValue& value)
+    {
+        const char* position = text.c_str();
+        const char* end = position + text.size();
+        const unsigned int TOP_LEVEL_DEPTH = 0;
+        bool value_parsed = ParseValue(position, end, TOP_LEVEL_DEPTH, value);
+        if (!value_parsed)
+        {
+            return false;
+        }
+        SkipWhitespace(position, end);
+        bool text_fully_parsed = (end == position);
+        return text_fully_parsed;
+    }
+
+    /// Appends a string to JSON text, escaping any characters that can't appear directly in a JSON string.
+    /// @param[in]  text - The text to append.
+    /// @param[in,out]  json - The JSON text to append to.
+    static void AppendEscaped(const std::string& text, std::string& json)
+    {
+        for (char character : text)
+        {
+            bool needs_escaping = ('"' == character || '\\' == character);
+            bool is_control_character = (static_cast<unsigned char>(character) < 0x20);
+            if (needs_escaping)
+            {
+                json.push_back('\\');
+                json.push_back(character);
+            }
+            else if (is_control_character)
+            {
+                const char HEX_DIGITS[] = "0123456789abcdef";
+                json += "\\u00";
+                json.push_back(HEX_DIGITS[(character >> 4) & 0xF]);
+                json.push_back(HEX_DIGITS[character & 0xF]);
+            }
+            else
+            {
+                json.push_back(character);
+            }
+        }
+    }
+
+    /// Finds a member of an object.
+    /// @param[in]  name - The name of the member.
+    /// @return The member's value, or null if this isn't an object or it has no member with the name.
+    const JsonValue* GetMember(const std::string& name) const
+    {
+        for (const auto& member : Members)
+        {
+            if (name == member.first)
+            {
+                return &member.second;
+            }
+        }
+        return nullptr;
+    }
+
+    /// Appends the value to JSON text.
+    /// @param[in,out]  json - The JSON text to append to.
+    void AppendTo(std::string& json) const
+    {
+        switch (ValueType)
+        {
+            case Type::NULL_VALUE:
+                json += "null";
+                break;
+            case Type::BOOLEAN:
+                json += Boolean ? "true" : "false";
+                break;
+            case Type::NUMBER:
+            {
+                // Integers (such as request IDs) are written without any fractional part.
+                const double MAX_EXACT_INTEGER = 9007199254740992.0;
+                bool is_integer = (std::abs(Number) <= MAX_EXACT_INTEGER && static_cast<double>(static_cast<int64_t>(Number)) == Number);
+                if (is_integer)
+                {
+                    json += std::to_string(static_cast<int64_t>(Number));
+                }
+                else
+                {
+                    const int SIGNIFICANT_DIGITS = 17;
+                    char number_text[32];
+                    std::snprintf(number_text, sizeof(number_text), "%.*g", SIGNIFICANT_DIGITS, Number);
+                    json += number_text;
+                }
+                break;
+            }
+            case Type::STRING:
+                json.push_back('"');
+                AppendEscaped(String, json);
+                json.push_back('"');
+                break;
+            case Type::ARRAY:
+                json.push_back('[');
+                for (std::size_t element_index = 0; element_index < Elements.size(); ++element_index)
+                {
+                    if (element_index > 0)
+                    {
+                        json.push_back(',');
+                    }
+                    Elements[element_index].AppendTo(json);
+                }
+                json.push_back(']');
+                break;
+            case Type::OBJECT:
+                json.push_back('{');
+                for (std::size_t member_index = 0; member_index < Members.size(); ++member_index)
+                {
+                    if (member_index > 0)
+                    {
+                        json.push_back(',');
+                    }
+                    json.push_back('"');
+                    AppendEscaped(Members[member_index].first, json);
+                    json += "\":";
+                    Members[member_index].second.AppendTo(json);
+                }
+                json.push_back('}');
+                break;
+        }
+    }
+
+    // MEMBER VARIABLES.
+    /// The type of the value.
+    Type ValueType = Type::NULL_VALUE;
+    /// The value of a boolean.
+    bool Boolean = false;
+    /// The value of a number.
+    double Number = 0.0;
+    /// The value of a string, encoded as UTF-8.
+    std::string String = "";
+    /// The elements of an array.
+    std::vector<JsonValue> Elements = {};
+    /// The names and values of an object's members, in order.
+    std::vector<std::pair<std::string, JsonValue>> Members = {};
+
+private:
+    /// The maximum depth of nested arrays and objects, which keeps deeply nested text from exhausting the stack.
+    static const unsigned int MAX_DEPTH = 64;
+
+    /// Skips any whitespace.
+    /// @param[in,out]  position - The position in the text, which is moved past any whitespace.
+    /// @param[in]  end - The end of the text.
+    static void SkipWhitespace(const char*& position, const char* end)
+    {
+        while (end != position && (' ' == *position || '\t' == *position || '\n' == *position || '\r' == *position))
+        {
+            ++position;
+        }
+    }
+
+    /// Checks if the text continues with a literal (such as "true"), moving past it if so.
+    /// @param[in]  literal - The null-terminated literal.
+    /// @param[in,out]  position - The position in the text.
+    /// @param[in]  end - The end of the text.
+    /// @return True if the literal was found; false otherwise.
+    static bool SkipLiteral(const char* literal, const char*& position, const char* end)
+    {
+        std::size_t literal_length = std::strlen(literal);
+        bool literal_found = (static_cast<std::size_t>(end - position) >= literal_length && 0 == std::memcmp(position, literal, literal_length));
+        if (literal_found)
+        {
+            position += literal_length;
+        }
+        return literal_found;
+    }
+
+    /// Parses a value.
+    /// @param[in,out]  position - The position in the text, which is moved past the value.
+    /// @param[in]  end - The end of the text.
+    /// @param[in]  depth - The number of arrays and objects containing the value.
+    /// @param[out]  value - The parsed value.
+    /// @return True if a valid value was parsed; false otherwise.
+    static bool ParseValue(const char*& position, const char* end, const unsigned int depth, JsonValue& value)
+    {
+        // DETERMINE THE TYPE OF VALUE FROM ITS FIRST CHARACTER.
+        SkipWhitespace(position, end);
+        if (end == position)
+        {
+            return false;
+        }
+        value = JsonValue();
+        char first_character = *position;
+        if ('"' == first_character)
+        {
+            value.ValueType = Type::STRING;
+            return ParseString(position, end, value.String);
+        }
+        if ('[' == first_character || '{' == first_character)
+        {
+            bool too_deep = (depth >= MAX_DEPTH);
+            if (too_deep)
+            {
+                return false;
+            }
+            return ('[' == first_character) ? ParseArray(position, end, depth, value) : ParseObject(position, end, depth, value);
+        }
+        if (SkipLiteral("null", position, end))
+        {
+            return true;
+        }
+        if (SkipLiteral("true", position, end))
+        {
+            value.ValueType = Type::BOOLEAN;
+            value.Boolean = true;
+            return true;
+        }
+        if (SkipLiteral("false", position, end))
+        {
+            value.ValueType = Type::BOOLEAN;
+            return true;
+        }
+
+        // PARSE A NUMBER.
+        // The characters that can be part of a number are gathered first so that parsing can't run past the end of the text.
+        const char* number_end = position;
+        while (end != number_end && (std::isdigit(static_cast<unsigned char>(*number_end)) || std::strchr("+-.eE", *number_end)))
+        {
+            ++number_end;
+        }
+        bool number_found = (number_end != position) && ('-' == first_character || std::isdigit(static_cast<unsigned char>(first_character)));
+        if (!number_found)
+        {
+            return false;
+        }
+        std::string number_text(position, number_end);
+        char* parsed_number_end = nullptr;
+        value.ValueType = Type::NUMBER;
+        value.Number = std::strtod(number_text.c_str(), &parsed_number_end);
+        position = number_end;
+        bool number_fully_parsed = ('\0' == *parsed_number_end);
+        return number_fully_parsed;
+    }
+
+    /// Parses a string, including its quotes.
+    /// @param[in,out]  position - The position of the opening quote, which is moved past the closing quote.
+    /// @param[in]  end - The end of the text.
+    /// @param[out]  text - The parsed string, with any escape sequences replaced by the characters they represent.
+    /// @return True if a valid string was parsed; false otherwise.
+    static bool ParseString(const char*& position, const char* end, std::string& text)
+    {
+        ++position;
+        while (end != position)
+        {
+            // COPY ORDINARY CHARACTERS.
+            char character = *position;
+            ++position;
+            if ('"' == character)
+            {
+                return true;
+            }
+            bool is_control_character = (static_cast<unsigned char>(character) < 0x20);
+            if (is_control_character)
+            {
+                return false;
+            }
+            if ('\\' != character)
+            {
+                text.push_back(character);
+                continue;
+            }
+
+            // REPLACE ESCAPE SEQUENCES.
+            if (end == position)
+            {
+                return false;
+            }
+            char escaped_character = *position;
+            ++position;
+            switch (escaped_character)
+            {
+                case '"':
+                case '\\':
+                case '/':
+                    text.push_back(escaped_character);
+                    break;
+                case 'b':
+                    text.push_back('\b');
+                    break;
+                case 'f':
+                    text.push_back('\f');
+                    break;
+                case 'n':
+                    text.push_back('\n');
+                    break;
+                case 'r':
+                    text.push_back('\r');
+                    break;
+                case 't':
+                    text.push_back('\t');
+                    break;
+                case 'u':
+                {
+                    // Characters outside the basic multilingual plane are escaped as a pair of UTF-16 surrogates.
+                    uint32_t code_point = 0;
+                    bool code_point_parsed = ParseHexDigits(position, end, code_point);
+                    if (!code_point_parsed)
+                    {
+                        return false;
+                    }
+                    bool is_high_surrogate = (code_point >= 0xD800 && code_point <= 0xDBFF);
+                    if (is_high_surrogate)
+                    {
+                        uint32_t low_surrogate = 0;
+                        bool low_surrogate_parsed = (
+                            SkipLiteral("\\u", position, end) &&
+                            ParseHexDigits(position, end, low_surrogate) &&
+                            low_surrogate >= 0xDC00 &&
+                            low_surrogate <= 0xDFFF);
+                        if (!low_surrogate_parsed)
+                        {
+                            return false;
+                        }
+                        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low_surrogate - 0xDC00);
+                    }
+                    Utf8Text::Append(code_point, text);
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        return false;
+    }
+
+    /// Parses the four hexadecimal digits of a \u escape sequence.
+    /// @param[in,out]  position - The position of the first digit, which is moved past the last digit.
+    /// @param[in]  end - The end of the text.
+    /// @param[out]  value - The value of the digits.
+    /// @return True if four valid digits were parsed; false otherwise.
+    static bool ParseHexDigits(const char*& position, const char* end, uint32_t& value)
+    {
+        const std::size_t DIGIT_COUNT = 4;
+        bool digits_present = (static_cast<std::size_t>(end - position) >= DIGIT_COUNT);
+        if (!digits_present)
+        {
+            return false;
+        }
+        value = 0;
+        for (std::size_t digit_index = 0; digit_index < DIGIT_COUNT; ++digit_index)
+        {
+            char digit = *position;
+            ++position;
+            uint32_t digit_value = 0;
+            if (digit >= '0' && digit <= '9')
+            {
+                digit_value = static_cast<uint32_t>(digit - '0');
+            }
+            else if (digit >= 'a' && digit <= 'f')
+            {
+                digit_value = static_cast<uint32_t>(digit - 'a' + 10);
+            }
+            else if (digit >= 'A' && digit <= 'F')
+            {
+                digit_value = static_cast<uint32_t>(digit - 'A' + 10);
+            }
+            else
+            {
+                return false;
+            }
+            value = (value << 4) | digit_value;
+        }
+        return true;
+    }
+
+    /// Parses an array.
+    /// @param[in,out]  position - The position of the opening bracket, which is moved past the closing bracket.
+    /// @param[in]  end - The end of the text.
+    /// @param[in]  depth - The number of arrays and objects containing the array.
+    /// @param[out]  value - The parsed array.
+    /// @return True if a valid array was parsed; false otherwise.
+    static bool ParseArray(const char*& position, const char* end, const unsigned int depth, JsonValue& value)
+    {
+        value.ValueType = Type::ARRAY;
+        ++position;
+        SkipWhitespace(position, end);
+        if (SkipLiteral("]", position, end))
+        {
+            return true;
+        }
+        for (;;)
+        {
+            value.Elements.emplace_back();
+            bool element_parsed = ParseValue(position, end, depth + 1, value.Elements.back());
+            if (!element_parsed)
+            {
+                return false;
+            }
+            SkipWhitespace(position, end);
+            if (SkipLiteral("]", position, end))
+            {
+                return true;
+            }
+            if (!SkipLiteral(",", position, end))
+            {
+                return false;
+            }
+        }
+    }
+
+    /// Parses an object.
+    /// @param[in,out]  position - The position of the opening brace, which is moved past the closing brace.
+    /// @param[in]  end - The end of the text.
+    /// @param[in]  depth - The number of arrays and objects containing the object.
+    /// @param[out]  value - The parsed object.
+    /// @return True if a valid object was parsed; false otherwise.
+    static bool ParseObject(const char*& position, const char* end, const unsigned int depth, JsonValue& value)
+    {
+        value.ValueType = Type::OBJECT;
+        ++position;
+        SkipWhitespace(position, end);
+        if (SkipLiteral("}", position, end))
+        {
+            return true;
+        }
+        for (;;)
+        {
+            value.Members.emplace_back();
+            auto& member = value.Members.back();
+            SkipWhitespace(position, end);
+            bool member_parsed = (
+                end != position &&
+                '"' == *position &&
+                ParseString(position, end, member.first));
+            if (!member_parsed)
+            {
+                return false;
+            }
+            SkipWhitespace(position, end);
+            member_parsed = (SkipLiteral(":", position, end) && ParseValue(position, end, depth + 1, member.second));
+            if (!member_parsed)
+            {
+                return false;
+            }
+            SkipWhitespace(position, end);
+            if (SkipLiteral("}", position, end))
+            {
+                return true;
+            }
+            if (!SkipLiteral(",", position, end))
+            {
+                return false;
+            }
+        }
+    }
+};
+
+const unsigned int JsonValue::MAX_DEPTH;
+
+/// Measures what the program spends its time on and how much it asks of the operating system, for the
+/// trace and statistics that can be requested on the command line.  The work being measured is spread
+/// across many classes and threads, so all measurements are collected in one place for the whole process.
+/// Individual spans are only recorded while tracing is enabled; otherwise, measuring costs a few counter updates.
+class Instrumentation
+{
+public:
+    /// A span of time spent on some piece of work, as recorded in the trace.
+    struct Span
+    {
+        /// The name of the work, which must be a string literal.
+        const char* Name;
+        /// What the work was done on (such as a path).  May be empty.
+        std::string Detail;
+        /// The index of the thread that did the work (see GetThreadIndex).
+        unsigned int ThreadIndex;
+        /// When the work started, in microseconds since the program started.
+        uint64_t StartTimeInMicroseconds;
+        /// How long the work took, in microseconds.
+        uint64_t DurationInMicroseconds;
+    };
+
+    /// The total time spent in one phase of the program (such as scanning or writing a particular file).
+    struct Phase
+    {
+        /// The name of the phase, which must be a string literal.
+        const char* Name;
+        /// What the phase was done on (such as a path).  May be empty.
+        std::string Detail;
+        /// The total time spent in the phase, in microseconds.
+        uint64_t DurationInMicroseconds;
+    };
+
+    /// Starts recording spans for the trace.
+    static void EnableTracing()
+    {
+        TracingEnabled = true;
+    }
+
+    /// Determines if spans are being recorded for the trace.
+    /// @return True if tracing is enabled; false otherwise.
+    static bool IsTracingEnabled()
+    {
+        return TracingEnabled.load(std::memory_order_relaxed);
+    }
+
+    /// Gets the current time relative to when the program started.
+    /// @return The current time, in microseconds since the program started.
+    static uint64_t GetTimeInMicroseconds()
+    {
+        auto elapsed_time = std::chrono::steady_clock::now() - StartTime;
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed_time).count());
+    }
+
+    /// Gets a small index identifying the calling thread, which is much easier to read in a trace
+    /// than the operating system's thread IDs.  Indices are assigned in the order threads first ask.
+    /// @return The index of the calling thread.
+    static unsigned int GetThreadIndex()
+    {
+        static std::atomic<unsigned int> next_thread_index(0);
+        thread_local unsigned int thread_index = next_thread_index++;
+        return thread_index;
+    }
+
+    /// Records a span of work for the trace, and adds it to the total for its phase if it's a phase.
+    /// @param[in]  name - The name of the work, which must be a string literal.
+    /// @param[in]  detail - What the work was done on.  May be empty.
+    /// @param[in]  is_phase - True if the work is one of the phases reported in the statistics.
+    /// @param[in]  start_time_in_microseconds - When the work started (see GetTimeInMicroseconds).
+    /// @param[in]  end_time_in_microseconds - When the work ended (see GetTimeInMicroseconds).
+    static void RecordSpan(
+        const char* name,
+        const std::string& detail,
+        const bool is_phase,
+        const uint64_t start_time_in_microseconds,
+        const uint64_t end_time_in_microseconds)
+    {
+        uint64_t duration_in_microseconds = end_time_in_microseconds - start_time_in_microseconds;
+        unsigned int thread_index = GetThreadIndex();
+        std::lock_guard<std::mutex> lock(Mutex);
+
+        // RECORD THE SPAN IF TRACING.
+        if (IsTracingEnabled())
+        {
+            Spans.push_back({ name, detail, thread_index, start_time_in_microseconds, duration_in_microseconds });
+        }
+
+        // ADD THE TIME TO ITS PHASE.
+        // Phases are kept in the order they first occurred, and there are few enough to search linearly.
+        if (!is_phase)
+        {
+            return;
+        }
+        for (Phase& phase : Phases)
+        {
+            bool same_phase = (0 == std::strcmp(phase.Name, name) && phase.Detail == detail);
+            if (same_phase)
+            {
+                phase.DurationInMicroseconds += duration_in_microseconds;
+                return;
+            }
+        }
+        Phases.push_back({ name, detail, duration_in_microseconds });
+    }
+
+    /// Counts calls made to the operating system's file system functions.
+    /// @param[in]  call_count - The number of calls made.
+    static void CountFileSystemCalls(const uint64_t call_count)
+    {
+        FileSystemCallCount.fetch_add(call_count, std::memory_order_relaxed);
+    }
+
+    /// Counts a directory whose entries were listed.
+    static void CountDirectoryListing()
+    {
+        DirectoryListingCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// Counts a file that was written.
+    /// @param[in]  byte_count - The number of bytes written to the file.
+    static void CountFileWritten(const uint64_t byte_count)
+    {
+        FilesWrittenCount.fetch_add(1, std::memory_order_relaxed);
+        BytesWrittenCount.fetch_add(byte_count, std::memory_order_relaxed);
+    }
+
+    /// Writes all recorded spans as a trace in the Chrome trace event format, which can be viewed
+    /// in chrome://tracing or https://ui.perfetto.dev.
+    /// @param[in]  process_name - The name to show for the process in the trace.
+    /// @return The trace as JSON.
+    static std::string GetTraceJson(const std::string& process_name)
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        const char PROCESS_ID[] = "1";
+        std::string trace = "{\"traceEvents\":[\n";
+        trace += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":";
+        trace += PROCESS_ID;
+        trace += ",\"tid\":0,\"args\":{\"name\":\"";
+        JsonValue::AppendEscaped(process_name, trace);
+        trace += "\"}}";
+        for (const Span& span : Spans)
+        {
+            trace += ",\n{\"name\":\"";
+            trace += span.Name;
+            trace += "\",\"ph\":\"X\",\"ts\":";
+            trace += std::to_string(span.StartTimeInMicroseconds);
+            trace += ",\"dur\":";
+            trace += std::to_string(span.DurationInMicroseconds);
+            trace += ",\"pid\":";
+            trace += PROCESS_ID;
+            trace += ",\"tid\":";
+            trace += std::to_string(span.ThreadIndex);
+            if (!span.Detail.empty())
+            {
+                trace += ",\"args\":{\"path\":\"";
+                JsonValue::AppendEscaped(span.Detail, trace);
+                trace += "\"}";
+            }
+            trace += "}";
+        }
+        trace += "\n]}\n";
+        return trace;
+    }
+
+    // MEMBER VARIABLES.
+    /// The number of calls made to the operating system's file system functions.
+    static std::atomic<uint64_t> FileSystemCallCount;
+    /// The number of directories whose entries were listed.
+    static std::atomic<uint64_t> DirectoryListingCount;
+    /// The number of files written.
+    static std::atomic<uint64_t> FilesWrittenCount;
+    /// The number of bytes written to files.
+    static std::atomic<uint64_t> BytesWrittenCount;
+    /// The phases of the program, in the order they first occurred.  Only safe to read once all work is done.
+    static std::vector<Phase> Phases;
+
+private:
+    /// True if spans are being recorded for the trace.
+    static std::atomic<bool> TracingEnabled;
+    /// When the program started, which all recorded times are relative to.
+    static const std::chrono::steady_clock::time_point StartTime;
+    /// The mutex protecting the recorded spans and phases.
+    static std::mutex Mutex;
+    /// The spans recorded for the trace.
+    static std::vector<Span> Spans;
+};
+
+std::atomic<uint64_t> Instrumentation::FileSystemCallCount(0);
+std::atomic<uint64_t> Instrumentation::DirectoryListingCount(0);
+std::atomic<uint64_t> Instrumentation::FilesWrittenCount(0);
+std::atomic<uint64_t> Instrumentation::BytesWrittenCount(0);
+std::vector<Instrumentation::Phase> Instrumentation::Phases;
+std::atomic<bool> Instrumentation::TracingEnabled(false);
+const std::chrono::steady_clock::time_point Instrumentation::StartTime = std::chrono::steady_clock::now();
+std::mutex Instrumentation::Mutex;
+std::vector<Instrumentation::Span> Instrumentation::Spans;
+
+/// Measures a piece of work from when it's constructed until it's destroyed, recording it with Instrumentation.
+class TraceSpan
+{
+public:
+    /// Constructor.  Starts measuring the work.
+    /// @param[in]  name - The name of the work, which must be a string literal.
+    /// @param[in]  detail - What the work is done on, which must outlive the span.  Null if nothing in particular.
+    /// @param[in]  is_phase - True if the work is one of the phases reported in the statistics.
+    ///     Other work is only measured while tracing, so measuring it otherwise costs almost nothing.
+    explicit TraceSpan(const char* name, const std::string* detail = nullptr, const bool is_phase = false) :
+        Name(name),
+        Detail(detail),
+        IsPhase(is_phase),
+        Measuring(is_phase || Instrumentation::IsTracingEnabled()),
+        StartTimeInMicroseconds(Measuring ? Instrumentation::GetTimeInMicroseconds() : 0)
+    {}
+
+    /// Destructor.  Records the work.
+    ~TraceSpan()
+    {
+        if (Measuring)
+        {
+            static const std::string NO_DETAIL = "";
+            Instrumentation::RecordSpan(Name, Detail ? *Detail : NO_DETAIL, IsPhase, StartTimeInMicroseconds, Instrumentation::GetTimeInMicroseconds());
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    // MEMBER VARIABLES.
+    /// The name of the work.
+    const char* Name;
+    /// What the work is done on, if anything in particular.
+    const std::string* Detail;
+    /// True if the work is one of the phases reported in the statistics.
+    bool IsPhase;
+    /// True if the work is being measured.
+    bool Measuring;
+    /// When the work started, in microseconds since the program started.
+    uint64_t StartTimeInMicroseconds;
+};
+
+/// Lists the entries directly within a single directory, using the fastest directory
+/// enumeration API available on the current platform.
+class DirectoryListing
+{
+public:
+    /// Converts a path using the separator from Visual Studio project files
+    /// to a path that can be passed to the operating system.
+    /// @param[in]  path - The path to convert.
+    /// @return The path with native path separators.
+    static std::string ToNativePath(const std::string& path)
+    {
+        std::string native_path = path;
+        std::replace(native_path.begin(), native_path.end(), PATH_SEPARATOR[0], NATIVE_PATH_SEPARATOR);
+        return native_path;
+    }
+
+    /// Converts a path provided by a user to a path using the separator from Visual Studio project files,
+    /// without any trailing separators.
+    /// @param[in]  path - The path to convert.
+    /// @return The path as used in project files.
+    static std::string ToProjectPath(const std::string& path)
+    {
+        std::string project_path = path;
+        std::replace(project_path.begin(), project_path.end(), '/', PATH_SEPARATOR[0]);
+        const std::size_t MIN_PATH_LENGTH = 1;
+        while (project_path.size() > MIN_PATH_LENGTH && PATH_SEPARATOR[0] == project_path.back())
+        {
+            project_path.pop_back();
+        }
+        return project_path;
+    }
+
+    /// Converts a path using the separator from Visual Studio project files to a path that can be used
+    /// in an #include directive.  Forward slashes work with every compiler, on every platform.
+    /// @param[in]  path - The path to convert.
+    /// @return The path with forward slashes.
+    static std::string ToIncludePath(const std::string& path)
+    {
+        std::string include_path = path;
+        std::replace(include_path.begin(), include_path.end(), PATH_SEPARATOR[0], '/');
+        return include_path;
+    }
+
+    /// Gets the time a directory's entries were last modified.  This changes whenever an entry
+    /// is added to, removed from, or renamed within the directory.
+    /// @param[in]  relative_path - The relative path to the directory.
+    /// @param[out]  modification_time - The modification time, in the file system's native units.
+    /// @return True if the modification time was retrieved; false otherwise.
+    static bool GetModificationTime(const std::string& relative_path, uint64_t& modification_time)
+    {
+        Instrumentation::CountFileSystemCalls(1);
+#if defined(_WIN32)
+        WIN32_FILE_ATTRIBUTE_DATA attributes;
+        bool attributes_retrieved = (FALSE != GetFileAttributesEx(relative_path.c_str(), GetFileExInfoStandard, &attributes));
+        if (!attributes_retrieved)
+        {
+            return false;
+        }
+        modification_time = ToModificationTime(attributes.ftLastWriteTime);
+        return true;
+#else
+        std::string native_path = ToNativePath(relative_path);
+        struct stat status;
+        bool status_retrieved = (0 == stat(native_path.c_str(), &status));
+        if (!status_retrieved)
+        {
+            return false;
+        }
+        modification_time = ToModificationTime(status);
+        return true;
+#endif
+    }
+
+    /// Gets the size and modification time of a file.
+    /// @param[in]  relative_path - The relative path to the file.
+    /// @param[out]  size_in_bytes - The size of the file.
+    /// @param[out]  modification_time - The time the file was last modified, in the file system's native units.
+    /// @return True if the size and modification time were retrieved; false otherwise.
+    static bool GetFileMetadata(const std::string& relative_path, uint64_t& size_in_bytes, uint64_t& modification_time)
+    {
+        Instrumentation::CountFileSystemCalls(1);
+#if defined(_WIN32)
+        WIN32_FILE_ATTRIBUTE_DATA attributes;
+        bool attributes_retrieved = (FALSE != GetFileAttributesEx(relative_path.c_str(), GetFileExInfoStandard, &attributes));
+        if (!attributes_retrieved)
+        {
+            return false;
+        }
+        size_in_bytes = (static_cast<uint64_t>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+        modification_time = ToModificationTime(attributes.ftLastWriteTime);
+        return true;
+#else
+        std::string native_path = ToNativePath(relative_path);
+        struct stat status;
+        bool status_retrieved = (0 == stat(native_path.c_str(), &status));
+        if (!status_retrieved)
+        {
+            return false;
+        }
+        size_in_bytes = static_cast<uint64_t>(status.st_size);
+        modification_time = ToModificationTime(status);
+        return true;
+#endif
+    }
+
+    /// Gets the absolute path for a relative path.
+    /// @param[in]  relative_path - The relative path.
+    /// @param[out]  absolute_path - The absolute path, with native path separators.
+    /// @return True if the absolute path was retrieved; false otherwise.
+    static bool GetAbsolutePath(const std::string& relative_path, std::string& absolute_path)
+    {
+        Instrumentation::CountFileSystemCalls(1);
+        std::string native_path = ToNativePath(relative_path);
+#if defined(_WIN32)
+        DWORD absolute_path_size = GetFullPathName(native_path.c_str(), 0, NULL, NULL);
+        if (0 == absolute_path_size)
+        {
+            return false;
+        }
+        absolute_path.resize(absolute_path_size);
+        DWORD absolute_path_length = GetFullPathName(native_path.c_str(), absolute_path_size, &absolute_path[0], NULL);
+        bool absolute_path_retrieved = (0 < absolute_path_length && absolute_path_length < absolute_path_size);
+        absolute_path.resize(absolute_path_retrieved ? absolute_path_length : 0);
+        return absolute_path_retrieved;
+#else
+        char* resolved_path = realpath(native_path.c_str(), nullptr);
+        if (!resolved_path)
+        {
+            return false;
+        }
+        absolute_path = resolved_path;
+        std::free(resolved_path);
+        return true;
+#endif
+    }
+
+    /// Gets the identity of a directory, following any links to it.
+    /// @param[in]  relative_path - The relative path to the directory.
+    /// @param[out]  identity - The identity of the directory.
+    /// @return True if the identity was retrieved; false otherwise.
+    static bool GetIdentity(const std::string& relative_path, FolderIdentity& identity)
+    {
+#if defined(_WIN32)
+        uint64_t modification_time = 0;
+        return GetDirectoryInformation(relative_path, modification_time, identity);
+#else
+        Instrumentation::CountFileSystemCalls(1);
+        std::string native_path = ToNativePath(relative_path);
+        struct stat status;
+        bool status_retrieved = (0 == stat(native_path.c_str(), &status));
+        if (!status_retrieved)
+        {
+            return false;
+        }
+        identity = ToIdentity(status);
+        return true;
+#endif
+    }
+
+    /// Visits all entries directly within a directory.  The entries for the current
+    /// and parent directories are skipped.
+    /// @param[in]  relative_path - The relative path to the directory.
+    /// @param[in]  visit_entry - The function to call for each entry, with the signature
+    ///     void(const char* name, bool is_directory, bool is_link).  Entries that are symbolic links
+    ///     (or junctions) are reported as the type of entry they link to, and links that can't be
+    ///     followed are reported as files.
+    /// @param[out]  modification_time - The time the directory's entries were last modified,
+    ///     retrieved before any entries are read.  Zero if it couldn't be retrieved.
+    /// @param[out]  identity - The identity of the directory.  Unknown if it couldn't be retrieved.
+    /// @return True if the directory could be listed; false otherwise.
+    template <typename EntryVisitor>
+    static bool Visit(const std::string& relative_path, EntryVisitor visit_entry, uint64_t& modification_time, FolderIdentity& identity)
+    {
+        // The modification time is retrieved first so that any changes made while the entries
+        // are being read will result in a newer modification time than the one recorded.
+        // Calls are counted locally and added to the statistics once the directory has been read.
+        // Entries are read before any are visited, so that they can be sorted and so that a directory
+        // that can't be read completely isn't partially visited.  Names are packed into a single buffer
+        // to avoid an allocation per entry.
+        modification_time = 0;
+        identity = FolderIdentity();
+        Instrumentation::CountDirectoryListing();
+        std::string entry_names;
+        std::vector<ListedEntry> entries;
+        auto add_entry = [&entry_names, &entries](const char* name, const bool is_directory, const bool is_link)
+        {
+            ListedEntry entry;
+            entry.NameOffset = static_cast<uint32_t>(entry_names.size());
+            entry.NameLength = static_cast<uint32_t>(std::strlen(name));
+            entry.IsDirectory = is_directory;
+            entry.IsLink = is_link;
+            entry_names.append(name, entry.NameLength);
+            entry_names.push_back('\0');
+            entries.push_back(entry);
+        };
+#if defined(_WIN32)
+        GetDirectoryInformation(relative_path, modification_time, identity);
+
+        // START SEARCHING FOR ALL FILES AND FOLDERS WITHIN THE FOLDER.
+        // The basic information level skips retrieving short 8.3 names, and the large fetch
+        // flag lets the file system return more entries for each underlying call.
+        const std::string WILDCARD = "*";
+        std::string find_all_files_and_folders = relative_path + PATH_SEPARATOR + WILDCARD;
+        WIN32_FIND_DATA file_data;
+        HANDLE search_handle = FindFirstFileEx(
+            find_all_files_and_folders.c_str(),
+            FindExInfoBasic,
+            &file_data,
+            FindExSearchNameMatch,
+            NULL,
+            FIND_FIRST_EX_LARGE_FETCH);
+        uint64_t file_system_call_count = 1;
+        bool search_started = (INVALID_HANDLE_VALUE != search_handle);
+        if (!search_started)
+        {
+            Instrumentation::CountFileSystemCalls(file_system_call_count);
+            return false;
+        }
+
+        // READ ALL ENTRIES IN THE FOLDER.
+        do
+        {
+            ++file_system_call_count;
+            // SKIP THE ENTRIES FOR THE CURRENT AND PARENT DIRECTORIES.
+            if (IsAbbreviatedDirectory(file_data.cFileName))
+            {
+                continue;
+            }
+
+            // Only symbolic links and junctions are links.  Other kinds of reparse points
+            // (such as files stored in the cloud) are ordinary entries.
+            const unsigned int FILE_ATTRIBUTE_NOT_SET = 0;
+            bool is_directory = (FILE_ATTRIBUTE_NOT_SET != (file_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY));
+            bool is_reparse_point = (FILE_ATTRIBUTE_NOT_SET != (file_data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT));
+            bool is_link = is_reparse_point && (IO_REPARSE_TAG_SYMLINK == file_data.dwReserved0 || IO_REPARSE_TAG_MOUNT_POINT == file_data.dwReserved0);
+            add_entry(file_data.cFileName, is_directory, is_link);
+        } while (FindNextFile(search_handle, &file_data));
+        DWORD search_error = GetLastError();
+
+        FindClose(search_handle);
+        ++file_system_call_count;
+        Instrumentation::CountFileSystemCalls(file_system_call_count);
+        bool all_entries_read = (ERROR_NO_MORE_FILES == search_error);
+        if (!all_entries_read)
+        {
+            std::cerr << "Failed to list " << relative_path << " (error " << search_error << ")" << std::endl;
+            modification_time = 0;
+            return false;
+        }
+#else
+        // OPEN THE DIRECTORY.
+        std::string native_path = ToNativePath(relative_path);
+        int directory = openat(AT_FDCWD, native_path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        uint64_t file_system_call_count = 1;
+        bool directory_opened = (directory >= 0);
+        if (!directory_opened)
+        {
+            Instrumentation::CountFileSystemCalls(file_system_call_count);
+            return false;
+        }
+
+        ++file_system_call_count;
+        struct stat directory_status;
+        bool directory_status_retrieved = (0 == fstat(directory, &directory_status));
+        if (directory_status_retrieved)
+        {
+            modification_time = ToModificationTime(directory_status);
+            identity = ToIdentity(directory_status);
+        }
+
+        // READ ALL ENTRIES IN THE DIRECTORY.
+        auto add_typed_entry = [&](const char* name, const unsigned char type)
+        {
+            if (IsAbbreviatedDirectory(name))
+            {
+                return;
+            }
+
+            bool is_link = false;
+            bool is_directory = IsDirectory(directory, name, type, is_link, file_system_call_count);
+            add_entry(name, is_directory, is_link);
+        };
+        int read_error = 0;
+#if defined(__linux__)
+        // Reading raw directory entries in large batches avoids the per-entry overhead of readdir().
+        alignas(8) char entry_buffer[64 * 1024];
+        for (;;)
+        {
+            long entry_buffer_byte_count = syscall(SYS_getdents64, directory, entry_buffer, sizeof(entry_buffer));
+            ++file_system_call_count;
+            bool read_failed = (entry_buffer_byte_count < 0);
+            if (read_failed)
+            {
+                read_error = errno;
+                break;
+            }
+            bool entries_read = (entry_buffer_byte_count > 0);
+            if (!entries_read)
+            {
+                break;
+            }
+
+            for (long entry_offset = 0; entry_offset < entry_buffer_byte_count;)
+            {
+                const dirent64* entry = reinterpret_cast<const dirent64*>(entry_buffer + entry_offset);
+                add_typed_entry(entry->d_name, entry->d_type);
+                entry_offset += entry->d_reclen;
+            }
+        }
+        close(directory);
+        ++file_system_call_count;
+#else
+        DIR* directory_stream = fdopendir(directory);
+        if (!directory_stream)
+        {
+            close(directory);
+            Instrumentation::CountFileSystemCalls(file_system_call_count + 1);
+            return false;
+        }
+
+        // readdir() reads entries in batches, but how many isn't known, so each call is counted.
+        // It returns null both at the end of the directory and on errors, which only set errno.
+        for (;;)
+        {
+            errno = 0;
+            const dirent* entry = readdir(directory_stream);
+            ++file_system_call_count;
+            if (!entry)
+            {
+                read_error = errno;
+                break;
+            }
+            add_typed_entry(entry->d_name, entry->d_type);
+        }
+        closedir(directory_stream);
+        ++file_system_call_count;
+#endif
+        Instrumentation::CountFileSystemCalls(file_system_call_count);
+
+        // REPORT DIRECTORIES THAT COULDN'T BE READ COMPLETELY.
+        // None of the entries are visited, and no modification time is recorded, so the directory will be listed again
+        // the next time rather than being left incomplete (such as in a scan cache).
+        bool all_entries_read = (0 == read_error);
+        if (!all_entries_read)
+        {
+            std::cerr << "Failed to list " << relative_path << ": " << std::strerror(read_error) << std::endl;
+            modification_time = 0;
+            return false;
+        }
+#endif
+
+        // VISIT THE ENTRIES IN SORTED ORDER.
+        // The order that entries are read in depends on the file system (NTFS keeps them sorted, whereas most
+        // Linux file systems use hash order), so they're sorted the same way NTFS does on every platform.
+        const char* entry_name_characters = entry_names.c_str();
+        std::sort(
+            entries.begin(),
+            entries.end(),
+            [entry_name_characters](const ListedEntry& left, const ListedEntry& right)
+            {
+                int order = CompareNames(
+                    entry_name_characters + left.NameOffset,
+                    left.NameLength,
+                    entry_name_characters + right.NameOffset,
+                    right.NameLength);
+                return (order < 0);
+            });
+        for (const auto& entry : entries)
+        {
+            visit_entry(entry_name_characters + entry.NameOffset, entry.IsDirectory, entry.IsLink);
+        }
+        return true;
+    }
+
+    /// Compares two names in the order NTFS keeps directory entries in, which compares their characters as uppercase,
+    /// so that entries are ordered the same way on every platform and file system.  Only ASCII letters are converted to
+    /// uppercase.  Names that only differ by case (which can only both exist on case-sensitive file systems) are then
+    /// ordered by their exact characters.
+    /// @param[in]  left_name - The characters of the first name.
+    /// @param[in]  left_name_length - The number of characters in the first name.
+    /// @param[in]  right_name - The characters of the second name.
+    /// @param[in]  right_name_length - The number of characters in the second name.
+    /// @return Negative if the first name comes first, positive if the second name comes first, or zero if they're the same.
+    static int CompareNames(const char* left_name, const std::size_t left_name_length, const char* right_name, const std::size_t right_name_length)
+    {
+        // COMPARE THE NAMES IGNORING CASE.
+        const unsigned char LOWERCASE_TO_UPPERCASE_OFFSET = 'a' - 'A';
+        std::size_t common_length = std::min(left_name_length, right_name_length);
+        for (std::size_t character_index = 0; character_index < common_length; ++character_index)
+        {
+            unsigned char left_character = static_cast<unsigned char>(left_name[character_index]);
+            unsigned char right_character = static_cast<unsigned char>(right_name[character_index]);
+            if ('a' <= left_character && left_character <= 'z')
+            {
+                left_character = static_cast<unsigned char>(left_character - LOWERCASE_TO_UPPERCASE_OFFSET);
+            }
+            if ('a' <= right_character && right_character <= 'z')
+            {
+                right_character = static_cast<unsigned char>(right_character - LOWERCASE_TO_UPPERCASE_OFFSET);
+            }
+            if (left_character != right_character)
+            {
+                return (left_character < right_character) ? -1 : 1;
+            }
+        }
+        if (left_name_length != right_name_length)
+        {
+            return (left_name_length < right_name_length) ? -1 : 1;
+        }
+
+        // ORDER NAMES THAT ONLY DIFFER BY CASE.
+        return std::memcmp(left_name, right_name, common_length);
+    }
+
+private:
+    /// An entry read from a directory, before the entries are sorted.
+    struct ListedEntry
+    {
+        /// The offset of the entry's name within the names read.
+        uint32_t NameOffset;
+        /// The number of characters in the entry's name.
+        uint32_t NameLength;
+        /// True if the entry is a directory (or a link to one); false otherwise.
+        bool IsDirectory;
+        /// True if the entry is a symbolic link; false otherwise.
+        bool IsLink;
+    };
+
+    /// Determines if a filename refers to the current or parent directories.
+    /// These entries may be found by the file finding functions, but they
+    /// should never be included in the list of subfolders.
+    /// @param[in]  name - The filename to check.
+    /// @return True if the name is for the current or parent directory; false otherwise.
+    static bool IsAbbreviatedDirectory(const char* name)
+    {
+        bool is_current_directory = ('.' == name[0] && '\0' == name[1]);
+        bool is_parent_directory = ('.' == name[0] && '.' == name[1] && '\0' == name[2]);
+        bool is_abbreviated_directory = (is_current_directory || is_parent_directory);
+        return is_abbreviated_directory;
+    }
+
+#if defined(_WIN32)
+    /// Converts a file time to a modification time.
+    /// @param[in]  file_time - The file time to convert.
+    /// @return The modification time, in 100-nanosecond intervals.
+    static uint64_t ToModificationTime(const FILETIME& file_time)
+    {
+        uint64_t modification_time = (static_cast<uint64_t>(file_time.dwHighDateTime) << 32) | file_time.dwLowDateTime;
+        return modification_time;
+    }
+
+    /// Gets the modification time and identity of a directory, following any links to it.
+    /// @param[in]  relative_path - The relative path to the directory.
+    /// @param[out]  modification_time - The modification time, in 100-nanosecond intervals.
+    /// @param[out]  identity - The identity of the directory.
+    /// @return True if the information was retrieved; false otherwise.
+    static bool GetDirectoryInformation(const std::string& relative_path, uint64_t& modification_time, FolderIdentity& identity)
+    {
+        // OPEN THE DIRECTORY.
+        // Directories can only be opened with backup semantics.  No access rights are needed to read their information,
+        // and sharing everything avoids getting in the way of anything else using the directory.
+        HANDLE directory = CreateFile(
+            relative_path.c_str(),
+            0,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            NULL,
+            OPEN_EXISTING,
+            FILE_FLAG_BACKUP_SEMANTICS,
+            NULL);
+        uint64_t file_system_call_count = 1;
+        bool directory_opened = (INVALID_HANDLE_VALUE != directory);
+        if (!directory_opened)
+        {
+            Instrumentation::CountFileSystemCalls(file_system_call_count);
+            return false;
+        }
+
+        // READ THE DIRECTORY'S INFORMATION.
+        BY_HANDLE_FILE_INFORMATION information;
+        bool information_retrieved = (FALSE != GetFileInformationByHandle(directory, &information));
+        CloseHandle(directory);
+        file_system_call_count += 2;
+        Instrumentation::CountFileSystemCalls(file_system_call_count);
+        if (!information_retrieved)
+        {
+            return false;
+        }
+        modification_time = ToModificationTime(information.ftLastWriteTime);
+        identity.Device = information.dwVolumeSerialNumber;
+        identity.FileId = (static_cast<uint64_t>(information.nFileIndexHigh) << 32) | information.nFileIndexLow;
+        return true;
+    }
+#else
+    /// Gets the modification time from a file's status.
+    /// @param[in]  status - The file's status.
+    /// @return The modification time, in nanoseconds.
+    static uint64_t ToModificationTime(const struct stat& status)
+    {
+        const uint64_t NANOSECONDS_PER_SECOND = 1000000000;
+#if defined(__APPLE__)
+        const struct timespec& time = status.st_mtimespec;
+#else
+        const struct timespec& time = status.st_mtim;
+#endif
+        uint64_t modification_time = static_cast<uint64_t>(time.tv_sec) * NANOSECONDS_PER_SECOND + static_cast<uint64_t>(time.tv_nsec);
+        return modification_time;
+    }
+
+    /// Gets the identity of a directory from its status.
+    /// @param[in]  status - The directory's status.
+    /// @return The identity of the directory.
+    static FolderIdentity ToIdentity(const struct stat& status)
+    {
+        FolderIdentity identity;
+        identity.Device = static_cast<uint64_t>(status.st_dev);
+        identity.FileId = static_cast<uint64_t>(status.st_ino);
+        return identity;
+    }
+
+    /// Determines if a directory entry is a directory.  The type reported with the entry is used
+    /// whenever possible so that no per-entry stat() call is needed.  Symbolic links and file systems
+    /// that don't report types fall back to stat() so that links to directories are followed like
+    /// Windows follows junctions.
+    /// @param[in]  directory - The open directory containing the entry.
+    /// @param[in]  name - The name of the entry.
+    /// @param[in]  type - The type reported for the entry by the directory listing.
+    /// @param[out]  is_link - True if the entry is a symbolic link; false otherwise.
+    /// @param[in,out]  file_system_call_count - The number of file system calls made, which is incremented
+    ///     if the entry has to be examined.
+    /// @return True if the entry is a directory; false otherwise.
+    static bool IsDirectory(const int directory, const char* name, const unsigned char type, bool& is_link, uint64_t& file_system_call_count)
+    {
+        is_link = (DT_LNK == type);
+        bool type_known = (DT_LNK != type && DT_UNKNOWN != type);
+        if (type_known)
+        {
+            bool is_directory = (DT_DIR == type);
+            return is_directory;
+        }
+
+        // FIND OUT IF AN ENTRY OF UNKNOWN TYPE IS A LINK.
+        if (DT_UNKNOWN == type)
+        {
+            ++file_system_call_count;
+            struct stat link_status;
+            bool link_status_retrieved = (0 == fstatat(directory, name, &link_status, AT_SYMLINK_NOFOLLOW));
+            is_link = link_status_retrieved && S_ISLNK(link_status.st_mode);
+            if (link_status_retrieved && !is_link)
+            {
+                bool is_directory = S_ISDIR(link_status.st_mode);
+                return is_directory;
+            }
+        }
+
+        // FOLLOW THE LINK.
+        // Entries that can't be examined (such as broken links) are treated as files.
+        ++file_system_call_count;
+        struct stat status;
+        bool status_retrieved = (0 == fstatat(directory, name, &status, 0));
+        bool is_directory = status_retrieved && S_ISDIR(status.st_mode);
+        return is_directory;
+    }
+#endif
+};
+
+/// A temporary file that holds data which would take up too much memory to keep in memory, such as
+/// the contents of a huge generated file.  Data is appended to the end and can be read back from anywhere.
+/// The file is deleted when this object is destroyed, unless it has been moved elsewhere to keep it.
+class SpillFile
+{
+public:
+    /// Constructor.  No file is created until Create() is called.
+    SpillFile() = default;
+
+    /// Destructor.  Closes and deletes the file, if it still exists.
+    ~SpillFile()
+    {
+        Delete();
+    }
+
+    SpillFile(const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+
+    /// Creates an empty file, replacing any existing file.
+    /// @param[in]  native_path - The path of the file, with native path separators.
+    /// @return True if the file was created; false otherwise.
+    bool Create(const std::string& native_path)
+    {
+        Delete();
+        Instrumentation::CountFileSystemCalls(1);
+#if defined(_WIN32)
+        File = CreateFile(
+            native_path.c_str(),
+            GENERIC_READ | GENERIC_WRITE,
+            0,
+            NULL,
+            CREATE_ALWAYS,
+            FILE_ATTRIBUTE_TEMPORARY,
+            NULL);
+        bool file_created = (INVALID_HANDLE_VALUE != File);
+#else
+        const mode_t READ_WRITE_PERMISSIONS = 0666;
+        File = open(native_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, READ_WRITE_PERMISSIONS);
+        bool file_created = (File >= 0);
+#endif
+        if (file_created)
+        {
+            NativePath = native_path;
+            Size = 0;
+        }
+        return file_created;
+    }
+
+    /// Appends data to the end of the file.
+    /// @param[in]  data - The data to append.
+    /// @param[in]  size_in_bytes - The number of bytes to append.
+    /// @return True if all of the data was appended; false otherwise.
+    bool Append(const char* data, const std::size_t size_in_bytes)
+    {
+        // Offsets are always given explicitly so that reads and writes never depend on the current file position.
+        uint64_t file_system_call_count = 0;
+        std::size_t total_bytes_written = 0;
+        while (total_bytes_written < size_in_bytes)
+        {
+            ++file_system_call_count;
+            uint64_t offset = Size + total_bytes_written;
+#if defined(_WIN32)
+            const std::size_t MAX_BYTES_PER_WRITE = 0x40000000;
+            DWORD bytes_to_write = static_cast<DWORD>(std::min(size_in_bytes - total_bytes_written, MAX_BYTES_PER_WRITE));
+            OVERLAPPED position = {};
+            position.Offset = static_cast<DWORD>(offset);
+            position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+            DWORD bytes_written = 0;
+            bool write_failed = (!WriteFile(File, data + total_bytes_written, bytes_to_write, &bytes_written, &position) || 0 == bytes_written);
+#else
+            ssize_t bytes_written = pwrite(File, data + total_bytes_written, size_in_bytes - total_bytes_written, static_cast<off_t>(offset));
+            bool write_failed = (bytes_written <= 0);
+#endif
+            if (write_failed)
+            {
+                break;
+            }
+            total_bytes_written += static_cast<std::size_t>(bytes_written);
+        }
+        Instrumentation::CountFileSystemCalls(file_system_call_count);
+        Size += total_bytes_written;
+        bool all_data_appended = (size_in_bytes == total_bytes_written);
+        return all_data_appended;
+    }
+
+    /// Reads data from the file.
+    /// @param[in]  offset - The offset of the first byte to read.
+    /// @param[in]  size_in_bytes - The number of bytes to read.
+    /// @param[out]  buffer - The buffer to read into, which must hold at least the number of bytes to read.
+    /// @return True if all of the requested bytes were read; false otherwise.
+    bool Read(const uint64_t offset, const std::size_t size_in_bytes, char* buffer) const
+    {
+        uint64_t file_system_call_count = 0;
+        std::size_t total_bytes_read = 0;
+        while (total_bytes_read < size_in_bytes)
+        {
+            ++file_system_call_count;
+            uint64_t read_offset = offset + total_bytes_read;
+#if defined(_WIN32)
+            const std::size_t MAX_BYTES_PER_READ = 0x40000000;
+            DWORD bytes_to_read = static_cast<DWORD>(std::min(size_in_bytes - total_bytes_read, MAX_BYTES_PER_READ));
+            OVERLAPPED position = {};
+            position.Offset = static_cast<DWORD>(read_offset);
+            position.OffsetHigh = static_cast<DWORD>(read_offset >> 32);
+            DWORD bytes_read = 0;
+            bool read_failed = (!ReadFile(File, buffer + total_bytes_read, bytes_to_read, &bytes_read, &position) || 0 == bytes_read);
+#else
+            ssize_t bytes_read = pread(File, buffer + total_bytes_read, size_in_bytes - total_bytes_read, static_cast<off_t>(read_offset));
+            bool read_failed = (bytes_read <= 0);
+#endif
+            if (read_failed)
+            {
+                break;
+            }
+            total_bytes_read += static_cast<std::size_t>(bytes_read);
+        }
+        Instrumentation::CountFileSystemCalls(file_system_call_count);
+        bool all_data_read = (size_in_bytes == total_bytes_read);
+        return all_data_read;
+    }
+
+    /// Closes the file and moves it to a new path, replacing any existing file there.
+    /// The file is no longer deleted once it has been moved.
+    /// @param[in]  native_path - The new path of the file, with native path separators.
+    /// @return True if the file was moved; false otherwise (in which case it's deleted).
+    bool MoveTo(const std::string& native_path)
+    {
+        Close();
+        Instrumentation::CountFileSystemCalls(1);
+#if defined(_WIN32)
+        bool file_moved = (FALSE != MoveFileEx(NativePath.c_str(), native_path.c_str(), MOVEFILE_REPLACE_EXISTING));
+#else
+        bool file_moved = (0 == rename(NativePath.c_str(), native_path.c_str()));
+#endif
+        if (file_moved)
+        {
+            NativePath.clear();
+        }
+        Delete();
+        return file_moved;
+    }
+
+    /// Closes and deletes the file, if it exists.
+    void Delete()
+    {
+        Close();
+        if (NativePath.empty())
+        {
+            return;
+        }
+        Instrumentation::CountFileSystemCalls(1);
+#if defined(_WIN32)
+        DeleteFile(NativePath.c_str());
+#else
+        unlink(NativePath.c_str());
+#endif
+        NativePath.clear();
+        Size = 0;
+    }
+
+    // MEMBER VARIABLES.
+    /// The path of the file, with native path separators.  Empty if there is no file.
+    std::string NativePath = "";
+    /// The number of bytes in the file.
+    uint64_t Size = 0;
+
+private:
+    /// Closes the file, if it's open.
+    void Close()
+    {
+#if defined(_WIN32)
+        if (INVALID_HANDLE_VALUE != File)
+        {
+            Instrumentation::CountFileSystemCalls(1);
+            CloseHandle(File);
+            File = INVALID_HANDLE_VALUE;
+        }
+#else
+        if (File >= 0)
+        {
+            Instrumentation::CountFileSystemCalls(1);
+            close(File);
+            File = -1;
+        }
+#endif
+    }
+
+    /// The open file.
+#if defined(_WIN32)
+    HANDLE File = INVALID_HANDLE_VALUE;
+#else
+    int File = -1;
+#endif
+};
+
+/// A generated file whose entire contents are built in memory and then written with a single operation.
+/// Existing files with identical contents are left untouched, which avoids needless writes and keeps
+/// Visual Studio from reloading a solution or project when nothing in it actually changed.
+///
+/// Files too large to build entirely in memory can have their memory use limited (see LimitMemory).
+/// Once their contents grow past the limit, the contents are moved to a temporary spill file next to the file,
+/// which is moved into place when the file is written (or deleted if the existing file has the same contents).
+class OutputFile
+{
+public:
+    /// Constructor.
+    /// @param[in]  path - The path of the file to write.
+    explicit OutputFile(const std::string& path) :
+        Path(path)
+    {}
+
+    /// Reserves space for the contents of the file so that they don't need to be reallocated as they're built.
+    /// @param[in]  size_in_bytes - The expected size of the file.
+    void Reserve(const std::size_t size_in_bytes)
+    {
+        Contents.reserve(size_in_bytes);
+    }
+
+    /// Appends text to the contents of the file.
+    /// @param[in]  text - The text to append.
+    /// @return This file.
+    OutputFile& operator<<(const std::string& text)
+    {
+        Append(text.data(), text.size());
+        return *this;
+    }
+
+    /// Appends text to the contents of the file.
+    /// @param[in]  text - The null-terminated text to append.
+    /// @return This file.
+    OutputFile& operator<<(const char* text)
+    {
+        Append(text, std::strlen(text));
+        return *this;
+    }
+
+    /// Appends constant text to the contents of the file.
+    /// @param[in]  text - The text to append.
+    /// @return This file.
+    OutputFile& operator<<(const TextFragment& text)
+    {
+        Append(text.Characters, text.Length);
+        return *this;
+    }
+
+    /// Appends space to the contents of the file for text of a known length to be copied directly into,
+    /// such as a record assembled from several parts.
+    /// @param[in]  text_length - The number of characters to make space for.
+    /// @return The start of the appended space, which is only valid until anything else is appended.
+    char* Extend(const std::size_t text_length)
+    {
+        bool memory_limit_exceeded = (Contents.size() + text_length > MaxBufferedBytes);
+        if (memory_limit_exceeded)
+        {
+            SpillContents();
+        }
+        std::size_t text_offset = Contents.size();
+        Contents.resize(text_offset + text_length);
+        return &Contents[text_offset];
+    }
+
+    /// Limits how much of the file's contents are kept in memory.  Anything more is moved to a spill file.
+    /// Memory for the limit is reserved up-front so that the contents are never reallocated.
+    /// @param[in]  max_buffered_bytes - The maximum number of bytes of the contents to keep in memory.
+    void LimitMemory(const std::size_t max_buffered_bytes)
+    {
+        MaxBufferedBytes = max_buffered_bytes;
+        bool memory_limit_exceeded = (Contents.size() > MaxBufferedBytes);
+        if (memory_limit_exceeded)
+        {
+            SpillContents();
+        }
+        Contents.reserve(MaxBufferedBytes);
+    }
+
+    /// Appends the contents of another file, which is typically a section of this file built separately.
+    /// The other file's contents are released as they're appended, and any failure to spill them
+    /// carries over to this file.
+    /// @param[in,out]  section - The file whose contents to append.
+    void AppendSection(OutputFile& section)
+    {
+        // APPEND ANY SPILLED CONTENTS A CHUNK AT A TIME.
+        // They're appended like any other text so that this file spills as needed too.
+        SpillFailed = SpillFailed || section.SpillFailed;
+        if (section.Spill)
+        {
+            std::string chunk;
+            uint64_t offset = 0;
+            while (offset < section.Spill->Size)
+            {
+                chunk.resize(static_cast<std::size_t>(std::min<uint64_t>(CHUNK_SIZE_IN_BYTES, section.Spill->Size - offset)));
+                bool chunk_read = section.Spill->Read(offset, chunk.size(), &chunk[0]);
+                if (!chunk_read)
+                {
+                    SpillFailed = true;
+                    break;
+                }
+                *this << chunk;
+                offset += chunk.size();
+            }
+            section.Spill.reset();
+        }
+
+        // APPEND THE CONTENTS STILL IN MEMORY.
+        *this << section.Contents;
+        section.Contents = std::string();
+    }
+
+    /// Appends the contents of several other files in order, which are typically consecutive sections of this
+    /// file built separately on different threads.  Space for all of the sections is reserved up-front
+    /// so that the contents are only reallocated once, and the sections are released as they're appended.
+    /// @param[in,out]  sections - The files whose contents to append.
+    void AppendSections(std::vector<OutputFile>& sections)
+    {
+        // RESERVE SPACE FOR ALL OF THE SECTIONS.
+        // Contents that are (or will be) spilled never grow past the memory limit, so no space is reserved for them.
+        std::size_t contents_size = Contents.size();
+        for (const OutputFile& section : sections)
+        {
+            contents_size += section.Contents.size();
+        }
+        bool contents_fit_in_memory = (!Spill && contents_size <= MaxBufferedBytes);
+        if (contents_fit_in_memory)
+        {
+            Contents.reserve(contents_size);
+        }
+
+        // APPEND EACH SECTION.
+        for (OutputFile& section : sections)
+        {
+            AppendSection(section);
+        }
+    }
+
+    /// Gets the size of the file's contents, including any that were spilled.
+    /// @return The number of bytes in the file's contents.
+    uint64_t GetSize() const
+    {
+        uint64_t spilled_size = Spill ? Spill->Size : 0;
+        return spilled_size + Contents.size();
+    }
+
+    /// Writes the contents of the file if they differ from what's currently in the file.
+    /// @return The result of writing the file, which is also stored in this file.
+    OutputFileWriteResult WriteIfChanged()
+    {
+        // MOVE ANY REMAINING CONTENTS TO THE SPILL FILE IF THE CONTENTS WERE SPILLED.
+        // This way, the spill file can simply be moved into place if the contents changed.
+        if (Spill)
+        {
+            SpillContents();
+        }
+        if (SpillFailed)
+        {
+            Spill.reset();
+            WriteResult = OutputFileWriteResult::FAILED;
+            return WriteResult;
+        }
+
+        // CHECK IF THE FILE ALREADY HAS THE SAME CONTENTS.
+        std::string native_path = DirectoryListing::ToNativePath(Path);
+        bool contents_unchanged = ExistingContentsMatch(native_path);
+        if (contents_unchanged)
+        {
+            Spill.reset();
+            WriteResult = OutputFileWriteResult::UNCHANGED;
+            return WriteResult;
+        }
+
+        // WRITE THE NEW CONTENTS.
+        bool contents_written = false;
+        if (Spill)
+        {
+            uint64_t spilled_size = Spill->Size;
+            contents_written = Spill->MoveTo(native_path);
+            Spill.reset();
+            Instrumentation::CountFileWritten(contents_written ? spilled_size : 0);
+        }
+        else
+        {
+            contents_written = WriteContents(native_path);
+        }
+        WriteResult = contents_written ? OutputFileWriteResult::WRITTEN : OutputFileWriteResult::FAILED;
+        return WriteResult;
+    }
+
+    // MEMBER VARIABLES.
+    /// The path of the file to write.
+    std::string Path;
+    /// The contents to write to the file.  If the contents were spilled, this only holds what was appended since.
+    std::string Contents = "";
+    /// The result of the last attempt to write the file.  Files that haven't been written yet are considered failed.
+    OutputFileWriteResult WriteResult = OutputFileWriteResult::FAILED;
+
+private:
+    /// The extension added to a file's path for its spill file.
+    static const std::string SPILL_FILE_EXTENSION;
+    /// The number of bytes that spilled and existing contents are read in at a time.
+    static const std::size_t CHUNK_SIZE_IN_BYTES = 256 * 1024;
+
+    /// Appends text to the contents of the file, first spilling the contents if the text would take them past the memory limit.
+    /// @param[in]  text - The text to append.
+    /// @param[in]  text_length - The number of characters in the text.
+    void Append(const char* text, const std::size_t text_length)
+    {
+        bool memory_limit_exceeded = (Contents.size() + text_length > MaxBufferedBytes);
+        if (memory_limit_exceeded)
+        {
+            SpillContents();
+        }
+        Contents.append(text, text_length);
+    }
+
+    /// Moves the contents in memory to the end of the spill file, creating it if needed.
+    /// The contents are discarded even if they can't be spilled, so that memory use stays limited,
+    /// but the file will then fail to be written.
+    void SpillContents()
+    {
+        // CREATE THE SPILL FILE IF NEEDED.
+        if (!Spill)
+        {
+            Spill.reset(new SpillFile());
+            bool spill_file_created = Spill->Create(DirectoryListing::ToNativePath(Path + SPILL_FILE_EXTENSION));
+            SpillFailed = SpillFailed || !spill_file_created;
+        }
+
+        // MOVE THE CONTENTS TO THE SPILL FILE.
+        // The memory for the contents is kept, since more contents will likely be appended.
+        bool contents_spilled = !SpillFailed && Spill->Append(Contents.data(), Contents.size());
+        SpillFailed = !contents_spilled;
+        Contents.clear();
+    }
+
+    /// Gets part of the contents of this file, whether they're in the spill file or in memory.
+    /// Only contents that have all been spilled or are all still in memory can be retrieved.
+    /// @param[in]  offset - The offset of the first byte to get.
+    /// @param[in]  size_in_bytes - The number of bytes to get.
+    /// @param[in,out]  buffer - The buffer to read spilled contents into, which is resized as needed.
+    /// @return The requested part of the contents, or null if they couldn't be read.
+    const char* GetContents(const uint64_t offset, const std::size_t size_in_bytes, std::string& buffer) const
+    {
+        if (!Spill)
+        {
+            return Contents.data() + offset;
+        }
+
+        buffer.resize(size_in_bytes);
+        bool contents_read = Spill->Read(offset, size_in_bytes, &buffer[0]);
+        return contents_read ? buffer.data() : nullptr;
+    }
+
+    /// Determines if a file already exists with the same contents as this file.
+    /// @param[in]  native_path - The path of the file, with native path separators.
+    /// @return True if the file exists with identical contents; false otherwise.
+    bool ExistingContentsMatch(const std::string& native_path) const
+    {
+#if defined(_WIN32)
+        // OPEN THE EXISTING FILE.
+        HANDLE existing_file = CreateFile(
+            native_path.c_str(),
+            GENERIC_READ,
+            FILE_SHARE_READ,
+            NULL,
+            OPEN_EXISTING,
+            FILE_FLAG_SEQUENTIAL_SCAN,
+            NULL);
+        bool existing_file_opened = (INVALID_HANDLE_VALUE != existing_file);
+        if (!existing_file_opened)
+        {
+            Instrumentation::CountFileSystemCalls(1);
+            return false;
+        }
+
+        // COMPARE THE EXISTING CONTENTS IF THE SIZE MATCHES.
+        // Comparing sizes first avoids reading the file in the common case where its contents changed size.
+        // The contents are compared a chunk at a time so that huge files never need to be read into memory at once.
+        // Opening the file, getting its size, and closing it are always needed, in addition to any reads.
+        uint64_t file_system_call_count = 3;
+        uint64_t contents_size = GetSize();
+        LARGE_INTEGER existing_file_size;
+        bool size_retrieved = (FALSE != GetFileSizeEx(existing_file, &existing_file_size));
+        bool size_matches = size_retrieved && (static_cast<uint64_t>(existing_file_size.QuadPart) == contents_size);
+        bool contents_match = size_matches;
+        std::string existing_contents_chunk(static_cast<std::size_t>(std::min<uint64_t>(CHUNK_SIZE_IN_BYTES, contents_size)), '\0');
+        std::string contents_chunk;
+        uint64_t offset = 0;
+        while (contents_match && offset < contents_size)
+        {
+            DWORD bytes_to_read = static_cast<DWORD>(std::min<uint64_t>(existing_contents_chunk.size(), contents_size - offset));
+            DWORD bytes_read = 0;
+            BOOL read_succeeded = ReadFile(existing_file, &existing_contents_chunk[0], bytes_to_read, &bytes_read, NULL);
+            ++file_system_call_count;
+            bool read_failed = (!read_succeeded || 0 == bytes_read);
+            if (read_failed)
+            {
+                contents_match = false;
+                break;
+            }
+            const char* contents = GetContents(offset, bytes_read, contents_chunk);
+            contents_match = contents && (0 == std::memcmp(existing_contents_chunk.data(), contents, bytes_read));
+            offset += bytes_read;
+        }
+        CloseHandle(existing_file);
+        Instrumentation::CountFileSystemCalls(file_system_call_count);
+        return contents_match;
+#else
+        // OPEN THE EXISTING FILE.
+        int existing_file = open(native_path.c_str(), O_RDONLY | O_CLOEXEC);
+        bool existing_file_opened = (existing_file >= 0);
+        if (!existing_file_opened)
+        {
+            Instrumentation::CountFileSystemCalls(1);
+            return false;
+        }
+
+        // COMPARE THE EXISTING CONTENTS IF THE SIZE MATCHES.
+        // Comparing sizes first avoids reading the file in the common case where its contents changed size.
+        // The contents are compared a chunk at a time so that huge files never need to be read into memory at once.
+        // Opening the file, getting its size, and closing it are always needed, in addition to any reads.
+        uint64_t file_system_call_count = 3;
+        uint64_t contents_size = GetSize();
+        struct stat existing_file_status;
+        bool size_retrieved = (0 == fstat(existing_file, &existing_file_status));
+        bool size_matches = size_retrieved && (static_cast<uint64_t>(existing_file_status.st_size) == contents_size);
+        bool contents_match = size_matches;
+        std::string existing_contents_chunk(static_cast<std::size_t>(std::min<uint64_t>(CHUNK_SIZE_IN_BYTES, contents_size)), '\0');
+        std::string contents_chunk;
+        uint64_t offset = 0;
+        while (contents_match && offset < contents_size)
+        {
+            std::size_t bytes_to_read = static_cast<std::size_t>(std::min<uint64_t>(existing_contents_chunk.size(), contents_size - offset));
+            ssize_t bytes_read = read(existing_file, &existing_contents_chunk[0], bytes_to_read);
+            ++file_system_call_count;
+            bool read_failed = (bytes_read <= 0);
+            if (read_failed)
+            {
+                contents_match = false;
+                break;
+            }
+            std::size_t bytes_compared = static_cast<std::size_t>(bytes_read);
+            const char* contents = GetContents(offset, bytes_compared, contents_chunk);
+            contents_match = contents && (0 == std::memcmp(existing_contents_chunk.data(), contents, bytes_compared));
+            offset += bytes_compared;
+        }
+        close(existing_file);
+        Instrumentation::CountFileSystemCalls(file_system_call_count);
+        return contents_match;
+#endif
+    }
+
+    /// Writes the contents of this file, replacing any existing file.
+    /// @param[in]  native_path - The path of the file, with native path separators.
+    /// @return True if the file was written; false otherwise.
+    bool WriteContents(const std::string& native_path) const
+    {
+#if defined(_WIN32)
+        // CREATE THE FILE.
+        HANDLE file = CreateFile(
+            native_path.c_str(),
+            GENERIC_WRITE,
+            0,
+            NULL,
+            CREATE_ALWAYS,
+            FILE_ATTRIBUTE_NORMAL,
+            NULL);
+        bool file_created = (INVALID_HANDLE_VALUE != file);
+        if (!file_created)
+        {
+            Instrumentation::CountFileSystemCalls(1);
+            return false;
+        }
+
+        // WRITE THE CONTENTS.
+        // Files are almost always small enough to be written in a single call.
+        // Creating and closing the file are always needed, in addition to the writes.
+        uint64_t file_system_call_count = 2;
+        std::size_t total_bytes_written = 0;
+        while (total_bytes_written < Contents.size())
+        {
+            const std::size_t MAX_BYTES_PER_WRITE = 0x40000000;
+            DWORD bytes_to_write = static_cast<DWORD>(std::min(Contents.size() - total_bytes_written, MAX_BYTES_PER_WRITE));
+            DWORD bytes_written = 0;
+            BOOL write_succeeded = WriteFile(file, Contents.data() + total_bytes_written, bytes_to_write, &bytes_written, NULL);
+            ++file_system_call_count;
+            if (!write_succeeded)
+            {
+                break;
+            }
+            total_bytes_written += bytes_written;
+        }
+        CloseHandle(file);
+        Instrumentation::CountFileSystemCalls(file_system_call_count);
+        Instrumentation::CountFileWritten(total_bytes_written);
+        bool all_contents_written = (Contents.size() == total_bytes_written);
+        return all_contents_written;
+#else
+        // CREATE THE FILE.
+        const mode_t READ_WRITE_PERMISSIONS = 0666;
+        int file = open(native_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, READ_WRITE_PERMISSIONS);
+        bool file_created = (file >= 0);
+        if (!file_created)
+        {
+            Instrumentation::CountFileSystemCalls(1);
+            return false;
+        }
+
+        // WRITE THE CONTENTS.
+        // Files are almost always small enough to be written in a single call.
+        // Creating and closing the file are always needed, in addition to the writes.
+        uint64_t file_system_call_count = 2;
+        std::size_t total_bytes_written = 0;
+        while (total_bytes_written < Contents.size())
+        {
+            ssize_t bytes_written = write(file, Contents.data() + total_bytes_written, Contents.size() - total_bytes_written);
+            ++file_system_call_count;
+            bool write_failed = (bytes_written <= 0);
+            if (write_failed)
+            {
+                break;
+            }
+            total_bytes_written += static_cast<std::size_t>(bytes_written);
+        }
+        bool file_closed = (0 == close(file));
+        Instrumentation::CountFileSystemCalls(file_system_call_count);
+        Instrumentation::CountFileWritten(total_bytes_written);
+        bool all_contents_written = (Contents.size() == total_bytes_written) && file_closed;
+        return all_contents_written;
+#endif
+    }
+
+    /// The maximum number of bytes of the contents to keep in memory before spilling them.
+    std::size_t MaxBufferedBytes = std::numeric_limits<std::size_t>::max();
+    /// The file that contents have been spilled to, if any.
+    std::unique_ptr<SpillFile> Spill = nullptr;
+    /// True if any contents couldn't be spilled, so the file can't be written.
+    bool SpillFailed = false;
+};
+
+const std::string OutputFile::SPILL_FILE_EXTENSION = ".spill";
+const std::size_t OutputFile::CHUNK_SIZE_IN_BYTES;
+
+/// Text written into XML files, such as the paths in project files.  Characters with special meaning in XML
+/// (&, <, >, ", and ') are replaced with entity references so that paths containing them can't corrupt the file.
+///
+/// Almost no paths contain such characters, so text is scanned for them 16 characters at a time with SSE2
+/// (where it's available), and each character is only examined individually within a block that has a hit.
+/// Text without such characters is copied as-is.
+class XmlText
+{
+public:
+    /// Appends a record to a file, made of constant fragments of markup that are written as-is and text that's
+    /// escaped, in the order given.  The record's exact size is computed first so that it's appended at once.
+    /// @param[in,out]  file - The file (or section of a file) to append to.
+    /// @param[in]  parts - The fragments (TextFragment) and text (std::string) making up the record.
+    template <typename... RecordParts>
+    static void AppendRecord(OutputFile& file, const RecordParts&... parts)
+    {
+        std::size_t record_length = GetRecordLength(parts...);
+        char* record = file.Extend(record_length);
+        CopyRecord(record, parts...);
+    }
+
+    /// Gets the length of text once escaped.
+    /// @param[in]  text - The text to escape.
+    /// @param[in]  text_length - The number of characters in the text.
+    /// @return The number of characters in the escaped text.
+    static std::size_t GetEscapedLength(const char* text, const std::size_t text_length)
+    {
+        std::size_t escaped_length = text_length;
+        std::size_t character_index = FindCharacterToEscape(text, 0, text_length);
+        while (character_index < text_length)
+        {
+            // The entity replaces the character itself.
+            escaped_length += GetEntity(text[character_index]).Length - 1;
+            character_index = FindCharacterToEscape(text, character_index + 1, text_length);
+        }
+        return escaped_length;
+    }
+
+    /// Copies text, escaping it.
+    /// @param[in]  text - The text to escape.
+    /// @param[in]  text_length - The number of characters in the text.
+    /// @param[out]  destination - Where to copy the escaped text, which must have space for its escaped length.
+    /// @return The position just past the escaped text in the destination.
+    static char* CopyEscaped(const char* text, const std::size_t text_length, char* destination)
+    {
+        std::size_t copied_length = 0;
+        while (copied_length < text_length)
+        {
+            // COPY EVERYTHING UP TO THE NEXT CHARACTER TO ESCAPE AS-IS.
+            std::size_t character_index = FindCharacterToEscape(text, copied_length, text_length);
+            std::memcpy(destination, text + copied_length, character_index - copied_length);
+            destination += character_index - copied_length;
+            bool escaping_needed = (character_index < text_length);
+            if (!escaping_needed)
+            {
+                break;
+            }
+
+            // COPY THE ENTITY FOR THE CHARACTER.
+            TextFragment entity = GetEntity(text[character_index]);
+            std::memcpy(destination, entity.Characters, entity.Length);
+            destination += entity.Length;
+            copied_length = character_index + 1;
+        }
+        return destination;
+    }
+
+    /// Finds the next character in text that needs to be escaped.
+    /// @param[in]  text - The text to search.
+    /// @param[in]  start_index - The index of the character to start searching from.
+    /// @param[in]  text_length - The number of characters in the text.
+    /// @return The index of the next character to escape, or the text length if there are none.
+    static std::size_t FindCharacterToEscape(const char* text, const std::size_t start_index, const std::size_t text_length)
+    {
+        std::size_t character_index = start_index;
+#if defined(GENERATE_PROJECT_SSE2)
+        // SCAN FOR A BLOCK OF CHARACTERS WITH ANY CHARACTER TO ESCAPE.
+        // Each block is compared against every special character at once, and the comparison results are
+        // combined into a mask of the characters that matched, so only blocks with matches need a closer look.
+        const std::size_t BLOCK_SIZE_IN_BYTES = sizeof(__m128i);
+        const __m128i AMPERSANDS = _mm_set1_epi8('&');
+        const __m128i LESS_THAN_SIGNS = _mm_set1_epi8('<');
+        const __m128i GREATER_THAN_SIGNS = _mm_set1_epi8('>');
+        const __m128i QUOTATION_MARKS = _mm_set1_epi8('"');
+        const __m128i APOSTROPHES = _mm_set1_epi8('\'');
+        while (character_index + BLOCK_SIZE_IN_BYTES <= text_length)
+        {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + character_index));
+            __m128i matches = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(block, AMPERSANDS), _mm_cmpeq_epi8(block, LESS_THAN_SIGNS)),
+                _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(block, GREATER_THAN_SIGNS), _mm_cmpeq_epi8(block, QUOTATION_MARKS)),
+                    _mm_cmpeq_epi8(block, APOSTROPHES)));
+            bool block_has_character_to_escape = (0 != _mm_movemask_epi8(matches));
+            if (block_has_character_to_escape)
+            {
+                break;
+            }
+            character_index += BLOCK_SIZE_IN_BYTES;
+        }
+#endif
+
+        // FIND THE NEXT CHARACTER TO ESCAPE ONE CHARACTER AT A TIME.
+        // This covers the block containing the next character to escape (if any) and any characters after the last full block.
+        for (; character_index < text_length; ++character_index)
+        {
+            bool character_needs_escaping = (GetEntity(text[character_index]).Length > 0);
+            if (character_needs_escaping)
+            {
+                return character_index;
+            }
+        }
+        return text_length;
+    }
+
+private:
+    /// Gets the entity reference that a character is replaced with.
+    /// @param[in]  character - The character to escape.
+    /// @return The entity reference for the character, or an empty fragment if the character doesn't need escaping.
+    static TextFragment GetEntity(const char character)
+    {
+        switch (character)
+        {
+            case '&':
+                return TextFragment::From("&amp;");
+            case '<':
+                return TextFragment::From("&lt;");
+            case '>':
+                return TextFragment::From("&gt;");
+            case '"':
+                return TextFragment::From("&quot;");
+            case '\'':
+                return TextFragment::From("&apos;");
+            default:
+                return TextFragment::From("");
+        }
+    }
+
+    /// Gets the length of an empty record.
+    /// @return 0.
+    static std::size_t GetRecordLength()
+    {
+        return 0;
+    }
+
+    /// Gets the length of a record starting with a constant fragment.
+    /// @param[in]  fragment - The first part of the record.
+    /// @param[in]  remaining_parts - The rest of the record.
+    /// @return The number of characters in the record.
+    template <typename... RecordParts>
+    static std::size_t GetRecordLength(const TextFragment& fragment, const RecordParts&... remaining_parts)
+    {
+        return fragment.Length + GetRecordLength(remaining_parts...);
+    }
+
+    /// Gets the length of a record starting with text to escape.
+    /// @param[in]  text - The first part of the record.
+    /// @param[in]  remaining_parts - The rest of the record.
+    /// @return The number of characters in the record.
+    template <typename... RecordParts>
+    static std::size_t GetRecordLength(const std::string& text, const RecordParts&... remaining_parts)
+    {
+        return GetEscapedLength(text.data(), text.size()) + GetRecordLength(remaining_parts...);
+    }
+
+    /// Copies an empty record.
+    static void CopyRecord(char*)
+    {}
+
+    /// Copies a record starting with a constant fragment.
+    /// @param[out]  destination - Where to copy the record.
+    /// @param[in]  fragment - The first part of the record.
+    /// @param[in]  remaining_parts - The rest of the record.
+    template <typename... RecordParts>
+    static void CopyRecord(char* destination, const TextFragment& fragment, const RecordParts&... remaining_parts)
+    {
+        std::memcpy(destination, fragment.Characters, fragment.Length);
+        CopyRecord(destination + fragment.Length, remaining_parts...);
+    }
+
+    /// Copies a record starting with text to escape.
+    /// @param[out]  destination - Where to copy the record.
+    /// @param[in]  text - The first part of the record.
+    /// @param[in]  remaining_parts - The rest of the record.
+    template <typename... RecordParts>
+    static void CopyRecord(char* destination, const std::string& text, const RecordParts&... remaining_parts)
+    {
+        char* end_of_text = CopyEscaped(text.data(), text.size(), destination);
+        CopyRecord(end_of_text, remaining_parts...);
+    }
+};
+
+/// Reads XML documents, such as existing project files, reporting each element to a handler as soon as its tag
+/// is read instead of building a tree of the whole document.  Names and attribute values refer directly to the
+/// document's characters, so nothing is copied, and the offset of each tag is reported so that parts of the
+/// document can be copied exactly as they are.
+///
+/// Only what's needed for project files is supported: text, comments, CDATA sections, processing instructions,
+/// and document type declarations (without an internal subset) are skipped.  Entity references are left as-is,
+/// since only attribute values used for comparison need them replaced (see Unescape).
+class XmlReader
+{
+public:
+    /// An attribute of an element.
+    struct Attribute
+    {
+        /// The name of the attribute, which isn't null-terminated.
+        const char* Name;
+        /// The number of characters in the name.
+        std::size_t NameLength;
+        /// The value of the attribute, without quotes or any entity references replaced.  It isn't null-terminated.
+        const char* Value;
+        /// The number of characters in the value.
+        std::size_t ValueLength;
+    };
+
+    /// A start or end tag.  Empty elements (like <Element />) are a single tag that both starts and ends the element.
+    struct Tag
+    {
+        /// Determines if the tag is for an element with a particular name.
+        /// @param[in]  name - The name to check for.
+        /// @return True if the tag's element has the name; false otherwise.
+        bool NameIs(const TextFragment& name) const
+        {
+            return (name.Length == NameLength) && (0 == std::memcmp(Name, name.Characters, NameLength));
+        }
+
+        /// Finds an attribute of the tag's element.  Only start tags have attributes.
+        /// @param[in]  name - The name of the attribute to find.
+        /// @return The attribute, or null if the element doesn't have it.
+        const Attribute* FindAttribute(const TextFragment& name) const
+        {
+            for (const auto& attribute : Attributes)
+            {
+                bool attribute_found = (name.Length == attribute.NameLength) && (0 == std::memcmp(attribute.Name, name.Characters, name.Length));
+                if (attribute_found)
+                {
+                    return &attribute;
+                }
+            }
+            return nullptr;
+        }
+
+        /// The name of the tag's element, which isn't null-terminated.
+        const char* Name = nullptr;
+        /// The number of characters in the name.
+        std::size_t NameLength = 0;
+        /// The attributes of the element, in the order they're written.
+        std::vector<Attribute> Attributes = {};
+        /// The offset of the tag's opening angle bracket within the document.
+        std::size_t StartOffset = 0;
+        /// The offset just past the tag's closing angle bracket within the document.
+        std::size_t EndOffset = 0;
+        /// True if the tag is for an empty element (<Element />); false otherwise.
+        bool IsEmpty = false;
+    };
+
+    /// Reads a document, reporting each element to a handler with the handler's StartElement(const Tag&) and
+    /// EndElement(const Tag&) methods.  Both are called with the same tag for empty elements.
+    /// @param[in]  document - The characters of the document, which don't need to be null-terminated.
+    /// @param[in]  document_length - The number of characters in the document.
+    /// @param[in,out]  handler - The handler to report elements to.  Tags are only valid during each call.
+    /// @return True if the document was read; false if it isn't well-formed (in which case elements may already
+    ///     have been reported).
+    template <typename ElementHandler>
+    static bool Read(const char* document, const std::size_t document_length, ElementHandler& handler)
+    {
+        // SKIP ANY BYTE ORDER MARK.
+        // Visual Studio writes UTF-8 files with one.
+        const TextFragment BYTE_ORDER_MARK = TextFragment::From("\xEF\xBB\xBF");
+        std::size_t offset = StartsWith(document, document_length, 0, BYTE_ORDER_MARK) ? BYTE_ORDER_MARK.Length : 0;
+
+        // READ EACH TAG.
+        // Comments and CDATA sections are checked before other declarations since they also start like declarations.
+        const std::pair<TextFragment, TextFragment> SKIPPED_MARKUP[] =
+        {
+            { TextFragment::From("<?"), TextFragment::From("?>") },
+            { TextFragment::From("<!--"), TextFragment::From("-->") },
+            { TextFragment::From("<![CDATA["), TextFragment::From("]]>") },
+            { TextFragment::From("<!"), TextFragment::From(">") }
+        };
+        const TextFragment END_TAG_START = TextFragment::From("</");
+        std::vector<std::pair<const char*, std::size_t>> open_element_names;
+        bool root_element_read = false;
+        Tag tag;
+        for (;;)
+        {
+            // FIND THE NEXT TAG.
+            // Everything between tags is text, which is skipped.
+            const void* tag_start = std::memchr(document + offset, '<', document_length - offset);
+            if (!tag_start)
+            {
+                break;
+            }
+            std::size_t tag_offset = static_cast<std::size_t>(static_cast<const char*>(tag_start) - document);
+
+            // SKIP ANYTHING THAT ISN'T AN ELEMENT.
+            // All such markup starts with "<?" or "<!", so most tags don't need to be checked further.
+            std::size_t markup_type_offset = tag_offset + 1;
+            bool markup_possible = (markup_type_offset < document_length) && ('?' == document[markup_type_offset] || '!' == document[markup_type_offset]);
+            bool markup_skipped = false;
+            for (auto skipped_markup = std::begin(SKIPPED_MARKUP); markup_possible && std::end(SKIPPED_MARKUP) != skipped_markup; ++skipped_markup)
+            {
+                bool markup_found = StartsWith(document, document_length, tag_offset, skipped_markup->first);
+                if (markup_found)
+                {
+                    const char* markup_end = std::search(
+                        document + tag_offset + skipped_markup->first.Length,
+                        document + document_length,
+                        skipped_markup->second.Characters,
+                        skipped_markup->second.Characters + skipped_markup->second.Length);
+                    if (document + document_length == markup_end)
+                    {
+                        return false;
+                    }
+                    offset = static_cast<std::size_t>(markup_end - document) + skipped_markup->second.Length;
+                    markup_skipped = true;
+                    break;
+                }
+            }
+            if (markup_skipped)
+            {
+                continue;
+            }
+
+            // READ THE TAG'S NAME.
+            bool is_end_tag = StartsWith(document, document_length, tag_offset, END_TAG_START);
+            offset = tag_offset + (is_end_tag ? END_TAG_START.Length : 1);
+            tag.Name = document + offset;
+            offset = SkipName(document, document_length, offset);
+            tag.NameLength = static_cast<std::size_t>(document + offset - tag.Name);
+            tag.Attributes.clear();
+            tag.StartOffset = tag_offset;
+            tag.IsEmpty = false;
+            bool name_present = (tag.NameLength > 0);
+            if (!name_present)
+            {
+                return false;
+            }
+
+            // READ AN END TAG.
+            // It must match the innermost open element.
+            if (is_end_tag)
+            {
+                offset = SkipWhitespace(document, document_length, offset);
+                bool tag_ended = (offset < document_length) && ('>' == document[offset]);
+                bool element_open = !open_element_names.empty();
+                bool element_matches = element_open &&
+                    (open_element_names.back().second == tag.NameLength) &&
+                    (0 == std::memcmp(open_element_names.back().first, tag.Name, tag.NameLength));
+                if (!tag_ended || !element_matches)
+                {
+                    return false;
+                }
+                ++offset;
+                tag.EndOffset = offset;
+                open_element_names.pop_back();
+                handler.EndElement(tag);
+                continue;
+            }
+
+            // READ THE START TAG'S ATTRIBUTES.
+            // There can only be one root element.
+            bool second_root_element = open_element_names.empty() && root_element_read;
+            if (second_root_element)
+            {
+                return false;
+            }
+            for (;;)
+            {
+                offset = SkipWhitespace(document, document_length, offset);
+                if (offset >= document_length)
+                {
+                    return false;
+                }
+                if ('>' == document[offset])
+                {
+                    ++offset;
+                    break;
+                }
+                if ('/' == document[offset])
+                {
+                    bool tag_ended = (offset + 1 < document_length) && ('>' == document[offset + 1]);
+                    if (!tag_ended)
+                    {
+                        return false;
+                    }
+                    offset += 2;
+                    tag.IsEmpty = true;
+                    break;
+                }
+
+                Attribute attribute;
+                attribute.Name = document + offset;
+                offset = SkipName(document, document_length, offset);
+                attribute.NameLength = static_cast<std::size_t>(document + offset - attribute.Name);
+                offset = SkipWhitespace(document, document_length, offset);
+                bool equals_sign_present = (attribute.NameLength > 0) && (offset < document_length) && ('=' == document[offset]);
+                if (!equals_sign_present)
+                {
+                    return false;
+                }
+                offset = SkipWhitespace(document, document_length, offset + 1);
+                bool value_quoted = (offset < document_length) && ('"' == document[offset] || '\'' == document[offset]);
+                if (!value_quoted)
+                {
+                    return false;
+                }
+                char quote = document[offset];
+                ++offset;
+                const void* value_end = std::memchr(document + offset, quote, document_length - offset);
+                if (!value_end)
+                {
+                    return false;
+                }
+                attribute.Value = document + offset;
+                attribute.ValueLength = static_cast<std::size_t>(static_cast<const char*>(value_end) - attribute.Value);
+                offset += attribute.ValueLength + 1;
+                tag.Attributes.push_back(attribute);
+            }
+
+            // REPORT THE ELEMENT.
+            tag.EndOffset = offset;
+            root_element_read = true;
+            handler.StartElement(tag);
+            if (tag.IsEmpty)
+            {
+                handler.EndElement(tag);
+            }
+            else
+            {
+                open_element_names.emplace_back(tag.Name, tag.NameLength);
+            }
+        }
+
+        // MAKE SURE EVERY ELEMENT WAS CLOSED.
+        bool document_complete = root_element_read && open_element_names.empty();
+        return document_complete;
+    }
+
+    /// Replaces the entity and character references in text (such as an attribute value) with the characters they refer to.
+    /// @param[in]  text - The text, which doesn't need to be null-terminated.
+    /// @param[in]  text_length - The number of characters in the text.
+    /// @return The text with references replaced.  Unknown or malformed references are left as-is.
+    static std::string Unescape(const char* text, const std::size_t text_length)
+    {
+        // Almost no text has any references.
+        const void* first_reference = std::memchr(text, '&', text_length);
+        if (!first_reference)
+        {
+            return std::string(text, text_length);
+        }
+
+        std::string unescaped_text(text, static_cast<std::size_t>(static_cast<const char*>(first_reference) - text));
+        for (std::size_t character_index = unescaped_text.size(); character_index < text_length; ++character_index)
+        {
+            // COPY ORDINARY CHARACTERS AS-IS.
+            const char* reference = text + character_index;
+            const void* reference_end = ('&' == *reference) ? std::memchr(reference, ';', text_length - character_index) : nullptr;
+            if (!reference_end)
+            {
+                unescaped_text.push_back(*reference);
+                continue;
+            }
+
+            // REPLACE THE REFERENCE.
+            // Character references are written in decimal (&#38;) or hexadecimal (&#x26;).
+            std::string name(reference + 1, static_cast<const char*>(reference_end));
+            const std::pair<const char*, char> ENTITIES[] =
+            {
+                { "amp", '&' },
+                { "lt", '<' },
+                { "gt", '>' },
+                { "quot", '"' },
+                { "apos", '\'' }
+            };
+            auto entity = std::find_if(
+                std::begin(ENTITIES),
+                std::end(ENTITIES),
+                [&name](const std::pair<const char*, char>& known_entity) { return name == known_entity.first; });
+            bool is_character_reference = (name.size() > 1 && '#' == name[0]);
+            if (std::end(ENTITIES) != entity)
+            {
+                unescaped_text.push_back(entity->second);
+            }
+            else if (is_character_reference)
+            {
+                const int DECIMAL_BASE = 10;
+                const int HEXADECIMAL_BASE = 16;
+                bool is_hexadecimal = ('x' == name[1]);
+                const char* digits = name.c_str() + (is_hexadecimal ? 2 : 1);
+                char* digits_end = nullptr;
+                unsigned long code_point = std::strtoul(digits, &digits_end, is_hexadecimal ? HEXADECIMAL_BASE : DECIMAL_BASE);
+                bool code_point_valid = ('\0' != *digits) && ('\0' == *digits_end);
+                if (!code_point_valid)
+                {
+                    unescaped_text.append(reference, static_cast<const char*>(reference_end) + 1);
+                }
+                else
+                {
+                    Utf8Text::Append(static_cast<uint32_t>(code_point), unescaped_text);
+                }
+            }
+            else
+            {
+                unescaped_text.append(reference, static_cast<const char*>(reference_end) + 1);
+            }
+            character_index += name.size() + 1;
+        }
+        return unescaped_text;
+    }
+
+private:
+    /// Determines if text in a document starts with a fragment at an offset.
+    /// @param[in]  document - The characters of the document.
+    /// @param[in]  document_length - The number of characters in the document.
+    /// @param[in]  offset - The offset to check at.
+    /// @param[in]  fragment - The fragment to check for.
+    /// @return True if the fragment is at the offset; false otherwise.
+    static bool StartsWith(const char* document, const std::size_t document_length, const std::size_t offset, const TextFragment& fragment)
+    {
+        bool fragment_fits = (document_length - offset >= fragment.Length);
+        return fragment_fits && (0 == std::memcmp(document + offset, fragment.Characters, fragment.Length));
+    }
+
+    /// Determines if a character is whitespace between markup.
+    /// @param[in]  character - The character to check.
+    /// @return True if the character is whitespace; false otherwise.
+    static bool IsWhitespace(const char character)
+    {
+        return (' ' == character) || ('\t' == character) || ('\r' == character) || ('\n' == character);
+    }
+
+    /// Skips past any whitespace in a document.
+    /// @param[in]  document - The characters of the document.
+    /// @param[in]  document_length - The number of characters in the document.
+    /// @param[in]  offset - The offset to start at.
+    /// @return The offset of the first character that isn't whitespace, or the length of the document.
+    static std::size_t SkipWhitespace(const char* document, const std::size_t document_length, std::size_t offset)
+    {
+        while (offset < document_length && IsWhitespace(document[offset]))
+        {
+            ++offset;
+        }
+        return offset;
+    }
+
+    /// Skips past a name in a document.  Names are assumed to end at whitespace or any markup character.
+    /// @param[in]  document - The characters of the document.
+    /// @param[in]  document_length - The number of characters in the document.
+    /// @param[in]  offset - The offset of the start of the name.
+    /// @return The offset just past the end of the name.
+    static std::size_t SkipName(const char* document, const std::size_t document_length, std::size_t offset)
+    {
+        while (offset < document_length)
+        {
+            char character = document[offset];
+            bool name_ended = IsWhitespace(character) || ('/' == character) || ('>' == character) || ('=' == character) || ('<' == character);
+            if (name_ended)
+            {
+                break;
+            }
+            ++offset;
+        }
+        return offset;
+    }
+};
+
+/// A read-only view of a file's contents mapped directly into memory.
+class MemoryMappedFile
+{
+public:
+    /// Constructor.  No file will be mapped.
+    MemoryMappedFile() = default;
+
+    /// Destructor.  Unmaps any mapped file.
+    ~MemoryMappedFile()
+    {
+        Close();
+    }
+
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+    /// Maps a file into memory, unmapping any previously mapped file.
+    /// @param[in]  path - The path of the file to map.
+    /// @return True if the file was mapped; false otherwise.  Empty files are successfully
+    ///     mapped but have no data.
+    bool Open(const std::string& path)
+    {
+        Close();
+        std::string native_path = DirectoryListing::ToNativePath(path);
+#if defined(_WIN32)
+        // OPEN THE FILE.
+        HANDLE file = CreateFile(native_path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        Instrumentation::CountFileSystemCalls(1);
+        bool file_opened = (INVALID_HANDLE_VALUE != file);
+        if (!file_opened)
+        {
+            return false;
+        }
+
+        // MAP THE FILE IF IT ISN'T EMPTY.
+        // Empty files can't be mapped on Windows.
+        // Getting the size and closing the file are always needed.
+        LARGE_INTEGER file_size;
+        bool size_retrieved = (FALSE != GetFileSizeEx(file, &file_size));
+        Instrumentation::CountFileSystemCalls(2);
+        bool file_mapped = size_retrieved;
+        if (size_retrieved && file_size.QuadPart > 0)
+        {
+            HANDLE mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            Instrumentation::CountFileSystemCalls(1);
+            if (mapping)
+            {
+                Data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                CloseHandle(mapping);
+                Instrumentation::CountFileSystemCalls(2);
+            }
+            file_mapped = (nullptr != Data);
+            Size = file_mapped ? static_cast<std::size_t>(file_size.QuadPart) : 0;
+        }
+        CloseHandle(file);
+        return file_mapped;
+#else
+        // OPEN THE FILE.
+        int file = open(native_path.c_str(), O_RDONLY | O_CLOEXEC);
+        Instrumentation::CountFileSystemCalls(1);
+        bool file_opened = (file >= 0);
+        if (!file_opened)
+        {
+            return false;
+        }
+
+        // MAP THE FILE IF IT ISN'T EMPTY.
+        // The mapping remains valid after the file is closed.
+        // Getting the size and closing the file are always needed.
+        struct stat status;
+        bool size_retrieved = (0 == fstat(file, &status));
+        Instrumentation::CountFileSystemCalls(2);
+        bool file_mapped = size_retrieved;
+        if (size_retrieved && status.st_size > 0)
+        {
+            void* mapped_data = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+            Instrumentation::CountFileSystemCalls(1);
+            file_mapped = (MAP_FAILED != mapped_data);
+            if (file_mapped)
+            {
+                Data = static_cast<const char*>(mapped_data);
+                Size = static_cast<std::size_t>(status.st_size);
+            }
+        }
+        close(file);
+        return file_mapped;
+#endif
+    }
+
+    /// Unmaps any mapped file.
+    void Close()
+    {
+        if (Data)
+        {
+            Instrumentation::CountFileSystemCalls(1);
+#if defined(_WIN32)
+            UnmapViewOfFile(Data);
+#else
+            munmap(const_cast<char*>(Data), Size);
+#endif
+        }
+        Data = nullptr;
+        Size = 0;
+    }
+
+    // MEMBER VARIABLES.
+    /// The contents of the file, or null if no file (or an empty file) is mapped.
+    const char* Data = nullptr;
+    /// The size of the file in bytes.
+    std::size_t Size = 0;
+};
+
+/// Runs independent tasks concurrently.
+class ParallelTasks
+{
+public:
+    /// Runs all tasks, spreading them across threads, and waits for them to complete.
+    /// @param[in]  thread_count - The maximum number of threads to use.  The calling thread is one of them.
+    /// @param[in]  tasks - The tasks to run.
+    static void Run(const unsigned int thread_count, const std::vector<std::function<void()>>& tasks)
+    {
+        // RUN TASKS ON EACH THREAD UNTIL NO TASKS REMAIN.
+        std::atomic<std::size_t> next_task_index(0);
+        auto run_tasks = [&tasks, &next_task_index]()
+        {
+            for (std::size_t task_index = next_task_index++; task_index < tasks.size(); task_index = next_task_index++)
+            {
+                tasks[task_index]();
+            }
+        };
+        // RUN THE TASKS ON ALL THREADS.
+        // No more threads are started than there are tasks.
+        std::size_t used_thread_count = std::min<std::size_t>(std::max(1u, thread_count), tasks.size());
+        std::vector<std::thread> threads;
+        for (std::size_t thread_index = 1; thread_index < used_thread_count; ++thread_index)
+        {
+            threads.emplace_back(run_tasks);
+        }
+        run_tasks();
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    /// Processes a range of items in batches, spreading the batches across threads, and waits for them to complete.
+    /// Several batches are made for each thread, which keeps all threads busy even if some items take longer than others.
+    /// @param[in]  item_count - The number of items to process.
+    /// @param[in]  thread_count - The maximum number of threads to use.  The calling thread is one of them.
+    /// @param[in]  process_batch - The function to call for each batch, with the signature
+    ///     void(std::size_t first_item_index, std::size_t end_item_index).  It's called concurrently for different batches.
+    template <typename BatchFunction>
+    static void ForEachBatch(const std::size_t item_count, const unsigned int thread_count, BatchFunction process_batch)
+    {
+        // SPLIT THE ITEMS INTO BATCHES.
+        const std::size_t BATCHES_PER_THREAD = 8;
+        std::size_t batch_count = std::max(1u, thread_count) * BATCHES_PER_THREAD;
+        std::size_t items_per_batch = std::max<std::size_t>(1, (item_count + batch_count - 1) / batch_count);
+        std::vector<std::function<void()>> batches;
+        for (std::size_t first_item_index = 0; first_item_index < item_count; first_item_index += items_per_batch)
+        {
+            std::size_t end_item_index = std::min(first_item_index + items_per_batch, item_count);
+            batches.push_back([&process_batch, first_item_index, end_item_index]() { process_batch(first_item_index, end_item_index); });
+        }
+
+        // PROCESS THE BATCHES ON ALL THREADS.
+        Run(thread_count, batches);
+    }
+};
+
+/// The ignore rules that apply to a scanned folder before any of the rules files within it are read.
+struct BaseIgnoreRules
+{
+    /// The compiled rules.
+    IgnoreRules Rules = {};
+    /// The path of the scanned folder from the base folder of the rules, with '/' between folder names.
+    /// Empty if the scanned folder is the base folder.
+    std::string RootFolderBasePath = "";
+    /// True if .gitignore files within the scanned folder are read; false otherwise.
+    bool GitIgnoreFilesRead = false;
+    /// Which folders reached through links are included.
+    LinkPolicy LinkedFolders = LinkPolicy::ALWAYS;
+    /// A hash of all rules read, for detecting if they change.
+    uint64_t Hash = 0;
+};
+
+/// The git repository containing a folder.
+struct GitRepository
+{
+    /// The name of the entry at the root of a repository's working tree that holds (or points to) its git data.
+    static const std::string GIT_FOLDER_NAME;
+
+    /// Finds the git repository containing a folder.  Its root is the closest folder containing a .git entry
+    /// (which is a file for linked working trees and submodules).
+    /// @param[in]  folder_path - The relative path of the folder.
+    /// @param[out]  repository - The repository containing the folder, if it's in one.
+    /// @return True if the folder is in a git repository; false otherwise.
+    static bool Find(const std::string& folder_path, GitRepository& repository)
+    {
+        std::string absolute_folder_path;
+        bool absolute_path_retrieved = DirectoryListing::GetAbsolutePath(folder_path, absolute_folder_path);
+        if (!absolute_path_retrieved)
+        {
+            return false;
+        }
+        std::vector<std::string> folder_names_within_root;
+        for (;;)
+        {
+            uint64_t modification_time = 0;
+            bool repository_root_found = DirectoryListing::GetModificationTime(AppendName(absolute_folder_path, GIT_FOLDER_NAME), modification_time);
+            if (repository_root_found)
+            {
+                break;
+            }
+
+            // MOVE UP TO THE PARENT FOLDER.
+            // The root of the file system keeps its separator.
+            std::size_t separator_index = absolute_folder_path.find_last_of(NATIVE_PATH_SEPARATOR);
+            bool file_system_root_reached = (std::string::npos == separator_index || absolute_folder_path.size() == separator_index + 1);
+            if (file_system_root_reached)
+            {
+                return false;
+            }
+            folder_names_within_root.push_back(absolute_folder_path.substr(separator_index + 1));
+            absolute_folder_path.resize(separator_index);
+            bool parent_is_file_system_root = (std::string::npos == absolute_folder_path.find(NATIVE_PATH_SEPARATOR));
+            if (parent_is_file_system_root)
+            {
+                absolute_folder_path.push_back(NATIVE_PATH_SEPARATOR);
+            }
+        }
+
+        // The folder names were found from the innermost folder outwards.
+        repository.RootPath = absolute_folder_path;
+        repository.FolderNamesWithinRoot.assign(folder_names_within_root.crbegin(), folder_names_within_root.crend());
+        return true;
+    }
+
+    /// Appends a name to a native path.
+    /// @param[in]  path - The path to append to.
+    /// @param[in]  name - The name of the file or folder within the path.
+    /// @return The path of the file or folder.
+    static std::string AppendName(const std::string& path, const std::string& name)
+    {
+        bool separator_needed = (path.empty() || NATIVE_PATH_SEPARATOR != path.back());
+        return separator_needed ? (path + NATIVE_PATH_SEPARATOR + name) : (path + name);
+    }
+
+    /// Gets the path of the repository's index file.  It's in the .git folder, unless .git is a file (for linked
+    /// working trees and submodules) pointing to the actual git folder with a "gitdir: <path>" line.
+    /// @return The native path of the index file.
+    std::string GetIndexPath() const
+    {
+        // CHECK IF THE .GIT ENTRY POINTS TO ANOTHER FOLDER.
+        // Folders can't be mapped as files, so this only reads anything if .git is a file.
+        const std::string INDEX_FILENAME = "index";
+        std::string git_entry_path = AppendName(RootPath, GIT_FOLDER_NAME);
+        MemoryMappedFile git_file;
+        bool git_file_read = git_file.Open(git_entry_path) && git_file.Data;
+        const std::string GIT_FOLDER_PREFIX = "gitdir: ";
+        bool git_folder_elsewhere = git_file_read && (0 == std::string(git_file.Data, git_file.Size).compare(0, GIT_FOLDER_PREFIX.size(), GIT_FOLDER_PREFIX));
+        if (!git_folder_elsewhere)
+        {
+            return AppendName(git_entry_path, INDEX_FILENAME);
+        }
+
+        // GET THE PATH OF THE OTHER FOLDER.
+        // It may be relative to the root of the working tree.
+        std::string git_folder_path(git_file.Data + GIT_FOLDER_PREFIX.size(), git_file.Size - GIT_FOLDER_PREFIX.size());
+        std::size_t line_end = git_folder_path.find_first_of("\r\n");
+        if (std::string::npos != line_end)
+        {
+            git_folder_path.resize(line_end);
+        }
+        bool git_folder_path_absolute = (
+            (!git_folder_path.empty() && ('/' == git_folder_path.front() || '\\' == git_folder_path.front())) ||
+            (git_folder_path.size() > 1 && ':' == git_folder_path[1]));
+        if (!git_folder_path_absolute)
+        {
+            git_folder_path = AppendName(RootPath, git_folder_path);
+        }
+        return AppendName(git_folder_path, INDEX_FILENAME);
+    }
+
+    /// Gets the path of the folder the repository was found from, relative to the root of the repository.
+    /// @return The path with '/' between folder names, which is empty if the folder is the root.
+    std::string GetFolderPathWithinRoot() const
+    {
+        std::string folder_path;
+        for (const auto& folder_name : FolderNamesWithinRoot)
+        {
+            folder_path += (folder_path.empty() ? "" : "/") + folder_name;
+        }
+        return folder_path;
+    }
+
+    // MEMBER VARIABLES.
+    /// The absolute path of the root of the repository's working tree, with native path separators.
+    std::string RootPath = "";
+    /// The names of the folders from the root of the repository to the folder it was found from, outermost first.
+    std::vector<std::string> FolderNamesWithinRoot = {};
+};
+
+const std::string GitRepository::GIT_FOLDER_NAME = ".git";
+
+/// Reads the rules for what to leave out when scanning folders.
+///
+/// Like git, rules come from the .gitignore file in each folder (which applies to everything within the folder),
+/// from .gitignore files in the folders containing the scanned folder up to the root of its git repository,
+/// and from the repository's .git/info/exclude file.  Rules from the command line take priority over all of them.
+/// Every set of rules read is hashed, so that rescans can tell if any rules changed since the previous scan.
+class IgnoreRuleFiles
+{
+public:
+    /// The name of the rules file in each folder.
+    static const std::string GITIGNORE_FILENAME;
+
+    /// Loads the rules that apply to a folder to scan from outside of it.
+    /// @param[in]  root_folder_path - The relative path of the folder to scan.
+    /// @param[in]  settings - The settings for what to ignore.
+    /// @return The compiled rules, which are relative to the root of the folder's git repository if it's in one.
+    static BaseIgnoreRules LoadBaseRules(const std::string& root_folder_path, const IgnoreSettings& settings)
+    {
+        // IGNORE VERSION CONTROL FOLDERS.
+        // They're added first so that any other rules can include them again.
+        BaseIgnoreRules base_rules;
+        base_rules.GitIgnoreFilesRead = settings.VersionControlIgnored;
+        if (settings.VersionControlIgnored)
+        {
+            const std::string VERSION_CONTROL_RULES = ".git/\n.hg/\n.svn/\n";
+            base_rules.Rules.Add(VERSION_CONTROL_RULES, "", false);
+            ReadRepositoryRules(root_folder_path, base_rules);
+        }
+
+        // ADD THE RULES FROM THE COMMAND LINE.
+        base_rules.Rules.Add(settings.RulesText, base_rules.RootFolderBasePath, true);
+        base_rules.Hash ^= Hash(std::string(), settings.RulesText);
+        base_rules.Rules.Compile();
+
+        // INCLUDE WHICH LINKS ARE FOLLOWED IN THE HASH.
+        // Following links differently leaves out different folders, just like changing the rules does.
+        const std::string LINK_POLICY_HASH_PATH = "<links>";
+        base_rules.LinkedFolders = settings.LinkedFolders;
+        base_rules.Hash ^= Hash(LINK_POLICY_HASH_PATH, std::to_string(static_cast<int>(settings.LinkedFolders)));
+        return base_rules;
+    }
+
+    /// Reads a rules file.
+    /// @param[in]  path - The path of the rules file.
+    /// @param[out]  rules_text - The text of the rules file.
+    /// @return True if the file was read; false otherwise.
+    static bool Read(const std::string& path, std::string& rules_text)
+    {
+        MemoryMappedFile rules_file;
+        bool rules_file_read = rules_file.Open(path);
+        if (!rules_file_read)
+        {
+            return false;
+        }
+        rules_text.assign(rules_file.Data ? rules_file.Data : "", rules_file.Size);
+        return true;
+    }
+
+    /// Hashes a set of rules.  Hashes of different sets are combined with exclusive or, so that the
+    /// combined hash doesn't depend on the order that the sets were read in.
+    /// @param[in]  path - The path of the rules file the rules came from.
+    /// @param[in]  rules_text - The text of the rules.
+    /// @return The hash of the rules.
+    static uint64_t Hash(const std::string& path, const std::string& rules_text)
+    {
+        // The path is terminated so that moving characters between it and the rules changes the hash.
+        std::string path_and_rules_text = path;
+        path_and_rules_text.push_back('\0');
+        path_and_rules_text += rules_text;
+        return ContentHash::Hash(path_and_rules_text.data(), path_and_rules_text.size());
+    }
+
+private:
+    /// Reads the rules that apply to a folder to scan from the git repository containing it, if any.
+    /// @param[in]  root_folder_path - The relative path of the folder to scan.
+    /// @param[in,out]  base_rules - The rules to add to.  The path of the folder to scan is set
+    ///     relative to the root of the repository.
+    static void ReadRepositoryRules(const std::string& root_folder_path, BaseIgnoreRules& base_rules)
+    {
+        // FIND THE ROOT OF THE REPOSITORY.
+        // Folders that aren't in a repository only have the rules from their own .gitignore files.
+        GitRepository repository;
+        bool repository_found = GitRepository::Find(root_folder_path, repository);
+        if (!repository_found)
+        {
+            return;
+        }
+
+        // READ THE REPOSITORY'S RULES FILES.
+        // Rules from folders closer to the scanned folder take priority, so they're added last.
+        // The scanned folder's own .gitignore file is read when it's scanned.
+        std::string folder_path = repository.RootPath;
+        std::string info_folder_path = GitRepository::AppendName(GitRepository::AppendName(folder_path, GitRepository::GIT_FOLDER_NAME), "info");
+        ReadRulesFile(GitRepository::AppendName(info_folder_path, "exclude"), "", base_rules);
+        std::string base_path;
+        for (const auto& folder_name : repository.FolderNamesWithinRoot)
+        {
+            ReadRulesFile(GitRepository::AppendName(folder_path, GITIGNORE_FILENAME), base_path, base_rules);
+            folder_path = GitRepository::AppendName(folder_path, folder_name);
+            base_path += (base_path.empty() ? "" : "/") + folder_name;
+        }
+        base_rules.RootFolderBasePath = base_path;
+    }
+
+    /// Reads a rules file and adds its rules, if it exists.
+    /// @param[in]  path - The path of the rules file.
+    /// @param[in]  base_path - The path of the folder the rules are relative to, from the base folder.
+    /// @param[in,out]  base_rules - The rules to add to.
+    static void ReadRulesFile(const std::string& path, const std::string& base_path, BaseIgnoreRules& base_rules)
+    {
+        std::string rules_text;
+        bool rules_file_read = Read(path, rules_text);
+        if (rules_file_read)
+        {
+            base_rules.Rules.Add(rules_text, base_path, false);
+            base_rules.Hash ^= Hash(path, rules_text);
+        }
+    }
+};
+
+const std::string IgnoreRuleFiles::GITIGNORE_FILENAME = ".gitignore";
+
+/// The entries added to or removed from a folder hierarchy when it was rescanned.
+/// A folder that was renamed shows up as a removed folder and an added folder,
+/// along with all of the files within each.
+struct FolderTreeChanges
+{
+    /// The relative paths of folders that were added.
+    std::vector<std::string> AddedFolderPaths = {};
+    /// The relative paths of folders that were removed.
+    std::vector<std::string> RemovedFolderPaths = {};
+    /// The relative paths of files that were added.
+    std::vector<std::string> AddedFilePaths = {};
+    /// The relative paths of files that were removed.
+    std::vector<std::string> RemovedFilePaths = {};
+};
+
+/// A folder hierarchy stored as flat arrays rather than as nested objects.
+///
+/// Folders are stored in pre-order (each folder followed by all of its descendants), and
+/// files are stored grouped by folder in the same order.  Iterating over either array therefore
+/// visits entries in the same order as a recursive walk of the hierarchy, and every folder's
+/// descendants occupy a contiguous range of each array.  Folders are linked to their parents,
+/// first subfolders, and next siblings by index.
+///
+/// Only the name of each folder or file is stored, interned in a string arena.  Full paths
+/// are only built when needed by concatenating names along the chain of parent folders.
+class FolderTree
+{
+public:
+    /// The index used when a folder or file doesn't exist.
+    static const uint32_t NO_INDEX = 0xFFFFFFFF;
+
+    /// A folder in the tree.
+    struct FolderRecord
+    {
+        /// The name of the folder.  For the root folder, this is the full path to the folder.
+        StringReference Name;
+        /// The index of the folder containing this folder, or NO_INDEX for the root folder.
+        uint32_t ParentIndex;
+        /// The index of the first subfolder of this folder, or NO_INDEX if there are no subfolders.
+        uint32_t FirstSubfolderIndex;
+        /// The index of the next subfolder of this folder's parent, or NO_INDEX if this is the last one.
+        uint32_t NextSiblingIndex;
+        /// The index just past this folder's last descendant.
+        uint32_t SubtreeEndIndex;
+        /// The index of the first file directly in this folder.
+        uint32_t FirstFileIndex;
+        /// The number of files directly in this folder.
+        uint32_t FileCount;
+        /// The time the folder's entries were last modified, in the file system's native units.
+        uint64_t ModificationTime;
+        /// The folder's identity on disk, which is unknown if the folder wasn't listed (such as when found from the git index).
+        FolderIdentity Identity;
+        /// 1 if the folder is a link to another folder; 0 otherwise.  Flags take up whole words
+        /// so that records have no padding, since they're saved to the scan cache byte for byte.
+        uint32_t IsLink;
+        /// 1 if the folder's entries were copied from the same folder reached by another path; 0 if they were listed.
+        uint32_t IsAlias;
+    };
+
+    /// A file in the tree.
+    struct FileRecord
+    {
+        /// The name of the file, including any extension.
+        StringReference Name;
+        /// The index of the folder containing the file.
+        uint32_t FolderIndex;
+    };
+
+    /// Gets the folder at the specified path, with all of its files and subfolders.
+    /// The folder hierarchy is scanned in parallel (see FolderScanner).
+    /// @param[in]  relative_path - The relative path to the folder.
+    ///     This path may be relative to anything, but mixing paths relative to different
+    ///     things is not recommended in the same program.
+    /// @param[in]  ignore_settings - The settings for which files and folders to leave out.
+    ///     Ignored folders are never listed.
+    /// @param[in]  thread_count - The number of threads to use for scanning.
+    ///     Zero uses one thread per hardware core.
+    /// @return The tree for the folder at the specified path (with files and subfolders
+    ///     populated, assuming any are found).
+    static FolderTree Get(const std::string& relative_path, const IgnoreSettings& ignore_settings, const unsigned int thread_count);
+
+    /// Finds the folders in a tree that have changed on disk since the tree was scanned, based on
+    /// each folder's modification time.  Folders are checked in parallel.
+    /// @param[in]  thread_count - The number of threads to use for checking.
+    ///     Zero uses one thread per hardware core.
+    /// @param[in,out]  tree - The tree to check.  Its folder paths will be built.
+    /// @return A flag for each folder in the tree indicating if it changed (or no longer exists).
+    static std::vector<uint8_t> FindChangedFolders(const unsigned int thread_count, FolderTree& tree);
+
+    /// Rescans a tree, only listing the entries of folders that changed since the tree was
+    /// previously scanned (along with any new folders).  The entries of all other folders are
+    /// taken from the previous tree, unless any ignore rules changed, in which case every folder
+    /// is listed again.  The same ignore settings are used as for the previous tree.
+    /// @param[in]  thread_count - The number of threads to use for scanning.
+    ///     Zero uses one thread per hardware core.
+    /// @param[in]  changed_folders - A flag for each folder in the previous tree indicating if it changed.
+    /// @param[in,out]  previous_tree - The tree from the previous scan.  If no folders changed, it is moved
+    ///     into the returned tree.
+    /// @param[out]  changes - The entries that were added or removed, if they're needed.  May be null.
+    /// @return The updated tree.
+    static FolderTree Rescan(
+        const unsigned int thread_count,
+        const std::vector<uint8_t>& changed_folders,
+        FolderTree& previous_tree,
+        FolderTreeChanges* changes);
+
+    /// Reads the size and modification time of every file in the tree into the file metadata columns
+    /// (see FileMetadataReader).  Files that can't be examined get a size and modification time of 0.
+    /// @param[in]  thread_count - The number of threads to use if files have to be examined one call at a time.
+    ///     Zero uses one thread per hardware core.
+    void ReadFileMetadata(const unsigned int thread_count);
+
+    /// Checks if the file metadata columns have been read for all files in the tree.
+    /// @return True if every file has a size and modification time; false otherwise.
+    bool HasFileMetadata() const
+    {
+        bool file_metadata_read = (FileSizesInBytes.size() == Files.size() && FileModificationTimes.size() == Files.size());
+        return file_metadata_read;
+    }
+
+    /// Adds scanned folders to the tree as a new root folder.  The scanned folders are emptied as they're
+    /// added so that they no longer take up memory by the time the tree is complete.
+    /// @param[in,out]  root_folder - The root folder of the scanned hierarchy.
+    void AddScannedFolders(ScannedFolder& root_folder)
+    {
+        // RESERVE SPACE FOR ALL FOLDERS AND FILES.
+        std::size_t folder_count = 0;
+        std::size_t file_count = 0;
+        CountScannedEntries(root_folder, folder_count, file_count);
+        Folders.reserve(Folders.size() + folder_count);
+        Files.reserve(Files.size() + file_count);
+
+        // ADD ALL FOLDERS AND FILES.
+        StringReference root_folder_name = Names.Intern(root_folder.RelativePath.c_str(), root_folder.RelativePath.size());
+        AddScannedFolder(root_folder_name, NO_INDEX, root_folder);
+    }
+
+    /// Finds a subfolder directly within a folder.
+    /// @param[in]  folder_index - The index of the folder to search.
+    /// @param[in]  name - The name of the subfolder to find.
+    /// @return The index of the subfolder, or NO_INDEX if it wasn't found.
+    uint32_t FindSubfolder(const uint32_t folder_index, const std::string& name) const
+    {
+        for (uint32_t subfolder_index = Folders[folder_index].FirstSubfolderIndex;
+            NO_INDEX != subfolder_index;
+            subfolder_index = Folders[subfolder_index].NextSiblingIndex)
+        {
+            const StringReference& subfolder_name = Folders[subfolder_index].Name;
+            bool names_match = (
+                subfolder_name.Length == name.size() &&
+                0 == std::memcmp(Names.GetCharacters(subfolder_name), name.data(), name.size()));
+            if (names_match)
+            {
+                return subfolder_index;
+            }
+        }
+        return NO_INDEX;
+    }
+
+    /// Gets the index just past the last file in a folder or any of its descendants.
+    /// Since files are grouped by folder in pre-order, all of these files are contiguous,
+    /// starting at the folder's first file index.
+    /// @param[in]  folder_index - The index of the folder.
+    /// @return The index just past the last file in the folder's subtree.
+    uint32_t GetSubtreeFileEndIndex(const uint32_t folder_index) const
+    {
+        uint32_t subtree_end_index = Folders[folder_index].SubtreeEndIndex;
+        bool subtree_at_end = (subtree_end_index >= Folders.size());
+        if (subtree_at_end)
+        {
+            return static_cast<uint32_t>(Files.size());
+        }
+        return Folders[subtree_end_index].FirstFileIndex;
+    }
+
+    /// Builds the full paths of all folders in the tree.  While paths can always be retrieved,
+    /// building all of them once ahead of time makes retrieving them much faster.
+    /// The paths must be re-built if any folders are added to the tree afterwards.
+    void BuildFolderPaths()
+    {
+        FolderPathCharacters.clear();
+        FolderPathOffsets.clear();
+        FolderPathOffsets.reserve(Folders.size() + 1);
+        for (const auto& folder : Folders)
+        {
+            // APPEND THE FOLDER'S PATH.
+            // Since folders are stored in pre-order, a folder's parent always already has its path built.
+            FolderPathOffsets.push_back(static_cast<uint32_t>(FolderPathCharacters.size()));
+            bool is_root_folder = (NO_INDEX == folder.ParentIndex);
+            if (!is_root_folder)
+            {
+                uint32_t parent_path_offset = FolderPathOffsets[folder.ParentIndex];
+                uint32_t parent_path_length = FolderPathOffsets[folder.ParentIndex + 1] - parent_path_offset;
+                FolderPathCharacters.append(FolderPathCharacters, parent_path_offset, parent_path_length);
+                FolderPathCharacters.append(PATH_SEPARATOR);
+            }
+            Names.Append(folder.Name, FolderPathCharacters);
+        }
+        FolderPathOffsets.push_back(static_cast<uint32_t>(FolderPathCharacters.size()));
+    }
+
+    /// Appends the relative path of a folder to a string.
+    /// @param[in]  folder_index - The index of the folder.
+    /// @param[in,out]  path - The string to append the folder's path to.
+    void AppendFolderPath(const uint32_t folder_index, std::string& path) const
+    {
+        // USE THE PRE-BUILT PATH IF AVAILABLE.
+        bool folder_paths_built = (FolderPathOffsets.size() == Folders.size() + 1);
+        if (folder_paths_built)
+        {
+            uint32_t path_offset = FolderPathOffsets[folder_index];
+            uint32_t path_length = FolderPathOffsets[folder_index + 1] - path_offset;
+            path.append(FolderPathCharacters, path_offset, path_length);
+            return;
+        }
+
+        // BUILD THE PATH FROM THE CHAIN OF PARENT FOLDERS.
+        const FolderRecord& folder = Folders[folder_index];
+        bool is_root_folder = (NO_INDEX == folder.ParentIndex);
+        if (!is_root_folder)
+        {
+            AppendFolderPath(folder.ParentIndex, path);
+            path.append(PATH_SEPARATOR);
+        }
+        Names.Append(folder.Name, path);
+    }
+
+    /// Gets the length of the relative path of a folder.
+    /// @param[in]  folder_index - The index of the folder.
+    /// @return The number of characters in the folder's path.
+    std::size_t GetFolderPathLength(const uint32_t folder_index) const
+    {
+        // USE THE PRE-BUILT PATH IF AVAILABLE.
+        bool folder_paths_built = (FolderPathOffsets.size() == Folders.size() + 1);
+        if (folder_paths_built)
+        {
+            std::size_t path_length = FolderPathOffsets[folder_index + 1] - FolderPathOffsets[folder_index];
+            return path_length;
+        }
+
+        // ADD UP THE LENGTHS ALONG THE CHAIN OF PARENT FOLDERS.
+        const FolderRecord& folder = Folders[folder_index];
+        std::size_t path_length = folder.Name.Length;
+        bool is_root_folder = (NO_INDEX == folder.ParentIndex);
+        if (!is_root_folder)
+        {
+            path_length += GetFolderPathLength(folder.ParentIndex) + PATH_SEPARATOR.size();
+        }
+        return path_length;
+    }
+
+    /// Gets the length of the relative path of a file.
+    /// @param[in]  file_index - The index of the file.
+    /// @return The number of characters in the file's path.
+    std::size_t GetFilePathLength(const uint32_t file_index) const
+    {
+        const FileRecord& file = Files[file_index];
+        std::size_t path_length = GetFolderPathLength(file.FolderIndex) + PATH_SEPARATOR.size() + file.Name.Length;
+        return path_length;
+    }
+
+    /// Appends the relative path of a file to a string.
+    /// @param[in]  file_index - The index of the file.
+    /// @param[in,out]  path - The string to append the file's path to.
+    void AppendFilePath(const uint32_t file_index, std::string& path) const
+    {
+        const FileRecord& file = Files[file_index];
+        AppendFolderPath(file.FolderIndex, path);
+        path.append(PATH_SEPARATOR);
+        Names.Append(file.Name, path);
+    }
+
+    /// Debug printing for the tree.  Every folder and file is printed, so this is only done when requested.
+    /// @param[in,out]  output - The stream to print to.
+    void DebugPrint(std::ostream& output) const
+    {
+        // Lines aren't flushed individually since trees can have a huge number of files.
+        std::string path;
+        for (uint32_t folder_index = 0; folder_index < Folders.size(); ++folder_index)
+        {
+            // PRINT THE FOLDER'S PATH.
+            path.clear();
+            AppendFolderPath(folder_index, path);
+            output << "RelativePath: " << path << '\n';
+
+            // PRINT ALL FILES IN THE ROOT OF THIS FOLDER.
+            // Subfolders immediately follow their parent folders, so they'll be printed next.
+            output << "Files: " << '\n';
+            const FolderRecord& folder = Folders[folder_index];
+            for (uint32_t file_index = folder.FirstFileIndex; file_index < folder.FirstFileIndex + folder.FileCount; ++file_index)
+            {
+                path.clear();
+                AppendFilePath(file_index, path);
+                output << "\t" << path << '\n';
+            }
+            output << "Subfolders: " << '\n';
+        }
+        output.flush();
+    }
+
+    // MEMBER VARIABLES.
+    /// The names of all folders and files.
+    StringArena Names = {};
+    /// All folders, in pre-order.
+    std::vector<FolderRecord> Folders = {};
+    /// All files, grouped by folder in the same order as the folders.
+    std::vector<FileRecord> Files = {};
+    /// The size of each file, by file index.  Only populated once file metadata is read, since listings don't include it.
+    std::vector<uint64_t> FileSizesInBytes = {};
+    /// The time each file was last modified, in the file system's native units, by file index.  Only populated once file metadata is read.
+    std::vector<uint64_t> FileModificationTimes = {};
+    /// The settings for which files and folders were left out of the tree.
+    IgnoreSettings IgnoreRuleSettings = {};
+    /// A hash of all ignore rules applied while scanning, for detecting if they change.
+    uint64_t IgnoreRulesHash = 0;
+
+private:
+    /// Counts the number of folders and files in a scanned folder hierarchy.
+    /// @param[in]  folder - The root of the scanned hierarchy.
+    /// @param[in,out]  folder_count - The count of folders to add to.
+    /// @param[in,out]  file_count - The count of files to add to.
+    static void CountScannedEntries(const ScannedFolder& folder, std::size_t& folder_count, std::size_t& file_count)
+    {
+        ++folder_count;
+        file_count += folder.FileNameOffsets.size();
+        for (const auto& subfolder : folder.Subfolders)
+        {
+            if (!subfolder.LeftOut)
+            {
+                CountScannedEntries(subfolder, folder_count, file_count);
+            }
+        }
+    }
+
+    /// Adds a scanned folder and all of its descendants to the tree, emptying the scanned folder.
+    /// @param[in]  name - The name of the folder.
+    /// @param[in]  parent_index - The index of the folder's parent.
+    /// @param[in,out]  scanned_folder - The scanned folder to add.
+    /// @return The index of the added folder.
+    uint32_t AddScannedFolder(const StringReference& name, const uint32_t parent_index, ScannedFolder& scanned_folder)
+    {
+        // ADD THE FOLDER.
+        uint32_t folder_index = static_cast<uint32_t>(Folders.size());
+        FolderRecord folder;
+        folder.Name = name;
+        folder.ParentIndex = parent_index;
+        folder.FirstSubfolderIndex = NO_INDEX;
+        folder.NextSiblingIndex = NO_INDEX;
+        folder.SubtreeEndIndex = NO_INDEX;
+        folder.FirstFileIndex = static_cast<uint32_t>(Files.size());
+        folder.FileCount = static_cast<uint32_t>(scanned_folder.FileNameOffsets.size());
+        folder.ModificationTime = scanned_folder.ModificationTime;
+        folder.Identity = scanned_folder.Identity;
+        folder.IsLink = scanned_folder.IsLink ? 1 : 0;
+        folder.IsAlias = scanned_folder.IsAlias ? 1 : 0;
+        Folders.push_back(folder);
+
+        // ADD THE FOLDER'S FILES.
+        for (uint32_t file_name_offset : scanned_folder.FileNameOffsets)
+        {
+            const char* file_name = scanned_folder.GetEntryName(file_name_offset);
+            FileRecord file;
+            file.Name = Names.Intern(file_name, std::strlen(file_name));
+            file.FolderIndex = folder_index;
+            Files.push_back(file);
+        }
+
+        // ADD THE FOLDER'S SUBFOLDERS.
+        uint32_t previous_subfolder_index = NO_INDEX;
+        for (std::size_t subfolder_index = 0; subfolder_index < scanned_folder.Subfolders.size(); ++subfolder_index)
+        {
+            // SKIP THE SUBFOLDER IF IT WAS LEFT OUT.
+            if (scanned_folder.Subfolders[subfolder_index].LeftOut)
+            {
+                continue;
+            }
+
+            // ADD THE SUBFOLDER.
+            const char* subfolder_name = scanned_folder.GetEntryName(scanned_folder.SubfolderNameOffsets[subfolder_index]);
+            StringReference interned_subfolder_name = Names.Intern(subfolder_name, std::strlen(subfolder_name));
+            uint32_t added_subfolder_index = AddScannedFolder(
+                interned_subfolder_name,
+                folder_index,
+                scanned_folder.Subfolders[subfolder_index]);
+
+            // LINK THE SUBFOLDER TO ITS PREVIOUS SIBLING.
+            bool is_first_subfolder = (NO_INDEX == previous_subfolder_index);
+            if (is_first_subfolder)
+            {
+                Folders[folder_index].FirstSubfolderIndex = added_subfolder_index;
+            }
+            else
+            {
+                Folders[previous_subfolder_index].NextSiblingIndex = added_subfolder_index;
+            }
+            previous_subfolder_index = added_subfolder_index;
+        }
+        Folders[folder_index].SubtreeEndIndex = static_cast<uint32_t>(Folders.size());
+
+        // RELEASE THE SCANNED FOLDER'S MEMORY.
+        scanned_folder = ScannedFolder(std::string());
+        return folder_index;
+    }
+
+    /// The full paths of all folders, concatenated.  Only populated once built.
+    std::string FolderPathCharacters = "";
+    /// The offset of each folder's path, plus the end offset of the last path.  Only populated once built.
+    std::vector<uint32_t> FolderPathOffsets = {};
+};
+
+const uint32_t FolderTree::NO_INDEX;
+
+/// Scans a folder hierarchy in parallel.  Each folder is a separate task that lists the folder's
+/// entries and then queues a task for each subfolder.  Every thread has its own queue of tasks,
+/// which it works on in last-in-first-out order to keep the traversal depth-first and local,
+/// and idle threads steal the oldest (and typically largest) tasks from other threads' queues.
+///
+/// The subfolders of a folder are all created before any of their tasks are queued,
+/// so each task can fill in its folder in place without any copying or further synchronization.
+/// The scanned folders are later flattened into a FolderTree.
+///
+/// When rescanning, a tree from a previous scan can be provided.  Folders from the previous scan that
+/// haven't changed take their entries from the previous tree instead of being listed again.
+///
+/// Entries matching any ignore rules (see IgnoreRules) are removed as soon as a folder is listed, so ignored
+/// folders are never listed at all.  Each folder carries the state of the rules after its own path, so each
+/// entry only has its name matched.  A folder with its own .gitignore file gets a copy of its parent's rules
+/// with the new rules added, which then applies to everything within it.
+///
+/// Subfolders that are links (symbolic links, or junctions on Windows) are set aside until everything else has
+/// been scanned, and are then resolved one at a time in order of their paths, so the result never depends on how
+/// the scan was split across threads.  Every folder is identified by its device and file ID, so a link leading back
+/// to a folder containing it is left out instead of being followed forever, and a folder reached by several paths
+/// is only listed once (see LinkPolicy).
+class FolderScanner
+{
+public:
+    /// Determines the number of threads to use for scanning.
+    /// @param[in]  requested_thread_count - The requested number of threads.
+    ///     Zero uses one thread per hardware core.
+    /// @return The number of threads to use for scanning.
+    static unsigned int ResolveThreadCount(const unsigned int requested_thread_count)
+    {
+        const unsigned int USE_HARDWARE_THREAD_COUNT = 0;
+        bool use_hardware_thread_count = (USE_HARDWARE_THREAD_COUNT == requested_thread_count);
+        if (!use_hardware_thread_count)
+        {
+            return requested_thread_count;
+        }
+
+        // The hardware thread count may not be known, in which case a single thread is used.
+        const unsigned int MIN_THREAD_COUNT = 1;
+        unsigned int hardware_thread_count = std::thread::hardware_concurrency();
+        return std::max(MIN_THREAD_COUNT, hardware_thread_count);
+    }
+
+    /// Scans the folder hierarchy under the provided folder.
+    /// @param[in]  thread_count - The number of threads to use for scanning.
+    ///     Zero uses one thread per hardware core.
+    /// @param[in]  previous_tree - The tree from a previous scan, if any.  The root folder's
+    ///     previous folder index must be set for the previous tree to be used.
+    /// @param[in]  changed_folders - A flag for each folder in the previous tree indicating if it changed.
+    ///     Only used if there is a previous tree.
+    /// @param[out]  changes - The entries added or removed since the previous scan, if they're needed.
+    ///     May be null.  Only used if there is a previous tree.
+    /// @param[in]  base_ignore_rules - The ignore rules that apply to the root folder from outside of it.
+    /// @param[in,out]  root_folder - The folder to scan.  Its path must be set, and its
+    ///     lists of files and subfolders will be populated.
+    /// @return A hash of all ignore rules applied, for detecting if they change.
+    static uint64_t Scan(
+        const unsigned int thread_count,
+        const FolderTree* previous_tree,
+        const std::vector<uint8_t>* changed_folders,
+        FolderTreeChanges* changes,
+        const BaseIgnoreRules& base_ignore_rules,
+        ScannedFolder& root_folder)
+    {
+        // CREATE A TASK QUEUE FOR EACH THREAD.
+        unsigned int resolved_thread_count = ResolveThreadCount(thread_count);
+        FolderScanner scanner(resolved_thread_count, previous_tree, changed_folders, previous_tree ? changes : nullptr, base_ignore_rules, root_folder);
+
+        // QUEUE THE TASK FOR THE ROOT FOLDER.
+        const unsigned int MAIN_THREAD_INDEX = 0;
+        scanner.PendingFolderCount = 1;
+        scanner.Queues[MAIN_THREAD_INDEX]->Folders.push_back(&root_folder);
+
+        // SCAN USING ALL THREADS.
+        scanner.Run();
+
+        // SCAN THE FOLDERS REACHED THROUGH LINKS.
+        // Folders reached through links may contain more links, which are resolved once those folders have been scanned.
+        // Trees without any links never need their folders' identities looked up.
+        std::vector<ScannedFolder*> scanned_root_folders(1, &root_folder);
+        while (!scanner.LinkedFolders.empty())
+        {
+            for (const ScannedFolder* scanned_root_folder : scanned_root_folders)
+            {
+                scanner.AddFolderIdentities(*scanned_root_folder);
+            }
+            scanned_root_folders = scanner.QueueLinkedFolders();
+            scanner.Run();
+        }
+        scanner.CopyAliasedFolders();
+        return scanner.IgnoreRulesHash.load();
+    }
+
+    /// Applies the ignore rules from outside of a folder being scanned to the folder itself.
+    /// @param[in]  base_ignore_rules - The ignore rules that apply to the folder from outside of it.
+    /// @param[in,out]  root_folder - The folder being scanned.  Its ignore rules are set, if there are any.
+    static void ApplyBaseIgnoreRules(const BaseIgnoreRules& base_ignore_rules, ScannedFolder& root_folder)
+    {
+        // Without any rules, nothing needs to be matched.
+        bool ignore_rules_present = !base_ignore_rules.Rules.Empty();
+        if (ignore_rules_present)
+        {
+            root_folder.ApplicableIgnoreRules = &base_ignore_rules.Rules;
+            root_folder.IgnoreRulesState = GetFolderIgnoreRulesState(base_ignore_rules.Rules, base_ignore_rules.RootFolderBasePath);
+        }
+    }
+
+    /// Applies the ignore rules to a folder's entries, after adding the rules from the folder's own .gitignore file.
+    /// .gitignore files themselves are never ignored, so that changes to them are always found.
+    /// @param[in]  base_ignore_rules - The ignore rules that apply to the scanned root folder from outside of it.
+    /// @param[in]  root_folder_path_length - The length of the scanned root folder's path.
+    /// @param[in]  entries_listed - True if the folder's entries were listed; false if they were taken from the
+    ///     previous scan, in which case they were already filtered by the same rules.
+    /// @param[in,out]  folder - The folder.  Its ignore rules must be set, and are replaced if the folder
+    ///     has its own rules.  Its ignored entries are removed.
+    /// @param[out]  folder_rules_hash - A hash of the folder's own rules file, or zero if it doesn't have one.
+    /// @return The folder's new rules if it has its own, which must be kept as long as the folder or any of its
+    ///     subfolders use them; null otherwise.
+    static std::unique_ptr<IgnoreRules> ApplyIgnoreRules(
+        const BaseIgnoreRules& base_ignore_rules,
+        const std::size_t root_folder_path_length,
+        const bool entries_listed,
+        ScannedFolder& folder,
+        uint64_t& folder_rules_hash)
+    {
+        // ADD THE RULES FROM THE FOLDER'S OWN RULES FILE.
+        // They're added to a copy of the rules from the containing folders, since those still apply.
+        const std::string& RULES_FILENAME = IgnoreRuleFiles::GITIGNORE_FILENAME;
+        bool rules_file_present = base_ignore_rules.GitIgnoreFilesRead && std::any_of(
+            folder.FileNameOffsets.cbegin(),
+            folder.FileNameOffsets.cend(),
+            [&folder, &RULES_FILENAME](const uint32_t name_offset) { return RULES_FILENAME == folder.GetEntryName(name_offset); });
+        std::string rules_file_path = rules_file_present ? (folder.RelativePath + PATH_SEPARATOR + RULES_FILENAME) : "";
+        std::string rules_text;
+        bool rules_file_read = rules_file_present && IgnoreRuleFiles::Read(rules_file_path, rules_text);
+        folder_rules_hash = 0;
+        std::unique_ptr<IgnoreRules> folder_rules;
+        if (rules_file_read)
+        {
+            folder_rules_hash = IgnoreRuleFiles::Hash(rules_file_path, rules_text);
+            std::string base_path = GetIgnoreBasePath(base_ignore_rules, root_folder_path_length, folder);
+            folder_rules.reset(new IgnoreRules(*folder.ApplicableIgnoreRules));
+            bool rules_added = folder_rules->Add(rules_text, base_path, false);
+            if (rules_added)
+            {
+                folder_rules->Compile();
+                folder.ApplicableIgnoreRules = folder_rules.get();
+                folder.IgnoreRulesState = GetFolderIgnoreRulesState(*folder_rules, base_path);
+            }
+            else
+            {
+                folder_rules.reset();
+            }
+        }
+        if (!entries_listed)
+        {
+            return folder_rules;
+        }
+
+        // REMOVE THE IGNORED ENTRIES.
+        const IgnoreRules& rules = *folder.ApplicableIgnoreRules;
+        auto remove_ignored_entries = [&folder, &rules, &RULES_FILENAME](std::vector<uint32_t>& name_offsets, const bool is_directory)
+        {
+            auto ignored_entries_start = std::remove_if(
+                name_offsets.begin(),
+                name_offsets.end(),
+                [&folder, &rules, &RULES_FILENAME, is_directory](const uint32_t name_offset)
+                {
+                    const char* name = folder.GetEntryName(name_offset);
+                    bool is_rules_file = !is_directory && (RULES_FILENAME == name);
+                    uint32_t name_state = rules.Advance(folder.IgnoreRulesState, name, std::strlen(name));
+                    return !is_rules_file && rules.IsIgnored(name_state, is_directory);
+                });
+            name_offsets.erase(ignored_entries_start, name_offsets.end());
+        };
+        remove_ignored_entries(folder.FileNameOffsets, false);
+        remove_ignored_entries(folder.SubfolderNameOffsets, true);
+        return folder_rules;
+    }
+
+    /// Gives a subfolder the same ignore rules as its folder.  Only the subfolder's name needs to be matched,
+    /// since the rules are already in the state after the folder's path.
+    /// @param[in]  folder - The folder containing the subfolder.
+    /// @param[in]  subfolder_name - The null-terminated name of the subfolder.
+    /// @param[in,out]  subfolder - The subfolder, whose ignore rules are set if the folder has any.
+    static void InheritIgnoreRules(const ScannedFolder& folder, const char* subfolder_name, ScannedFolder& subfolder)
+    {
+        if (!folder.ApplicableIgnoreRules)
+        {
+            return;
+        }
+        const IgnoreRules& rules = *folder.ApplicableIgnoreRules;
+        subfolder.ApplicableIgnoreRules = &rules;
+        uint32_t subfolder_name_state = rules.Advance(folder.IgnoreRulesState, subfolder_name, std::strlen(subfolder_name));
+        subfolder.IgnoreRulesState = rules.Advance(subfolder_name_state, "/", 1);
+    }
+
+private:
+    /// A queue of folders waiting to be scanned by a single thread.
+    struct TaskQueue
+    {
+        /// The mutex protecting the queue.
+        std::mutex Mutex;
+        /// The folders waiting to be scanned.  The owning thread takes folders from
+        /// the back, while other threads steal from the front.
+        std::deque<ScannedFolder*> Folders;
+    };
+
+    /// Constructor.
+    /// @param[in]  thread_count - The number of threads that will scan.
+    /// @param[in]  previous_tree - The tree from a previous scan, if any.
+    /// @param[in]  changed_folders - A flag for each folder in the previous tree indicating if it changed.
+    /// @param[out]  changes - The changes to record added or removed entries in, if any.
+    /// @param[in]  base_ignore_rules - The ignore rules that apply to the root folder from outside of it.
+    /// @param[in,out]  root_folder - The folder to scan.  Its ignore rules are set.
+    explicit FolderScanner(
+        const unsigned int thread_count,
+        const FolderTree* previous_tree,
+        const std::vector<uint8_t>* changed_folders,
+        FolderTreeChanges* changes,
+        const BaseIgnoreRules& base_ignore_rules,
+        ScannedFolder& root_folder) :
+        Queues(),
+        PendingFolderCount(0),
+        PreviousTree(previous_tree),
+        ChangedFolders(changed_folders),
+        ChangesMutex(),
+        Changes(changes),
+        BaseRules(&base_ignore_rules),
+        RootFolderPathLength(root_folder.RelativePath.size()),
+        IgnoreRulesMutex(),
+        FolderIgnoreRules(),
+        IgnoreRulesHash(base_ignore_rules.Hash),
+        LinkedFoldersMutex(),
+        LinkedFolders(),
+        FoldersByIdentity(),
+        AliasFolders()
+    {
+        for (unsigned int thread_index = 0; thread_index < thread_count; ++thread_index)
+        {
+            Queues.emplace_back(new TaskQueue());
+        }
+        ApplyBaseIgnoreRules(base_ignore_rules, root_folder);
+    }
+
+    /// Scans all queued folders (along with every subfolder found within them) using all threads.
+    /// The calling thread participates as the first worker.
+    void Run()
+    {
+        const unsigned int MAIN_THREAD_INDEX = 0;
+        std::vector<std::thread> worker_threads;
+        for (unsigned int thread_index = MAIN_THREAD_INDEX + 1; thread_index < Queues.size(); ++thread_index)
+        {
+            worker_threads.emplace_back(&FolderScanner::Work, this, thread_index);
+        }
+        Work(MAIN_THREAD_INDEX);
+        for (auto& worker_thread : worker_threads)
+        {
+            worker_thread.join();
+        }
+    }
+
+    /// Runs the scanning loop for a single thread until all folders have been scanned.
+    /// @param[in]  thread_index - The index of the thread (and its task queue).
+    void Work(const unsigned int thread_index)
+    {
+        for (;;)
+        {
+            // SCAN THE NEXT AVAILABLE FOLDER.
+            ScannedFolder* folder = TakeOwnTask(thread_index);
+            if (!folder)
+            {
+                folder = StealTask(thread_index);
+            }
+            if (folder)
+            {
+                ScanFolder(thread_index, *folder);
+                continue;
+            }
+
+            // STOP ONCE ALL FOLDERS HAVE BEEN SCANNED.
+            // If some other thread is still scanning a folder, it may queue more subfolders.
+            const unsigned int NO_PENDING_FOLDERS = 0;
+            bool all_folders_scanned = (NO_PENDING_FOLDERS == PendingFolderCount.load());
+            if (all_folders_scanned)
+            {
+                return;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    /// Takes the most recently queued task from a thread's own queue.
+    /// @param[in]  thread_index - The index of the thread.
+    /// @return The folder to scan, if one was available; null otherwise.
+    ScannedFolder* TakeOwnTask(const unsigned int thread_index)
+    {
+        TaskQueue& queue = *Queues[thread_index];
+        std::lock_guard<std::mutex> lock(queue.Mutex);
+        if (queue.Folders.empty())
+        {
+            return nullptr;
+        }
+
+        ScannedFolder* folder = queue.Folders.back();
+        queue.Folders.pop_back();
+        return folder;
+    }
+
+    /// Steals the oldest queued task from another thread's queue.
+    /// @param[in]  thread_index - The index of the thread doing the stealing.
+    /// @return The folder to scan, if one was available; null otherwise.
+    ScannedFolder* StealTask(const unsigned int thread_index)
+    {
+        // Starting with the next thread spreads out the stealing across all threads.
+        std::size_t thread_count = Queues.size();
+        for (std::size_t victim_offset = 1; victim_offset < thread_count; ++victim_offset)
+        {
+            TaskQueue& victim_queue = *Queues[(thread_index + victim_offset) % thread_count];
+            std::lock_guard<std::mutex> lock(victim_queue.Mutex);
+            if (!victim_queue.Folders.empty())
+            {
+                ScannedFolder* folder = victim_queue.Folders.front();
+                victim_queue.Folders.pop_front();
+                return folder;
+            }
+        }
+
+        return nullptr;
+    }
+
+    /// Scans a single folder, populating its files and subfolders and queuing tasks to scan the subfolders.
+    /// @param[in]  thread_index - The index of the thread doing the scanning.
+    /// @param[in,out]  folder - The folder to scan.
+    void ScanFolder(const unsigned int thread_index, ScannedFolder& folder)
+    {
+        // CHECK IF THE FOLDER'S ENTRIES CAN BE TAKEN FROM THE PREVIOUS SCAN.
+        // Aliases in the previous scan were copied rather than listed, so they're never checked for changes.
+        bool previously_scanned = PreviousTree && (ScannedFolder::NOT_PREVIOUSLY_SCANNED != folder.PreviousFolderIndex);
+        bool previous_entries_reusable = (
+            previously_scanned &&
+            !(*ChangedFolders)[folder.PreviousFolderIndex] &&
+            !PreviousTree->Folders[folder.PreviousFolderIndex].IsAlias);
+        if (previous_entries_reusable)
+        {
+            AddPreviousEntries(folder);
+        }
+        else
+        {
+            // LIST THE FOLDER'S ENTRIES.
+            // A folder that can't be listed is returned without any subfolders or files.  Folders that couldn't be read
+            // completely are reported, and have no modification time so that they're listed again on the next scan.
+            TraceSpan listing_span("list folder", &folder.RelativePath);
+            bool links_followed = (LinkPolicy::NEVER != BaseRules->LinkedFolders);
+            DirectoryListing::Visit(
+                folder.RelativePath,
+                [&folder, links_followed](const char* name, const bool is_directory, const bool is_link)
+                {
+                    bool is_linked_folder = (is_directory && is_link);
+                    if (!is_linked_folder)
+                    {
+                        folder.AddEntry(name, is_directory);
+                    }
+                    else if (links_followed)
+                    {
+                        folder.AddLinkedSubfolder(name, std::strlen(name));
+                    }
+                },
+                folder.ModificationTime,
+                folder.Identity);
+        }
+
+        // LEAVE OUT ANY IGNORED ENTRIES.
+        // Any rules from the folder's own rules file are kept until the scan is done, since its subfolders use them.
+        if (folder.ApplicableIgnoreRules)
+        {
+            uint64_t folder_rules_hash = 0;
+            std::unique_ptr<IgnoreRules> folder_rules = ApplyIgnoreRules(
+                *BaseRules,
+                RootFolderPathLength,
+                !previous_entries_reusable,
+                folder,
+                folder_rules_hash);
+            IgnoreRulesHash ^= folder_rules_hash;
+            if (folder_rules)
+            {
+                std::lock_guard<std::mutex> lock(IgnoreRulesMutex);
+                FolderIgnoreRules.push_back(std::move(folder_rules));
+            }
+        }
+
+        // CREATE ALL SUBFOLDERS BEFORE QUEUING ANY OF THEM.
+        // This ensures the list of subfolders never moves while other threads are filling them in.
+        // Subfolders start with the same ignore rules, so only their names need to be matched.
+        folder.Subfolders.reserve(folder.SubfolderNameOffsets.size());
+        for (uint32_t subfolder_name_offset : folder.SubfolderNameOffsets)
+        {
+            const char* subfolder_name = folder.GetEntryName(subfolder_name_offset);
+            std::string subfolder_path = folder.RelativePath + PATH_SEPARATOR + subfolder_name;
+            folder.Subfolders.emplace_back(subfolder_path);
+            ScannedFolder& subfolder = folder.Subfolders.back();
+            subfolder.Parent = &folder;
+            subfolder.IsLink = folder.IsLinkedSubfolder(subfolder_name_offset);
+            InheritIgnoreRules(folder, subfolder_name, subfolder);
+        }
+        if (previously_scanned)
+        {
+            MatchPreviousSubfolders(previous_entries_reusable, folder);
+        }
+
+        // RECORD ANY ENTRIES ADDED OR REMOVED SINCE THE PREVIOUS SCAN.
+        // Folders whose entries were taken from the previous scan can't have any.
+        bool changes_needed = (Changes && !previous_entries_reusable);
+        if (changes_needed)
+        {
+            RecordChanges(previously_scanned, folder);
+        }
+
+        // QUEUE THE SUBFOLDERS TO BE SCANNED.
+        // They're queued in reverse so that this thread scans them in order.
+        // Links are set aside to be resolved once everything else has been scanned.
+        auto is_link = [](const ScannedFolder& subfolder) { return subfolder.IsLink; };
+        std::size_t linked_subfolder_count = std::count_if(folder.Subfolders.cbegin(), folder.Subfolders.cend(), is_link);
+        PendingFolderCount += static_cast<unsigned int>(folder.Subfolders.size() - linked_subfolder_count);
+        {
+            TaskQueue& queue = *Queues[thread_index];
+            std::lock_guard<std::mutex> lock(queue.Mutex);
+            for (auto subfolder = folder.Subfolders.rbegin(); subfolder != folder.Subfolders.rend(); ++subfolder)
+            {
+                if (!subfolder->IsLink)
+                {
+                    queue.Folders.push_back(&*subfolder);
+                }
+            }
+        }
+        if (linked_subfolder_count > 0)
+        {
+            std::lock_guard<std::mutex> lock(LinkedFoldersMutex);
+            for (auto& subfolder : folder.Subfolders)
+            {
+                if (subfolder.IsLink)
+                {
+                    LinkedFolders.push_back(&subfolder);
+                }
+            }
+        }
+
+        // This folder is only finished once its subfolders have been counted as pending,
+        // so the pending count can't reach zero while work remains.
+        --PendingFolderCount;
+    }
+
+    /// Adds the identities of a scanned folder and all folders within it, so that links to any of them can be found.
+    /// Folders are added in pre-order, and the first folder added with an identity is kept.
+    /// @param[in]  folder - The scanned folder.
+    void AddFolderIdentities(const ScannedFolder& folder)
+    {
+        if (folder.Identity.IsKnown())
+        {
+            FoldersByIdentity.emplace(folder.Identity, &folder);
+        }
+        for (const auto& subfolder : folder.Subfolders)
+        {
+            AddFolderIdentities(subfolder);
+        }
+    }
+
+    /// Resolves the links set aside while scanning, in order of their paths, and queues the folders they lead to
+    /// that haven't been reached yet to be scanned.  Links leading back to a folder containing them are left out.
+    /// Links to folders that have already been reached become aliases of them, unless each folder is only included once,
+    /// in which case they're left out.
+    /// @return The linked folders queued to be scanned.
+    std::vector<ScannedFolder*> QueueLinkedFolders()
+    {
+        // SORT THE LINKS BY PATH.
+        std::vector<ScannedFolder*> linked_folders;
+        linked_folders.swap(LinkedFolders);
+        std::sort(
+            linked_folders.begin(),
+            linked_folders.end(),
+            [](const ScannedFolder* left, const ScannedFolder* right) { return left->RelativePath < right->RelativePath; });
+
+        std::vector<ScannedFolder*> queued_folders;
+        for (ScannedFolder* linked_folder : linked_folders)
+        {
+            // LEAVE OUT LINKS THAT CAN'T BE FOLLOWED OR LEAD BACK TO A FOLDER CONTAINING THEM.
+            bool identity_retrieved = DirectoryListing::GetIdentity(linked_folder->RelativePath, linked_folder->Identity);
+            bool leads_to_containing_folder = false;
+            for (const ScannedFolder* ancestor = linked_folder->Parent; identity_retrieved && ancestor; ancestor = ancestor->Parent)
+            {
+                leads_to_containing_folder = leads_to_containing_folder || (ancestor->Identity == linked_folder->Identity);
+            }
+            if (!identity_retrieved || leads_to_containing_folder)
+            {
+                linked_folder->LeftOut = true;
+                continue;
+            }
+
+            // HANDLE LINKS TO FOLDERS THAT HAVE ALREADY BEEN REACHED.
+            auto reached_folder = FoldersByIdentity.find(linked_folder->Identity);
+            bool folder_already_reached = (FoldersByIdentity.cend() != reached_folder);
+            if (folder_already_reached)
+            {
+                bool folders_included_once = (LinkPolicy::ONCE == BaseRules->LinkedFolders);
+                if (folders_included_once)
+                {
+                    linked_folder->LeftOut = true;
+                }
+                else
+                {
+                    linked_folder->AliasedFolder = reached_folder->second;
+                    AliasFolders.push_back(linked_folder);
+                }
+                continue;
+            }
+
+            // QUEUE THE LINKED FOLDER TO BE SCANNED.
+            FoldersByIdentity.emplace(linked_folder->Identity, linked_folder);
+            queued_folders.push_back(linked_folder);
+        }
+
+        // QUEUE THE LINKED FOLDERS ON THE FIRST THREAD.
+        // They're queued in reverse so that they're scanned in order, with other threads stealing from the end.
+        const unsigned int MAIN_THREAD_INDEX = 0;
+        PendingFolderCount = static_cast<unsigned int>(queued_folders.size());
+        Queues[MAIN_THREAD_INDEX]->Folders.assign(queued_folders.rbegin(), queued_folders.rend());
+        return queued_folders;
+    }
+
+    /// Copies the entries of every alias from the folder it's an alias of, once every folder has been scanned.
+    void CopyAliasedFolders()
+    {
+        std::vector<FolderIdentity> ancestor_identities;
+        for (ScannedFolder* alias_folder : AliasFolders)
+        {
+            // GET THE IDENTITIES OF THE FOLDERS CONTAINING THE ALIAS.
+            // Copying stops wherever it would lead back to one of them.
+            ancestor_identities.clear();
+            for (const ScannedFolder* ancestor = alias_folder->Parent; ancestor; ancestor = ancestor->Parent)
+            {
+                ancestor_identities.push_back(ancestor->Identity);
+            }
+
+            CopyFolder(*alias_folder->AliasedFolder, ancestor_identities, *alias_folder);
+        }
+    }
+
+    /// Copies the entries of a folder into an alias of it, along with copies of all folders within it.
+    /// @param[in]  source_folder - The folder to copy, which must have been listed rather than copied itself.
+    /// @param[in,out]  ancestor_identities - The identities of the folders containing the alias.  Subfolders leading
+    ///     back to any of them are left out.  The identities are the same once copying is done.
+    /// @param[in,out]  alias_folder - The alias to copy the entries into.
+    static void CopyFolder(const ScannedFolder& source_folder, std::vector<FolderIdentity>& ancestor_identities, ScannedFolder& alias_folder)
+    {
+        // COPY THE FOLDER'S ENTRIES.
+        alias_folder.ModificationTime = source_folder.ModificationTime;
+        alias_folder.Identity = source_folder.Identity;
+        alias_folder.IsAlias = true;
+        alias_folder.EntryNames = source_folder.EntryNames;
+        alias_folder.FileNameOffsets = source_folder.FileNameOffsets;
+        alias_folder.SubfolderNameOffsets = source_folder.SubfolderNameOffsets;
+        alias_folder.LinkedSubfolderNameOffsets = source_folder.LinkedSubfolderNameOffsets;
+
+        // COPY THE FOLDER'S SUBFOLDERS.
+        // Subfolders that are aliases themselves are copied from the folders they're aliases of.
+        ancestor_identities.push_back(source_folder.Identity);
+        alias_folder.Subfolders.reserve(source_folder.Subfolders.size());
+        for (std::size_t subfolder_index = 0; subfolder_index < source_folder.Subfolders.size(); ++subfolder_index)
+        {
+            const ScannedFolder& source_subfolder = source_folder.Subfolders[subfolder_index];
+            const char* subfolder_name = source_folder.GetEntryName(source_folder.SubfolderNameOffsets[subfolder_index]);
+            alias_folder.Subfolders.emplace_back(alias_folder.RelativePath + PATH_SEPARATOR + subfolder_name);
+            ScannedFolder& alias_subfolder = alias_folder.Subfolders.back();
+            alias_subfolder.Parent = &alias_folder;
+            alias_subfolder.IsLink = source_subfolder.IsLink;
+
+            const ScannedFolder& listed_subfolder = source_subfolder.AliasedFolder ? *source_subfolder.AliasedFolder : source_subfolder;
+            bool leads_to_containing_folder = listed_subfolder.Identity.IsKnown() && (ancestor_identities.cend() != std::find(
+                ancestor_identities.cbegin(),
+                ancestor_identities.cend(),
+                listed_subfolder.Identity));
+            if (source_subfolder.LeftOut || leads_to_containing_folder)
+            {
+                alias_subfolder.LeftOut = true;
+                continue;
+            }
+            CopyFolder(listed_subfolder, ancestor_identities, alias_subfolder);
+        }
+        ancestor_identities.pop_back();
+    }
+
+    /// Gets the path of a folder from the base folder of the ignore rules.
+    /// @param[in]  base_ignore_rules - The ignore rules that apply to the scanned root folder from outside of it.
+    /// @param[in]  root_folder_path_length - The length of the scanned root folder's path.
+    /// @param[in]  folder - The folder.
+    /// @return The path of the folder from the base folder, with '/' between folder names.
+    static std::string GetIgnoreBasePath(const BaseIgnoreRules& base_ignore_rules, const std::size_t root_folder_path_length, const ScannedFolder& folder)
+    {
+        std::string base_path = base_ignore_rules.RootFolderBasePath;
+        bool folder_within_root = (folder.RelativePath.size() > root_folder_path_length);
+        if (folder_within_root)
+        {
+            std::string path_within_root = folder.RelativePath.substr(root_folder_path_length + PATH_SEPARATOR.size());
+            base_path += (base_path.empty() ? "" : "/") + DirectoryListing::ToIncludePath(path_within_root);
+        }
+        return base_path;
+    }
+
+    /// Gets the state of ignore rules after matching a folder's path.
+    /// @param[in]  rules - The ignore rules.
+    /// @param[in]  base_path - The path of the folder from the base folder of the rules.
+    /// @return The state after the folder's path, including a trailing separator unless it's the base folder.
+    static uint32_t GetFolderIgnoreRulesState(const IgnoreRules& rules, const std::string& base_path)
+    {
+        uint32_t state = rules.GetStartState();
+        if (!base_path.empty())
+        {
+            state = rules.Advance(state, base_path.c_str(), base_path.size());
+            state = rules.Advance(state, "/", 1);
+        }
+        return state;
+    }
+
+    /// Adds the entries of a folder from the previous scan, since they haven't changed.
+    /// @param[in,out]  folder - The folder to add entries to.  Its previous folder index must be set.
+    void AddPreviousEntries(ScannedFolder& folder) const
+    {
+        const FolderTree::FolderRecord& previous_folder = PreviousTree->Folders[folder.PreviousFolderIndex];
+        folder.ModificationTime = previous_folder.ModificationTime;
+        folder.Identity = previous_folder.Identity;
+        for (uint32_t file_index = previous_folder.FirstFileIndex; file_index < previous_folder.FirstFileIndex + previous_folder.FileCount; ++file_index)
+        {
+            const StringReference& file_name = PreviousTree->Files[file_index].Name;
+            folder.AddEntry(PreviousTree->Names.GetCharacters(file_name), file_name.Length, false);
+        }
+        for (uint32_t subfolder_index = previous_folder.FirstSubfolderIndex;
+            FolderTree::NO_INDEX != subfolder_index;
+            subfolder_index = PreviousTree->Folders[subfolder_index].NextSiblingIndex)
+        {
+            const FolderTree::FolderRecord& previous_subfolder = PreviousTree->Folders[subfolder_index];
+            const char* subfolder_name = PreviousTree->Names.GetCharacters(previous_subfolder.Name);
+            if (previous_subfolder.IsLink)
+            {
+                folder.AddLinkedSubfolder(subfolder_name, previous_subfolder.Name.Length);
+            }
+            else
+            {
+                folder.AddEntry(subfolder_name, previous_subfolder.Name.Length, true);
+            }
+        }
+    }
+
+    /// Matches the subfolders of a folder with the same subfolders from the previous scan,
+    /// so that unchanged subfolders can take their entries from the previous scan.
+    /// @param[in]  entries_from_previous_scan - True if the folder's entries were taken from the previous scan,
+    ///     in which case its subfolders are in the same order as in the previous scan.
+    /// @param[in,out]  folder - The folder whose subfolders to match.  Its previous folder index must be set.
+    void MatchPreviousSubfolders(const bool entries_from_previous_scan, ScannedFolder& folder) const
+    {
+        // MATCH SUBFOLDERS IN ORDER IF THE ENTRIES CAME FROM THE PREVIOUS SCAN.
+        const FolderTree::FolderRecord& previous_folder = PreviousTree->Folders[folder.PreviousFolderIndex];
+        if (entries_from_previous_scan)
+        {
+            uint32_t previous_subfolder_index = previous_folder.FirstSubfolderIndex;
+            for (auto& subfolder : folder.Subfolders)
+            {
+                subfolder.PreviousFolderIndex = previous_subfolder_index;
+                previous_subfolder_index = PreviousTree->Folders[previous_subfolder_index].NextSiblingIndex;
+            }
+            return;
+        }
+
+        // GET THE PREVIOUS SUBFOLDERS SORTED BY NAME.
+        // This allows each current subfolder to be found with a binary search.
+        std::vector<std::pair<std::string, uint32_t>> previous_subfolders;
+        for (uint32_t previous_subfolder_index = previous_folder.FirstSubfolderIndex;
+            FolderTree::NO_INDEX != previous_subfolder_index;
+            previous_subfolder_index = PreviousTree->Folders[previous_subfolder_index].NextSiblingIndex)
+        {
+            const StringReference& name = PreviousTree->Folders[previous_subfolder_index].Name;
+            previous_subfolders.emplace_back(std::string(PreviousTree->Names.GetCharacters(name), name.Length), previous_subfolder_index);
+        }
+        std::sort(previous_subfolders.begin(), previous_subfolders.end());
+
+        // MATCH SUBFOLDERS BY NAME.
+        for (std::size_t subfolder_index = 0; subfolder_index < folder.Subfolders.size(); ++subfolder_index)
+        {
+            std::pair<std::string, uint32_t> subfolder(folder.GetEntryName(folder.SubfolderNameOffsets[subfolder_index]), 0);
+            auto previous_subfolder = std::lower_bound(previous_subfolders.cbegin(), previous_subfolders.cend(), subfolder);
+            bool previous_subfolder_found = (previous_subfolders.cend() != previous_subfolder && previous_subfolder->first == subfolder.first);
+            if (previous_subfolder_found)
+            {
+                folder.Subfolders[subfolder_index].PreviousFolderIndex = previous_subfolder->second;
+            }
+        }
+    }
+
+    /// Records the entries of a listed folder that were added or removed since the previous scan.
+    /// Added subfolders aren't recorded here since they're recorded when they're scanned themselves.
+    /// @param[in]  previously_scanned - True if the folder existed in the previous scan; false if it's new.
+    /// @param[in]  folder - The listed folder.  Its subfolders must already be matched to the previous scan.
+    void RecordChanges(const bool previously_scanned, const ScannedFolder& folder)
+    {
+        // GET THE NAMES OF THE FOLDER'S CURRENT AND PREVIOUS FILES.
+        // New folders have no previous files, so all of their files were added.
+        std::vector<std::string> file_names;
+        file_names.reserve(folder.FileNameOffsets.size());
+        for (uint32_t file_name_offset : folder.FileNameOffsets)
+        {
+            file_names.emplace_back(folder.GetEntryName(file_name_offset));
+        }
+        std::vector<std::string> previous_file_names;
+        FolderTreeChanges folder_changes;
+        if (previously_scanned)
+        {
+            const FolderTree::FolderRecord& previous_folder = PreviousTree->Folders[folder.PreviousFolderIndex];
+            for (uint32_t file_index = previous_folder.FirstFileIndex; file_index < previous_folder.FirstFileIndex + previous_folder.FileCount; ++file_index)
+            {
+                const StringReference& file_name = PreviousTree->Files[file_index].Name;
+                previous_file_names.emplace_back(PreviousTree->Names.GetCharacters(file_name), file_name.Length);
+            }
+        }
+        else
+        {
+            folder_changes.AddedFolderPaths.push_back(folder.RelativePath);
+        }
+
+        // RECORD THE ADDED AND REMOVED FILES.
+        std::sort(file_names.begin(), file_names.end());
+        std::sort(previous_file_names.begin(), previous_file_names.end());
+        std::vector<std::string> added_file_names;
+        std::set_difference(
+            file_names.cbegin(), file_names.cend(),
+            previous_file_names.cbegin(), previous_file_names.cend(),
+            std::back_inserter(added_file_names));
+        for (const auto& added_file_name : added_file_names)
+        {
+            folder_changes.AddedFilePaths.push_back(folder.RelativePath + PATH_SEPARATOR + added_file_name);
+        }
+        std::vector<std::string> removed_file_names;
+        std::set_difference(
+            previous_file_names.cbegin(), previous_file_names.cend(),
+            file_names.cbegin(), file_names.cend(),
+            std::back_inserter(removed_file_names));
+        for (const auto& removed_file_name : removed_file_names)
+        {
+            folder_changes.RemovedFilePaths.push_back(folder.RelativePath + PATH_SEPARATOR + removed_file_name);
+        }
+
+        // RECORD THE REMOVED SUBFOLDERS ALONG WITH EVERYTHING IN THEM.
+        // Any previous subfolder that wasn't matched to a current subfolder was removed.
+        if (previously_scanned)
+        {
+            std::vector<uint32_t> matched_subfolder_indices;
+            for (const auto& subfolder : folder.Subfolders)
+            {
+                matched_subfolder_indices.push_back(subfolder.PreviousFolderIndex);
+            }
+            std::sort(matched_subfolder_indices.begin(), matched_subfolder_indices.end());
+
+            const FolderTree::FolderRecord& previous_folder = PreviousTree->Folders[folder.PreviousFolderIndex];
+            for (uint32_t subfolder_index = previous_folder.FirstSubfolderIndex;
+                FolderTree::NO_INDEX != subfolder_index;
+                subfolder_index = PreviousTree->Folders[subfolder_index].NextSiblingIndex)
+            {
+                bool subfolder_removed = !std::binary_search(matched_subfolder_indices.cbegin(), matched_subfolder_indices.cend(), subfolder_index);
+                if (!subfolder_removed)
+                {
+                    continue;
+                }
+
+                // Descendants of the removed subfolder immediately follow it in the previous tree.
+                const FolderTree::FolderRecord& removed_subfolder = PreviousTree->Folders[subfolder_index];
+                for (uint32_t removed_folder_index = subfolder_index; removed_folder_index < removed_subfolder.SubtreeEndIndex; ++removed_folder_index)
+                {
+                    std::string removed_folder_path;
+                    PreviousTree->AppendFolderPath(removed_folder_index, removed_folder_path);
+                    folder_changes.RemovedFolderPaths.push_back(removed_folder_path);
+
+                    const FolderTree::FolderRecord& removed_folder = PreviousTree->Folders[removed_folder_index];
+                    for (uint32_t file_index = removed_folder.FirstFileIndex; file_index < removed_folder.FirstFileIndex + removed_folder.FileCount; ++file_index)
+                    {
+                        std::string removed_file_path;
+                        PreviousTree->AppendFilePath(file_index, removed_file_path);
+                        folder_changes.RemovedFilePaths.push_back(removed_file_path);
+                    }
+                }
+            }
+        }
+
+        // ADD THE FOLDER'S CHANGES TO ALL CHANGES.
+        // Changes are typically rare, so contention for the lock isn't a concern.
+        std::lock_guard<std::mutex> lock(ChangesMutex);
+        auto append = [](std::vector<std::string>& source, std::vector<std::string>& destination)
+        {
+            std::move(source.begin(), source.end(), std::back_inserter(destination));
+        };
+        append(folder_changes.AddedFolderPaths, Changes->AddedFolderPaths);
+        append(folder_changes.RemovedFolderPaths, Changes->RemovedFolderPaths);
+        append(folder_changes.AddedFilePaths, Changes->AddedFilePaths);
+        append(folder_changes.RemovedFilePaths, Changes->RemovedFilePaths);
+    }
+
+    // MEMBER VARIABLES.
+    /// The task queue for each thread.
+    std::vector<std::unique_ptr<TaskQueue>> Queues;
+    /// The number of folders that have been queued but not yet completely scanned.
+    std::atomic<unsigned int> PendingFolderCount;
+    /// The tree from a previous scan, if any.
+    const FolderTree* PreviousTree;
+    /// A flag for each folder in the previous tree indicating if it changed.
+    const std::vector<uint8_t>* ChangedFolders;
+    /// The mutex protecting the recorded changes.
+    std::mutex ChangesMutex;
+    /// The changes to record added or removed entries in, if any.
+    FolderTreeChanges* Changes;
+    /// The ignore rules that apply to the root folder from outside of it.
+    const BaseIgnoreRules* BaseRules;
+    /// The length of the root folder's relative path.
+    std::size_t RootFolderPathLength;
+    /// The mutex protecting the ignore rules for folders with their own rules files.
+    std::mutex IgnoreRulesMutex;
+    /// The ignore rules for folders with their own rules files, which scanned folders refer to.
+    std::vector<std::unique_ptr<const IgnoreRules>> FolderIgnoreRules;
+    /// The combined hash of all ignore rules applied.
+    std::atomic<uint64_t> IgnoreRulesHash;
+    /// The mutex protecting the links set aside while scanning.
+    std::mutex LinkedFoldersMutex;
+    /// The links set aside while scanning, waiting to be resolved.
+    std::vector<ScannedFolder*> LinkedFolders;
+    /// The first folder reached with each identity, once links are being resolved.
+    std::unordered_map<FolderIdentity, const ScannedFolder*, FolderIdentityHash> FoldersByIdentity;
+    /// The links that became aliases of folders that were already reached, waiting to be copied.
+    std::vector<ScannedFolder*> AliasFolders;
+};
+
+FolderTree FolderTree::Get(const std::string& relative_path, const IgnoreSettings& ignore_settings, const unsigned int thread_count)
+{
+    const bool IS_PHASE = true;
+    TraceSpan scan_span("scan", &relative_path, IS_PHASE);
+    BaseIgnoreRules base_ignore_rules = IgnoreRuleFiles::LoadBaseRules(relative_path, ignore_settings);
+    ScannedFolder root_folder(relative_path);
+    uint64_t ignore_rules_hash = FolderScanner::Scan(thread_count, nullptr, nullptr, nullptr, base_ignore_rules, root_folder);
+
+    FolderTree tree;
+    tree.AddScannedFolders(root_folder);
+    tree.IgnoreRuleSettings = ignore_settings;
+    tree.IgnoreRulesHash = ignore_rules_hash;
+    return tree;
+}
+
+std::vector<uint8_t> FolderTree::FindChangedFolders(const unsigned int thread_count, FolderTree& tree)
+{
+    // CHECK EACH FOLDER'S MODIFICATION TIME IN PARALLEL.
+    // Folders that no longer exist are considered changed.  Aliases are skipped since they're
+    // copied from the folders they're aliases of (which are checked themselves) whenever rescanned.
+    const bool IS_PHASE = true;
+    TraceSpan find_changed_folders_span("find changed folders", nullptr, IS_PHASE);
+    tree.BuildFolderPaths();
+    std::vector<uint8_t> changed_folders(tree.Folders.size(), 0);
+    ParallelTasks::ForEachBatch(
+        tree.Folders.size(),
+        FolderScanner::ResolveThreadCount(thread_count),
+        [&tree, &changed_folders](const std::size_t first_folder_index, const std::size_t end_folder_index)
+        {
+            std::string folder_path;
+            for (std::size_t folder_index = first_folder_index; folder_index < end_folder_index; ++folder_index)
+            {
+                if (tree.Folders[folder_index].IsAlias)
+                {
+                    continue;
+                }
+                folder_path.clear();
+                tree.AppendFolderPath(static_cast<uint32_t>(folder_index), folder_path);
+                uint64_t modification_time = 0;
+                bool modification_time_retrieved = DirectoryListing::GetModificationTime(folder_path, modification_time);
+                bool folder_changed = !modification_time_retrieved || (modification_time != tree.Folders[folder_index].ModificationTime);
+                changed_folders[folder_index] = folder_changed ? 1 : 0;
+            }
+        });
+    return changed_folders;
+}
+
+FolderTree FolderTree::Rescan(
+    const unsigned int thread_count,
+    const std::vector<uint8_t>& changed_folders,
+    FolderTree& previous_tree,
+    FolderTreeChanges* changes)
+{
+    // REUSE THE PREVIOUS TREE IF NOTHING CHANGED.
+    // Rules files can be edited without changing the folders they're in, so they're always read again.
+    const uint32_t ROOT_FOLDER_INDEX = 0;
+    std::string root_folder_path;
+    previous_tree.AppendFolderPath(ROOT_FOLDER_INDEX, root_folder_path);
+    BaseIgnoreRules base_ignore_rules = IgnoreRuleFiles::LoadBaseRules(root_folder_path, previous_tree.IgnoreRuleSettings);
+    bool any_folders_changed = (changed_folders.cend() != std::find(changed_folders.cbegin(), changed_folders.cend(), 1));
+    if (!any_folders_changed)
+    {
+        uint64_t ignore_rules_hash = base_ignore_rules.Hash;
+        bool rules_files_read = base_ignore_rules.GitIgnoreFilesRead;
+        std::string rules_file_path;
+        for (uint32_t file_index = 0; rules_files_read && file_index < previous_tree.Files.size(); ++file_index)
+        {
+            const StringReference& file_name = previous_tree.Files[file_index].Name;
+            bool is_rules_file = (
+                IgnoreRuleFiles::GITIGNORE_FILENAME.size() == file_name.Length &&
+                0 == IgnoreRuleFiles::GITIGNORE_FILENAME.compare(0, file_name.Length, previous_tree.Names.GetCharacters(file_name), file_name.Length));
+            if (is_rules_file)
+            {
+                std::string rules_text;
+                rules_file_path.clear();
+                previous_tree.AppendFilePath(file_index, rules_file_path);
+                bool rules_file_read = IgnoreRuleFiles::Read(rules_file_path, rules_text);
+                if (rules_file_read)
+                {
+                    ignore_rules_hash ^= IgnoreRuleFiles::Hash(rules_file_path, rules_text);
+                }
+            }
+        }
+        bool ignore_rules_changed = (ignore_rules_hash != previous_tree.IgnoreRulesHash);
+        if (!ignore_rules_changed)
+        {
+            // Files can be modified without their folders changing, so any file metadata is out of date.
+            previous_tree.FileSizesInBytes.clear();
+            previous_tree.FileModificationTimes.clear();
+            return std::move(previous_tree);
+        }
+    }
+
+    // RESCAN THE FOLDERS, STARTING FROM THE PREVIOUS ROOT FOLDER.
+    // If any ignore rules changed, the entries of unchanged folders are out of date too,
+    // since they were filtered by the old rules, so every folder is listed again.
+    const bool IS_PHASE = true;
+    TraceSpan scan_span("scan", &root_folder_path, IS_PHASE);
+    const std::vector<uint8_t> ALL_FOLDERS_CHANGED(previous_tree.Folders.size(), 1);
+    const std::vector<uint8_t>* folders_to_list = &changed_folders;
+    for (;;)
+    {
+        ScannedFolder root_folder(root_folder_path);
+        root_folder.PreviousFolderIndex = ROOT_FOLDER_INDEX;
+        FolderTreeChanges scan_changes;
+        uint64_t ignore_rules_hash = FolderScanner::Scan(
+            thread_count,
+            &previous_tree,
+            folders_to_list,
+            changes ? &scan_changes : nullptr,
+            base_ignore_rules,
+            root_folder);
+        bool ignore_rules_changed = (ignore_rules_hash != previous_tree.IgnoreRulesHash);
+        bool all_folders_listed = (&ALL_FOLDERS_CHANGED == folders_to_list);
+        if (ignore_rules_changed && !all_folders_listed)
+        {
+            folders_to_list = &ALL_FOLDERS_CHANGED;
+            continue;
+        }
+
+        // ADD THE CHANGES FROM THE SCAN.
+        if (changes)
+        {
+            auto append = [](std::vector<std::string>& source, std::vector<std::string>& destination)
+            {
+                std::move(source.begin(), source.end(), std::back_inserter(destination));
+            };
+            append(scan_changes.AddedFolderPaths, changes->AddedFolderPaths);
+            append(scan_changes.RemovedFolderPaths, changes->RemovedFolderPaths);
+            append(scan_changes.AddedFilePaths, changes->AddedFilePaths);
+            append(scan_changes.RemovedFilePaths, changes->RemovedFilePaths);
+        }
+
+        FolderTree tree;
+        tree.AddScannedFolders(root_folder);
+        tree.IgnoreRuleSettings = previous_tree.IgnoreRuleSettings;
+        tree.IgnoreRulesHash = ignore_rules_hash;
+        return tree;
+    }
+}
+
+/// Reads the sizes and modification times of many files at once.  Directory listings don't include them
+/// on every platform, and examining files one at a time would take about as long as scanning all over again.
+///
+/// On Linux, the files are examined with statx calls submitted through io_uring, so hundreds of calls are in
+/// flight at once from a single thread, and the kernel is only entered once for each batch of submissions and
+/// completions instead of once per file.  Where io_uring can't be used (on other platforms, on kernels too old to
+/// support statx through it, or where it's blocked), files are instead examined one call at a time on a pool of threads.
+class FileMetadataReader
+{
+public:
+    /// Reads the size and modification time of each file, using io_uring if possible.
+    /// @param[in]  thread_count - The number of threads to use if io_uring can't be used.
+    ///     Zero uses one thread per hardware core.
+    /// @param[in]  file_count - The number of files.
+    /// @param[in]  append_file_path - Appends the relative path of a file, given its index, to a string.
+    ///     It may be called from several threads at once.
+    /// @param[out]  sizes_in_bytes - The size of each file, by index.
+    /// @param[out]  modification_times - The modification time of each file, in the file system's native units, by index.
+    ///     Files that can't be examined get a size and modification time of 0.
+    template <typename AppendFilePathFunction>
+    static void Read(
+        const unsigned int thread_count,
+        const std::size_t file_count,
+        AppendFilePathFunction append_file_path,
+        std::vector<uint64_t>& sizes_in_bytes,
+        std::vector<uint64_t>& modification_times)
+    {
+        const bool IS_PHASE = true;
+        TraceSpan read_span("read file metadata", nullptr, IS_PHASE);
+        bool read_through_io_uring = ReadThroughIoUring(file_count, append_file_path, sizes_in_bytes, modification_times);
+        if (!read_through_io_uring)
+        {
+            ReadOnThreads(thread_count, file_count, append_file_path, sizes_in_bytes, modification_times);
+        }
+    }
+
+    /// Reads the size and modification time of each file through io_uring, if it can be used.
+    /// @param[in]  file_count - The number of files.
+    /// @param[in]  append_file_path - Appends the relative path of a file, given its index, to a string.
+    /// @param[out]  sizes_in_bytes - The size of each file, by index.
+    /// @param[out]  modification_times - The modification time of each file, in nanoseconds, by index.
+    ///     Files that can't be examined get a size and modification time of 0.
+    /// @return True if the files were read; false if io_uring can't be used, in which case the outputs are incomplete.
+    template <typename AppendFilePathFunction>
+    static bool ReadThroughIoUring(
+        const std::size_t file_count,
+        AppendFilePathFunction append_file_path,
+        std::vector<uint64_t>& sizes_in_bytes,
+        std::vector<uint64_t>& modification_times)
+    {
+#if defined(GENERATE_PROJECT_IO_URING)
+        // SET UP THE RING.
+        StatxRing ring;
+        bool ring_opened = ring.Open(MAX_CALLS_IN_FLIGHT);
+        if (!ring_opened)
+        {
+            return false;
+        }
+
+        // EXAMINE ALL FILES, KEEPING AS MANY CALLS IN FLIGHT AS POSSIBLE.
+        // Each call in flight has its own slot holding the path and status buffer that the kernel reads and writes,
+        // which must stay untouched until the call completes.  Calls are counted individually like any other
+        // file system calls, even though the kernel is entered far fewer times.
+        sizes_in_bytes.assign(file_count, 0);
+        modification_times.assign(file_count, 0);
+        std::unique_ptr<CallSlots> slots(new CallSlots());
+        std::vector<uint32_t> free_slot_indices;
+        for (uint32_t slot_index = MAX_CALLS_IN_FLIGHT; slot_index > 0; --slot_index)
+        {
+            free_slot_indices.push_back(slot_index - 1);
+        }
+        std::size_t next_file_index = 0;
+        std::size_t calls_in_flight = 0;
+        unsigned int consecutive_retry_count = 0;
+        while (next_file_index < file_count || calls_in_flight > 0)
+        {
+            // QUEUE A CALL FOR THE NEXT FILE IN EACH FREE SLOT.
+            uint64_t queued_call_count = 0;
+            while (!free_slot_indices.empty() && next_file_index < file_count)
+            {
+                uint32_t slot_index = free_slot_indices.back();
+                free_slot_indices.pop_back();
+                std::string& path = slots->Paths[slot_index];
+                path.clear();
+                append_file_path(next_file_index, path);
+                std::replace(path.begin(), path.end(), PATH_SEPARATOR[0], NATIVE_PATH_SEPARATOR);
+                slots->FileIndices[slot_index] = next_file_index;
+                ring.QueueStatx(path.c_str(), &slots->Statuses[slot_index], slot_index);
+                ++next_file_index;
+                ++calls_in_flight;
+                ++queued_call_count;
+            }
+            Instrumentation::CountFileSystemCalls(queued_call_count);
+
+            // SUBMIT THE QUEUED CALLS AND WAIT FOR SOME TO COMPLETE.
+            // A submission that needs to be retried is retried after taking any completions, a limited number of times in a row.
+            StatxRing::SubmitResult submit_result = ring.SubmitAndWait();
+            bool submission_retried = (StatxRing::SubmitResult::RETRY == submit_result);
+            consecutive_retry_count = submission_retried ? consecutive_retry_count + 1 : 0;
+            bool ring_failed = (StatxRing::SubmitResult::FAILED == submit_result) || (consecutive_retry_count > MAX_CONSECUTIVE_RETRY_COUNT);
+            if (ring_failed)
+            {
+                // Calls already submitted can't be abandoned, since the kernel may still write to their slots.
+                // If they don't complete in time, their slots are deliberately leaked rather than freed under the kernel.
+                std::size_t submitted_calls_in_flight = calls_in_flight - ring.GetQueuedCallCount();
+                bool calls_completed = WaitForSubmittedCalls(submitted_calls_in_flight, ring);
+                if (!calls_completed)
+                {
+                    CallSlots* abandoned_slots = slots.release();
+                    (void)abandoned_slots;
+                }
+                return false;
+            }
+
+            // RECORD THE RESULTS OF ALL COMPLETED CALLS.
+            uint64_t slot_index = 0;
+            int call_result = 0;
+            std::size_t completed_call_count = 0;
+            while (ring.TakeCompletion(slot_index, call_result))
+            {
+                const int CALL_SUCCEEDED = 0;
+                bool file_examined = (CALL_SUCCEEDED == call_result);
+                if (file_examined)
+                {
+                    const struct statx& status = slots->Statuses[slot_index];
+                    std::size_t file_index = slots->FileIndices[slot_index];
+                    const uint64_t NANOSECONDS_PER_SECOND = 1000000000;
+                    sizes_in_bytes[file_index] = status.stx_size;
+                    modification_times[file_index] = static_cast<uint64_t>(status.stx_mtime.tv_sec) * NANOSECONDS_PER_SECOND + status.stx_mtime.tv_nsec;
+                }
+                free_slot_indices.push_back(static_cast<uint32_t>(slot_index));
+                --calls_in_flight;
+                ++completed_call_count;
+            }
+
+            // BACK OFF BEFORE RETRYING IF NOTHING COMPLETED.
+            // Otherwise, a kernel that's out of resources would just be entered again immediately.
+            bool back_off = submission_retried && (0 == completed_call_count);
+            if (back_off)
+            {
+                std::this_thread::sleep_for(RETRY_BACK_OFF_TIME);
+            }
+        }
+        return true;
+#else
+        (void)file_count;
+        (void)append_file_path;
+        (void)sizes_in_bytes;
+        (void)modification_times;
+        return false;
+#endif
+    }
+
+    /// Reads the size and modification time of each file one call at a time, spread across threads.
+    /// @param[in]  thread_count - The number of threads to use.  Zero uses one thread per hardware core.
+    /// @param[in]  file_count - The number of files.
+    /// @param[in]  append_file_path - Appends the relative path of a file, given its index, to a string.
+    ///     It's called from several threads at once.
+    /// @param[out]  sizes_in_bytes - The size of each file, by index.
+    /// @param[out]  modification_times - The modification time of each file, in the file system's native units, by index.
+    ///     Files that can't be examined get a size and modification time of 0.
+    template <typename AppendFilePathFunction>
+    static void ReadOnThreads(
+        const unsigned int thread_count,
+        const std::size_t file_count,
+        AppendFilePathFunction append_file_path,
+        std::vector<uint64_t>& sizes_in_bytes,
+        std::vector<uint64_t>& modification_times)
+    {
+        // EXAMINE THE FILES IN BATCHES IN PARALLEL.
+        sizes_in_bytes.assign(file_count, 0);
+        modification_times.assign(file_count, 0);
+        ParallelTasks::ForEachBatch(
+            file_count,
+            FolderScanner::ResolveThreadCount(thread_count),
+            [&append_file_path, &sizes_in_bytes, &modification_times](const std::size_t first_file_index, const std::size_t end_file_index)
+            {
+                std::string file_path;
+                for (std::size_t file_index = first_file_index; file_index < end_file_index; ++file_index)
+                {
+                    file_path.clear();
+                    append_file_path(file_index, file_path);
+                    DirectoryListing::GetFileMetadata(file_path, sizes_in_bytes[file_index], modification_times[file_index]);
+                }
+            });
+    }
+
+private:
+#if defined(GENERATE_PROJECT_IO_URING)
+    /// The buffers for each call in flight, by slot, which the kernel reads and writes until the call completes.
+    struct CallSlots
+    {
+        /// The native path of the file being examined in each slot.
+        std::vector<std::string> Paths = std::vector<std::string>(MAX_CALLS_IN_FLIGHT);
+        /// The status of the file being examined in each slot, once its call completes.
+        std::vector<struct statx> Statuses = std::vector<struct statx>(MAX_CALLS_IN_FLIGHT);
+        /// The index of the file being examined in each slot.
+        std::vector<std::size_t> FileIndices = std::vector<std::size_t>(MAX_CALLS_IN_FLIGHT, 0);
+    };
+
+    /// A ring shared with the kernel for submitting statx calls and receiving their results (see io_uring(7)).
+    /// The ring is used directly through system calls, since liburing isn't always installed.
+    class StatxRing
+    {
+    public:
+        /// The result of submitting queued calls.
+        enum class SubmitResult
+        {
+            /// The calls were submitted.
+            SUBMITTED,
+            /// The calls weren't submitted because the wait was interrupted or the kernel was temporarily
+            /// out of resources, so submitting them should be retried.  Calls already in flight still complete.
+            RETRY,
+            /// The ring failed.
+            FAILED
+        };
+
+        /// Constructor.  No ring will be set up.
+        StatxRing() = default;
+
+        /// Destructor.  Closes any ring.
+        ~StatxRing()
+        {
+            Close();
+        }
+
+        StatxRing(const StatxRing&) = delete;
+        StatxRing& operator=(const StatxRing&) = delete;
+
+        /// Sets up the ring, if io_uring is available and supports statx.
+        /// @param[in]  entry_count - The maximum number of calls in flight.
+        /// @return True if the ring was set up; false otherwise.
+        bool Open(const uint32_t entry_count)
+        {
+            // CREATE THE RING.
+            io_uring_params parameters;
+            std::memset(&parameters, 0, sizeof(parameters));
+            RingFile = static_cast<int>(syscall(__NR_io_uring_setup, entry_count, &parameters));
+            bool ring_created = (RingFile >= 0);
+            if (!ring_created)
+            {
+                return false;
+            }
+
+            // MAKE SURE STATX CAN BE SUBMITTED.
+            // Probing was added in the same kernel version as statx, so probing fails on kernels too old for it.
+            const std::size_t PROBED_OPERATION_COUNT = IORING_OP_STATX + 1;
+            std::vector<uint8_t> probe_memory(sizeof(io_uring_probe) + PROBED_OPERATION_COUNT * sizeof(io_uring_probe_op), 0);
+            io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(probe_memory.data());
+            bool probed = (0 == syscall(__NR_io_uring_register, RingFile, IORING_REGISTER_PROBE, probe, PROBED_OPERATION_COUNT));
+            bool statx_supported = (
+                probed &&
+                probe->last_op >= IORING_OP_STATX &&
+                0 != (probe->ops[IORING_OP_STATX].flags & IO_URING_OP_SUPPORTED));
+            if (!statx_supported)
+            {
+                Close();
+                return false;
+            }
+
+            // MAP THE RING INTO MEMORY.
+            // Newer kernels map the submission and completion queues together.
+            SubmissionQueueSize = parameters.sq_off.array + parameters.sq_entries * sizeof(uint32_t);
+            CompletionQueueSize = parameters.cq_off.cqes + parameters.cq_entries * sizeof(io_uring_cqe);
+            bool queues_mapped_together = (0 != (parameters.features & IORING_FEAT_SINGLE_MMAP));
+            if (queues_mapped_together)
+            {
+                SubmissionQueueSize = std::max(SubmissionQueueSize, CompletionQueueSize);
+                CompletionQueueSize = SubmissionQueueSize;
+            }
+            SubmissionQueue = Map(SubmissionQueueSize, IORING_OFF_SQ_RING);
+            CompletionQueue = queues_mapped_together ? SubmissionQueue : Map(CompletionQueueSize, IORING_OFF_CQ_RING);
+            SubmissionEntriesSize = parameters.sq_entries * sizeof(io_uring_sqe);
+            SubmissionEntries = reinterpret_cast<io_uring_sqe*>(Map(SubmissionEntriesSize, IORING_OFF_SQES));
+            bool ring_mapped = (SubmissionQueue && CompletionQueue && SubmissionEntries);
+            if (!ring_mapped)
+            {
+                Close();
+                return false;
+            }
+#if defined(IORING_FEAT_EXT_ARG)
+            TimedWaitsSupported = (0 != (parameters.features & IORING_FEAT_EXT_ARG));
+#endif
+            SubmissionHead = reinterpret_cast<const uint32_t*>(SubmissionQueue + parameters.sq_off.head);
+            SubmissionTail = reinterpret_cast<uint32_t*>(SubmissionQueue + parameters.sq_off.tail);
+            SubmissionMask = *reinterpret_cast<const uint32_t*>(SubmissionQueue + parameters.sq_off.ring_mask);
+            SubmissionArray = reinterpret_cast<uint32_t*>(SubmissionQueue + parameters.sq_off.array);
+            CompletionHead = reinterpret_cast<uint32_t*>(CompletionQueue + parameters.cq_off.head);
+            CompletionTail = reinterpret_cast<const uint32_t*>(CompletionQueue + parameters.cq_off.tail);
+            CompletionMask = *reinterpret_cast<const uint32_t*>(CompletionQueue + parameters.cq_off.ring_mask);
+            Completions = reinterpret_cast<const io_uring_cqe*>(CompletionQueue + parameters.cq_off.cqes);
+            return true;
+        }
+
+        /// Closes the ring.  Any calls still in flight are cancelled.
+        void Close()
+        {
+            if (SubmissionEntries)
+            {
+                munmap(SubmissionEntries, SubmissionEntriesSize);
+            }
+            bool completion_queue_mapped_separately = (CompletionQueue && CompletionQueue != SubmissionQueue);
+            if (completion_queue_mapped_separately)
+            {
+                munmap(CompletionQueue, CompletionQueueSize);
+            }
+            if (SubmissionQueue)
+            {
+                munmap(SubmissionQueue, SubmissionQueueSize);
+            }
+            bool ring_created = (RingFile >= 0);
+            if (ring_created)
+            {
+                close(RingFile);
+            }
+            SubmissionEntries = nullptr;
+            CompletionQueue = nullptr;
+            SubmissionQueue = nullptr;
+            RingFile = -1;
+        }
+
+        /// Queues a statx call for a file, following any symbolic links to it like stat does.
+        /// The call isn't submitted until SubmitAndWait is called.
+        /// @param[in]  path - The native path to the file, which must stay valid until the call completes.
+        /// @param[out]  status - The status of the file once the call completes.
+        /// @param[in]  tag - The tag identifying the call when it completes.
+        void QueueStatx(const char* path, struct statx* status, const uint64_t tag)
+        {
+            // FILL IN THE NEXT SUBMISSION ENTRY.
+            // Only this thread writes the submission tail, so it doesn't need to be read atomically.
+            uint32_t tail = *SubmissionTail;
+            uint32_t entry_index = tail & SubmissionMask;
+            io_uring_sqe& entry = SubmissionEntries[entry_index];
+            std::memset(&entry, 0, sizeof(entry));
+            entry.opcode = IORING_OP_STATX;
+            entry.fd = AT_FDCWD;
+            entry.addr = reinterpret_cast<uint64_t>(path);
+            entry.len = STATX_SIZE | STATX_MTIME;
+            entry.off = reinterpret_cast<uint64_t>(status);
+            entry.user_data = tag;
+            SubmissionArray[entry_index] = entry_index;
+
+            // PUBLISH THE ENTRY TO THE KERNEL.
+            __atomic_store_n(SubmissionTail, tail + 1, __ATOMIC_RELEASE);
+        }
+
+        /// Gets the number of queued calls that the kernel hasn't taken from the ring yet.
+        /// The kernel may take some calls even when submitting them fails, so this is read from the ring itself.
+        /// @return The number of queued calls.
+        uint32_t GetQueuedCallCount() const
+        {
+            uint32_t head = __atomic_load_n(SubmissionHead, __ATOMIC_ACQUIRE);
+            return *SubmissionTail - head;
+        }
+
+        /// Submits all queued calls and waits for at least one call to complete.
+        /// @return Whether the calls were submitted, need to be retried, or the ring failed.
+        SubmitResult SubmitAndWait()
+        {
+            const uint32_t MIN_COMPLETE_COUNT = 1;
+            long submitted_call_count = syscall(
+                __NR_io_uring_enter,
+                RingFile,
+                GetQueuedCallCount(),
+                MIN_COMPLETE_COUNT,
+                IORING_ENTER_GETEVENTS,
+                nullptr,
+                0);
+            bool calls_submitted = (submitted_call_count >= 0);
+            if (!calls_submitted)
+            {
+                bool retry_needed = (EINTR == errno || EAGAIN == errno || EBUSY == errno);
+                return retry_needed ? SubmitResult::RETRY : SubmitResult::FAILED;
+            }
+            return SubmitResult::SUBMITTED;
+        }
+
+        /// Waits for at least one call to complete without submitting any queued calls.
+        /// Kernels that can't limit how long they wait are only checked for completions (including any
+        /// that overflowed the ring), followed by a short sleep, so the wait never lasts much longer than the timeout.
+        /// @param[in]  timeout - The longest to wait.
+        /// @return True if the wait ended normally (a call may or may not have completed); false if the ring failed.
+        bool WaitForCompletion(const std::chrono::nanoseconds timeout)
+        {
+            const uint32_t NO_CALLS_TO_SUBMIT = 0;
+            uint32_t min_complete_count = 0;
+            unsigned int flags = IORING_ENTER_GETEVENTS;
+            const void* argument = nullptr;
+            std::size_t argument_size = 0;
+#if defined(IORING_FEAT_EXT_ARG)
+            io_uring_getevents_arg wait_argument;
+            std::memset(&wait_argument, 0, sizeof(wait_argument));
+            __kernel_timespec wait_timeout;
+            if (TimedWaitsSupported)
+            {
+                const int64_t NANOSECONDS_PER_SECOND = 1000000000;
+                wait_timeout.tv_sec = timeout.count() / NANOSECONDS_PER_SECOND;
+                wait_timeout.tv_nsec = timeout.count() % NANOSECONDS_PER_SECOND;
+                wait_argument.ts = reinterpret_cast<uint64_t>(&wait_timeout);
+                min_complete_count = 1;
+                flags |= IORING_ENTER_EXT_ARG;
+                argument = &wait_argument;
+                argument_size = sizeof(wait_argument);
+            }
+#endif
+            long result = syscall(__NR_io_uring_enter, RingFile, NO_CALLS_TO_SUBMIT, min_complete_count, flags, argument, argument_size);
+            bool wait_ended_normally = (result >= 0 || EINTR == errno || ETIME == errno || EAGAIN == errno || EBUSY == errno);
+            if (wait_ended_normally && !TimedWaitsSupported)
+            {
+                std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(timeout, RETRY_BACK_OFF_TIME));
+            }
+            return wait_ended_normally;
+        }
+
+        /// Takes the result of the next completed call, if any.
+        /// @param[out]  tag - The tag of the completed call.
+        /// @param[out]  result - The result of the call, which is 0 on success or a negated error code.
+        /// @return True if a completed call was taken; false if no calls have completed.
+        bool TakeCompletion(uint64_t& tag, int& result)
+        {
+            // The kernel writes the completion tail, so it must be read atomically to see the completions before it.
+            uint32_t head = *CompletionHead;
+            uint32_t tail = __atomic_load_n(CompletionTail, __ATOMIC_ACQUIRE);
+            bool completion_available = (head != tail);
+            if (!completion_available)
+            {
+                return false;
+            }
+            const io_uring_cqe& completion = Completions[head & CompletionMask];
+            tag = completion.user_data;
+            result = completion.res;
+            __atomic_store_n(CompletionHead, head + 1, __ATOMIC_RELEASE);
+            return true;
+        }
+
+    private:
+        /// Maps part of the ring into memory.
+        /// @param[in]  size_in_bytes - The size of the part to map.
+        /// @param[in]  offset - The offset identifying the part to map.
+        /// @return The mapped memory, or null if it couldn't be mapped.
+        uint8_t* Map(const std::size_t size_in_bytes, const off_t offset)
+        {
+            void* memory = mmap(nullptr, size_in_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, RingFile, offset);
+            bool memory_mapped = (MAP_FAILED != memory);
+            return memory_mapped ? static_cast<uint8_t*>(memory) : nullptr;
+        }
+
+        // MEMBER VARIABLES.
+        /// The file descriptor of the ring, or -1 if no ring is set up.
+        int RingFile = -1;
+        /// The submission queue, as mapped into memory.
+        uint8_t* SubmissionQueue = nullptr;
+        /// The size of the mapped submission queue, in bytes.
+        std::size_t SubmissionQueueSize = 0;
+        /// The completion queue, as mapped into memory.  This may be the same memory as the submission queue.
+        uint8_t* CompletionQueue = nullptr;
+        /// The size of the mapped completion queue, in bytes.
+        std::size_t CompletionQueueSize = 0;
+        /// The submission entries, as mapped into memory.
+        io_uring_sqe* SubmissionEntries = nullptr;
+        /// The size of the mapped submission entries, in bytes.
+        std::size_t SubmissionEntriesSize = 0;
+        /// True if the kernel can limit how long it waits for completions.
+        bool TimedWaitsSupported = false;
+        /// The index of the next submission entry for the kernel to take, shared with the kernel.
+        const uint32_t* SubmissionHead = nullptr;
+        /// The index just past the last queued submission entry, shared with the kernel.
+        uint32_t* SubmissionTail = nullptr;
+        /// The mask for wrapping submission indices around the queue.
+        uint32_t SubmissionMask = 0;
+        /// The indices of the submission entries in the queue, shared with the kernel.
+        uint32_t* SubmissionArray = nullptr;
+        /// The index of the next completion to take, shared with the kernel.
+        uint32_t* CompletionHead = nullptr;
+        /// The index just past the last completion, shared with the kernel.
+        const uint32_t* CompletionTail = nullptr;
+        /// The mask for wrapping completion indices around the queue.
+        uint32_t CompletionMask = 0;
+        /// The completions, shared with the kernel.
+        const io_uring_cqe* Completions = nullptr;
+    };
+
+    /// Waits for calls already submitted to a failed ring to complete, taking their completions.
+    /// @param[in]  submitted_call_count - The number of submitted calls that haven't completed.
+    /// @param[in,out]  ring - The ring the calls were submitted to.
+    /// @return True if all of the calls completed; false if they didn't complete before a deadline or the ring stopped working.
+    static bool WaitForSubmittedCalls(std::size_t submitted_call_count, StatxRing& ring)
+    {
+        auto deadline = std::chrono::steady_clock::now() + MAX_SUBMITTED_CALL_WAIT_TIME;
+        while (submitted_call_count > 0)
+        {
+            // TAKE ANY COMPLETED CALLS.
+            uint64_t slot_index = 0;
+            int call_result = 0;
+            while (submitted_call_count > 0 && ring.TakeCompletion(slot_index, call_result))
+            {
+                --submitted_call_count;
+            }
+            if (0 == submitted_call_count)
+            {
+                break;
+            }
+
+            // WAIT FOR MORE CALLS TO COMPLETE UNTIL THE DEADLINE.
+            auto now = std::chrono::steady_clock::now();
+            bool deadline_passed = (now >= deadline);
+            if (deadline_passed)
+            {
+                return false;
+            }
+            bool waited = ring.WaitForCompletion(std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now));
+            if (!waited)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// The maximum number of statx calls in flight at once.
+    static const uint32_t MAX_CALLS_IN_FLIGHT = 256;
+    /// The maximum number of times in a row that submitting calls is retried before giving up on the ring.
+    static const unsigned int MAX_CONSECUTIVE_RETRY_COUNT = 100;
+    /// How long to wait before retrying a submission when no calls completed.
+    static const std::chrono::milliseconds RETRY_BACK_OFF_TIME;
+    /// How long to wait for calls already submitted to a failed ring to complete before abandoning them.
+    static const std::chrono::seconds MAX_SUBMITTED_CALL_WAIT_TIME;
+#endif
+};
+
+#if defined(GENERATE_PROJECT_IO_URING)
+const uint32_t FileMetadataReader::MAX_CALLS_IN_FLIGHT;
+const unsigned int FileMetadataReader::MAX_CONSECUTIVE_RETRY_COUNT;
+const std::chrono::milliseconds FileMetadataReader::RETRY_BACK_OFF_TIME(1);
+const std::chrono::seconds FileMetadataReader::MAX_SUBMITTED_CALL_WAIT_TIME(5);
+#endif
+
+void FolderTree::ReadFileMetadata(const unsigned int thread_count)
+{
+    BuildFolderPaths();
+    FileMetadataReader::Read(
+        thread_count,
+        Files.size(),
+        [this](const std::size_t file_index, std::string& path) { AppendFilePath(static_cast<uint32_t>(file_index), path); },
+        FileSizesInBytes,
+        FileModificationTimes);
+}
+
+/// Lists a folder hierarchy one folder at a time, in the same pre-order as a FolderTree, without ever holding the
+/// whole hierarchy in memory.  This is for hierarchies too large to hold in memory that only need to be visited once.
+///
+/// Folders are listed and visited in a producer/consumer pipeline.  The folders still to be visited are kept on a stack,
+/// with the next folder to visit on top, and the visiting thread only ever takes the folder on top.  Worker threads list
+/// the unlisted folders nearest the top ahead of time, so their entries are usually ready by the time they're visited.  Once the
+/// listings waiting to be visited take up too much memory, the workers wait until some have been visited, and if no worker
+/// has listed the folder on top, the visiting thread lists it itself so that visiting always makes progress.  Each listing
+/// is released as soon as its folder has been visited, so memory use depends on the limit on listings and the shape of
+/// the hierarchy (the subfolders still to be visited at each level), not on how many folders and files it has.
+///
+/// Entries are left out by ignore rules exactly as when scanning with FolderScanner, and links leading back to a folder
+/// containing them are left out too.  Since folders are released once visited, a folder reached by several paths
+/// is listed again for each one, so including each folder only once (LinkPolicy::ONCE) isn't supported.
+class FolderStream
+{
+public:
+    /// Visits every folder in a hierarchy, in pre-order.
+    /// @param[in]  relative_path - The relative path to the root folder of the hierarchy.
+    /// @param[in]  ignore_settings - The settings for which files and folders to leave out.
+    ///     Ignored folders are never listed.
+    /// @param[in]  thread_count - The number of threads to use, including the calling thread.
+    ///     Zero uses one thread per hardware core.
+    /// @param[in]  max_buffered_listing_bytes - The maximum memory for listings waiting to be visited.
+    /// @param[in]  visit_folder - The function to call for each folder, with the signature
+    ///     void(const ScannedFolder& folder).  Only the folder's path, modification time, and entries
+    ///     (without any ignored entries) are populated.  It's always called on the calling thread.
+    template <typename FolderVisitor>
+    static void Visit(
+        const std::string& relative_path,
+        const IgnoreSettings& ignore_settings,
+        const unsigned int thread_count,
+        const std::size_t max_buffered_listing_bytes,
+        FolderVisitor visit_folder)
+    {
+        // START WITH THE ROOT FOLDER ON THE STACK.
+        BaseIgnoreRules base_ignore_rules = IgnoreRuleFiles::LoadBaseRules(relative_path, ignore_settings);
+        FolderStream stream(base_ignore_rules, relative_path.size(), max_buffered_listing_bytes);
+        std::unique_ptr<PendingFolder> root_folder(new PendingFolder(relative_path));
+        FolderScanner::ApplyBaseIgnoreRules(base_ignore_rules, root_folder->Folder);
+        stream.UnlistedFolders.push_back(root_folder.get());
+        stream.Stack.push_back(std::move(root_folder));
+
+        // START THE WORKER THREADS.
+        // The calling thread visits the folders, so it's not one of the workers.
+        const unsigned int VISITING_THREAD_COUNT = 1;
+        unsigned int worker_thread_count = FolderScanner::ResolveThreadCount(thread_count) - VISITING_THREAD_COUNT;
+        std::vector<std::thread> worker_threads;
+        for (unsigned int thread_index = 0; thread_index < worker_thread_count; ++thread_index)
+        {
+            worker_threads.emplace_back(&FolderStream::Work, &stream);
+        }
+
+        // VISIT EACH FOLDER.
+        std::unique_lock<std::mutex> lock(stream.Mutex);
+        while (!stream.Stack.empty())
+        {
+            // WAIT FOR THE NEXT FOLDER TO BE LISTED.
+            // It's listed here if no worker has started listing it yet, in which case
+            // it's also the unlisted folder nearest the top of the stack.
+            PendingFolder& next_folder = *stream.Stack.back();
+            if (ListingState::NOT_LISTED == next_folder.State)
+            {
+                stream.UnlistedFolders.pop_back();
+                stream.List(next_folder, lock);
+            }
+            stream.ListingFinished.wait(lock, [&next_folder]() { return ListingState::LISTED == next_folder.State; });
+
+            // TAKE THE FOLDER OFF OF THE STACK.
+            std::unique_ptr<PendingFolder> folder = std::move(stream.Stack.back());
+            stream.Stack.pop_back();
+            stream.BufferedListingBytes -= folder->ListingSizeInBytes;
+            stream.ListingNeeded.notify_all();
+            lock.unlock();
+
+            // VISIT THE FOLDER.
+            const ScannedFolder& visited_folder = folder->Folder;
+            visit_folder(visited_folder);
+
+            // CREATE THE FOLDER'S SUBFOLDERS.
+            // They're created in reverse so that the first subfolder ends up on top of the stack.
+            // Each subfolder keeps any of the folder's own ignore rules alive for as long as it needs them,
+            // along with the identities of the folders containing it.
+            std::shared_ptr<const AncestorFolder> subfolder_ancestors(new AncestorFolder{ visited_folder.Identity, folder->Ancestors });
+            std::vector<std::unique_ptr<PendingFolder>> subfolders;
+            subfolders.reserve(visited_folder.SubfolderNameOffsets.size());
+            for (auto subfolder_name_offset = visited_folder.SubfolderNameOffsets.crbegin();
+                subfolder_name_offset != visited_folder.SubfolderNameOffsets.crend();
+                ++subfolder_name_offset)
+            {
+                const char* subfolder_name = visited_folder.GetEntryName(*subfolder_name_offset);
+                std::unique_ptr<PendingFolder> subfolder(new PendingFolder(visited_folder.RelativePath + PATH_SEPARATOR + subfolder_name));
+                FolderScanner::InheritIgnoreRules(visited_folder, subfolder_name, subfolder->Folder);
+                subfolder->IgnoreRulesOwner = folder->IgnoreRulesOwner;
+                subfolder->Ancestors = subfolder_ancestors;
+                subfolders.push_back(std::move(subfolder));
+            }
+            folder.reset();
+
+            // ADD THE SUBFOLDERS TO THE STACK FOR THE WORKERS TO LIST.
+            lock.lock();
+            for (auto& subfolder : subfolders)
+            {
+                stream.UnlistedFolders.push_back(subfolder.get());
+                stream.Stack.push_back(std::move(subfolder));
+            }
+            stream.ListingNeeded.notify_all();
+        }
+
+        // STOP THE WORKER THREADS.
+        stream.Finished = true;
+        stream.ListingNeeded.notify_all();
+        lock.unlock();
+        for (auto& worker_thread : worker_threads)
+        {
+            worker_thread.join();
+        }
+    }
+
+private:
+    /// How far along a pending folder is in being listed.
+    enum class ListingState
+    {
+        /// Nothing has started listing the folder.
+        NOT_LISTED,
+        /// A thread is listing the folder.
+        LISTING,
+        /// The folder's entries are ready to be visited.
+        LISTED
+    };
+
+    /// A folder containing a folder waiting to be visited, for finding links that lead back to it.
+    struct AncestorFolder
+    {
+        /// The identity of the folder.
+        FolderIdentity Identity;
+        /// The folder containing this folder, or null for the root folder.
+        std::shared_ptr<const AncestorFolder> Parent;
+    };
+
+    /// A folder waiting to be visited.
+    struct PendingFolder
+    {
+        /// Constructor.
+        /// @param[in]  relative_path - The relative path to the folder.
+        explicit PendingFolder(const std::string& relative_path) :
+            Folder(relative_path)
+        {}
+
+        /// The folder, whose entries are populated once it's listed.
+        ScannedFolder Folder;
+        /// The ignore rules from the rules file of the folder or the nearest folder containing it that has one,
+        /// which the folder's ignore rules may refer to.  Null if the folder only uses the base rules.
+        std::shared_ptr<const IgnoreRules> IgnoreRulesOwner = nullptr;
+        /// The folder containing this folder, or null for the root folder.
+        std::shared_ptr<const AncestorFolder> Ancestors = nullptr;
+        /// How far along the folder is in being listed.
+        ListingState State = ListingState::NOT_LISTED;
+        /// The approximate memory taken up by the folder's listing, once listed.
+        std::size_t ListingSizeInBytes = 0;
+    };
+
+    /// Constructor.
+    /// @param[in]  base_ignore_rules - The ignore rules that apply to the root folder from outside of it.
+    /// @param[in]  root_folder_path_length - The length of the root folder's relative path.
+    /// @param[in]  max_buffered_listing_bytes - The maximum memory for listings waiting to be visited.
+    explicit FolderStream(
+        const BaseIgnoreRules& base_ignore_rules,
+        const std::size_t root_folder_path_length,
+        const std::size_t max_buffered_listing_bytes) :
+        BaseRules(&base_ignore_rules),
+        RootFolderPathLength(root_folder_path_length),
+        MaxBufferedListingBytes(max_buffered_listing_bytes)
+    {}
+
+    /// Runs the listing loop for a worker thread until all folders have been visited.
+    void Work()
+    {
+        std::unique_lock<std::mutex> lock(Mutex);
+        for (;;)
+        {
+            // WAIT FOR A FOLDER TO LIST.
+            PendingFolder* folder = nullptr;
+            ListingNeeded.wait(lock, [this, &folder]()
+            {
+                folder = TakeFolderToList();
+                return Finished || folder;
+            });
+            if (Finished)
+            {
+                return;
+            }
+
+            // LIST THE FOLDER.
+            List(*folder, lock);
+        }
+    }
+
+    /// Takes the unlisted folder nearest the top of the stack to list, unless enough listings
+    /// are already waiting to be visited.  The mutex must be held.
+    /// @return The folder to list, if any; null otherwise.
+    PendingFolder* TakeFolderToList()
+    {
+        bool listing_limit_reached = (BufferedListingBytes >= MaxBufferedListingBytes);
+        if (listing_limit_reached || UnlistedFolders.empty())
+        {
+            return nullptr;
+        }
+        PendingFolder* folder = UnlistedFolders.back();
+        UnlistedFolders.pop_back();
+        return folder;
+    }
+
+    /// Lists a pending folder's entries, leaving out any ignored entries.  The mutex is released while listing.
+    /// @param[in,out]  folder - The folder to list, which must already be taken out of the unlisted folders.
+    /// @param[in,out]  lock - The lock holding the mutex.
+    void List(PendingFolder& folder, std::unique_lock<std::mutex>& lock)
+    {
+        // LIST THE FOLDER'S ENTRIES.
+        // As with FolderScanner, a folder that can't be listed is simply left empty.
+        folder.State = ListingState::LISTING;
+        lock.unlock();
+        ScannedFolder& listed_folder = folder.Folder;
+        {
+            TraceSpan listing_span("list folder", &listed_folder.RelativePath);
+            bool links_followed = (LinkPolicy::NEVER != BaseRules->LinkedFolders);
+            DirectoryListing::Visit(
+                listed_folder.RelativePath,
+                [&listed_folder, links_followed](const char* name, const bool is_directory, const bool is_link)
+                {
+                    bool is_linked_folder = (is_directory && is_link);
+                    if (!is_linked_folder)
+                    {
+                        listed_folder.AddEntry(name, is_directory);
+                    }
+                    else if (links_followed)
+                    {
+                        listed_folder.AddLinkedSubfolder(name, std::strlen(name));
+                    }
+                },
+                listed_folder.ModificationTime,
+                listed_folder.Identity);
+        }
+
+        // LEAVE OUT ANY IGNORED ENTRIES.
+        if (listed_folder.ApplicableIgnoreRules)
+        {
+            const bool ENTRIES_LISTED = true;
+            uint64_t folder_rules_hash = 0;
+            std::unique_ptr<IgnoreRules> folder_rules = FolderScanner::ApplyIgnoreRules(
+                *BaseRules,
+                RootFolderPathLength,
+                ENTRIES_LISTED,
+                listed_folder,
+                folder_rules_hash);
+            if (folder_rules)
+            {
+                folder.IgnoreRulesOwner = std::move(folder_rules);
+            }
+        }
+
+        // LEAVE OUT ANY LINKS LEADING BACK TO THE FOLDER OR A FOLDER CONTAINING IT.
+        auto leads_to_containing_folder = [&folder, &listed_folder](const uint32_t subfolder_name_offset)
+        {
+            if (!listed_folder.IsLinkedSubfolder(subfolder_name_offset))
+            {
+                return false;
+            }
+            FolderIdentity linked_folder_identity;
+            std::string linked_folder_path = listed_folder.RelativePath + PATH_SEPARATOR + listed_folder.GetEntryName(subfolder_name_offset);
+            bool identity_retrieved = DirectoryListing::GetIdentity(linked_folder_path, linked_folder_identity);
+            if (!identity_retrieved)
+            {
+                return true;
+            }
+            bool is_containing_folder = (linked_folder_identity == listed_folder.Identity);
+            for (const AncestorFolder* ancestor = folder.Ancestors.get(); ancestor && !is_containing_folder; ancestor = ancestor->Parent.get())
+            {
+                is_containing_folder = (linked_folder_identity == ancestor->Identity);
+            }
+            return is_containing_folder;
+        };
+        if (!listed_folder.LinkedSubfolderNameOffsets.empty())
+        {
+            std::vector<uint32_t>& subfolder_name_offsets = listed_folder.SubfolderNameOffsets;
+            subfolder_name_offsets.erase(
+                std::remove_if(subfolder_name_offsets.begin(), subfolder_name_offsets.end(), leads_to_containing_folder),
+                subfolder_name_offsets.end());
+        }
+
+        // MAKE THE LISTING AVAILABLE TO VISIT.
+        std::size_t listing_size_in_bytes = (
+            sizeof(PendingFolder) +
+            listed_folder.RelativePath.capacity() +
+            listed_folder.EntryNames.capacity() +
+            (listed_folder.FileNameOffsets.capacity() + listed_folder.SubfolderNameOffsets.capacity() + listed_folder.LinkedSubfolderNameOffsets.capacity()) * sizeof(uint32_t));
+        lock.lock();
+        folder.ListingSizeInBytes = listing_size_in_bytes;
+        BufferedListingBytes += listing_size_in_bytes;
+        folder.State = ListingState::LISTED;
+        ListingFinished.notify_one();
+    }
+
+    // MEMBER VARIABLES.
+    /// The ignore rules that apply to the root folder from outside of it.
+    const BaseIgnoreRules* BaseRules;
+    /// The length of the root folder's relative path.
+    std::size_t RootFolderPathLength;
+    /// The maximum memory for listings waiting to be visited.
+    std::size_t MaxBufferedListingBytes;
+    /// The mutex protecting the stack, the state of each pending folder, and the memory used by listings.
+    std::mutex Mutex = {};
+    /// Signaled when a folder has been listed, for the visiting thread to wait on.
+    std::condition_variable ListingFinished = {};
+    /// Signaled when there may be more folders to list (or visiting has finished), for the workers to wait on.
+    std::condition_variable ListingNeeded = {};
+    /// The folders waiting to be visited, with the next one to visit at the back.
+    std::vector<std::unique_ptr<PendingFolder>> Stack = {};
+    /// The folders on the stack that nothing has started listing, in the same order as on the stack.
+    /// Since folders are only added to and taken from the top of the stack, the unlisted folder nearest
+    /// the top is always at the back, so finding the next folder to list never requires searching.
+    std::vector<PendingFolder*> UnlistedFolders = {};
+    /// The approximate memory taken up by listings waiting to be visited.
+    std::size_t BufferedListingBytes = 0;
+    /// True once all folders have been visited.
+    bool Finished = false;
+};
+
+/// A persistent on-disk cache of a scanned FolderTree, used to avoid re-listing folders that haven't changed.
+///
+/// The cache file is a small header followed directly by the tree's folder records, file records, and name
+/// characters, exactly as they're laid out in memory.  Loading the cache just maps the file and copies each
+/// array as a single block, with no per-entry parsing.  The folder records include each folder's modification
+/// time, which is all that's needed to determine which folders must be listed again (see FolderTree::Rescan).
+/// The header includes a hash of everything after it, so that a damaged cache is scanned again from scratch
+/// instead of being loaded, since its wrong entries would otherwise stay wrong until their folders changed.
+class ScanCache
+{
+public:
+    /// Loads a tree from a cache file.
+    /// @param[in]  cache_path - The path of the cache file.
+    /// @param[in]  root_folder_path - The path of the root folder the tree must be for.
+    /// @param[in]  ignore_settings - The settings for which files and folders to leave out of the tree.
+    ///     If the rules they lead to differ from the ones the cached tree was scanned with, every folder
+    ///     is listed again when the tree is rescanned.
+    /// @param[out]  tree - The tree loaded from the cache.
+    /// @return True if a valid cache for the root folder was loaded; false otherwise.
+    static bool Load(const std::string& cache_path, const std::string& root_folder_path, const IgnoreSettings& ignore_settings, FolderTree& tree)
+    {
+        // MAP THE CACHE FILE.
+        const bool IS_PHASE = true;
+        TraceSpan load_span("load scan cache", &cache_path, IS_PHASE);
+        MemoryMappedFile cache_file;
+        bool cache_file_mapped = cache_file.Open(cache_path);
+        if (!cache_file_mapped)
+        {
+            return false;
+        }
+
+        // VERIFY THE CACHE FILE IS COMPATIBLE.
+        // Caches from other versions of this program or with different record layouts are ignored.
+        bool header_present = (cache_file.Size >= sizeof(Header));
+        if (!header_present)
+        {
+            return false;
+        }
+        Header header;
+        std::memcpy(&header, cache_file.Data, sizeof(header));
+        bool header_valid = (
+            0 == std::memcmp(header.Signature, SIGNATURE, sizeof(header.Signature)) &&
+            sizeof(FolderTree::FolderRecord) == header.FolderRecordSize &&
+            sizeof(FolderTree::FileRecord) == header.FileRecordSize &&
+            header.FolderCount > 0);
+        if (!header_valid)
+        {
+            return false;
+        }
+        uint64_t folders_size_in_bytes = static_cast<uint64_t>(header.FolderCount) * sizeof(FolderTree::FolderRecord);
+        uint64_t files_size_in_bytes = static_cast<uint64_t>(header.FileCount) * sizeof(FolderTree::FileRecord);
+        uint64_t expected_size_in_bytes = sizeof(Header) + folders_size_in_bytes + files_size_in_bytes + header.NameCharacterCount;
+        bool size_valid = (expected_size_in_bytes == cache_file.Size);
+        if (!size_valid)
+        {
+            return false;
+        }
+
+        // VERIFY THE CACHE FILE ISN'T DAMAGED.
+        const char* payload_data = cache_file.Data + sizeof(Header);
+        uint64_t payload_hash = ContentHash::Hash(payload_data, cache_file.Size - sizeof(Header));
+        bool payload_intact = (header.PayloadHash == payload_hash);
+        if (!payload_intact)
+        {
+            return false;
+        }
+
+        // COPY THE TREE'S ARRAYS.
+        const char* folders_data = payload_data;
+        const char* files_data = folders_data + folders_size_in_bytes;
+        const char* names_data = files_data + files_size_in_bytes;
+        FolderTree cached_tree;
+        cached_tree.Folders.resize(header.FolderCount);
+        std::memcpy(cached_tree.Folders.data(), folders_data, static_cast<std::size_t>(folders_size_in_bytes));
+        cached_tree.Files.resize(header.FileCount);
+        std::memcpy(cached_tree.Files.data(), files_data, static_cast<std::size_t>(files_size_in_bytes));
+        cached_tree.Names.Characters.assign(names_data, names_data + header.NameCharacterCount);
+
+        // VERIFY THE TREE IS FOR THE ROOT FOLDER.
+        bool tree_consistent = IsConsistent(cached_tree);
+        if (!tree_consistent)
+        {
+            return false;
+        }
+        const uint32_t ROOT_FOLDER_INDEX = 0;
+        std::string cached_root_folder_path;
+        cached_tree.AppendFolderPath(ROOT_FOLDER_INDEX, cached_root_folder_path);
+        bool root_folder_matches = (root_folder_path == cached_root_folder_path);
+        if (!root_folder_matches)
+        {
+            return false;
+        }
+
+        cached_tree.IgnoreRuleSettings = ignore_settings;
+        cached_tree.IgnoreRulesHash = header.IgnoreRulesHash;
+        tree = std::move(cached_tree);
+        return true;
+    }
+
+    /// Saves a tree to a cache file.  The file is only written if its contents changed.
+    /// @param[in]  tree - The tree to save.
+    /// @param[in]  cache_path - The path of the cache file.
+    /// @return The result of writing the cache file.
+    static OutputFileWriteResult Save(const FolderTree& tree, const std::string& cache_path)
+    {
+        // FILL IN THE HEADER.
+        const bool IS_PHASE = true;
+        TraceSpan save_span("save scan cache", &cache_path, IS_PHASE);
+        Header header;
+        std::memcpy(header.Signature, SIGNATURE, sizeof(header.Signature));
+        header.FolderRecordSize = sizeof(FolderTree::FolderRecord);
+        header.FileRecordSize = sizeof(FolderTree::FileRecord);
+        header.FolderCount = static_cast<uint32_t>(tree.Folders.size());
+        header.FileCount = static_cast<uint32_t>(tree.Files.size());
+        header.NameCharacterCount = tree.Names.Characters.size();
+        header.IgnoreRulesHash = tree.IgnoreRulesHash;
+        header.PayloadHash = 0;
+
+        // WRITE THE HEADER AND ALL OF THE TREE'S ARRAYS.
+        std::size_t folders_size_in_bytes = tree.Folders.size() * sizeof(FolderTree::FolderRecord);
+        std::size_t files_size_in_bytes = tree.Files.size() * sizeof(FolderTree::FileRecord);
+        OutputFile cache_file(cache_path);
+        cache_file.Reserve(sizeof(header) + folders_size_in_bytes + files_size_in_bytes + tree.Names.Characters.size());
+        cache_file.Contents.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        cache_file.Contents.append(reinterpret_cast<const char*>(tree.Folders.data()), folders_size_in_bytes);
+        cache_file.Contents.append(reinterpret_cast<const char*>(tree.Files.data()), files_size_in_bytes);
+        cache_file.Contents.append(tree.Names.Characters.data(), tree.Names.Characters.size());
+
+        // HASH EVERYTHING AFTER THE HEADER.
+        header.PayloadHash = ContentHash::Hash(cache_file.Contents.data() + sizeof(header), cache_file.Contents.size() - sizeof(header));
+        std::memcpy(&cache_file.Contents[0], &header, sizeof(header));
+        return cache_file.WriteIfChanged();
+    }
+
+private:
+    /// The signature at the start of every cache file, which includes the format version.
+    static const char SIGNATURE[8];
+
+    /// The header at the start of a cache file.
+    struct Header
+    {
+        /// The signature identifying the file as a cache file.
+        char Signature[8];
+        /// The size of each folder record, in bytes.
+        uint32_t FolderRecordSize;
+        /// The size of each file record, in bytes.
+        uint32_t FileRecordSize;
+        /// The number of folder records.
+        uint32_t FolderCount;
+        /// The number of file records.
+        uint32_t FileCount;
+        /// The number of name characters.
+        uint64_t NameCharacterCount;
+        /// The hash of the ignore rules the tree was scanned with.
+        uint64_t IgnoreRulesHash;
+        /// The hash of the rest of the file after the header (see ContentHash).
+        uint64_t PayloadHash;
+    };
+
+    /// Checks that all indices and names in a tree loaded from a cache are in range, so that a corrupt
+    /// cache can't cause invalid memory accesses.
+    /// @param[in]  tree - The tree to check.
+    /// @return True if the tree is consistent; false otherwise.
+    static bool IsConsistent(const FolderTree& tree)
+    {
+        // CHECK ALL FOLDERS.
+        // Since folders are in pre-order, every folder's parent must come before it.
+        std::size_t name_character_count = tree.Names.Characters.size();
+        auto name_in_range = [name_character_count](const StringReference& name)
+        {
+            return (name.Offset <= name_character_count) && (name.Length <= name_character_count - name.Offset);
+        };
+        for (uint32_t folder_index = 0; folder_index < tree.Folders.size(); ++folder_index)
+        {
+            const FolderTree::FolderRecord& folder = tree.Folders[folder_index];
+            bool is_root_folder = (0 == folder_index);
+            bool parent_valid = is_root_folder ? (FolderTree::NO_INDEX == folder.ParentIndex) : (folder.ParentIndex < folder_index);
+            bool links_valid = (
+                (FolderTree::NO_INDEX == folder.FirstSubfolderIndex || (folder.FirstSubfolderIndex > folder_index && folder.FirstSubfolderIndex < tree.Folders.size())) &&
+                (FolderTree::NO_INDEX == folder.NextSiblingIndex || (folder.NextSiblingIndex > folder_index && folder.NextSiblingIndex < tree.Folders.size())) &&
+                (folder.SubtreeEndIndex > folder_index && folder.SubtreeEndIndex <= tree.Folders.size()));
+            bool files_valid = (folder.FirstFileIndex <= tree.Files.size()) && (folder.FileCount <= tree.Files.size() - folder.FirstFileIndex);
+            bool folder_valid = parent_valid && links_valid && files_valid && name_in_range(folder.Name);
+            if (!folder_valid)
+            {
+                return false;
+            }
+        }
+
+        // CHECK ALL FILES.
+        for (const auto& file : tree.Files)
+        {
+            bool file_valid = (file.FolderIndex < tree.Folders.size()) && name_in_range(file.Name);
+            if (!file_valid)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+const char ScanCache::SIGNATURE[8] = { 'G', 'P', 'S', 'C', 'A', 'N', '0', '6' };
+
+/// Finds the files in a code folder from the index of the git repository containing it (.git/index) instead
+/// of listing every folder on disk.  The index lists every tracked file in the repository in a single sorted file.
+///
+/// The index is memory-mapped and parsed directly, so git itself isn't needed.  Versions 2 to 4 of the index
+/// format are supported, including the path prefix compression of version 4.  Files in submodules are read from
+/// the submodules' own indexes.  The same ignore rules apply as when scanning, and .gitignore files are found
+/// from the index and read directly.  Files that aren't in the working tree (for sparse checkouts) are left out,
+/// and so are folders without any tracked files.
+///
+/// Untracked files can optionally be included too.  Every folder holding tracked files is then listed on disk
+/// and compared to the index's entries, and any folders that aren't in the index are scanned (see FolderTree::Rescan).
+/// Folder modification times can't be used to skip folders, since git rewrites the index (such as for
+/// "git status") without adding untracked files to it, leaving it newer than folders with untracked files.
+class GitIndex
+{
+public:
+    /// Gets the folder tree for a code folder, from its git repository's index if requested.  If the index
+    /// can't be read (such as if the code folder isn't in a git repository), the code folder is scanned instead.
+    /// @param[in]  relative_path - The relative path to the code folder.
+    /// @param[in]  ignore_settings - The settings for which files and folders to leave out.
+    /// @param[in]  git_index_use - How to use the git index.
+    /// @param[in]  thread_count - The number of threads to use for scanning or checking folders.
+    ///     Zero uses one thread per hardware core.
+    /// @return The tree for the code folder.
+    static FolderTree GetFolderTree(
+        const std::string& relative_path,
+        const IgnoreSettings& ignore_settings,
+        const GitIndexUse git_index_use,
+        const unsigned int thread_count)
+    {
+        // SCAN THE CODE FOLDER IF THE INDEX ISN'T USED.
+        bool index_used = (GitIndexUse::NONE != git_index_use);
+        if (!index_used)
+        {
+            return FolderTree::Get(relative_path, ignore_settings, thread_count);
+        }
+
+        // READ THE TRACKED FILES FROM THE INDEX.
+        FolderTree index_tree;
+        uint64_t index_modification_time = 0;
+        bool index_read = false;
+        {
+            const bool IS_PHASE = true;
+            TraceSpan scan_span("scan", &relative_path, IS_PHASE);
+            index_read = Read(relative_path, ignore_settings, index_tree, index_modification_time);
+        }
+        if (!index_read)
+        {
+            std::cerr << "Failed to read the git index for " << relative_path << ", so it will be scanned instead" << std::endl;
+            return FolderTree::Get(relative_path, ignore_settings, thread_count);
+        }
+
+        // LIST EVERY FOLDER FOR UNTRACKED FILES IF REQUESTED.
+        // Any untracked folders are found in the listings of the folders containing them.
+        bool untracked_files_included = (GitIndexUse::TRACKED_AND_UNTRACKED_FILES == git_index_use);
+        if (untracked_files_included)
+        {
+            std::vector<uint8_t> all_folders(index_tree.Folders.size(), 1);
+            return FolderTree::Rescan(thread_count, all_folders, index_tree, nullptr);
+        }
+        return index_tree;
+    }
+
+    /// Builds a folder's tree from a list of the files within it instead of scanning it, in the same way as from the
+    /// files tracked in the index.  Folders are implied by the paths of the files within them, and no ignore rules
+    /// apply, since the list is exactly the files wanted (which don't even need to exist on disk).
+    /// @param[in]  relative_path - The relative path to the folder.
+    /// @param[in]  file_paths - The paths of the files, relative to the folder.  Folder names may be separated
+    ///     with either '/' or '\'.  Empty and repeated paths are skipped.
+    /// @return The tree for the folder.  Every folder's modification time is zero.
+    static FolderTree FromFilePaths(const std::string& relative_path, const std::vector<std::string>& file_paths)
+    {
+        // GATHER THE PATHS WITH '/' BETWEEN FOLDER NAMES.
+        std::vector<std::string> sorted_file_paths;
+        sorted_file_paths.reserve(file_paths.size());
+        for (const auto& file_path : file_paths)
+        {
+            if (file_path.empty())
+            {
+                continue;
+            }
+            sorted_file_paths.push_back(file_path);
+            std::replace(sorted_file_paths.back().begin(), sorted_file_paths.back().end(), '\\', '/');
+        }
+        std::sort(sorted_file_paths.begin(), sorted_file_paths.end());
+        sorted_file_paths.erase(std::unique(sorted_file_paths.begin(), sorted_file_paths.end()), sorted_file_paths.end());
+        TrackedPaths paths;
+        for (const auto& file_path : sorted_file_paths)
+        {
+            paths.Offsets.push_back(static_cast<uint32_t>(paths.Characters.size()));
+            paths.Characters.append(file_path);
+            paths.Characters.push_back('\0');
+        }
+
+        // BUILD THE TREE FROM THE PATHS.
+        IgnoreSettings no_ignore_settings;
+        no_ignore_settings.VersionControlIgnored = false;
+        const uint64_t NO_MODIFICATION_TIME = 0;
+        FolderTree tree;
+        BuildTree(relative_path, no_ignore_settings, NO_MODIFICATION_TIME, paths, tree);
+        return tree;
+    }
+
+private:
+    /// The paths of tracked files, relative to a code folder with '/' between folder names.
+    struct TrackedPaths
+    {
+        /// Gets a path.
+        /// @param[in]  path_index - The index of the path.
+        /// @return The null-terminated path.
+        const char* Get(const std::size_t path_index) const
+        {
+            return Characters.c_str() + Offsets[path_index];
+        }
+
+        /// The null-terminated paths, concatenated.
+        std::string Characters = "";
+        /// The offset of each path.
+        std::vector<uint32_t> Offsets = {};
+    };
+
+    /// Constructor.
+    /// @param[in]  paths - The tracked paths to build folders from.
+    /// @param[in]  base_ignore_rules - The ignore rules that apply to the code folder from outside of it.
+    /// @param[in]  root_folder_path_length - The length of the code folder's path.
+    explicit GitIndex(const TrackedPaths& paths, const BaseIgnoreRules& base_ignore_rules, const std::size_t root_folder_path_length) :
+        Paths(&paths),
+        BaseRules(&base_ignore_rules),
+        RootFolderPathLength(root_folder_path_length),
+        FolderIgnoreRules(),
+        IgnoreRulesHash(base_ignore_rules.Hash)
+    {}
+
+    /// Reads a code folder's tree from its git repository's index.
+    /// @param[in]  relative_path - The relative path to the code folder.
+    /// @param[in]  ignore_settings - The settings for which files and folders to leave out.
+    /// @param[out]  tree - The tree for the code folder.  Every folder's modification time is the index's.
+    /// @param[out]  index_modification_time - The time the index was last written, in the file system's native units.
+    /// @return True if the index was read; false otherwise.
+    static bool Read(const std::string& relative_path, const IgnoreSettings& ignore_settings, FolderTree& tree, uint64_t& index_modification_time)
+    {
+        // READ THE TRACKED PATHS.
+        TrackedPaths paths;
+        const std::string NO_PATH_PREFIX = "";
+        bool paths_read = ReadTrackedPaths(relative_path, NO_PATH_PREFIX, paths, &index_modification_time);
+        if (!paths_read)
+        {
+            return false;
+        }
+
+        // BUILD THE TREE FROM THE PATHS.
+        BuildTree(relative_path, ignore_settings, index_modification_time, paths, tree);
+        return true;
+    }
+
+    /// Builds a folder's tree from the paths of the files within it.
+    /// @param[in]  relative_path - The relative path to the folder.
+    /// @param[in]  ignore_settings - The settings for which files and folders to leave out.
+    /// @param[in]  modification_time - The modification time to give every folder, in the file system's native units.
+    /// @param[in,out]  paths - The paths of the files, relative to the folder with '/' between folder names.  They're sorted.
+    /// @param[out]  tree - The tree for the folder.
+    static void BuildTree(
+        const std::string& relative_path,
+        const IgnoreSettings& ignore_settings,
+        const uint64_t modification_time,
+        TrackedPaths& paths,
+        FolderTree& tree)
+    {
+        // SORT THE PATHS SO THAT EACH FOLDER'S ENTRIES ARE TOGETHER.
+        // Paths are compared one name at a time, in the same order that folders are listed in (see DirectoryListing::CompareNames).
+        // The index is sorted byte by byte instead, which puts characters like '-' and '.' before the '/' after a folder name.
+        // So "a/b" is between "a-b" and "a.b", even though subfolders are listed in order by name (and "a" is first).
+        // Names that only differ by case are also ordered differently, but the index is almost always in the right order already.
+        auto path_less_than = [&paths](const uint32_t left_offset, const uint32_t right_offset)
+        {
+            const char* FOLDER_SEPARATOR = "/";
+            const char* left = paths.Characters.c_str() + left_offset;
+            const char* right = paths.Characters.c_str() + right_offset;
+            for (;;)
+            {
+                std::size_t left_name_length = std::strcspn(left, FOLDER_SEPARATOR);
+                std::size_t right_name_length = std::strcspn(right, FOLDER_SEPARATOR);
+                int name_order = DirectoryListing::CompareNames(left, left_name_length, right, right_name_length);
+                if (0 != name_order)
+                {
+                    return (name_order < 0);
+                }
+
+                // A file comes before any paths within a folder of the same name.
+                left += left_name_length;
+                right += right_name_length;
+                bool left_ended = ('\0' == *left);
+                bool right_ended = ('\0' == *right);
+                if (left_ended || right_ended)
+                {
+                    return (left_ended && !right_ended);
+                }
+                ++left;
+                ++right;
+            }
+        };
+        bool paths_sorted = std::is_sorted(paths.Offsets.cbegin(), paths.Offsets.cend(), path_less_than);
+        if (!paths_sorted)
+        {
+            std::sort(paths.Offsets.begin(), paths.Offsets.end(), path_less_than);
+        }
+
+        // BUILD THE FOLDERS FROM THE PATHS.
+        BaseIgnoreRules base_ignore_rules = IgnoreRuleFiles::LoadBaseRules(relative_path, ignore_settings);
+        ScannedFolder root_folder(relative_path);
+        root_folder.ModificationTime = modification_time;
+        FolderScanner::ApplyBaseIgnoreRules(base_ignore_rules, root_folder);
+        GitIndex index(paths, base_ignore_rules, relative_path.size());
+        const std::size_t FIRST_PATH_INDEX = 0;
+        const std::size_t ROOT_FOLDER_NAME_OFFSET = 0;
+        index.AddEntries(FIRST_PATH_INDEX, paths.Offsets.size(), ROOT_FOLDER_NAME_OFFSET, root_folder);
+
+        tree.AddScannedFolders(root_folder);
+        tree.IgnoreRuleSettings = ignore_settings;
+        tree.IgnoreRulesHash = index.IgnoreRulesHash;
+    }
+
+    /// Reads the paths of the files tracked within a folder from the index of the git repository containing it.
+    /// Files in submodules are read from the submodules' own indexes.
+    /// @param[in]  relative_path - The relative path to the folder.
+    /// @param[in]  path_prefix - The prefix to add to each path, which is the path of the folder within the code folder.
+    /// @param[in,out]  paths - The paths to add to.
+    /// @param[out]  index_modification_time - The time the index was last written, if needed.  May be null.
+    /// @return True if the index was read; false otherwise.
+    static bool ReadTrackedPaths(const std::string& relative_path, const std::string& path_prefix, TrackedPaths& paths, uint64_t* index_modification_time)
+    {
+        // MAP THE INDEX.
+        GitRepository repository;
+        bool repository_found = GitRepository::Find(relative_path, repository);
+        if (!repository_found)
+        {
+            return false;
+        }
+        std::string index_path = repository.GetIndexPath();
+        MemoryMappedFile index;
+        bool index_mapped = index.Open(index_path);
+        if (!index_mapped)
+        {
+            return false;
+        }
+        bool modification_time_retrieved = !index_modification_time || DirectoryListing::GetModificationTime(index_path, *index_modification_time);
+        if (!modification_time_retrieved)
+        {
+            return false;
+        }
+
+        // ADD THE PATHS WITHIN THE FOLDER.
+        // Entries for files with merge conflicts are repeated for each version of the file, so repeated paths are skipped.
+        std::string folder_path_within_root = repository.GetFolderPathWithinRoot();
+        std::string folder_prefix = folder_path_within_root.empty() ? "" : (folder_path_within_root + "/");
+        std::string previous_path;
+        std::vector<std::string> submodule_paths;
+        bool index_parsed = VisitEntries(
+            index,
+            [&](const std::string& path, const uint32_t mode)
+            {
+                bool path_within_folder = (path.size() > folder_prefix.size() && 0 == path.compare(0, folder_prefix.size(), folder_prefix));
+                bool path_repeated = (path == previous_path);
+                if (!path_within_folder || path_repeated)
+                {
+                    return;
+                }
+                previous_path = path;
+
+                // Submodules are read once this index has been read.
+                const uint32_t OBJECT_TYPE_MASK = 0170000;
+                const uint32_t SUBMODULE_OBJECT_TYPE = 0160000;
+                bool is_submodule = (SUBMODULE_OBJECT_TYPE == (mode & OBJECT_TYPE_MASK));
+                if (is_submodule)
+                {
+                    submodule_paths.push_back(path.substr(folder_prefix.size()));
+                    return;
+                }
+
+                paths.Offsets.push_back(static_cast<uint32_t>(paths.Characters.size()));
+                paths.Characters.append(path_prefix);
+                paths.Characters.append(path, folder_prefix.size(), std::string::npos);
+                paths.Characters.push_back('\0');
+            });
+        const std::size_t MAX_PATHS_SIZE_IN_BYTES = std::numeric_limits<uint32_t>::max();
+        bool paths_fit = (paths.Characters.size() <= MAX_PATHS_SIZE_IN_BYTES);
+        if (!index_parsed || !paths_fit)
+        {
+            return false;
+        }
+        index.Close();
+
+        // ADD THE PATHS IN EACH SUBMODULE.
+        // Submodules that haven't been checked out don't have their own repositories, so they're left out.
+        for (const auto& submodule_path : submodule_paths)
+        {
+            std::string submodule_relative_path = relative_path + PATH_SEPARATOR + DirectoryListing::ToProjectPath(submodule_path);
+            GitRepository submodule_repository;
+            bool submodule_checked_out = (
+                GitRepository::Find(submodule_relative_path, submodule_repository) &&
+                submodule_repository.FolderNamesWithinRoot.empty());
+            if (!submodule_checked_out)
+            {
+                continue;
+            }
+            bool submodule_paths_read = ReadTrackedPaths(submodule_relative_path, path_prefix + submodule_path + "/", paths, nullptr);
+            if (!submodule_paths_read)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// Visits each entry in a git index that's in the working tree.
+    /// See https://git-scm.com/docs/index-format for the format of the index.
+    /// @param[in]  index - The mapped index file.
+    /// @param[in]  visit_entry - The function to call with the path of each entry (with '/' between folder names) and its mode.
+    /// @return True if the index was parsed; false if it's corrupt or uses unsupported features.
+    template <typename EntryVisitor>
+    static bool VisitEntries(const MemoryMappedFile& index, EntryVisitor visit_entry)
+    {
+        // READ THE HEADER.
+        // It has a signature, the version of the format, and the number of entries.
+        const std::size_t HEADER_SIZE_IN_BYTES = 12;
+        const char SIGNATURE[] = { 'D', 'I', 'R', 'C' };
+        bool header_present = (index.Data && index.Size >= HEADER_SIZE_IN_BYTES && 0 == std::memcmp(index.Data, SIGNATURE, sizeof(SIGNATURE)));
+        if (!header_present)
+        {
+            return false;
+        }
+        const uint32_t MIN_VERSION = 2;
+        const uint32_t PREFIX_COMPRESSION_VERSION = 4;
+        uint32_t version = ReadBigEndian32(index.Data + 4);
+        bool version_supported = (MIN_VERSION <= version && version <= PREFIX_COMPRESSION_VERSION);
+        if (!version_supported)
+        {
+            return false;
+        }
+        uint32_t entry_count = ReadBigEndian32(index.Data + 8);
+
+        // READ EACH ENTRY.
+        // Each entry starts with the file's status (such as times and size), its mode, its object ID, and flags.
+        // Object IDs are assumed to be SHA-1 hashes, since the name lengths in the flags won't match otherwise.
+        const std::size_t MODE_OFFSET = 24;
+        const std::size_t OBJECT_ID_SIZE_IN_BYTES = 20;
+        const std::size_t FLAGS_OFFSET = 40 + OBJECT_ID_SIZE_IN_BYTES;
+        const std::size_t FLAGS_SIZE_IN_BYTES = 2;
+        const uint16_t EXTENDED_FLAGS_PRESENT_FLAG = 0x4000;
+        const uint16_t NAME_LENGTH_MASK = 0x0FFF;
+        const uint16_t SKIP_WORKTREE_FLAG = 0x4000;
+        const std::size_t ENTRY_ALIGNMENT_IN_BYTES = 8;
+        std::size_t entry_offset = HEADER_SIZE_IN_BYTES;
+        std::string path;
+        for (uint32_t entry_index = 0; entry_index < entry_count; ++entry_index)
+        {
+            // READ THE FLAGS.
+            // Later versions have a second set of flags, including whether the file is in the working tree.
+            std::size_t path_offset = entry_offset + FLAGS_OFFSET + FLAGS_SIZE_IN_BYTES;
+            if (path_offset > index.Size)
+            {
+                return false;
+            }
+            uint32_t mode = ReadBigEndian32(index.Data + entry_offset + MODE_OFFSET);
+            uint16_t flags = ReadBigEndian16(index.Data + entry_offset + FLAGS_OFFSET);
+            bool in_working_tree = true;
+            bool extended_flags_present = (0 != (flags & EXTENDED_FLAGS_PRESENT_FLAG));
+            if (extended_flags_present)
+            {
+                if (path_offset + FLAGS_SIZE_IN_BYTES > index.Size)
+                {
+                    return false;
+                }
+                uint16_t extended_flags = ReadBigEndian16(index.Data + path_offset);
+                in_working_tree = (0 == (extended_flags & SKIP_WORKTREE_FLAG));
+                path_offset += FLAGS_SIZE_IN_BYTES;
+            }
+
+            // READ THE PATH.
+            // With prefix compression, each path starts with the number of characters to remove from the end of
+            // the previous path, followed by the characters to add.
+            if (PREFIX_COMPRESSION_VERSION == version)
+            {
+                uint64_t removed_length = 0;
+                bool removed_length_read = ReadVariableLengthInteger(index, path_offset, removed_length);
+                if (!removed_length_read || removed_length > path.size())
+                {
+                    return false;
+                }
+                path.resize(path.size() - static_cast<std::size_t>(removed_length));
+            }
+            else
+            {
+                path.clear();
+            }
+            const char* path_characters = index.Data + path_offset;
+            const void* path_end = std::memchr(path_characters, '\0', index.Size - path_offset);
+            if (!path_end)
+            {
+                return false;
+            }
+            std::size_t path_characters_length = static_cast<std::size_t>(static_cast<const char*>(path_end) - path_characters);
+            path.append(path_characters, path_characters_length);
+
+            // Names too long for the flags have the maximum length there.
+            std::size_t expected_name_length = std::min<std::size_t>(path.size(), NAME_LENGTH_MASK);
+            bool name_length_matches = (expected_name_length == (flags & NAME_LENGTH_MASK));
+            if (!name_length_matches)
+            {
+                return false;
+            }
+
+            // MOVE TO THE NEXT ENTRY.
+            // Without prefix compression, entries are padded with 1 to 8 null characters to a multiple of 8 bytes.
+            if (PREFIX_COMPRESSION_VERSION == version)
+            {
+                entry_offset = path_offset + path_characters_length + 1;
+            }
+            else
+            {
+                std::size_t entry_size_in_bytes = path_offset - entry_offset + path_characters_length;
+                entry_offset += (entry_size_in_bytes + ENTRY_ALIGNMENT_IN_BYTES) & ~(ENTRY_ALIGNMENT_IN_BYTES - 1);
+            }
+
+            if (in_working_tree)
+            {
+                visit_entry(path, mode);
+            }
+        }
+
+        // MAKE SURE THE INDEX ISN'T SPLIT.
+        // Extensions follow the entries, each with a signature and size, and the file ends with a hash of its contents.
+        // A split index only has the entries changed since a separate shared index was written, which isn't supported.
+        const std::size_t EXTENSION_HEADER_SIZE_IN_BYTES = 8;
+        const char SPLIT_INDEX_SIGNATURE[] = { 'l', 'i', 'n', 'k' };
+        while (entry_offset + EXTENSION_HEADER_SIZE_IN_BYTES + OBJECT_ID_SIZE_IN_BYTES <= index.Size)
+        {
+            bool index_split = (0 == std::memcmp(index.Data + entry_offset, SPLIT_INDEX_SIGNATURE, sizeof(SPLIT_INDEX_SIGNATURE)));
+            if (index_split)
+            {
+                return false;
+            }
+            uint32_t extension_size_in_bytes = ReadBigEndian32(index.Data + entry_offset + sizeof(SPLIT_INDEX_SIGNATURE));
+            entry_offset += EXTENSION_HEADER_SIZE_IN_BYTES + extension_size_in_bytes;
+        }
+        return true;
+    }
+
+    /// Reads a big-endian 32-bit integer, as used throughout the index.
+    /// @param[in]  data - The bytes of the integer.
+    /// @return The integer.
+    static uint32_t ReadBigEndian32(const char* data)
+    {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+        return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) | (static_cast<uint32_t>(bytes[2]) << 8) | bytes[3];
+    }
+
+    /// Reads a big-endian 16-bit integer, as used throughout the index.
+    /// @param[in]  data - The bytes of the integer.
+    /// @return The integer.
+    static uint16_t ReadBigEndian16(const char* data)
+    {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+        return static_cast<uint16_t>((bytes[0] << 8) | bytes[1]);
+    }
+
+    /// Reads a variable-length integer from the index.  Each byte holds 7 bits of the integer, most significant
+    /// first, with the high bit set if more bytes follow.  Each byte after the first also adds one (before
+    /// shifting), so that every integer has only one encoding.
+    /// @param[in]  index - The mapped index file.
+    /// @param[in,out]  offset - The offset of the integer, which is moved past it.
+    /// @param[out]  value - The integer.
+    /// @return True if the integer was read; false if it's past the end of the index or too large.
+    static bool ReadVariableLengthInteger(const MemoryMappedFile& index, std::size_t& offset, uint64_t& value)
+    {
+        const unsigned char MORE_BYTES_FLAG = 0x80;
+        const unsigned char VALUE_MASK = 0x7F;
+        const unsigned int BITS_PER_BYTE = 7;
+        const uint64_t MAX_VALUE_BEFORE_SHIFT = std::numeric_limits<uint64_t>::max() >> BITS_PER_BYTE;
+        value = 0;
+        for (bool first_byte = true;; first_byte = false)
+        {
+            if (offset >= index.Size)
+            {
+                return false;
+            }
+            unsigned char byte = static_cast<unsigned char>(index.Data[offset++]);
+            if (!first_byte)
+            {
+                ++value;
+                if (value > MAX_VALUE_BEFORE_SHIFT)
+                {
+                    return false;
+                }
+                value <<= BITS_PER_BYTE;
+            }
+            value |= (byte & VALUE_MASK);
+            bool more_bytes = (0 != (byte & MORE_BYTES_FLAG));
+            if (!more_bytes)
+            {
+                return true;
+            }
+        }
+    }
+
+    /// Adds a folder's files and subfolders from the tracked paths within it, and then does the same for each subfolder,
+    /// leaving out ignored entries just like FolderScanner does.
+    /// @param[in]  first_path_index - The index of the first path within the folder.
+    /// @param[in]  end_path_index - The index just past the last path within the folder.
+    /// @param[in]  name_offset - The offset of the folder's entry names within each path.
+    /// @param[in,out]  folder - The folder.  Its path, modification time, and ignore rules must be set.
+    void AddEntries(const std::size_t first_path_index, const std::size_t end_path_index, const std::size_t name_offset, ScannedFolder& folder)
+    {
+        // ADD THE FOLDER'S FILES AND SUBFOLDERS.
+        // All paths within each subfolder are together since they're sorted.
+        struct SubfolderPaths
+        {
+            uint32_t NameOffset;
+            std::size_t FirstPathIndex;
+            std::size_t EndPathIndex;
+        };
+        std::vector<SubfolderPaths> subfolder_paths;
+        for (std::size_t path_index = first_path_index; path_index < end_path_index;)
+        {
+            const char* entry_path = Paths->Get(path_index) + name_offset;
+            const char* separator = std::strchr(entry_path, '/');
+            if (!separator)
+            {
+                folder.AddEntry(entry_path, false);
+                ++path_index;
+                continue;
+            }
+
+            std::size_t subfolder_prefix_length = static_cast<std::size_t>(separator - entry_path) + 1;
+            std::size_t subfolder_end_path_index = path_index + 1;
+            while (subfolder_end_path_index < end_path_index && 0 == std::strncmp(Paths->Get(subfolder_end_path_index) + name_offset, entry_path, subfolder_prefix_length))
+            {
+                ++subfolder_end_path_index;
+            }
+            folder.AddEntry(entry_path, subfolder_prefix_length - 1, true);
+            subfolder_paths.push_back({ folder.SubfolderNameOffsets.back(), path_index, subfolder_end_path_index });
+            path_index = subfolder_end_path_index;
+        }
+
+        // LEAVE OUT ANY IGNORED ENTRIES.
+        // Any rules from the folder's own rules file are kept until all folders are added, since its subfolders use them.
+        if (folder.ApplicableIgnoreRules)
+        {
+            const bool ENTRIES_LISTED = true;
+            uint64_t folder_rules_hash = 0;
+            std::unique_ptr<IgnoreRules> folder_rules = FolderScanner::ApplyIgnoreRules(*BaseRules, RootFolderPathLength, ENTRIES_LISTED, folder, folder_rules_hash);
+            IgnoreRulesHash ^= folder_rules_hash;
+            if (folder_rules)
+            {
+                FolderIgnoreRules.push_back(std::move(folder_rules));
+            }
+        }
+
+        // ADD EACH SUBFOLDER'S ENTRIES.
+        // Ignored subfolders were removed without changing the order of the rest.
+        folder.Subfolders.reserve(folder.SubfolderNameOffsets.size());
+        auto subfolder = subfolder_paths.cbegin();
+        for (uint32_t subfolder_name_offset : folder.SubfolderNameOffsets)
+        {
+            while (subfolder->NameOffset != subfolder_name_offset)
+            {
+                ++subfolder;
+            }
+            const char* subfolder_name = folder.GetEntryName(subfolder_name_offset);
+            folder.Subfolders.emplace_back(folder.RelativePath + PATH_SEPARATOR + subfolder_name);
+            ScannedFolder& added_subfolder = folder.Subfolders.back();
+            added_subfolder.ModificationTime = folder.ModificationTime;
+            FolderScanner::InheritIgnoreRules(folder, subfolder_name, added_subfolder);
+            std::size_t subfolder_name_offset_within_paths = name_offset + std::strlen(subfolder_name) + 1;
+            AddEntries(subfolder->FirstPathIndex, subfolder->EndPathIndex, subfolder_name_offset_within_paths, added_subfolder);
+        }
+    }
+
+    // MEMBER VARIABLES.
+    /// The tracked paths to build folders from.
+    const TrackedPaths* Paths;
+    /// The ignore rules that apply to the code folder from outside of it.
+    const BaseIgnoreRules* BaseRules;
+    /// The length of the code folder's path.
+    std::size_t RootFolderPathLength;
+    /// The rules read from .gitignore files, which folders refer to until all folders are added.
+    std::vector<std::unique_ptr<IgnoreRules>> FolderIgnoreRules;
+    /// A hash of all ignore rules applied, for detecting if they change.
+    uint64_t IgnoreRulesHash;
+};
+
+/// Watches the folders of a FolderTree for entries being added, removed, or renamed.
+///
+/// On Linux, every folder is watched with inotify, so changes are reported as soon as they happen, and
+/// only the folders that actually changed need to be listed again.  Elsewhere (or if inotify can't watch
+/// every folder, such as when the system's limit on watches is reached), the modification times of all
+/// folders are polled instead (see FolderTree::FindChangedFolders).
+///
+/// Changes typically arrive in bursts (such as from a version control checkout or an editor saving
+/// through a temporary file), so once a change is seen, further changes are collected until the
+/// folders have been quiet for a short time.  All of them are then reported together.
+class FolderWatcher
+{
+public:
+    /// Constructor.
+    FolderWatcher() = default;
+    FolderWatcher(const FolderWatcher&) = delete;
+    FolderWatcher& operator=(const FolderWatcher&) = delete;
+
+    /// Destructor.  Stops watching all folders.
+    ~FolderWatcher()
+    {
+#if defined(__linux__)
+        if (INVALID_DESCRIPTOR != InotifyDescriptor)
+        {
+            close(InotifyDescriptor);
+        }
+#endif
+    }
+
+    /// Updates the watched folders to match a tree.  Folders that are new to the tree start being watched,
+    /// and folders that are no longer in the tree stop being watched.
+    /// @param[in]  tree - The tree whose folders to watch.  Its folder paths should be built.
+    /// @return A flag for each folder in the tree indicating if it just started being watched.  Changes made
+    ///     to such folders before they were watched could have been missed, so they should be listed again.
+    std::vector<uint8_t> Update(const FolderTree& tree)
+    {
+        std::vector<uint8_t> newly_watched_folders(tree.Folders.size(), 0);
+#if defined(__linux__)
+        // START INOTIFY IF IT HASN'T BEEN STARTED.
+        if (Polling)
+        {
+            return newly_watched_folders;
+        }
+        if (INVALID_DESCRIPTOR == InotifyDescriptor)
+        {
+            InotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            if (INVALID_DESCRIPTOR == InotifyDescriptor)
+            {
+                std::cerr << "Unable to start watching for changes; polling for changes instead." << std::endl;
+                Polling = true;
+                return newly_watched_folders;
+            }
+        }
+
+        // WATCH ALL FOLDERS IN THE TREE.
+        // Folders that were already watched keep their existing watches, unless the watch was removed
+        // because the folder was deleted (in which case a new folder may now be at the same path).
+        std::unordered_map<std::string, int> watch_descriptors_by_path;
+        std::unordered_map<int, std::vector<uint32_t>> folder_indices_by_watch_descriptor;
+        watch_descriptors_by_path.reserve(tree.Folders.size());
+        folder_indices_by_watch_descriptor.reserve(tree.Folders.size());
+        std::string folder_path;
+        for (uint32_t folder_index = 0; folder_index < tree.Folders.size(); ++folder_index)
+        {
+            // CHECK IF THE FOLDER IS ALREADY WATCHED.
+            folder_path.clear();
+            tree.AppendFolderPath(folder_index, folder_path);
+            auto existing_watch = WatchDescriptorsByPath.find(folder_path);
+            bool already_watched = (
+                WatchDescriptorsByPath.cend() != existing_watch &&
+                FolderIndicesByWatchDescriptor.count(existing_watch->second) > 0);
+            if (already_watched)
+            {
+                watch_descriptors_by_path[folder_path] = existing_watch->second;
+                folder_indices_by_watch_descriptor[existing_watch->second].push_back(folder_index);
+                continue;
+            }
+
+            // WATCH THE FOLDER.
+            // Folders reached through different paths (such as via symbolic links) share a single watch.
+            std::string native_folder_path = DirectoryListing::ToNativePath(folder_path);
+            const uint32_t WATCHED_EVENTS = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+            int watch_descriptor = inotify_add_watch(InotifyDescriptor, native_folder_path.c_str(), WATCHED_EVENTS);
+            bool folder_watched = (INVALID_DESCRIPTOR != watch_descriptor);
+            if (folder_watched)
+            {
+                watch_descriptors_by_path[folder_path] = watch_descriptor;
+                folder_indices_by_watch_descriptor[watch_descriptor].push_back(folder_index);
+                newly_watched_folders[folder_index] = 1;
+                continue;
+            }
+
+            // HANDLE FOLDERS THAT COULDN'T BE WATCHED.
+            // A folder that was already deleted again just needs to be listed again.  Otherwise, folders
+            // can't be watched individually, so all of them must be polled instead.
+            bool folder_deleted = (ENOENT == errno || ENOTDIR == errno);
+            if (folder_deleted)
+            {
+                newly_watched_folders[folder_index] = 1;
+                continue;
+            }
+            std::cerr << "Unable to watch " << folder_path << " for changes; polling for changes instead." << std::endl;
+            close(InotifyDescriptor);
+            InotifyDescriptor = INVALID_DESCRIPTOR;
+            WatchDescriptorsByPath.clear();
+            FolderIndicesByWatchDescriptor.clear();
+            Polling = true;
+            return std::vector<uint8_t>(tree.Folders.size(), 0);
+        }
+
+        // STOP WATCHING FOLDERS THAT ARE NO LONGER IN THE TREE.
+        // A renamed folder keeps its watch, so watches still used by a folder in the tree are kept.
+        for (const auto& previous_watch : WatchDescriptorsByPath)
+        {
+            bool watch_still_used = (folder_indices_by_watch_descriptor.count(previous_watch.second) > 0);
+            if (!watch_still_used)
+            {
+                // The watch may have already been removed if the folder was deleted, in which case this safely fails.
+                inotify_rm_watch(InotifyDescriptor, previous_watch.second);
+            }
+        }
+        WatchDescriptorsByPath = std::move(watch_descriptors_by_path);
+        FolderIndicesByWatchDescriptor = std::move(folder_indices_by_watch_descriptor);
+#else
+        Polling = true;
+#endif
+        return newly_watched_folders;
+    }
+
+    /// Waits until any folders in the watched tree change.
+    /// @param[in]  thread_count - The number of threads to use for polling folders, if they're polled.
+    ///     Zero uses one thread per hardware core.
+    /// @param[in,out]  tree - The watched tree.  It must be the tree most recently passed to Update.
+    /// @return A flag for each folder in the tree indicating if it changed.  At least one folder will have changed.
+    std::vector<uint8_t> WaitForChanges(const unsigned int thread_count, FolderTree& tree)
+    {
+        // The quiet time is short enough to keep the total time from a change to updated files low,
+        // while still grouping the bursts of changes made by most tools.  Changes are reported after
+        // the maximum time even if they never stop, so that continuous changes can't delay updates forever.
+        const std::chrono::milliseconds QUIET_DURATION(20);
+        const std::chrono::milliseconds MAX_BATCH_DURATION(60);
+        for (;;)
+        {
+            // POLL FOR CHANGES IF FOLDERS CAN'T BE WATCHED.
+            if (Polling)
+            {
+                std::vector<uint8_t> polled_changed_folders = PollForChanges(thread_count, tree);
+                FirstChangeTime = std::chrono::steady_clock::now();
+                return polled_changed_folders;
+            }
+
+#if defined(__linux__)
+            // WAIT FOR THE FIRST CHANGE.
+            pollfd inotify_poll_request = { InotifyDescriptor, POLLIN, 0 };
+            const int WAIT_INDEFINITELY = -1;
+            const int ERROR_RESULT = -1;
+            int poll_result = poll(&inotify_poll_request, 1, WAIT_INDEFINITELY);
+            bool poll_failed = (ERROR_RESULT == poll_result);
+            if (poll_failed)
+            {
+                bool interrupted = (EINTR == errno);
+                if (!interrupted)
+                {
+                    std::cerr << "Unable to wait for changes; polling for changes instead." << std::endl;
+                    Polling = true;
+                }
+                continue;
+            }
+
+            // COLLECT CHANGES UNTIL THE FOLDERS ARE QUIET.
+            std::vector<uint8_t> changed_folders(tree.Folders.size(), 0);
+            bool events_lost = false;
+            FirstChangeTime = std::chrono::steady_clock::now();
+            ReadEvents(changed_folders, events_lost);
+            auto batch_start_time = FirstChangeTime;
+            for (;;)
+            {
+                auto batch_duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - batch_start_time);
+                bool batch_complete = (batch_duration >= MAX_BATCH_DURATION);
+                if (batch_complete)
+                {
+                    break;
+                }
+
+                std::chrono::milliseconds wait_duration = std::min(QUIET_DURATION, MAX_BATCH_DURATION - batch_duration);
+                poll_result = poll(&inotify_poll_request, 1, static_cast<int>(wait_duration.count()));
+                bool more_changes_occurred = (poll_result > 0);
+                if (!more_changes_occurred)
+                {
+                    break;
+                }
+                ReadEvents(changed_folders, events_lost);
+            }
+
+            // CHECK ALL FOLDERS IF ANY EVENTS WERE LOST.
+            if (events_lost)
+            {
+                changed_folders = FolderTree::FindChangedFolders(thread_count, tree);
+            }
+
+            // REPORT THE CHANGES.
+            // Events may only have been for folders that are no longer in the tree, in which case nothing changed.
+            bool any_folders_changed = (changed_folders.cend() != std::find(changed_folders.cbegin(), changed_folders.cend(), 1));
+            if (any_folders_changed)
+            {
+                return changed_folders;
+            }
+#endif
+        }
+    }
+
+    /// Gets when the changes most recently reported by WaitForChanges were first seen, which is when
+    /// the first of their events arrived (or when polling found them).
+    /// @return The time that the changes were first seen.
+    std::chrono::steady_clock::time_point GetFirstChangeTime() const
+    {
+        return FirstChangeTime;
+    }
+
+    /// Rescans the folders of the watched tree that changed, and starts watching any new folders.
+    /// New folders only start being watched after they're scanned, so they're listed again
+    /// in case anything was added to them in between.
+    /// @param[in]  thread_count - The number of threads to use for listing folders.
+    ///     Zero uses one thread per hardware core.
+    /// @param[in]  changed_folders - A flag for each folder in the tree indicating if it changed,
+    ///     as returned by WaitForChanges.
+    /// @param[in,out]  tree - The watched tree, which is replaced by the rescanned tree with its folder paths built.
+    /// @return The changes to the tree.
+    FolderTreeChanges RescanChangedFolders(const unsigned int thread_count, std::vector<uint8_t> changed_folders, FolderTree& tree)
+    {
+        FolderTreeChanges changes;
+        bool any_folders_changed = true;
+        while (any_folders_changed)
+        {
+            FolderTree updated_tree = FolderTree::Rescan(thread_count, changed_folders, tree, &changes);
+            tree = std::move(updated_tree);
+            tree.BuildFolderPaths();
+            changed_folders = Update(tree);
+            any_folders_changed = (changed_folders.cend() != std::find(changed_folders.cbegin(), changed_folders.cend(), 1));
+        }
+        return changes;
+    }
+
+private:
+    /// Polls the modification times of all folders until any of them change.
+    /// @param[in]  thread_count - The number of threads to use for checking folders.
+    ///     Zero uses one thread per hardware core.
+    /// @param[in,out]  tree - The tree whose folders to check.
+    /// @return A flag for each folder in the tree indicating if it changed.  At least one folder will have changed.
+    static std::vector<uint8_t> PollForChanges(const unsigned int thread_count, FolderTree& tree)
+    {
+        const std::chrono::milliseconds POLL_INTERVAL(50);
+        for (;;)
+        {
+            std::this_thread::sleep_for(POLL_INTERVAL);
+            std::vector<uint8_t> changed_folders = FolderTree::FindChangedFolders(thread_count, tree);
+            bool any_folders_changed = (changed_folders.cend() != std::find(changed_folders.cbegin(), changed_folders.cend(), 1));
+            if (any_folders_changed)
+            {
+                return changed_folders;
+            }
+        }
+    }
+
+#if defined(__linux__)
+    /// Reads all available inotify events, flagging the folders they're for as changed.
+    /// @param[in,out]  changed_folders - A flag for each folder in the watched tree indicating if it changed.
+    /// @param[in,out]  events_lost - Set to true if the event queue overflowed, in which case which
+    ///     folders changed is unknown.
+    void ReadEvents(std::vector<uint8_t>& changed_folders, bool& events_lost)
+    {
+        // The buffer is aligned for the events read into it.
+        alignas(inotify_event) char event_buffer[64 * 1024];
+        for (;;)
+        {
+            // READ AS MANY EVENTS AS ARE AVAILABLE.
+            ssize_t bytes_read = read(InotifyDescriptor, event_buffer, sizeof(event_buffer));
+            bool events_read = (bytes_read > 0);
+            if (!events_read)
+            {
+                return;
+            }
+
+            // FLAG THE FOLDER FOR EACH EVENT.
+            for (ssize_t event_offset = 0; event_offset < bytes_read;)
+            {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(event_buffer + event_offset);
+                event_offset += sizeof(inotify_event) + event->len;
+
+                bool queue_overflowed = (0 != (event->mask & IN_Q_OVERFLOW));
+                if (queue_overflowed)
+                {
+                    events_lost = true;
+                    continue;
+                }
+
+                auto watched_folder_indices = FolderIndicesByWatchDescriptor.find(event->wd);
+                bool folder_watched = (FolderIndicesByWatchDescriptor.cend() != watched_folder_indices);
+                if (!folder_watched)
+                {
+                    continue;
+                }
+                for (uint32_t folder_index : watched_folder_indices->second)
+                {
+                    changed_folders[folder_index] = 1;
+                }
+
+                // Watches are automatically removed once their folders are deleted.
+                bool watch_removed = (0 != (event->mask & IN_IGNORED));
+                if (watch_removed)
+                {
+                    FolderIndicesByWatchDescriptor.erase(watched_folder_indices);
+                }
+            }
+        }
+    }
+
+    /// The value of descriptors that aren't valid.
+    static const int INVALID_DESCRIPTOR = -1;
+
+    /// The inotify instance watching the folders, or INVALID_DESCRIPTOR if it hasn't been started.
+    int InotifyDescriptor = INVALID_DESCRIPTOR;
+    /// The inotify watch for the path of each watched folder.
+    std::unordered_map<std::string, int> WatchDescriptorsByPath = {};
+    /// The indices of the folders in the watched tree for each inotify watch.
+    std::unordered_map<int, std::vector<uint32_t>> FolderIndicesByWatchDescriptor = {};
+#endif
+
+    /// True if folders are polled for changes rather than being watched.
+    bool Polling = false;
+    /// When the changes most recently reported by WaitForChanges were first seen.
+    std::chrono::steady_clock::time_point FirstChangeTime = {};
+};
+
+#if defined(__linux__)
+const int FolderWatcher::INVALID_DESCRIPTOR;
+#endif
+
+/// The categories of files that are relevant to projects.
+enum class FileCategory : uint8_t
+{
+    /// A file that isn't a C or C++ code file.
+    OTHER,
+    /// A header file that is included by other files.
+    HEADER,
+    /// A source file that is compiled as a translation unit.
+    CPP
+};
+
+/// The files in a FolderTree grouped by category.  All files are categorized in a single pass over the
+/// tree, and each category is a list of indices into the tree's files, in the same order as the tree.
+class CategorizedFileIndex
+{
+public:
+    /// Categorizes all files in a folder of a tree, including files in its subfolders.
+    /// @param[in]  tree - The tree whose files to categorize.
+    /// @param[in]  root_folder_index - The index of the folder whose files to categorize.
+    /// @return The index of the folder's files by category.
+    static CategorizedFileIndex Build(const FolderTree& tree, const uint32_t root_folder_index)
+    {
+        const bool IS_PHASE = true;
+        TraceSpan categorize_span("categorize", nullptr, IS_PHASE);
+        CategorizedFileIndex index;
+        uint32_t end_file_index = tree.GetSubtreeFileEndIndex(root_folder_index);
+        for (uint32_t file_index = tree.Folders[root_folder_index].FirstFileIndex; file_index < end_file_index; ++file_index)
+        {
+            // ADD THE FILE TO THE LIST FOR ITS CATEGORY.
+            const StringReference& name = tree.Files[file_index].Name;
+            FileCategory category = Categorize(tree.Names.GetCharacters(name), name.Length);
+            switch (category)
+            {
+                case FileCategory::HEADER:
+                    index.HeaderFiles.push_back(file_index);
+                    break;
+                case FileCategory::CPP:
+                    index.CppFiles.push_back(file_index);
+                    break;
+                case FileCategory::OTHER:
+                    break;
+            }
+        }
+        return index;
+    }
+
+    /// Determines the category of a file from the extension in its filename.
+    /// Assumes the file extension occurs after the last dot in the filename.
+    /// Extensions are matched without regard to case, as on Windows, and without any allocations.
+    /// @param[in]  filename - The characters of the filename.
+    /// @param[in]  filename_length - The number of characters in the filename.
+    /// @return The category of the file.
+    static FileCategory Categorize(const char* filename, const std::size_t filename_length)
+    {
+        // FIND THE START OF THE FILE EXTENSION.
+        // Only short extensions can be in the lookup table, so only the end of the filename needs to be searched.
+        const char FILE_EXTENSION_SEPARATOR = '.';
+        std::size_t search_length = std::min(filename_length, MAX_FILE_EXTENSION_LENGTH + 1);
+        const char* filename_end = filename + filename_length;
+        const char* extension = nullptr;
+        for (const char* character = filename_end - 1; character >= filename_end - search_length; --character)
+        {
+            if (FILE_EXTENSION_SEPARATOR == *character)
+            {
+                extension = character + 1;
+                break;
+            }
+        }
+        if (!extension)
+        {
+            return FileCategory::OTHER;
+        }
+
+        // LOOK UP THE CATEGORY FOR THE FILE EXTENSION.
+        uint32_t extension_key = PackFileExtension(extension, static_cast<std::size_t>(filename_end - extension));
+        for (const auto& file_extension_category : FILE_EXTENSION_CATEGORIES)
+        {
+            if (file_extension_category.ExtensionKey == extension_key)
+            {
+                return file_extension_category.Category;
+            }
+        }
+        return FileCategory::OTHER;
+    }
+
+    /// Determines if a source file is C rather than C++ code, which compilers need to know to compile it correctly.
+    /// Extensions are matched without regard to case, as with Categorize.
+    /// @param[in]  path - The path of the file.
+    /// @return True if the file has a .c extension; false otherwise.
+    static bool IsCFile(const std::string& path)
+    {
+        const std::size_t C_FILE_EXTENSION_LENGTH = 2;
+        bool is_c_file = (
+            path.size() > C_FILE_EXTENSION_LENGTH &&
+            '.' == path[path.size() - 2] &&
+            ('c' == path.back() || 'C' == path.back()));
+        return is_c_file;
+    }
+
+    // MEMBER VARIABLES.
+    /// The indices of header files (.h, .hpp, .hxx, .inl).
+    std::vector<uint32_t> HeaderFiles = {};
+    /// The indices of source files that are compiled (.cpp, .cc, .cxx, .c).
+    std::vector<uint32_t> CppFiles = {};
+
+private:
+    /// The maximum length of a file extension (without the dot) in the lookup table.
+    static const std::size_t MAX_FILE_EXTENSION_LENGTH = 3;
+
+    /// The category for a file extension in the lookup table.
+    struct FileExtensionCategory
+    {
+        /// The lowercase file extension packed into an integer (see PackFileExtension).
+        uint32_t ExtensionKey;
+        /// The category of files with the extension.
+        FileCategory Category;
+    };
+
+    /// Packs a short file extension into an integer so that it can be compared in one operation.
+    /// Letters are converted to lowercase, and the length is included so that extensions with
+    /// trailing null characters can't collide with shorter ones.
+    /// @param[in]  extension - The file extension, without the leading dot.
+    /// @param[in]  length - The number of characters in the extension.
+    /// @return The packed extension, or zero if the extension is too long to be in the lookup table.
+    static constexpr uint32_t PackFileExtension(const char* extension, const std::size_t length)
+    {
+        return (length > MAX_FILE_EXTENSION_LENGTH) ? 0 : (
+            static_cast<uint32_t>(length) |
+            (length > 0 ? (ToLowercase(extension[0]) << 8) : 0) |
+            (length > 1 ? (ToLowercase(extension[1]) << 16) : 0) |
+            (length > 2 ? (ToLowercase(extension[2]) << 24) : 0));
+    }
+
+    /// Converts an ASCII letter to lowercase.
+    /// @param[in]  character - The character to convert.
+    /// @return The lowercase character as an integer, or the unchanged character if it isn't an uppercase letter.
+    static constexpr uint32_t ToLowercase(const char character)
+    {
+        return ('A' <= character && character <= 'Z') ?
+            static_cast<uint32_t>(character - 'A' + 'a') :
+            static_cast<uint32_t>(static_cast<unsigned char>(character));
+    }
+
+    /// The number of file extensions in the lookup table.
+    static const std::size_t FILE_EXTENSION_CATEGORY_COUNT = 8;
+    /// The lookup table of categories for file extensions.
+    static const FileExtensionCategory FILE_EXTENSION_CATEGORIES[FILE_EXTENSION_CATEGORY_COUNT];
+};
+
+const std::size_t CategorizedFileIndex::MAX_FILE_EXTENSION_LENGTH;
+const std::size_t CategorizedFileIndex::FILE_EXTENSION_CATEGORY_COUNT;
+const CategorizedFileIndex::FileExtensionCategory CategorizedFileIndex::FILE_EXTENSION_CATEGORIES[FILE_EXTENSION_CATEGORY_COUNT] =
+{
+    { PackFileExtension("h", 1), FileCategory::HEADER },
+    { PackFileExtension("hpp", 3), FileCategory::HEADER },
+    { PackFileExtension("hxx", 3), FileCategory::HEADER },
+    { PackFileExtension("inl", 3), FileCategory::HEADER },
+    { PackFileExtension("cpp", 3), FileCategory::CPP },
+    { PackFileExtension("cc", 2), FileCategory::CPP },
+    { PackFileExtension("cxx", 3), FileCategory::CPP },
+    { PackFileExtension("c", 1), FileCategory::CPP }
+};
+
+/// Generates the unique IDs (GUIDs) that identify projects in solution and project files.
+///
+/// Each ID is a name-based (version 5) UUID derived from the project's name, so a project always
+/// gets the same ID no matter when, where, or alongside which other projects it's generated,
+/// while different projects in the same solution get different IDs.
+class ProjectGuid
+{
+public:
+    /// Gets the ID for a project.
+    /// @param[in]  project_name - The name of the project.
+    /// @return The project's ID, formatted in braces as in Visual Studio files.
+    static std::string FromName(const std::string& project_name)
+    {
+        // HASH THE NAME WITHIN THE NAMESPACE FOR PROJECT IDS.
+        // The namespace is the ID that all generated projects used to share.
+        const uint8_t PROJECT_ID_NAMESPACE[] =
+        {
+            0x46, 0xD9, 0x9A, 0x72, 0x17, 0xAF, 0x4E, 0x62, 0x80, 0x9F, 0xEE, 0xCB, 0x63, 0x7F, 0x6E, 0xE1
+        };
+        std::string hashed_data(reinterpret_cast<const char*>(PROJECT_ID_NAMESPACE), sizeof(PROJECT_ID_NAMESPACE));
+        hashed_data += project_name;
+        uint8_t hash[SHA1_HASH_SIZE_IN_BYTES];
+        Sha1(hashed_data, hash);
+
+        // SET THE VERSION AND VARIANT OF THE ID.
+        const std::size_t VERSION_BYTE_INDEX = 6;
+        const uint8_t NAME_BASED_SHA1_VERSION = 0x50;
+        hash[VERSION_BYTE_INDEX] = static_cast<uint8_t>((hash[VERSION_BYTE_INDEX] & 0x0F) | NAME_BASED_SHA1_VERSION);
+        const std::size_t VARIANT_BYTE_INDEX = 8;
+        const uint8_t RFC_4122_VARIANT = 0x80;
+        hash[VARIANT_BYTE_INDEX] = static_cast<uint8_t>((hash[VARIANT_BYTE_INDEX] & 0x3F) | RFC_4122_VARIANT);
+
+        // FORMAT THE ID.
+        // Only the first 16 bytes of the hash are used, with dashes between the usual groups of bytes.
+        const char HEXADECIMAL_DIGITS[] = "0123456789ABCDEF";
+        const std::size_t GUID_SIZE_IN_BYTES = 16;
+        std::string guid = "{";
+        for (std::size_t byte_index = 0; byte_index < GUID_SIZE_IN_BYTES; ++byte_index)
+        {
+            bool dash_needed = (4 == byte_index || 6 == byte_index || 8 == byte_index || 10 == byte_index);
+            if (dash_needed)
+            {
+                guid += '-';
+            }
+            guid += HEXADECIMAL_DIGITS[hash[byte_index] >> 4];
+            guid += HEXADECIMAL_DIGITS[hash[byte_index] & 0x0F];
+        }
+        guid += '}';
+        return guid;
+    }
+
+private:
+    /// The size of a SHA-1 hash.
+    static const std::size_t SHA1_HASH_SIZE_IN_BYTES = 20;
+
+    /// Computes the SHA-1 hash of data, as required for name-based UUIDs.
+    /// @param[in]  data - The data to hash.
+    /// @param[out]  hash - The hash of the data.
+    static void Sha1(const std::string& data, uint8_t hash[SHA1_HASH_SIZE_IN_BYTES])
+    {
+        // PAD THE DATA TO A MULTIPLE OF THE BLOCK SIZE.
+        // The padding is a single set bit, zeros, and then the length of the data in bits.
+        const std::size_t BLOCK_SIZE_IN_BYTES = 64;
+        const std::size_t LENGTH_SIZE_IN_BYTES = 8;
+        std::string padded_data = data;
+        padded_data += static_cast<char>(0x80);
+        while ((padded_data.size() % BLOCK_SIZE_IN_BYTES) != (BLOCK_SIZE_IN_BYTES - LENGTH_SIZE_IN_BYTES))
+        {
+            padded_data += '\0';
+        }
+        uint64_t data_size_in_bits = static_cast<uint64_t>(data.size()) * 8;
+        for (int shift = 56; shift >= 0; shift -= 8)
+        {
+            padded_data += static_cast<char>((data_size_in_bits >> shift) & 0xFF);
+        }
+
+        // HASH EACH BLOCK.
+        auto rotate_left = [](const uint32_t value, const int bits)
+        {
+            return (value << bits) | (value >> (32 - bits));
+        };
+        uint32_t state[] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+        for (std::size_t block_offset = 0; block_offset < padded_data.size(); block_offset += BLOCK_SIZE_IN_BYTES)
+        {
+            // EXPAND THE BLOCK INTO THE MESSAGE SCHEDULE.
+            const std::size_t MESSAGE_SCHEDULE_WORD_COUNT = 80;
+            uint32_t words[MESSAGE_SCHEDULE_WORD_COUNT];
+            for (std::size_t word_index = 0; word_index < 16; ++word_index)
+            {
+                const uint8_t* word_bytes = reinterpret_cast<const uint8_t*>(padded_data.data() + block_offset + word_index * 4);
+                words[word_index] = (
+                    (static_cast<uint32_t>(word_bytes[0]) << 24) |
+                    (static_cast<uint32_t>(word_bytes[1]) << 16) |
+                    (static_cast<uint32_t>(word_bytes[2]) << 8) |
+                    static_cast<uint32_t>(word_bytes[3]));
+            }
+            for (std::size_t word_index = 16; word_index < MESSAGE_SCHEDULE_WORD_COUNT; ++word_index)
+            {
+                words[word_index] = rotate_left(words[word_index - 3] ^ words[word_index - 8] ^ words[word_index - 14] ^ words[word_index - 16], 1);
+            }
+
+            // RUN THE COMPRESSION ROUNDS.
+            uint32_t a = state[0];
+            uint32_t b = state[1];
+            uint32_t c = state[2];
+            uint32_t d = state[3];
+            uint32_t e = state[4];
+            for (std::size_t round_index = 0; round_index < MESSAGE_SCHEDULE_WORD_COUNT; ++round_index)
+            {
+                uint32_t mixed_bits = 0;
+                uint32_t round_constant = 0;
+                if (round_index < 20)
+                {
+                    mixed_bits = (b & c) | (~b & d);
+                    round_constant = 0x5A827999;
+                }
+                else if (round_index < 40)
+                {
+                    mixed_bits = b ^ c ^ d;
+                    round_constant = 0x6ED9EBA1;
+                }
+                else if (round_index < 60)
+                {
+                    mixed_bits = (b & c) | (b & d) | (c & d);
+                    round_constant = 0x8F1BBCDC;
+                }
+                else
+                {
+                    mixed_bits = b ^ c ^ d;
+                    round_constant = 0xCA62C1D6;
+                }
+                uint32_t temp = rotate_left(a, 5) + mixed_bits + e + round_constant + words[round_index];
+                e = d;
+                d = c;
+                c = rotate_left(b, 30);
+                b = a;
+                a = temp;
+            }
+            state[0] += a;
+            state[1] += b;
+            state[2] += c;
+            state[3] += d;
+            state[4] += e;
+        }
+
+        // OUTPUT THE HASH.
+        for (std::size_t byte_index = 0; byte_index < SHA1_HASH_SIZE_IN_BYTES; ++byte_index)
+        {
+            hash[byte_index] = static_cast<uint8_t>(state[byte_index / 4] >> (24 - 8 * (byte_index % 4)));
+        }
+    }
+};
+
+const std::size_t ProjectGuid::SHA1_HASH_SIZE_IN_BYTES;
+
+/// A project to generate files for.
+struct Project
+{
+    /// The name of the project.
+    std::string Name = "";
+    /// The unique ID of the project (see ProjectGuid).
+    std::string Guid = "";
+    /// The relative path to the folder containing all code for the project.
+    std::string CodeFolderPath = "";
+    /// The filename of the build script for the project, which is in the current folder.
+    std::string BuildScriptFilename = "";
+    /// The command line that Visual Studio runs to build the project.
+    std::string BuildCommandLine = "";
+    /// The path of the program that the build command line builds, relative to the current folder.
+    std::string ProgramPath = "";
+    /// The filenames of additional .cpp files to include in the project that are
+    /// directly in the current folder rather than in the code folder.
+    std::vector<std::string> ProjectFolderCppFilenames = {};
+    /// The tree containing the project's code folder.  The tree may be shared with other projects
+    /// whose code folders contain (or are within) this project's code folder.
+    const FolderTree* CodeFolderTree = nullptr;
+    /// The index of the project's code folder within its tree.
+    uint32_t CodeFolderIndex = 0;
+    /// The index just past the last folder in the project's code folder tree whose files are in the project, or NO_INDEX
+    /// if all folders within its code folder are.  Only parts of split projects (see ProjectPartition) end early.
+    uint32_t CodeFolderEndIndex = FolderTree::NO_INDEX;
+    /// The name of the project that this project is a part of, if that project was split into several projects
+    /// (see ProjectPartition).  Empty if this project isn't a part of another project.
+    std::string WholeProjectName = "";
+    /// The code files in the project's code folder.
+    CategorizedFileIndex CodeFiles = {};
+    /// The index within the project's source files (CodeFiles.CppFiles) of the first file in each
+    /// unity build shard (see UnityBuild).  Empty if the project's files aren't split into shards.
+    std::vector<std::size_t> UnityShardStartIndices = {};
+    /// How each header to precompile is included (see PrecompiledHeader), with quotes or angle brackets,
+    /// in the order to include them.  Empty if headers aren't precompiled for the project.
+    std::vector<std::string> PrecompiledHeaderIncludes = {};
+    /// The filename of the manifest of fingerprints of the project's code files and translation units (see FingerprintManifest),
+    /// which is in the current folder.  Empty if fingerprints aren't written for the project.
+    std::string FingerprintManifestFilename = "";
+    /// The path and fingerprint of each code file that the project's translation units depend on: every file they include,
+    /// directly or indirectly, followed by the source files that nothing includes.  Empty until the files are fingerprinted.
+    std::vector<std::pair<std::string, uint64_t>> CodeFileFingerprints = {};
+    /// The fingerprint of the precompiled header, or 0 if headers aren't precompiled or the files aren't fingerprinted yet.
+    uint64_t PrecompiledHeaderFingerprint = 0;
+    /// The fingerprint of each translation unit, in the same order as ProjectFolderCppFilenames.  Empty until the files
+    /// are fingerprinted.
+    std::vector<uint64_t> TranslationUnitFingerprints = {};
+    /// The measured time to compile each source file in microseconds (see CompileProfile), in the same order as CodeFiles.CppFiles,
+    /// or 0 if a file's time wasn't measured.  Empty if no compile times are known for the project.
+    std::vector<uint64_t> CppFileCompileTimes = {};
+    /// The measured time to compile each file in ProjectFolderCppFilenames in microseconds, in the same order,
+    /// or 0 if a file's time wasn't measured.  Empty if no compile times are known for the project.
+    std::vector<uint64_t> ProjectFolderCppFileCompileTimes = {};
+};
+
+/// A file listing several projects to generate together in a single solution.
+///
+/// Each non-empty line of the file names a project and its code folder:
+///     <ProjectName> <CodeFolderRelativePath>
+/// The code folder path is everything after the whitespace following the project name, so it may contain spaces.
+/// Lines starting with # are comments.
+class ProjectManifest
+{
+public:
+    /// Loads the projects from a manifest file.  Any problems are reported to standard error.
+    /// @param[in]  manifest_path - The path of the manifest file.
+    /// @param[out]  projects - The projects in the manifest, in the same order.
+    /// @return True if the manifest was loaded; false otherwise.
+    static bool Load(const std::string& manifest_path, std::vector<RequestedProject>& projects)
+    {
+        // READ THE MANIFEST FILE.
+        MemoryMappedFile manifest_file;
+        bool manifest_file_read = manifest_file.Open(DirectoryListing::ToNativePath(manifest_path));
+        if (!manifest_file_read)
+        {
+            std::cerr << "Failed to read manifest " << manifest_path << std::endl;
+            return false;
+        }
+
+        // READ EACH PROJECT FROM THE MANIFEST.
+        const char* WHITESPACE = " \t\r";
+        std::string manifest_text(manifest_file.Data ? manifest_file.Data : "", manifest_file.Size);
+        std::size_t line_number = 0;
+        for (std::size_t line_start = 0; line_start < manifest_text.size();)
+        {
+            // GET THE NEXT LINE.
+            std::size_t line_end = manifest_text.find('\n', line_start);
+            if (std::string::npos == line_end)
+            {
+                line_end = manifest_text.size();
+            }
+            std::string line = manifest_text.substr(line_start, line_end - line_start);
+            line_start = line_end + 1;
+            ++line_number;
+
+            // SKIP LINES WITHOUT PROJECTS.
+            std::size_t name_start = line.find_first_not_of(WHITESPACE);
+            bool line_empty = (std::string::npos == name_start);
+            if (line_empty)
+            {
+                continue;
+            }
+            const char COMMENT_START = '#';
+            bool line_is_comment = (COMMENT_START == line[name_start]);
+            if (line_is_comment)
+            {
+                continue;
+            }
+
+            // READ THE PROJECT NAME AND CODE FOLDER PATH.
+            std::size_t name_end = line.find_first_of(WHITESPACE, name_start);
+            std::size_t path_start = (std::string::npos == name_end) ? std::string::npos : line.find_first_not_of(WHITESPACE, name_end);
+            bool path_provided = (std::string::npos != path_start);
+            if (!path_provided)
+            {
+                std::cerr << manifest_path << "(" << line_number << "): Missing code folder path for project" << std::endl;
+                return false;
+            }
+            std::size_t path_end = line.find_last_not_of(WHITESPACE) + 1;
+
+            RequestedProject project;
+            project.Name = line.substr(name_start, name_end - name_start);
+            project.CodeFolderPath = DirectoryListing::ToProjectPath(line.substr(path_start, path_end - path_start));
+
+            // MAKE SURE THE PROJECT IS UNIQUE.
+            // Projects with the same name would overwrite each other's files.
+            bool duplicate_project = std::any_of(
+                projects.cbegin(),
+                projects.cend(),
+                [&project](const RequestedProject& existing_project) { return existing_project.Name == project.Name; });
+            if (duplicate_project)
+            {
+                std::cerr << manifest_path << "(" << line_number << "): Duplicate project " << project.Name << std::endl;
+                return false;
+            }
+            projects.push_back(project);
+        }
+
+        bool projects_found = !projects.empty();
+        if (!projects_found)
+        {
+            std::cerr << "No projects in manifest " << manifest_path << std::endl;
+        }
+        return projects_found;
+    }
+};
+
+/// Scans the code folders for a set of projects, sharing a single scan among projects whose code folders overlap.
+/// Only the outermost code folders are scanned, and projects with code folders inside them use the
+/// corresponding subtrees of their scans.  A folder that was already scanned before (such as by an earlier
+/// request to a server, or in a scan cache) is only rescanned, listing just the folders that changed since then.
+class ProjectCodeFolders
+{
+public:
+    /// Scans the code folders for projects.
+    /// @param[in]  ignore_settings - The settings for which files and folders to leave out.
+    /// @param[in]  git_index_use - How to use the git index to find the files in each code folder.
+    ///     Previous scans are only reused if it isn't used, since the folders in trees from the index weren't listed.
+    /// @param[in]  thread_count - The number of threads to use for scanning.
+    ///     Zero uses one thread per hardware core.
+    /// @param[in,out]  previous_trees - Trees from previous scans with the same ignore settings.  Any that are
+    ///     rescanned are removed.
+    /// @param[in,out]  projects - The projects whose code folders to scan.  Each project's code folder tree and
+    ///     index are set, except for projects that already have a tree (such as one built from a list of files).
+    /// @return The scanned trees, which the projects refer to.  Folder paths are built for each tree.
+    static std::vector<std::unique_ptr<FolderTree>> Scan(
+        const IgnoreSettings& ignore_settings,
+        const GitIndexUse git_index_use,
+        const unsigned int thread_count,
+        std::vector<std::unique_ptr<FolderTree>>& previous_trees,
+        std::vector<Project>& projects)
+    {
+        // ORDER THE PROJECTS BY CODE FOLDER PATH.
+        // This puts containing folders before any folders within them.
+        std::vector<Project*> projects_by_path;
+        for (auto& project : projects)
+        {
+            if (!project.CodeFolderTree)
+            {
+                projects_by_path.push_back(&project);
+            }
+        }
+        std::sort(
+            projects_by_path.begin(),
+            projects_by_path.end(),
+            [](const Project* left, const Project* right) { return left->CodeFolderPath < right->CodeFolderPath; });
+
+        // FIND THE CODE FOLDER FOR EACH PROJECT.
+        // Each folder is scanned with all threads, since the scan itself is parallel.
+        std::vector<std::unique_ptr<FolderTree>> trees;
+        for (Project* project : projects_by_path)
+        {
+            // USE AN EXISTING SCAN IF THE CODE FOLDER IS WITHIN IT.
+            for (const auto& tree : trees)
+            {
+                bool code_folder_found = FindCodeFolder(*tree, *project);
+                if (code_folder_found)
+                {
+                    break;
+                }
+            }
+            if (project->CodeFolderTree)
+            {
+                continue;
+            }
+
+            // RESCAN THE CODE FOLDER IF IT WAS SCANNED BEFORE.
+            const uint32_t ROOT_FOLDER_INDEX = 0;
+            bool previous_trees_reusable = (GitIndexUse::NONE == git_index_use);
+            auto previous_tree = std::find_if(
+                previous_trees.begin(),
+                previous_trees.end(),
+                [project](const std::unique_ptr<FolderTree>& tree)
+                {
+                    std::string root_folder_path;
+                    tree->AppendFolderPath(ROOT_FOLDER_INDEX, root_folder_path);
+                    return (project->CodeFolderPath == root_folder_path);
+                });
+            bool previously_scanned = (previous_trees_reusable && previous_trees.end() != previous_tree);
+            if (previously_scanned)
+            {
+                FolderTree& tree = **previous_tree;
+                std::vector<uint8_t> changed_folders = FolderTree::FindChangedFolders(thread_count, tree);
+                tree = FolderTree::Rescan(thread_count, changed_folders, tree, nullptr);
+                trees.push_back(std::move(*previous_tree));
+                previous_trees.erase(previous_tree);
+            }
+            else
+            {
+                // SCAN THE CODE FOLDER.
+                trees.emplace_back(new FolderTree(GitIndex::GetFolderTree(project->CodeFolderPath, ignore_settings, git_index_use, thread_count)));
+            }
+            trees.back()->BuildFolderPaths();
+            project->CodeFolderTree = trees.back().get();
+            project->CodeFolderIndex = ROOT_FOLDER_INDEX;
+        }
+        return trees;
+    }
+
+private:
+    /// Finds a project's code folder within a tree.
+    /// @param[in]  tree - The tree to search.
+    /// @param[in,out]  project - The project whose code folder to find.  If the code folder
+    ///     is found, the project's code folder tree and index are set.
+    /// @return True if the code folder was found in the tree; false otherwise.
+    static bool FindCodeFolder(const FolderTree& tree, Project& project)
+    {
+        // CHECK IF THE CODE FOLDER IS WITHIN THE TREE'S ROOT FOLDER.
+        const uint32_t ROOT_FOLDER_INDEX = 0;
+        std::string root_folder_path;
+        tree.AppendFolderPath(ROOT_FOLDER_INDEX, root_folder_path);
+        bool code_folder_is_root = (project.CodeFolderPath == root_folder_path);
+        std::string root_folder_prefix = root_folder_path + PATH_SEPARATOR;
+        bool code_folder_within_root = (0 == project.CodeFolderPath.compare(0, root_folder_prefix.size(), root_folder_prefix));
+        if (!code_folder_is_root && !code_folder_within_root)
+        {
+            return false;
+        }
+
+        // FIND EACH FOLDER ALONG THE PATH TO THE CODE FOLDER.
+        uint32_t folder_index = ROOT_FOLDER_INDEX;
+        std::size_t name_start = code_folder_within_root ? root_folder_prefix.size() : project.CodeFolderPath.size();
+        while (FolderTree::NO_INDEX != folder_index && name_start < project.CodeFolderPath.size())
+        {
+            std::size_t name_end = project.CodeFolderPath.find(PATH_SEPARATOR, name_start);
+            if (std::string::npos == name_end)
+            {
+                name_end = project.CodeFolderPath.size();
+            }
+            folder_index = tree.FindSubfolder(folder_index, project.CodeFolderPath.substr(name_start, name_end - name_start));
+            name_start = name_end + PATH_SEPARATOR.size();
+        }
+        bool code_folder_found = (FolderTree::NO_INDEX != folder_index);
+        if (code_folder_found)
+        {
+            project.CodeFolderTree = &tree;
+            project.CodeFolderIndex = folder_index;
+        }
+        return code_folder_found;
+    }
+};
+
+/// Splits a project's source files across several "unity" (single translation unit) build files, or shards,
+/// so that the project can be compiled in parallel instead of as one huge translation unit.
+///
+/// Each shard is a contiguous range of the project's source files in folder order, so related files stay
+/// together, and the ranges are balanced by file size, since larger files generally take longer to compile.
+/// Any change to which files are in a shard requires recompiling the whole shard, so the shards from the
+/// previous run (read back from the existing shard files) are kept as long as they're still reasonably
+/// balanced.  Adding or removing a file then only changes the shard it's in.
+///
+/// C files can't be compiled as C++, so the shards skip them, and they're all included in a separate C shard instead.
+class UnityBuild
+{
+public:
+    /// Gets the filename of a shard, which is in the current folder.
+    /// @param[in]  project_name - The name of the project the shard is for.
+    /// @param[in]  shard_index - The index of the shard.
+    /// @return The filename of the shard.
+    static std::string GetShardFilename(const std::string& project_name, const std::size_t shard_index)
+    {
+        return project_name + "_Unity" + std::to_string(shard_index + 1) + CPP_FILE_EXTENSION;
+    }
+
+    /// Gets the filename of the shard that includes a project's C files, which is in the current folder.
+    /// @param[in]  project_name - The name of the project the shard is for.
+    /// @return The filename of the C shard.
+    static std::string GetCShardFilename(const std::string& project_name)
+    {
+        return project_name + "_UnityC.c";
+    }
+
+    /// Splits a project's source files into shards.
+    /// @param[in]  thread_count - The number of threads to use for getting file sizes.
+    ///     Zero uses one thread per hardware core.
+    /// @param[in]  shard_count - The number of shards to split the files into.  Shards will be
+    ///     empty if there are fewer files than shards.
+    /// @param[in,out]  project - The project to split, whose code files must already be categorized.
+    ///     Its unity shard start indices are set, and its project folder source files are set to the shards,
+    ///     followed by the C shard if the project has any C files.
+    static void Partition(const unsigned int thread_count, const std::size_t shard_count, Project& project)
+    {
+        const bool IS_PHASE = true;
+        TraceSpan partition_span("partition unity shards", &project.Name, IS_PHASE);
+
+        // GET THE PATHS OF THE SOURCE FILES.
+        const FolderTree& code_folder = *project.CodeFolderTree;
+        const std::vector<uint32_t>& cpp_files = project.CodeFiles.CppFiles;
+        std::vector<std::string> cpp_file_paths(cpp_files.size());
+        for (std::size_t cpp_file_index = 0; cpp_file_index < cpp_files.size(); ++cpp_file_index)
+        {
+            code_folder.AppendFilePath(cpp_files[cpp_file_index], cpp_file_paths[cpp_file_index]);
+        }
+
+        // LIST THE SHARDS.
+        // Any compile times measured for the C shard are lost if it's new, which only affects build ordering.
+        project.ProjectFolderCppFilenames.clear();
+        for (std::size_t shard_index = 0; shard_index < shard_count; ++shard_index)
+        {
+            project.ProjectFolderCppFilenames.push_back(GetShardFilename(project.Name, shard_index));
+        }
+        bool c_files_found = std::any_of(cpp_file_paths.cbegin(), cpp_file_paths.cend(), CategorizedFileIndex::IsCFile);
+        if (c_files_found)
+        {
+            project.ProjectFolderCppFilenames.push_back(GetCShardFilename(project.Name));
+        }
+        bool project_folder_cpp_file_compile_times_known = !project.ProjectFolderCppFileCompileTimes.empty();
+        if (project_folder_cpp_file_compile_times_known)
+        {
+            project.ProjectFolderCppFileCompileTimes.resize(project.ProjectFolderCppFilenames.size(), 0);
+        }
+
+        // SPLIT THE FILES INTO BALANCED SHARDS.
+        // C files are in the C shard rather than the shard whose range they're in, so they don't count towards its weight.
+        std::vector<uint64_t> weights = GetWeights(thread_count, cpp_file_paths, project.CppFileCompileTimes);
+        for (std::size_t cpp_file_index = 0; cpp_file_index < cpp_files.size(); ++cpp_file_index)
+        {
+            bool is_c_file = CategorizedFileIndex::IsCFile(cpp_file_paths[cpp_file_index]);
+            if (is_c_file)
+            {
+                weights[cpp_file_index] = 0;
+            }
+        }
+        std::vector<std::size_t> balanced_shard_start_indices = Balance(weights, shard_count);
+
+        // KEEP THE PREVIOUS SHARDS IF THEY'RE STILL BALANCED WELL ENOUGH.
+        // How balanced shards are is measured by the largest shard, since it determines how long compiling all of them takes.
+        std::vector<std::size_t> previous_shard_start_indices = FindPreviousShardStartIndices(project.Name, shard_count, cpp_file_paths);
+        bool previous_shards_found = !previous_shard_start_indices.empty();
+        if (previous_shards_found)
+        {
+            const uint64_t MAX_LARGEST_SHARD_WEIGHT_PERCENT_OF_BALANCED = 125;
+            const uint64_t PERCENT = 100;
+            uint64_t previous_largest_shard_weight = GetLargestShardWeight(weights, previous_shard_start_indices);
+            uint64_t balanced_largest_shard_weight = GetLargestShardWeight(weights, balanced_shard_start_indices);
+            bool previous_shards_balanced = (
+                previous_largest_shard_weight * PERCENT <= balanced_largest_shard_weight * MAX_LARGEST_SHARD_WEIGHT_PERCENT_OF_BALANCED);
+            if (previous_shards_balanced)
+            {
+                project.UnityShardStartIndices = previous_shard_start_indices;
+                return;
+            }
+        }
+        project.UnityShardStartIndices = balanced_shard_start_indices;
+    }
+
+private:
+    /// Gets the weight of each source file, which is an estimate of how long it takes to compile.
+    /// @param[in]  thread_count - The number of threads to use if files have to be examined one call at a time.
+    ///     Zero uses one thread per hardware core.
+    /// @param[in]  file_paths - The paths of the files.
+    /// @param[in]  compile_times - The measured time to compile each file (see CompileProfile), in the same order
+    ///     as the paths, with 0 for files whose time wasn't measured.  May be empty if no times were measured.
+    /// @return The weight of each file, in the same order as the paths.
+    static std::vector<uint64_t> GetWeights(
+        const unsigned int thread_count,
+        const std::vector<std::string>& file_paths,
+        const std::vector<uint64_t>& compile_times)
+    {
+        // GET THE SIZE OF EACH FILE.
+        std::vector<uint64_t> sizes_in_bytes;
+        std::vector<uint64_t> modification_times;
+        FileMetadataReader::Read(
+            thread_count,
+            file_paths.size(),
+            [&file_paths](const std::size_t file_index, std::string& path) { path.append(file_paths[file_index]); },
+            sizes_in_bytes,
+            modification_times);
+
+        // WEIGH EACH FILE BY ITS SIZE.
+        // Every file has some fixed cost regardless of its size, which also keeps
+        // empty files (or files that can't be examined) from being free.
+        const uint64_t FIXED_WEIGHT_PER_FILE = 1024;
+        std::vector<uint64_t> weights(file_paths.size(), 0);
+        for (std::size_t file_index = 0; file_index < file_paths.size(); ++file_index)
+        {
+            weights[file_index] = FIXED_WEIGHT_PER_FILE + sizes_in_bytes[file_index];
+        }
+
+        // WEIGH FILES BY THEIR MEASURED COMPILE TIMES IF KNOWN.
+        // Files without measurements are estimated from their sizes at the average rate that measured files compiled,
+        // so that both kinds of weights are in the same units.
+        bool compile_times_known = (compile_times.size() == file_paths.size());
+        if (!compile_times_known)
+        {
+            return weights;
+        }
+        uint64_t total_measured_compile_time = 0;
+        uint64_t total_measured_size_weight = 0;
+        for (std::size_t file_index = 0; file_index < file_paths.size(); ++file_index)
+        {
+            bool compile_time_measured = (compile_times[file_index] > 0);
+            if (compile_time_measured)
+            {
+                total_measured_compile_time += compile_times[file_index];
+                total_measured_size_weight += weights[file_index];
+            }
+        }
+        bool any_compile_time_measured = (total_measured_compile_time > 0);
+        if (!any_compile_time_measured)
+        {
+            return weights;
+        }
+        double compile_time_per_size_weight = static_cast<double>(total_measured_compile_time) / static_cast<double>(total_measured_size_weight);
+        for (std::size_t file_index = 0; file_index < file_paths.size(); ++file_index)
+        {
+            bool compile_time_measured = (compile_times[file_index] > 0);
+            if (compile_time_measured)
+            {
+                weights[file_index] = compile_times[file_index];
+            }
+            else
+            {
+                const uint64_t MIN_WEIGHT = 1;
+                uint64_t estimated_compile_time = static_cast<uint64_t>(static_cast<double>(weights[file_index]) * compile_time_per_size_weight);
+                weights[file_index] = std::max(MIN_WEIGHT, estimated_compile_time);
+            }
+        }
+        return weights;
+    }
+
+    /// Splits files into contiguous shards of roughly equal weight.
+    /// @param[in]  weights - The weight of each file.
+    /// @param[in]  shard_count - The number of shards.
+    /// @return The index of the first file in each shard.
+    static std::vector<std::size_t> Balance(const std::vector<uint64_t>& weights, const std::size_t shard_count)
+    {
+        uint64_t remaining_weight = 0;
+        for (uint64_t weight : weights)
+        {
+            remaining_weight += weight;
+        }
+
+        std::vector<std::size_t> shard_start_indices;
+        std::size_t file_index = 0;
+        for (std::size_t shard_index = 0; shard_index < shard_count; ++shard_index)
+        {
+            // FILL THE SHARD UNTIL IT'S AS CLOSE AS POSSIBLE TO ITS SHARE OF THE REMAINING WEIGHT.
+            // Each shard gets at least one file, if there are enough, and the last shard gets all remaining files.
+            shard_start_indices.push_back(file_index);
+            std::size_t remaining_shard_count = shard_count - shard_index;
+            uint64_t target_shard_weight = remaining_weight / remaining_shard_count;
+            uint64_t shard_weight = 0;
+            bool is_last_shard = (1 == remaining_shard_count);
+            for (; file_index < weights.size(); ++file_index)
+            {
+                bool shard_empty = (shard_start_indices.back() == file_index);
+                if (!is_last_shard && !shard_empty)
+                {
+                    std::size_t remaining_file_count = weights.size() - file_index;
+                    bool files_needed_for_later_shards = (remaining_file_count < remaining_shard_count);
+                    bool target_reached = (shard_weight >= target_shard_weight);
+                    uint64_t weight_with_file = shard_weight + weights[file_index];
+                    bool closer_to_target_without_file = (
+                        !target_reached &&
+                        weight_with_file > target_shard_weight &&
+                        weight_with_file - target_shard_weight > target_shard_weight - shard_weight);
+                    if (files_needed_for_later_shards || target_reached || closer_to_target_without_file)
+                    {
+                        break;
+                    }
+                }
+                shard_weight += weights[file_index];
+            }
+            remaining_weight -= shard_weight;
+        }
+        return shard_start_indices;
+    }
+
+    /// Gets the weight of the largest shard.
+    /// @param[in]  weights - The weight of each file.
+    /// @param[in]  shard_start_indices - The index of the first file in each shard.
+    /// @return The total weight of the files in the largest shard.
+    static uint64_t GetLargestShardWeight(const std::vector<uint64_t>& weights, const std::vector<std::size_t>& shard_start_indices)
+    {
+        uint64_t largest_shard_weight = 0;
+        for (std::size_t shard_index = 0; shard_index < shard_start_indices.size(); ++shard_index)
+        {
+            bool is_last_shard = (shard_index + 1 == shard_start_indices.size());
+            std::size_t end_file_index = is_last_shard ? weights.size() : shard_start_indices[shard_index + 1];
+            uint64_t shard_weight = 0;
+            for (std::size_t file_index = shard_start_indices[shard_index]; file_index < end_file_index; ++file_index)
+            {
+                shard_weight += weights[file_index];
+            }
+            largest_shard_weight = std::max(largest_shard_weight, shard_weight);
+        }
+        return largest_shard_weight;
+    }
+
+    /// Finds where the shards from the previous run start among the current files.  Each previous shard
+    /// starts at its first file that still exists, and files added in between previous shards go in the
+    /// earlier shard, so only shards whose files were added or removed change.
+    /// @param[in]  project_name - The name of the project the shards are for.
+    /// @param[in]  shard_count - The number of shards.
+    /// @param[in]  file_paths - The paths of the current files.
+    /// @return The index of the first file in each previous shard, or nothing if the previous shards
+    ///     couldn't be read or no longer make sense for the current files.
+    static std::vector<std::size_t> FindPreviousShardStartIndices(
+        const std::string& project_name,
+        const std::size_t shard_count,
+        const std::vector<std::string>& file_paths)
+    {
+        std::unordered_map<std::string, std::size_t> file_indices_by_path;
+        for (std::size_t file_index = 0; file_index < file_paths.size(); ++file_index)
+        {
+            file_indices_by_path.emplace(file_paths[file_index], file_index);
+        }
+
+        std::vector<std::size_t> shard_start_indices;
+        for (std::size_t shard_index = 0; shard_index < shard_count; ++shard_index)
+        {
+            // READ THE PREVIOUS SHARD FILE.
+            MemoryMappedFile shard_file;
+            bool shard_file_read = shard_file.Open(GetShardFilename(project_name, shard_index));
+            if (!shard_file_read)
+            {
+                return {};
+            }
+
+            // FIND THE FIRST INCLUDED FILE THAT STILL EXISTS.
+            const std::string INCLUDE_PREFIX = "#include \"";
+            std::size_t shard_start_index = file_paths.size();
+            const char* line = shard_file.Data;
+            const char* shard_file_end = shard_file.Data + shard_file.Size;
+            while (line < shard_file_end)
+            {
+                const char* line_end = std::find(line, shard_file_end, '\n');
+                std::size_t line_length = static_cast<std::size_t>(line_end - line);
+                bool is_include = (line_length > INCLUDE_PREFIX.size() && 0 == INCLUDE_PREFIX.compare(0, INCLUDE_PREFIX.size(), line, INCLUDE_PREFIX.size()));
+                if (is_include)
+                {
+                    const char* path_start = line + INCLUDE_PREFIX.size();
+                    const char* path_end = std::find(path_start, line_end, '"');
+                    auto file_index = file_indices_by_path.find(DirectoryListing::ToProjectPath(std::string(path_start, path_end)));
+                    bool file_exists = (file_indices_by_path.cend() != file_index);
+                    if (file_exists)
+                    {
+                        shard_start_index = file_index->second;
+                        break;
+                    }
+                }
+                line = line_end + 1;
+            }
+
+            // MAKE SURE THE SHARD STILL FOLLOWS THE PREVIOUS SHARD.
+            // Shards whose files are all gone (or that are out of order) mean the shards have to be rebalanced.
+            bool shard_start_found = (shard_start_index < file_paths.size());
+            bool shard_start_in_order = shard_start_indices.empty() || (shard_start_indices.back() < shard_start_index);
+            if (!shard_start_found || !shard_start_in_order)
+            {
+                return {};
+            }
+            shard_start_indices.push_back(shard_start_index);
+        }
+
+        // MAKE SURE ALL FILES ARE IN A SHARD.
+        // Files before the first previous shard's files must have been added since, so they go in the first shard.
+        if (!shard_start_indices.empty())
+        {
+            shard_start_indices.front() = 0;
+        }
+        return shard_start_indices;
+    }
+};
+
+/// Finds the #include directives in C++ code without preprocessing it.  Directives are found wherever
+/// they appear, including within conditionally compiled code and after #pragma once or include guards,
+/// which is accurate enough for finding out which headers are widely used.
+class IncludeScanner
+{
+public:
+    /// An #include directive.
+    struct Include
+    {
+        /// The path of the included file, as written in the directive.
+        std::string Path;
+        /// True if the path was in angle brackets (<path>); false if it was in quotes ("path").
+        bool IsAngled;
+        /// True if a macro was included rather than a literal path, in which case the path is the macro's name
+        /// and which file is included can't be known without preprocessing.
+        bool IsMacro;
+    };
+
+    /// Finds all #include directives in code.
+    /// @param[in]  code - The characters of the code.
+    /// @param[in]  code_size - The number of characters in the code.
+    /// @param[out]  includes - The directives found, in the order they appear, appended to any existing ones.
+    static void Scan(const char* code, const std::size_t code_size, std::vector<Include>& includes)
+    {
+        // FIND EACH PREPROCESSOR DIRECTIVE.
+        // memchr() is vectorized by standard libraries, so most of the code is skipped without looking at each character.
+        const char* code_end = code + code_size;
+        const char* search_start = code;
+        while (search_start < code_end)
+        {
+            const char* directive_start = static_cast<const char*>(std::memchr(search_start, '#', static_cast<std::size_t>(code_end - search_start)));
+            if (!directive_start)
+            {
+                break;
+            }
+            search_start = directive_start + 1;
+
+            // MAKE SURE THE DIRECTIVE STARTS ITS LINE.
+            // Only whitespace may come before it, which skips # characters within code, strings, and line comments.
+            const char* line_character = directive_start;
+            while (line_character > code && IsSpace(line_character[-1]))
+            {
+                --line_character;
+            }
+            bool directive_starts_line = (line_character == code || '\n' == line_character[-1]);
+            if (!directive_starts_line)
+            {
+                continue;
+            }
+
+            // CHECK IF THE DIRECTIVE IS AN INCLUDE.
+            const char* directive_name = SkipSpaces(directive_start + 1, code_end);
+            const std::string INCLUDE_DIRECTIVE_NAME = "include";
+            bool is_include = (
+                static_cast<std::size_t>(code_end - directive_name) > INCLUDE_DIRECTIVE_NAME.size() &&
+                0 == INCLUDE_DIRECTIVE_NAME.compare(0, INCLUDE_DIRECTIVE_NAME.size(), directive_name, INCLUDE_DIRECTIVE_NAME.size()));
+            if (!is_include)
+            {
+                continue;
+            }
+
+            // READ THE INCLUDED PATH.
+            // Includes of macros rather than literal paths are reported by the macro's name.
+            const char* path_delimiter = SkipSpaces(directive_name + INCLUDE_DIRECTIVE_NAME.size(), code_end);
+            bool is_quoted = (path_delimiter < code_end && '"' == *path_delimiter);
+            bool is_angled = (path_delimiter < code_end && '<' == *path_delimiter);
+            if (!is_quoted && !is_angled)
+            {
+                const char* macro_end = path_delimiter;
+                while (macro_end < code_end && ('_' == *macro_end || std::isalnum(static_cast<unsigned char>(*macro_end))))
+                {
+                    ++macro_end;
+                }
+                if (macro_end > path_delimiter)
+                {
+                    const bool IS_ANGLED = false;
+                    const bool IS_MACRO = true;
+                    includes.push_back({ std::string(path_delimiter, macro_end), IS_ANGLED, IS_MACRO });
+                }
+                continue;
+            }
+            const char CLOSING_DELIMITER = is_angled ? '>' : '"';
+            const char* path_start = path_delimiter + 1;
+            const char* path_end = path_start;
+            while (path_end < code_end && CLOSING_DELIMITER != *path_end && '\n' != *path_end)
+            {
+                ++path_end;
+            }
+            bool path_closed = (path_end < code_end && CLOSING_DELIMITER == *path_end);
+            if (path_closed && path_end > path_start)
+            {
+                const bool IS_MACRO = false;
+                includes.push_back({ std::string(path_start, path_end), is_angled, IS_MACRO });
+            }
+            search_start = path_end;
+        }
+    }
+
+private:
+    /// Determines if a character is whitespace within a line.
+    /// @param[in]  character - The character to check.
+    /// @return True if the character is a space or tab; false otherwise.
+    static bool IsSpace(const char character)
+    {
+        return (' ' == character || '\t' == character);
+    }
+
+    /// Skips whitespace within a line.
+    /// @param[in]  character - The first character to check.
+    /// @param[in]  end - The end of the characters.
+    /// @return The first character that isn't a space or tab.
+    static const char* SkipSpaces(const char* character, const char* end)
+    {
+        while (character < end && IsSpace(*character))
+        {
+            ++character;
+        }
+        return character;
+    }
+};
+
+/// Which files a project's files include, directly and indirectly.
+///
+/// Every header in the project is a node in the graph, as is every header included with angle brackets that
+/// isn't in the project (such as standard library and platform headers), since those are often the most
+/// expensive headers to compile.  Includes are resolved the way the generated build script's compiler would:
+/// quoted paths relative to the including file's folder first, and then all paths relative to the code folder
+/// and then each folder in the INCLUDE environment variable (which the build script's compiler also searches).
+/// Any other file that's found (such as an .inc file, or a header outside the code folder) is a node as well,
+/// and is scanned in turn, so that everything a translation unit depends on is in the graph, though only the
+/// project's headers and the headers it includes with angle brackets can be precompiled.  Quoted includes that
+/// can't be resolved (such as generated files) aren't part of the graph.
+class IncludeGraph
+{
+public:
+    /// Builds the include graph for a project by scanning all of its code files in parallel, and then scanning
+    /// the other files they include the same way until every file that's included has been scanned.
+    /// @param[in]  thread_count - The number of threads to use.  Zero uses one thread per hardware core.
+    /// @param[in]  project - The project, whose code files must already be categorized.  If its files aren't
+    ///     split into unity build shards, the .cpp files in the current folder are scanned too.
+    /// @param[in]  fingerprint_files - True to also fingerprint every scanned file by hashing its contents (see ContentHash)
+    ///     while it's in memory; false otherwise.
+    /// @return The include graph.
+    static IncludeGraph Build(const unsigned int thread_count, const Project& project, const bool fingerprint_files)
+    {
+        const bool IS_PHASE = true;
+        TraceSpan build_span("build include graph", &project.Name, IS_PHASE);
+
+        // ADD A NODE FOR EACH HEADER IN THE PROJECT.
+        // Paths are normalized so that includes written differently (or in a different case, as on Windows) still match.
+        const FolderTree& code_folder = *project.CodeFolderTree;
+        IncludeGraph graph;
+        std::unordered_map<std::string, uint32_t> header_indices_by_normalized_path;
+        std::vector<ScannedFile> scanned_files;
+        std::string path;
+        for (uint32_t header_file : project.CodeFiles.HeaderFiles)
+        {
+            path.clear();
+            code_folder.AppendFilePath(header_file, path);
+            uint32_t header_index = static_cast<uint32_t>(graph.Headers.size());
+            header_indices_by_normalized_path.emplace(NormalizePath(path), header_index);
+            graph.Headers.push_back({ "\"" + DirectoryListing::ToIncludePath(path) + "\"", path, {}, false, 0 });
+            const bool IS_PROJECT_FILE = true;
+            scanned_files.push_back({ path, header_index, IS_PROJECT_FILE });
+        }
+
+        // ADD EACH SOURCE FILE.
+        // The source files are also project files, so that the headers they include with angle brackets can be precompiled,
+        // but they're only nodes if they're included by something else.  The .cpp files in the current folder aren't project
+        // files, but without unity build shards they're the translation units, so they're nodes (after the project's headers).
+        graph.SourceIncludedHeaders.resize(project.CodeFiles.CppFiles.size());
+        graph.SourceIncludesMacros.resize(project.CodeFiles.CppFiles.size(), 0);
+        graph.SourceFingerprints.resize(project.CodeFiles.CppFiles.size(), 0);
+        for (uint32_t cpp_file : project.CodeFiles.CppFiles)
+        {
+            path.clear();
+            code_folder.AppendFilePath(cpp_file, path);
+            const bool IS_PROJECT_FILE = true;
+            scanned_files.push_back({ path, NO_HEADER, IS_PROJECT_FILE });
+        }
+        bool unity_shards_used = !project.UnityShardStartIndices.empty();
+        if (!unity_shards_used)
+        {
+            for (const std::string& project_folder_cpp_filename : project.ProjectFolderCppFilenames)
+            {
+                uint32_t header_index = static_cast<uint32_t>(graph.Headers.size());
+                header_indices_by_normalized_path.emplace(NormalizePath(project_folder_cpp_filename), header_index);
+                graph.Headers.push_back({ "", project_folder_cpp_filename, {}, false, 0 });
+                graph.ProjectFolderCppFileHeaders.push_back(header_index);
+                const bool IS_PROJECT_FILE = false;
+                scanned_files.push_back({ project_folder_cpp_filename, header_index, IS_PROJECT_FILE });
+            }
+        }
+
+        // DETERMINE THE FOLDERS TO SEARCH FOR INCLUDED FILES.
+        // After the including file's folder (for quoted includes), the code folder is searched first, just
+        // as it's the first folder the build script adds to the compiler's include path.
+        std::string code_folder_path;
+        code_folder.AppendFolderPath(project.CodeFolderIndex, code_folder_path);
+        std::string normalized_code_folder_path = NormalizePath(code_folder_path);
+        std::vector<std::string> include_folder_paths = { code_folder_path };
+        const char* include_environment_variable = std::getenv("INCLUDE");
+        std::string include_folder_list = include_environment_variable ? include_environment_variable : "";
+        for (std::size_t folder_path_start = 0; folder_path_start < include_folder_list.size();)
+        {
+            std::size_t folder_path_end = include_folder_list.find(';', folder_path_start);
+            if (std::string::npos == folder_path_end)
+            {
+                folder_path_end = include_folder_list.size();
+            }
+            bool folder_path_empty = (folder_path_end == folder_path_start);
+            if (!folder_path_empty)
+            {
+                include_folder_paths.push_back(DirectoryListing::ToProjectPath(include_folder_list.substr(folder_path_start, folder_path_end - folder_path_start)));
+            }
+            folder_path_start = folder_path_end + 1;
+        }
+
+        // RESOLVE INCLUDES TO FILES ON DISK.
+        // Only one thread resolves includes this way, since it adds nodes to the graph for files that are found.
+        // The same includes are often in many files, so the results are remembered.
+        std::unordered_map<std::string, uint32_t> header_indices_by_include;
+        std::vector<ScannedFile> files_to_scan_next;
+        auto resolve_include = [&](const std::string& folder_path, const IncludeScanner::Include& include)
+        {
+            // CHECK IF THE INCLUDE WAS ALREADY RESOLVED.
+            // Angled includes are resolved the same way wherever they are.
+            std::string include_key = include.IsAngled ? ("<" + include.Path) : (NormalizePath(folder_path) + "\"" + include.Path);
+            auto resolved_header = header_indices_by_include.find(include_key);
+            bool include_already_resolved = (header_indices_by_include.cend() != resolved_header);
+            if (include_already_resolved)
+            {
+                return resolved_header->second;
+            }
+
+            // SEARCH EACH FOLDER FOR THE INCLUDED FILE.
+            // A file that isn't a node yet is only checked for on disk.
+            std::string include_path = DirectoryListing::ToProjectPath(include.Path);
+            uint32_t header_index = NO_HEADER;
+            std::size_t first_folder_index = include.IsAngled ? 1 : 0;
+            for (std::size_t folder_index = first_folder_index; folder_index <= include_folder_paths.size(); ++folder_index)
+            {
+                const std::string& searched_folder_path = (0 == folder_index) ? folder_path : include_folder_paths[folder_index - 1];
+                std::string candidate_path = searched_folder_path.empty() ? include_path : (searched_folder_path + PATH_SEPARATOR + include_path);
+                std::string normalized_candidate_path = NormalizePath(candidate_path);
+                auto header = header_indices_by_normalized_path.find(normalized_candidate_path);
+                bool header_found = (header_indices_by_normalized_path.cend() != header);
+                if (header_found)
+                {
+                    header_index = header->second;
+                    break;
+                }
+
+                uint64_t size_in_bytes = 0;
+                uint64_t modification_time = 0;
+                bool file_exists = DirectoryListing::GetFileMetadata(candidate_path, size_in_bytes, modification_time);
+                if (file_exists)
+                {
+                    header_index = static_cast<uint32_t>(graph.Headers.size());
+                    header_indices_by_normalized_path.emplace(normalized_candidate_path, header_index);
+                    graph.Headers.push_back({ "", candidate_path, {}, false, 0 });
+                    const bool IS_PROJECT_FILE = false;
+                    files_to_scan_next.push_back({ candidate_path, header_index, IS_PROJECT_FILE });
+                    break;
+                }
+            }
+            header_indices_by_include.emplace(include_key, header_index);
+            return header_index;
+        };
+
+        // SCAN ALL OF THE FILES, AND THEN EVERYTHING THEY INCLUDE.
+        // The project's files come first, with the headers followed by the source files.  Each round of files is scanned in
+        // parallel, and each file's includes are resolved to files already in the graph as it's scanned (relative to the
+        // including file's folder or the code folder), but anything else is resolved afterwards, since that may change the graph.
+        std::unordered_map<std::string, uint32_t> external_header_indices_by_path;
+        std::size_t next_source_index = 0;
+        while (!scanned_files.empty())
+        {
+            std::vector<std::vector<uint32_t>> included_known_headers(scanned_files.size());
+            std::vector<std::vector<IncludeScanner::Include>> unresolved_includes(scanned_files.size());
+            std::vector<uint8_t> files_including_macros(scanned_files.size(), 0);
+            std::vector<uint64_t> file_fingerprints(scanned_files.size(), 0);
+            ParallelTasks::ForEachBatch(
+                scanned_files.size(),
+                FolderScanner::ResolveThreadCount(thread_count),
+                [&](const std::size_t first_file_index, const std::size_t end_file_index)
+                {
+                    std::vector<IncludeScanner::Include> includes;
+                    for (std::size_t file_index = first_file_index; file_index < end_file_index; ++file_index)
+                    {
+                        // FIND THE FILE'S INCLUDES.
+                        // Files that can't be read are treated as not including anything.
+                        const std::string& file_path = scanned_files[file_index].Path;
+                        TraceSpan scan_span("scan includes", &file_path);
+                        MemoryMappedFile file;
+                        bool file_read = file.Open(file_path);
+                        if (!file_read)
+                        {
+                            continue;
+                        }
+                        if (fingerprint_files)
+                        {
+                            file_fingerprints[file_index] = ContentHash::Hash(file.Data, file.Size);
+                        }
+                        includes.clear();
+                        IncludeScanner::Scan(file.Data, file.Size, includes);
+
+                        // RESOLVE EACH INCLUDE OF A FILE THAT'S ALREADY IN THE GRAPH.
+                        if (includes.empty())
+                        {
+                            continue;
+                        }
+                        std::string normalized_folder_path = NormalizePath(GetFolderPath(file_path));
+                        for (const IncludeScanner::Include& include : includes)
+                        {
+                            if (include.IsMacro)
+                            {
+                                files_including_macros[file_index] = 1;
+                                continue;
+                            }
+                            std::string normalized_include_path = NormalizePath(include.Path);
+                            auto header = header_indices_by_normalized_path.cend();
+                            if (!include.IsAngled)
+                            {
+                                header = header_indices_by_normalized_path.find(NormalizePath(normalized_folder_path + PATH_SEPARATOR + normalized_include_path));
+                            }
+                            if (header_indices_by_normalized_path.cend() == header)
+                            {
+                                header = header_indices_by_normalized_path.find(NormalizePath(normalized_code_folder_path + PATH_SEPARATOR + normalized_include_path));
+                            }
+                            bool header_found = (header_indices_by_normalized_path.cend() != header);
+                            if (header_found)
+                            {
+                                included_known_headers[file_index].push_back(header->second);
+                            }
+                            else
+                            {
+                                unresolved_includes[file_index].push_back(include);
+                            }
+                        }
+                    }
+                });
+
+            // CONNECT EACH FILE TO THE FILES IT INCLUDES.
+            // Headers outside the project included by project files with angle brackets get nodes even if they can't be found,
+            // in the order they're first included.  The order of each file's includes is kept, though headers resolved while
+            // scanning come last, which only matters for the order headers are precompiled in.
+            files_to_scan_next.clear();
+            for (std::size_t file_index = 0; file_index < scanned_files.size(); ++file_index)
+            {
+                const ScannedFile& scanned_file = scanned_files[file_index];
+                std::string folder_path = unresolved_includes[file_index].empty() ? std::string() : GetFolderPath(scanned_file.Path);
+                std::vector<uint32_t> included_headers;
+                for (const IncludeScanner::Include& include : unresolved_includes[file_index])
+                {
+                    uint32_t header_index = resolve_include(folder_path, include);
+                    bool precompilable_external_header = (scanned_file.IsProjectFile && include.IsAngled);
+                    if (precompilable_external_header && NO_HEADER == header_index)
+                    {
+                        auto external_header = external_header_indices_by_path.find(include.Path);
+                        bool external_header_found = (external_header_indices_by_path.cend() != external_header);
+                        if (external_header_found)
+                        {
+                            header_index = external_header->second;
+                        }
+                        else
+                        {
+                            header_index = static_cast<uint32_t>(graph.Headers.size());
+                            external_header_indices_by_path.emplace(include.Path, header_index);
+                            graph.Headers.push_back({ "<" + include.Path + ">", "", {}, false, 0 });
+                        }
+                    }
+                    else if (precompilable_external_header && graph.Headers[header_index].IncludeText.empty())
+                    {
+                        graph.Headers[header_index].IncludeText = "<" + include.Path + ">";
+                    }
+
+                    if (NO_HEADER != header_index)
+                    {
+                        included_headers.push_back(header_index);
+                    }
+                }
+                included_headers.insert(included_headers.end(), included_known_headers[file_index].cbegin(), included_known_headers[file_index].cend());
+
+                bool is_source_file = (NO_HEADER == scanned_file.HeaderIndex);
+                if (is_source_file)
+                {
+                    graph.SourceIncludedHeaders[next_source_index] = std::move(included_headers);
+                    graph.SourceIncludesMacros[next_source_index] = files_including_macros[file_index];
+                    graph.SourceFingerprints[next_source_index] = file_fingerprints[file_index];
+                    ++next_source_index;
+                }
+                else
+                {
+                    graph.Headers[scanned_file.HeaderIndex].IncludedHeaders = std::move(included_headers);
+                    graph.Headers[scanned_file.HeaderIndex].IncludesMacros = (0 != files_including_macros[file_index]);
+                    graph.Headers[scanned_file.HeaderIndex].Fingerprint = file_fingerprints[file_index];
+                }
+            }
+            scanned_files.swap(files_to_scan_next);
+        }
+        return graph;
+    }
+
+    /// Finds every file that some files include, directly or indirectly.
+    /// @param[in]  directly_included_headers - The indices of the files that are directly included.
+    /// @return The indices of all of the included files, including the directly included ones, in no particular order.
+    std::vector<uint32_t> FindIncludedHeaders(const std::vector<uint32_t>& directly_included_headers) const
+    {
+        std::vector<uint32_t> included_headers;
+        std::vector<uint8_t> visited_headers(Headers.size(), 0);
+        std::vector<uint32_t> headers_to_visit = directly_included_headers;
+        while (!headers_to_visit.empty())
+        {
+            uint32_t header_index = headers_to_visit.back();
+            headers_to_visit.pop_back();
+            if (visited_headers[header_index])
+            {
+                continue;
+            }
+            visited_headers[header_index] = 1;
+            included_headers.push_back(header_index);
+            const std::vector<uint32_t>& next_included_headers = Headers[header_index].IncludedHeaders;
+            headers_to_visit.insert(headers_to_visit.end(), next_included_headers.cbegin(), next_included_headers.cend());
+        }
+        return included_headers;
+    }
+
+    /// Counts how many translation units include each header, directly or indirectly.
+    /// @param[in]  thread_count - The number of threads to use.  Zero uses one thread per hardware core.
+    /// @param[in]  translation_unit_start_indices - The index of the first source file in each translation unit,
+    ///     in increasing order.  Each translation unit (such as a unity build shard) compiles the source files
+    ///     from its first one up to the first one of the next translation unit.
+    /// @return The number of translation units that include each header, by header index.
+    std::vector<uint32_t> CountIncludingTranslationUnits(
+        const unsigned int thread_count,
+        const std::vector<std::size_t>& translation_unit_start_indices) const
+    {
+        // COUNT THE TRANSLATION UNITS IN BATCHES IN PARALLEL.
+        // Each batch counts separately, and the counts are combined at the end.
+        std::vector<uint32_t> including_translation_unit_counts(Headers.size(), 0);
+        std::mutex counts_mutex;
+        ParallelTasks::ForEachBatch(
+            translation_unit_start_indices.size(),
+            FolderScanner::ResolveThreadCount(thread_count),
+            [this, &translation_unit_start_indices, &including_translation_unit_counts, &counts_mutex](
+                const std::size_t first_translation_unit_index,
+                const std::size_t end_translation_unit_index)
+            {
+                // VISIT ALL HEADERS EACH TRANSLATION UNIT'S SOURCE FILES INCLUDE.
+                // Headers are marked with the translation unit that last visited them, so the marks never need to be cleared,
+                // and headers included by several source files in the same translation unit are only counted once.
+                const uint32_t NOT_VISITED = 0xFFFFFFFF;
+                std::vector<uint32_t> last_visiting_translation_unit_indices(Headers.size(), NOT_VISITED);
+                std::vector<uint32_t> batch_counts(Headers.size(), 0);
+                std::vector<uint32_t> headers_to_visit;
+                for (std::size_t translation_unit_index = first_translation_unit_index; translation_unit_index < end_translation_unit_index; ++translation_unit_index)
+                {
+                    uint32_t visiting_translation_unit_index = static_cast<uint32_t>(translation_unit_index);
+                    bool is_last_translation_unit = (translation_unit_index + 1 == translation_unit_start_indices.size());
+                    std::size_t end_source_index = is_last_translation_unit ?
+                        SourceIncludedHeaders.size() :
+                        translation_unit_start_indices[translation_unit_index + 1];
+                    for (std::size_t source_index = translation_unit_start_indices[translation_unit_index]; source_index < end_source_index; ++source_index)
+                    {
+                        headers_to_visit.assign(SourceIncludedHeaders[source_index].cbegin(), SourceIncludedHeaders[source_index].cend());
+                        while (!headers_to_visit.empty())
+                        {
+                            uint32_t header_index = headers_to_visit.back();
+                            headers_to_visit.pop_back();
+                            bool already_visited = (visiting_translation_unit_index == last_visiting_translation_unit_indices[header_index]);
+                            if (already_visited)
+                            {
+                                continue;
+                            }
+                            last_visiting_translation_unit_indices[header_index] = visiting_translation_unit_index;
+                            ++batch_counts[header_index];
+                            const std::vector<uint32_t>& included_headers = Headers[header_index].IncludedHeaders;
+                            headers_to_visit.insert(headers_to_visit.end(), included_headers.cbegin(), included_headers.cend());
+                        }
+                    }
+                }
+
+                std::lock_guard<std::mutex> lock(counts_mutex);
+                for (std::size_t header_index = 0; header_index < Headers.size(); ++header_index)
+                {
+                    including_translation_unit_counts[header_index] += batch_counts[header_index];
+                }
+            });
+        return including_translation_unit_counts;
+    }
+
+    /// Orders headers so that every header comes after the headers it includes, as much as possible,
+    /// and otherwise in the order the headers are first included by the source files.
+    /// @param[in]  selected_headers - A flag for each header indicating if it should be ordered.
+    /// @return The indices of the selected headers, in order.
+    std::vector<uint32_t> OrderHeaders(const std::vector<uint8_t>& selected_headers) const
+    {
+        // VISIT ALL HEADERS IN THE ORDER THEY'RE INCLUDED.
+        // Each header is added once all of the headers it includes have been added, which
+        // can only be violated by circular includes.
+        std::vector<uint32_t> ordered_headers;
+        std::vector<uint8_t> visited_headers(Headers.size(), 0);
+        std::vector<std::pair<uint32_t, std::size_t>> visit_stack;
+        auto visit_header = [&](const uint32_t first_header_index)
+        {
+            if (visited_headers[first_header_index])
+            {
+                return;
+            }
+            visited_headers[first_header_index] = 1;
+            visit_stack.emplace_back(first_header_index, 0);
+            while (!visit_stack.empty())
+            {
+                // VISIT THE NEXT HEADER INCLUDED BY THE CURRENT HEADER.
+                uint32_t header_index = visit_stack.back().first;
+                std::size_t& next_included_header_index = visit_stack.back().second;
+                const std::vector<uint32_t>& included_headers = Headers[header_index].IncludedHeaders;
+                if (next_included_header_index < included_headers.size())
+                {
+                    uint32_t included_header_index = included_headers[next_included_header_index];
+                    ++next_included_header_index;
+                    if (!visited_headers[included_header_index])
+                    {
+                        visited_headers[included_header_index] = 1;
+                        visit_stack.emplace_back(included_header_index, 0);
+                    }
+                    continue;
+                }
+
+                // ADD THE HEADER ONCE EVERYTHING IT INCLUDES HAS BEEN ADDED.
+                if (selected_headers[header_index])
+                {
+                    ordered_headers.push_back(header_index);
+                }
+                visit_stack.pop_back();
+            }
+        };
+        for (const std::vector<uint32_t>& source_included_headers : SourceIncludedHeaders)
+        {
+            for (uint32_t header_index : source_included_headers)
+            {
+                visit_header(header_index);
+            }
+        }
+        return ordered_headers;
+    }
+
+    /// A header (or other included file) in the graph.
+    struct Header
+    {
+        /// How to include the header, with quotes or angle brackets.  Paths of project headers are relative to the current folder,
+        /// with forward slashes so that any compiler can use them.  Empty if the file can't be precompiled.
+        std::string IncludeText;
+        /// The path of the file, or empty if it couldn't be found.
+        std::string Path;
+        /// The indices of the headers this header directly includes, in the order they're included.
+        std::vector<uint32_t> IncludedHeaders;
+        /// True if the header includes a macro, so that it may include files that aren't in the graph.
+        bool IncludesMacros;
+        /// The hash of the header's contents (see ContentHash), if files were fingerprinted and the header could be read,
+        /// or 0 otherwise.
+        uint64_t Fingerprint;
+    };
+
+    /// The index of a header that doesn't exist.
+    static const uint32_t NO_HEADER = 0xFFFFFFFF;
+
+    // MEMBER VARIABLES.
+    /// All headers in the graph.  The project's headers come first, in the same order as the project's header files.
+    std::vector<Header> Headers = {};
+    /// The indices of the headers that each source file directly includes, in the same order as the project's source files.
+    std::vector<std::vector<uint32_t>> SourceIncludedHeaders = {};
+    /// A flag for each source file indicating if it includes a macro, in the same order as the project's source files.
+    std::vector<uint8_t> SourceIncludesMacros = {};
+    /// The hash of each source file's contents (see ContentHash), in the same order as the project's source files,
+    /// if files were fingerprinted and the source file could be read, or 0 otherwise.
+    std::vector<uint64_t> SourceFingerprints = {};
+    /// The index of the header for each of the project's .cpp files in the current folder, in the same order, or empty if
+    /// those files are unity build shards (which only include the project's source files).
+    std::vector<uint32_t> ProjectFolderCppFileHeaders = {};
+
+private:
+    /// A file to scan for includes.
+    struct ScannedFile
+    {
+        /// The path of the file.
+        std::string Path;
+        /// The index of the file's header, or NO_HEADER if it's one of the project's source files.
+        uint32_t HeaderIndex;
+        /// True if the file is one of the project's headers or source files; false if it's only included by them.
+        bool IsProjectFile;
+    };
+
+    /// Gets the path of the folder containing a file.
+    /// @param[in]  file_path - The path of the file.
+    /// @return The path of the folder, or empty if the file is in the current folder.
+    static std::string GetFolderPath(const std::string& file_path)
+    {
+        std::size_t last_separator = file_path.find_last_of("\\/");
+        return (std::string::npos == last_separator) ? std::string() : file_path.substr(0, last_separator);
+    }
+
+    /// Normalizes a path so that paths to the same file can be compared.  Path separators are made consistent,
+    /// the current (.) and parent (..) folders are removed, and letters are made lowercase, since paths on Windows
+    /// are case-insensitive.
+    /// @param[in]  path - The path to normalize.
+    /// @return The normalized path.
+    static std::string NormalizePath(const std::string& path)
+    {
+        std::string normalized_path;
+        normalized_path.reserve(path.size());
+        std::size_t name_start = 0;
+        while (name_start <= path.size())
+        {
+            // FIND THE NEXT NAME IN THE PATH.
+            std::size_t name_end = path.find_first_of("\\/", name_start);
+            if (std::string::npos == name_end)
+            {
+                name_end = path.size();
+            }
+            std::size_t name_length = name_end - name_start;
+
+            // ADD THE NAME TO THE NORMALIZED PATH.
+            // Parent folders are only removed if they're known, so paths leading out of the current folder are kept.
+            bool is_current_folder = (0 == name_length || (1 == name_length && '.' == path[name_start]));
+            bool is_parent_folder = (2 == name_length && 0 == path.compare(name_start, name_length, ".."));
+            std::size_t last_separator = normalized_path.rfind(PATH_SEPARATOR[0]);
+            std::size_t last_name_start = (std::string::npos == last_separator) ? 0 : last_separator + 1;
+            bool parent_folder_known = !normalized_path.empty() && 0 != normalized_path.compare(last_name_start, std::string::npos, "..");
+            if (is_parent_folder && parent_folder_known)
+            {
+                normalized_path.erase(std::string::npos == last_separator ? 0 : last_separator);
+            }
+            else if (!is_current_folder)
+            {
+                if (!normalized_path.empty())
+                {
+                    normalized_path.push_back(PATH_SEPARATOR[0]);
+                }
+                for (std::size_t character_index = name_start; character_index < name_end; ++character_index)
+                {
+                    char character = path[character_index];
+                    bool is_uppercase = ('A' <= character && character <= 'Z');
+                    normalized_path.push_back(is_uppercase ? static_cast<char>(character - 'A' + 'a') : character);
+                }
+            }
+            name_start = name_end + 1;
+        }
+        return normalized_path;
+    }
+};
+
+const uint32_t IncludeGraph::NO_HEADER;
+
+/// Chooses the headers to precompile for a project.
+///
+/// Headers are chosen by how many of the project's translation units include them, directly or indirectly,
+/// so that the precompiled header saves as much repeated work as possible.  Translation units are usually
+/// the project's source files, but with a unity build, only the shards are compiled against the precompiled header.  Any change to the chosen headers
+/// requires rebuilding everything, so headers chosen in the previous run (read back from the existing generated
+/// header) stay chosen as long as they're still fairly widely included.
+class PrecompiledHeader
+{
+public:
+    /// Gets the filename of the generated precompiled header, which is in the current folder.
+    /// @param[in]  project_name - The name of the project the header is for.
+    /// @return The filename of the header.
+    static std::string GetHeaderFilename(const std::string& project_name)
+    {
+        return project_name + "_Pch.h";
+    }
+
+    /// Gets the filename of the generated source file that creates the precompiled header, which is in the current folder.
+    /// @param[in]  project_name - The name of the project the header is for.
+    /// @return The filename of the source file.
+    static std::string GetSourceFilename(const std::string& project_name)
+    {
+        return project_name + "_Pch" + CPP_FILE_EXTENSION;
+    }
+
+    /// Chooses the headers to precompile for a project.
+    /// @param[in]  thread_count - The number of threads to use.  Zero uses one thread per hardware core.
+    /// @param[in,out]  project - The project, whose code files must already be categorized.  Its precompiled
+    ///     header includes are set, and are empty if precompiling headers wouldn't help.
+    static void Select(const unsigned int thread_count, Project& project)
+    {
+        // DETERMINE THE TRANSLATION UNITS.
+        // With a unity build, each shard is a translation unit, and empty shards are left out since they don't
+        // compile any of the project's code.  Otherwise, each source file is compiled on its own.
+        std::size_t source_file_count = project.CodeFiles.CppFiles.size();
+        std::vector<std::size_t> translation_unit_start_indices = project.UnityShardStartIndices;
+        bool unity_shards_used = !translation_unit_start_indices.empty();
+        if (unity_shards_used)
+        {
+            translation_unit_start_indices.erase(
+                std::unique(translation_unit_start_indices.begin(), translation_unit_start_indices.end()),
+                translation_unit_start_indices.end());
+            bool last_shard_empty = (source_file_count == translation_unit_start_indices.back());
+            if (last_shard_empty)
+            {
+                translation_unit_start_indices.pop_back();
+            }
+        }
+        else
+        {
+            for (std::size_t source_file_index = 0; source_file_index < source_file_count; ++source_file_index)
+            {
+                translation_unit_start_indices.push_back(source_file_index);
+            }
+        }
+
+        // CHOOSE THE WIDELY INCLUDED HEADERS.
+        // Headers that were previously chosen are kept as long as they're included by fewer translation units.
+        // A precompiled header can't save anything unless there are multiple translation units.
+        project.PrecompiledHeaderIncludes.clear();
+        const std::size_t MIN_TRANSLATION_UNIT_COUNT = 2;
+        std::size_t translation_unit_count = translation_unit_start_indices.size();
+        if (translation_unit_count < MIN_TRANSLATION_UNIT_COUNT)
+        {
+            return;
+        }
+        const bool FINGERPRINT_FILES = false;
+        IncludeGraph include_graph = IncludeGraph::Build(thread_count, project, FINGERPRINT_FILES);
+        std::vector<uint32_t> including_translation_unit_counts = include_graph.CountIncludingTranslationUnits(
+            thread_count,
+            translation_unit_start_indices);
+        std::vector<std::string> previous_includes = ReadPreviousIncludes(project.Name);
+        std::vector<uint8_t> selected_headers(include_graph.Headers.size(), 0);
+        const uint64_t MIN_INCLUDING_PERCENT = 50;
+        const uint64_t MIN_PREVIOUSLY_SELECTED_INCLUDING_PERCENT = 25;
+        const uint64_t PERCENT = 100;
+        for (std::size_t header_index = 0; header_index < include_graph.Headers.size(); ++header_index)
+        {
+            const std::string& include_text = include_graph.Headers[header_index].IncludeText;
+            bool can_precompile = !include_text.empty();
+            if (!can_precompile)
+            {
+                continue;
+            }
+            bool previously_selected = std::binary_search(previous_includes.cbegin(), previous_includes.cend(), include_text);
+            uint64_t min_including_percent = previously_selected ? MIN_PREVIOUSLY_SELECTED_INCLUDING_PERCENT : MIN_INCLUDING_PERCENT;
+            uint64_t including_percent_scaled = static_cast<uint64_t>(including_translation_unit_counts[header_index]) * PERCENT;
+            bool widely_included = (including_percent_scaled >= min_including_percent * translation_unit_count);
+            selected_headers[header_index] = widely_included ? 1 : 0;
+        }
+
+        // ORDER THE HEADERS SO THAT THEY CAN BE INCLUDED TOGETHER.
+        std::vector<uint32_t> ordered_headers = include_graph.OrderHeaders(selected_headers);
+        for (uint32_t header_index : ordered_headers)
+        {
+            project.PrecompiledHeaderIncludes.push_back(include_graph.Headers[header_index].IncludeText);
+        }
+    }
+
+private:
+    /// Reads the headers included by the previously generated precompiled header.
+    /// @param[in]  project_name - The name of the project the header is for.
+    /// @return How each header is included, with quotes or angle brackets, sorted so that they can be searched quickly.
+    ///     Empty if there's no previous header.
+    static std::vector<std::string> ReadPreviousIncludes(const std::string& project_name)
+    {
+        std::vector<std::string> previous_includes;
+        MemoryMappedFile previous_header_file;
+        bool previous_header_read = previous_header_file.Open(GetHeaderFilename(project_name));
+        if (!previous_header_read)
+        {
+            return previous_includes;
+        }
+
+        std::vector<IncludeScanner::Include> includes;
+        IncludeScanner::Scan(previous_header_file.Data, previous_header_file.Size, includes);
+        for (const IncludeScanner::Include& include : includes)
+        {
+            if (include.IsMacro)
+            {
+                continue;
+            }
+            previous_includes.push_back(include.IsAngled ? ("<" + include.Path + ">") : ("\"" + include.Path + "\""));
+        }
+        std::sort(previous_includes.begin(), previous_includes.end());
+        return previous_includes;
+    }
+};
+
+/// Splits projects with too many code files for Visual Studio to load quickly into several projects, or parts,
+/// so that each part's project file stays small.  The solution lists all parts in place of the whole project.
+///
+/// Each part is a contiguous range of the project's folders in pre-order, so parts are only ever cut between
+/// folders and each subfolder stays with its parent unless its parent's part is full.  The first part keeps
+/// the project's name, along with the additional source files in the current folder, and is the only part built
+/// by the solution, since every part builds the same program.  Each other part is named after its first folder,
+/// so its name and ID don't depend on how many parts come before it.  This also means the parts from the previous
+/// run can be found from the project names in the existing solution file.  Those parts are kept, and only the
+/// parts that grew past the limit are split further, so adding a file never moves files between other parts.
+class ProjectPartition
+{
+public:
+    /// Reads the names of the projects in an existing solution file, which is how the previous parts are found.
+    /// @param[in]  solution_filename - The filename of the solution file, in the current folder.
+    /// @return The names of the projects in the solution, or nothing if there's no solution file.
+    static std::unordered_set<std::string> ReadPreviousProjectNames(const std::string& solution_filename)
+    {
+        std::unordered_set<std::string> previous_project_names;
+        MemoryMappedFile solution_file;
+        bool solution_file_read = solution_file.Open(solution_filename);
+        if (!solution_file_read)
+        {
+            return previous_project_names;
+        }
+
+        // READ THE NAME FROM EACH PROJECT LINE.
+        // Project lines look like: Project("{TypeGuid}") = "ProjectName", "ProjectName.vcxproj", "{ProjectGuid}"
+        const std::string PROJECT_LINE_PREFIX = "Project(\"";
+        const std::string NAME_PREFIX = "= \"";
+        const char* line = solution_file.Data;
+        const char* solution_file_end = solution_file.Data + solution_file.Size;
+        while (line < solution_file_end)
+        {
+            const char* line_end = std::find(line, solution_file_end, '\n');
+            std::string line_text(line, line_end);
+            line = line_end + 1;
+
+            bool is_project_line = (0 == line_text.compare(0, PROJECT_LINE_PREFIX.size(), PROJECT_LINE_PREFIX));
+            if (!is_project_line)
+            {
+                continue;
+            }
+            std::size_t name_prefix_start = line_text.find(NAME_PREFIX);
+            if (std::string::npos == name_prefix_start)
+            {
+                continue;
+            }
+            std::size_t name_start = name_prefix_start + NAME_PREFIX.size();
+            std::size_t name_end = line_text.find('"', name_start);
+            if (std::string::npos == name_end)
+            {
+                continue;
+            }
+            previous_project_names.insert(line_text.substr(name_start, name_end - name_start));
+        }
+        return previous_project_names;
+    }
+
+    /// Splits a project into parts if it has too many items for one project file.
+    /// @param[in]  max_item_count - The most code files that a part should have.  Parts may only have more
+    ///     if a single folder directly contains more files than this.
+    /// @param[in]  previous_project_names - The names of the projects in the previous solution (see ReadPreviousProjectNames).
+    /// @param[in,out]  used_project_names - The names already taken by projects in the solution.  The names of the parts
+    ///     are added, and folders whose part names are already taken aren't used to start parts.
+    /// @param[in]  project - The project to split, whose code files must already be categorized.
+    /// @return The parts of the project, in folder order, or nothing if the project doesn't need to be split.
+    static std::vector<Project> Split(
+        const std::size_t max_item_count,
+        const std::unordered_set<std::string>& previous_project_names,
+        std::unordered_set<std::string>& used_project_names,
+        const Project& project)
+    {
+        const bool IS_PHASE = true;
+        TraceSpan partition_span("partition project", &project.Name, IS_PHASE);
+
+        // COUNT THE ITEMS IN EACH FOLDER.
+        // The additional source files in the current folder always go in the first part.
+        const FolderTree& code_folder = *project.CodeFolderTree;
+        uint32_t first_folder_index = project.CodeFolderIndex;
+        uint32_t end_folder_index = code_folder.Folders[first_folder_index].SubtreeEndIndex;
+        std::vector<std::size_t> folder_item_counts(end_folder_index - first_folder_index, 0);
+        for (uint32_t header_file : project.CodeFiles.HeaderFiles)
+        {
+            ++folder_item_counts[code_folder.Files[header_file].FolderIndex - first_folder_index];
+        }
+        for (uint32_t cpp_file : project.CodeFiles.CppFiles)
+        {
+            ++folder_item_counts[code_folder.Files[cpp_file].FolderIndex - first_folder_index];
+        }
+        folder_item_counts.front() += project.ProjectFolderCppFilenames.size();
+        std::size_t item_count = 0;
+        for (std::size_t folder_item_count : folder_item_counts)
+        {
+            item_count += folder_item_count;
+        }
+        bool split_needed = (item_count > max_item_count);
+        if (!split_needed)
+        {
+            return {};
+        }
+
+        // FIND WHERE THE PREVIOUS PARTS START.
+        // The first part always starts at the code folder.
+        std::vector<uint32_t> previous_part_start_indices = { first_folder_index };
+        for (uint32_t folder_index = first_folder_index + 1; folder_index < end_folder_index; ++folder_index)
+        {
+            bool previous_part_start = (previous_project_names.count(GetPartName(project, folder_index)) > 0);
+            if (previous_part_start)
+            {
+                previous_part_start_indices.push_back(folder_index);
+            }
+        }
+
+        // SPLIT ANY PREVIOUS PARTS THAT ARE NOW TOO LARGE.
+        // Folders are added to each part until the next one would make it too large, at which point it starts a new part.
+        std::vector<uint32_t> part_start_indices;
+        std::vector<std::string> part_names;
+        for (std::size_t previous_part_index = 0; previous_part_index < previous_part_start_indices.size(); ++previous_part_index)
+        {
+            uint32_t previous_part_start_index = previous_part_start_indices[previous_part_index];
+            bool is_last_previous_part = (previous_part_index + 1 == previous_part_start_indices.size());
+            uint32_t previous_part_end_index = is_last_previous_part ? end_folder_index : previous_part_start_indices[previous_part_index + 1];
+            std::size_t part_item_count = 0;
+            for (uint32_t folder_index = previous_part_start_index; folder_index < previous_part_end_index; ++folder_index)
+            {
+                // START A NEW PART IF NEEDED.
+                // Folders whose part names are already taken can't start parts, so they stay in the current part.
+                std::size_t folder_item_count = folder_item_counts[folder_index - first_folder_index];
+                bool part_full = (part_item_count > 0 && part_item_count + folder_item_count > max_item_count);
+                bool part_start_needed = (previous_part_start_index == folder_index || part_full);
+                if (part_start_needed)
+                {
+                    bool is_first_part = (first_folder_index == folder_index);
+                    std::string part_name = is_first_part ? project.Name : GetPartName(project, folder_index);
+                    bool part_name_available = (is_first_part || used_project_names.insert(part_name).second);
+                    if (part_name_available)
+                    {
+                        part_start_indices.push_back(folder_index);
+                        part_names.push_back(part_name);
+                        part_item_count = 0;
+                    }
+                }
+                part_item_count += folder_item_count;
+            }
+        }
+
+        // CREATE THE PARTS.
+        // Files are grouped by folder in pre-order, so each part's files are a contiguous range of the project's files.
+        std::vector<Project> parts(part_start_indices.size());
+        auto header_file = project.CodeFiles.HeaderFiles.cbegin();
+        auto cpp_file = project.CodeFiles.CppFiles.cbegin();
+        for (std::size_t part_index = 0; part_index < parts.size(); ++part_index)
+        {
+            Project& part = parts[part_index];
+            part.Name = part_names[part_index];
+            part.Guid = ProjectGuid::FromName(part.Name);
+            part.CodeFolderPath = project.CodeFolderPath;
+            part.BuildScriptFilename = project.BuildScriptFilename;
+            part.BuildCommandLine = project.BuildCommandLine;
+            part.ProgramPath = project.ProgramPath;
+            part.WholeProjectName = project.Name;
+            part.CodeFolderTree = project.CodeFolderTree;
+            part.CodeFolderIndex = part_start_indices[part_index];
+            bool is_last_part = (part_index + 1 == parts.size());
+            part.CodeFolderEndIndex = is_last_part ? end_folder_index : part_start_indices[part_index + 1];
+            if (0 == part_index)
+            {
+                part.ProjectFolderCppFilenames = project.ProjectFolderCppFilenames;
+            }
+
+            auto is_in_part = [&code_folder, &part](const uint32_t file_index)
+            {
+                return code_folder.Files[file_index].FolderIndex < part.CodeFolderEndIndex;
+            };
+            auto part_header_files_end = std::find_if_not(header_file, project.CodeFiles.HeaderFiles.cend(), is_in_part);
+            part.CodeFiles.HeaderFiles.assign(header_file, part_header_files_end);
+            header_file = part_header_files_end;
+            auto part_cpp_files_end = std::find_if_not(cpp_file, project.CodeFiles.CppFiles.cend(), is_in_part);
+            part.CodeFiles.CppFiles.assign(cpp_file, part_cpp_files_end);
+            cpp_file = part_cpp_files_end;
+        }
+        return parts;
+    }
+
+private:
+    /// Gets the name of a part of a project other than the first, which is named after its first folder.
+    /// @param[in]  project - The project that the part is a part of.
+    /// @param[in]  folder_index - The index of the part's first folder, which must be within the project's code folder.
+    /// @return The name of the part, which is the project's name followed by the path of the folder within the
+    ///     code folder, with underscores in place of path separators.
+    static std::string GetPartName(const Project& project, const uint32_t folder_index)
+    {
+        std::string folder_path;
+        project.CodeFolderTree->AppendFolderPath(folder_index, folder_path);
+        std::size_t code_folder_path_length = project.CodeFolderTree->GetFolderPathLength(project.CodeFolderIndex);
+        std::string part_name = project.Name;
+        for (std::size_t character_index = code_folder_path_length; character_index < folder_path.size(); ++character_index)
+        {
+            bool is_path_separator = (0 == folder_path.compare(character_index, PATH_SEPARATOR.size(), PATH_SEPARATOR));
+            if (is_path_separator)
+            {
+                part_name += '_';
+                character_index += PATH_SEPARATOR.size() - 1;
+            }
+            else
+            {
+                part_name += folder_path[character_index];
+            }
+        }
+        return part_name;
+    }
+};
+
+/// A Visual Studio solution file.
+class SolutionFile
+{
+public:
+    /// Writes a Visual Studio solution file.
+    /// @param[in]  projects - The projects in the solution file being generated.  Split projects are listed by their parts.
+    /// @param[in,out]  file - The file to write to.
+    static void Write(const std::vector<const Project*>& projects, OutputFile& file)
+    {
+        // WRITE THE PROJECTS.
+        file
+            << "Microsoft Visual Studio Solution File, Format Version 12.00" << NEWLINE
+            << "# Visual Studio 2013" << NEWLINE
+            << "VisualStudioVersion = 12.0.31101.0" << NEWLINE
+            << "MinimumVisualStudioVersion = 10.0.40219.1" << NEWLINE;
+        for (const Project* project : projects)
+        {
+            file
+                << "Project(\"{8BC9CEB8-8B4A-11D0-8D11-00A0C91BC942}\") = \"" << project->Name << "\", \"" << project->Name << ".vcxproj\", \"" << project->Guid << NEWLINE
+                << "EndProject" << NEWLINE;
+        }
+
+        // WRITE THE CONFIGURATIONS FOR THE PROJECTS.
+        file
+            << "Global" << NEWLINE
+            << "    GlobalSection(SolutionConfigurationPlatforms) = preSolution" << NEWLINE
+            << "        CommandLineBuild|Win32 = CommandLineBuild|Win32" << NEWLINE
+            << "        Debug|Win32 = Debug|Win32" << NEWLINE
+            << "        Release|Win32 = Release|Win32" << NEWLINE
+            << "    EndGlobalSection" << NEWLINE
+            << "    GlobalSection(ProjectConfigurationPlatforms) = postSolution" << NEWLINE;
+        for (const Project* project : projects)
+        {
+            // Only the first part of a split project is built with the solution, since every part builds the same program.
+            bool is_later_part = (!project->WholeProjectName.empty() && project->WholeProjectName != project->Name);
+            if (is_later_part)
+            {
+                file
+                    << "        " << project->Guid << ".CommandLineBuild|Win32.ActiveCfg = Release|Win32" << NEWLINE
+                    << "        " << project->Guid << ".Debug|Win32.ActiveCfg = Debug|Win32" << NEWLINE
+                    << "        " << project->Guid << ".Release|Win32.ActiveCfg = Release|Win32" << NEWLINE;
+                continue;
+            }
+            file
+                << "        " << project->Guid << ".CommandLineBuild|Win32.ActiveCfg = Release|Win32" << NEWLINE
+                << "        " << project->Guid << ".CommandLineBuild|Win32.Build.0 = Release|Win32" << NEWLINE
+                << "        " << project->Guid << ".Debug|Win32.ActiveCfg = Debug|Win32" << NEWLINE
+                << "        " << project->Guid << ".Debug|Win32.Build.0 = Debug|Win32" << NEWLINE
+                << "        " << project->Guid << ".Release|Win32.ActiveCfg = Release|Win32" << NEWLINE
+                << "        " << project->Guid << ".Release|Win32.Build.0 = Release|Win32" << NEWLINE;
+        }
+        file
+            << "    EndGlobalSection" << NEWLINE
+            << "    GlobalSection(SolutionProperties) = preSolution" << NEWLINE
+            << "        HideSolutionNode = FALSE" << NEWLINE
+            << "    EndGlobalSection" << NEWLINE
+            << "EndGlobal" << NEWLINE;
+    }
+};
+
+/// A group of consecutive items in a generated file, such as the header file inclusions in a project file.
+struct ItemGroup
+{
+    /// The number of items in the group.
+    std::size_t ItemCount = 0;
+    /// Writes the items in a range of the group (from the first index up to, but not including, the end index)
+    /// to a file or a section of a file.
+    std::function<void(std::size_t first_item_index, std::size_t end_item_index, OutputFile& file)> WriteItems = {};
+};
+
+/// The formatted items of a generated file's item groups.  Files with enough items have each group split into
+/// chunks that are formatted concurrently into their own sections, which are then appended to the file in order,
+/// so that the file is identical to one with its items written one after another.  Files with too few items to
+/// benefit have them written directly to the file when each group is appended.
+class ItemSections
+{
+public:
+    /// Formats the items of each group, if there are enough of them to format on several threads.
+    /// @param[in]  thread_count - The maximum number of threads to format items on.
+    /// @param[in]  groups - The groups of items.  They must remain valid until they've all been appended.
+    explicit ItemSections(const unsigned int thread_count, const std::vector<ItemGroup>& groups) :
+        Groups(groups),
+        GroupSections()
+    {
+        // CHECK IF THERE ARE ENOUGH ITEMS TO FORMAT IN CHUNKS.
+        // Starting threads costs more than formatting a few chunks of items on a single thread.
+        const std::size_t MIN_CHUNK_COUNT = 2;
+        std::size_t item_count = 0;
+        for (const ItemGroup& group : Groups)
+        {
+            item_count += group.ItemCount;
+        }
+        bool items_formatted_in_chunks = (thread_count > 1) && (item_count >= MIN_CHUNK_COUNT * ITEMS_PER_CHUNK);
+        if (!items_formatted_in_chunks)
+        {
+            return;
+        }
+
+        // FORMAT EACH CHUNK OF ITEMS INTO ITS OWN SECTION.
+        // Chunks from all groups are formatted together so that threads stay busy across groups.
+        GroupSections.resize(Groups.size());
+        std::vector<std::function<void()>> format_tasks;
+        for (std::size_t group_index = 0; group_index < Groups.size(); ++group_index)
+        {
+            const ItemGroup& group = Groups[group_index];
+            std::size_t chunk_count = (group.ItemCount + ITEMS_PER_CHUNK - 1) / ITEMS_PER_CHUNK;
+            std::vector<OutputFile>& sections = GroupSections[group_index];
+            sections.reserve(chunk_count);
+            for (std::size_t chunk_index = 0; chunk_index < chunk_count; ++chunk_index)
+            {
+                sections.emplace_back(std::string());
+            }
+            for (std::size_t chunk_index = 0; chunk_index < chunk_count; ++chunk_index)
+            {
+                std::size_t first_item_index = chunk_index * ITEMS_PER_CHUNK;
+                std::size_t end_item_index = std::min(first_item_index + ITEMS_PER_CHUNK, group.ItemCount);
+                OutputFile& section = sections[chunk_index];
+                format_tasks.push_back([&group, first_item_index, end_item_index, &section]()
+                {
+                    group.WriteItems(first_item_index, end_item_index, section);
+                });
+            }
+        }
+        ParallelTasks::Run(thread_count, format_tasks);
+    }
+
+    /// Appends the items of a group to a file, writing them directly if they weren't formatted in chunks.
+    /// @param[in]  group_index - The index of the group whose items to append.
+    /// @param[in,out]  file - The file to append to.
+    void Append(const std::size_t group_index, OutputFile& file)
+    {
+        bool items_formatted_in_chunks = !GroupSections.empty();
+        if (items_formatted_in_chunks)
+        {
+            file.AppendSections(GroupSections[group_index]);
+        }
+        else
+        {
+            const ItemGroup& group = Groups[group_index];
+            group.WriteItems(0, group.ItemCount, file);
+        }
+    }
+
+    /// The number of items formatted together on a thread.
+    static const std::size_t ITEMS_PER_CHUNK = 2048;
+
+private:
+    // MEMBER VARIABLES.
+    /// The groups of items.
+    const std::vector<ItemGroup>& Groups;
+    /// The formatted chunks of each group's items, if they were formatted in chunks; empty otherwise.
+    std::vector<std::vector<OutputFile>> GroupSections;
+};
+
+const std::size_t ItemSections::ITEMS_PER_CHUNK;
+
+/// A Visual Studio project file.
+class ProjectFile
+{
+public:
+    /// Writes a Visual Studio project file.  Projects with many files have their inclusions
+    /// formatted in chunks on several threads (see ItemSections).
+    /// @param[in]  thread_count - The maximum number of threads to format inclusions on.
+    /// @param[in]  project - The project for the project file being generated.  All of its
+    ///     categorized code files are included in the project file.
+    /// @param[in,out]  file - The file to write to.
+    static void Write(const unsigned int thread_count, const Project& project, OutputFile& file)
+    {
+        const FolderTree& code_folder = *project.CodeFolderTree;
+        const std::vector<uint32_t>& header_files = project.CodeFiles.HeaderFiles;
+        const std::vector<uint32_t>& cpp_files = project.CodeFiles.CppFiles;
+        const std::vector<std::string>& project_folder_cpp_filenames = project.ProjectFolderCppFilenames;
+
+        // RESERVE SPACE FOR THE ENTIRE FILE.
+        // The fixed parts of the file take up a few kilobytes, and each item adds its path plus a line of markup.
+        const std::size_t FIXED_CONTENTS_SIZE_IN_BYTES = 8 * 1024;
+        const std::size_t ITEM_MARKUP_SIZE_IN_BYTES = 32;
+        std::size_t item_count = header_files.size() + cpp_files.size() + project_folder_cpp_filenames.size();
+        std::size_t expected_size_in_bytes = FIXED_CONTENTS_SIZE_IN_BYTES + item_count * ITEM_MARKUP_SIZE_IN_BYTES;
+        for (uint32_t header_file : header_files)
+        {
+            expected_size_in_bytes += code_folder.GetFilePathLength(header_file);
+        }
+        for (uint32_t cpp_file : cpp_files)
+        {
+            expected_size_in_bytes += code_folder.GetFilePathLength(cpp_file);
+        }
+        for (const auto& project_folder_cpp_filename : project_folder_cpp_filenames)
+        {
+            expected_size_in_bytes += project_folder_cpp_filename.size();
+        }
+        file.Reserve(expected_size_in_bytes);
+
+        // FORMAT THE INCLUSIONS FOR THE CODE FOLDER'S FILES.
+        const std::size_t HEADER_FILES_GROUP_INDEX = 0;
+        const std::size_t CPP_FILES_GROUP_INDEX = 1;
+        std::vector<ItemGroup> item_groups(2);
+        item_groups[HEADER_FILES_GROUP_INDEX].ItemCount = header_files.size();
+        item_groups[HEADER_FILES_GROUP_INDEX].WriteItems = [&code_folder, &header_files](
+            const std::size_t first_item_index,
+            const std::size_t end_item_index,
+            OutputFile& items_file)
+        {
+            std::string path;
+            for (std::size_t item_index = first_item_index; item_index < end_item_index; ++item_index)
+            {
+                path.clear();
+                code_folder.AppendFilePath(header_files[item_index], path);
+                WriteHeaderFile(path, items_file);
+            }
+        };
+        item_groups[CPP_FILES_GROUP_INDEX].ItemCount = cpp_files.size();
+        item_groups[CPP_FILES_GROUP_INDEX].WriteItems = [&code_folder, &cpp_files](
+            const std::size_t first_item_index,
+            const std::size_t end_item_index,
+            OutputFile& items_file)
+        {
+            std::string path;
+            for (std::size_t item_index = first_item_index; item_index < end_item_index; ++item_index)
+            {
+                path.clear();
+                code_folder.AppendFilePath(cpp_files[item_index], path);
+                WriteCppFile(path, items_file);
+            }
+        };
+        ItemSections item_sections(thread_count, item_groups);
+
+        // WRITE THE PART OF THE PROJECT FILE BEFORE THE HEADER FILES.
+        WriteStart(file);
+
+        // WRITE THE INCLUSIONS FOR THE HEADER FILES.
+        item_sections.Append(HEADER_FILES_GROUP_INDEX, file);
+
+        // WRITE THE INCLUSIONS FOR THE CPP FILES.
+        WriteBetweenHeaderAndCppFiles(file);
+        item_sections.Append(CPP_FILES_GROUP_INDEX, file);
+
+        // WRITE THE REMAINDER OF THE PROJECT FILE.
+        WriteEnd(project, file);
+    }
+
+    /// Writes a Visual Studio project file from sections of header and source file inclusions that were
+    /// built separately (see WriteHeaderFile and WriteCppFile), such as while the code folder was being scanned.
+    /// @param[in]  project - The project for the project file being generated.  Its code files aren't used.
+    /// @param[in,out]  header_files - The inclusions for the header files, which are released once appended.
+    /// @param[in,out]  cpp_files - The inclusions for the code folder's source files, which are released once appended.
+    /// @param[in,out]  file - The file to write to.
+    static void Write(const Project& project, OutputFile& header_files, OutputFile& cpp_files, OutputFile& file)
+    {
+        WriteStart(file);
+        file.AppendSection(header_files);
+        WriteBetweenHeaderAndCppFiles(file);
+        file.AppendSection(cpp_files);
+        WriteEnd(project, file);
+    }
+
+    /// Writes the inclusion of a header file in a project file.
+    /// @param[in]  path - The path of the header file.
+    /// @param[in,out]  file - The file (or section of a file) to write to.
+    static void WriteHeaderFile(const std::string& path, OutputFile& file)
+    {
+        XmlText::AppendRecord(
+            file,
+            TextFragment::From("    <ClInclude Include=\""),
+            path,
+            TextFragment::From("\" />\r\n"));
+    }
+
+    /// Writes the inclusion of a source file in a project file.
+    /// @param[in]  path - The path of the source file.
+    /// @param[in,out]  file - The file (or section of a file) to write to.
+    static void WriteCppFile(const std::string& path, OutputFile& file)
+    {
+        XmlText::AppendRecord(
+            file,
+            TextFragment::From("    <ClCompile Include=\""),
+            path,
+            TextFragment::From("\" />\r\n"));
+    }
+
+private:
+    /// Writes the part of a project file before the header files.
+    /// @param[in,out]  file - The file to write to.
+    static void WriteStart(OutputFile& file)
+    {
+        file << TextFragment::From(
+            "<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n"
+            "<Project DefaultTargets=\"Build\" ToolsVersion=\"12.0\" xmlns=\"http://schemas.microsoft.com/developer/msbuild/2003\">\r\n"
+            "  <ItemGroup Label=\"ProjectConfigurations\">\r\n"
+            "    <ProjectConfiguration Include=\"Debug|Win32\">\r\n"
+            "      <Configuration>Debug</Configuration>\r\n"
+            "      <Platform>Win32</Platform>\r\n"
+            "    </ProjectConfiguration>\r\n"
+            "    <ProjectConfiguration Include=\"Release|Win32\">\r\n"
+            "      <Configuration>Release</Configuration>\r\n"
+            "      <Platform>Win32</Platform>\r\n"
+            "    </ProjectConfiguration>\r\n"
+            "  </ItemGroup>\r\n"
+            "  <ItemGroup>\r\n");
+    }
+
+    /// Writes the part of a project file between the header and source files.
+    /// @param[in,out]  file - The file to write to.
+    static void WriteBetweenHeaderAndCppFiles(OutputFile& file)
+    {
+        file << TextFragment::From(
+            "  </ItemGroup>\r\n"
+            "  <ItemGroup>\r\n");
+    }
+
+    /// Writes the part of a project file after the source files in the code folder, starting
+    /// with the additional source files in the current folder.
+    /// @param[in]  project - The project for the project file being generated.
+    /// @param[in,out]  file - The file to write to.
+    static void WriteEnd(const Project& project, OutputFile& file)
+    {
+        // Every part of a split project builds the whole project's program.
+        const std::string& project_name = project.Name;
+        for (const auto& project_folder_cpp_filename : project.ProjectFolderCppFilenames)
+        {
+            WriteCppFile(project_folder_cpp_filename, file);
+        }
+        XmlText::AppendRecord(
+            file,
+            TextFragment::From(
+                "  </ItemGroup>\r\n"
+                "  <ItemGroup>\r\n"
+                "    <None Include=\""),
+            project.BuildScriptFilename,
+            TextFragment::From(
+                "\" />\r\n"
+                "  </ItemGroup>\r\n"
+                "  <PropertyGroup Label=\"Globals\">\r\n"
+                "    <ProjectGuid>"),
+            project.Guid,
+            TextFragment::From(
+                "</ProjectGuid>\r\n"
+                "    <Keyword>MakeFileProj</Keyword>\r\n"
+                "    <ProjectName>"),
+            project_name,
+            TextFragment::From(
+                "</ProjectName>\r\n"
+                "  </PropertyGroup>\r\n"
+                "  <Import Project=\"$(VCTargetsPath)\\Microsoft.Cpp.Default.props\" />\r\n"
+                "  <PropertyGroup Condition=\"'$(Configuration)|$(Platform)'=='Debug|Win32'\" Label=\"Configuration\">\r\n"
+                "    <ConfigurationType>Makefile</ConfigurationType>\r\n"
+                "    <UseDebugLibraries>true</UseDebugLibraries>\r\n"
+                "    <PlatformToolset>v120</PlatformToolset>\r\n"
+                "  </PropertyGroup>\r\n"
+                "  <PropertyGroup Condition=\"'$(Configuration)|$(Platform)'=='Release|Win32'\" Label=\"Configuration\">\r\n"
+                "    <ConfigurationType>Makefile</ConfigurationType>\r\n"
+                "    <UseDebugLibraries>false</UseDebugLibraries>\r\n"
+                "    <PlatformToolset>v120</PlatformToolset>\r\n"
+                "  </PropertyGroup>\r\n"
+                "  <Import Project=\"$(VCTargetsPath)\\Microsoft.Cpp.props\" />\r\n"
+                "  <ImportGroup Label=\"ExtensionSettings\">\r\n"
+                "  </ImportGroup>\r\n"
+                "  <ImportGroup Label=\"PropertySheets\" Condition=\"'$(Configuration)|$(Platform)'=='Debug|Win32'\">\r\n"
+                "    <Import Project=\"$(UserRootDir)\\Microsoft.Cpp.$(Platform).user.props\" Condition=\"exists('$(UserRootDir)\\Microsoft.Cpp.$(Platform).user.props')\" Label=\"LocalAppDataPlatform\" />\r\n"
+                "  </ImportGroup>\r\n"
+                "  <ImportGroup Label=\"PropertySheets\" Condition=\"'$(Configuration)|$(Platform)'=='Release|Win32'\">\r\n"
+                "    <Import Project=\"$(UserRootDir)\\Microsoft.Cpp.$(Platform).user.props\" Condition=\"exists('$(UserRootDir)\\Microsoft.Cpp.$(Platform).user.props')\" Label=\"LocalAppDataPlatform\" />\r\n"
+                "  </ImportGroup>\r\n"
+                "  <PropertyGroup Label=\"UserMacros\" />\r\n"
+                "  <PropertyGroup Condition=\"'$(Configuration)|$(Platform)'=='Debug|Win32'\">\r\n"
+                "    <NMakeBuildCommandLine>"),
+            project.BuildCommandLine,
+            TextFragment::From(
+                "</NMakeBuildCommandLine>\r\n"
+                "    <NMakeOutput>"),
+            project.ProgramPath,
+            TextFragment::From(
+                "</NMakeOutput>\r\n"
+                "    <NMakePreprocessorDefinitions>WIN32;_DEBUG;$(NMakePreprocessorDefinitions)</NMakePreprocessorDefinitions>\r\n"
+                "    <OutDir>build\\</OutDir>\r\n"
+                "    <IntDir>build\\</IntDir>\r\n"
+                "  </PropertyGroup>\r\n"
+                "  <PropertyGroup Condition=\"'$(Configuration)|$(Platform)'=='Release|Win32'\">\r\n"
+                "    <NMakeBuildCommandLine>"),
+            project.BuildCommandLine,
+            TextFragment::From(
+                "</NMakeBuildCommandLine>\r\n"
+                "    <NMakeOutput>"),
+            project.ProgramPath,
+            TextFragment::From(
+                "</NMakeOutput>\r\n"
+                "    <NMakePreprocessorDefinitions>WIN32;NDEBUG;$(NMakePreprocessorDefinitions)</NMakePreprocessorDefinitions>\r\n"
+                "    <OutDir>build\\</OutDir>\r\n"
+                "    <IntDir>build\\</IntDir>\r\n"
+                "  </PropertyGroup>\r\n"
+                "  <ItemDefinitionGroup>\r\n"
+                "  </ItemDefinitionGroup>\r\n"
+                "  <Import Project=\"$(VCTargetsPath)\\Microsoft.Cpp.targets\" />\r\n"
+                "  <ImportGroup Label=\"ExtensionTargets\">\r\n"
+                "  </ImportGroup>\r\n"
+                "</Project>\r\n"));
+    }
+};
+
+/// A Visual Studio project filters file.
+class ProjectFiltersFile
+{
+public:
+    /// Writes a Visual Studio project filters file.  Projects with many files have their items
+    /// formatted in chunks on several threads (see ItemSections).
+    /// @param[in]  thread_count - The maximum number of threads to format items on.
+    /// @param[in]  project - The project for the project filters file being generated.  All of its
+    ///     categorized code files are included in the file, and all folders in its code folder
+    ///     are included as filters.
+    /// @param[in,out]  file - The file to write to.
+    static void Write(const unsigned int thread_count, const Project& project, OutputFile& file)
+    {
+        const FolderTree& code_folder = *project.CodeFolderTree;
+        const std::vector<uint32_t>& header_files = project.CodeFiles.HeaderFiles;
+        const std::vector<uint32_t>& cpp_files = project.CodeFiles.CppFiles;
+        const std::vector<std::string>& project_folder_cpp_filenames = project.ProjectFolderCppFilenames;
+        // The project's folders are its code folder and all of the folders following it in the tree,
+        // up to the end of its code folder's subtree or of its part of a split project.
+        uint32_t first_folder_index = project.CodeFolderIndex;
+        bool project_ends_early = (FolderTree::NO_INDEX != project.CodeFolderEndIndex);
+        uint32_t end_folder_index = project_ends_early ? project.CodeFolderEndIndex : code_folder.Folders[first_folder_index].SubtreeEndIndex;
+
+        // RESERVE SPACE FOR THE ENTIRE FILE.
+        // Each file item has its path, its folder's path, and a few lines of markup,
+        // and each folder has its path and a few lines of markup.
+        const std::size_t FIXED_CONTENTS_SIZE_IN_BYTES = 1024;
+        const std::size_t FILE_ITEM_MARKUP_SIZE_IN_BYTES = 80;
+        const std::size_t FOLDER_ITEM_MARKUP_SIZE_IN_BYTES = 128;
+        std::size_t file_item_count = header_files.size() + cpp_files.size() + project_folder_cpp_filenames.size();
+        std::size_t expected_size_in_bytes = (
+            FIXED_CONTENTS_SIZE_IN_BYTES +
+            file_item_count * FILE_ITEM_MARKUP_SIZE_IN_BYTES +
+            (end_folder_index - first_folder_index) * FOLDER_ITEM_MARKUP_SIZE_IN_BYTES);
+        for (uint32_t folder_index = first_folder_index; folder_index < end_folder_index; ++folder_index)
+        {
+            expected_size_in_bytes += code_folder.GetFolderPathLength(folder_index);
+        }
+        for (uint32_t header_file : header_files)
+        {
+            expected_size_in_bytes += code_folder.GetFilePathLength(header_file) + code_folder.GetFolderPathLength(code_folder.Files[header_file].FolderIndex);
+        }
+        for (uint32_t cpp_file : cpp_files)
+        {
+            expected_size_in_bytes += code_folder.GetFilePathLength(cpp_file) + code_folder.GetFolderPathLength(code_folder.Files[cpp_file].FolderIndex);
+        }
+        for (const auto& project_folder_cpp_filename : project_folder_cpp_filenames)
+        {
+            expected_size_in_bytes += project_folder_cpp_filename.size();
+        }
+        file.Reserve(expected_size_in_bytes);
+
+        // FORMAT THE ITEMS FOR THE CODE FOLDER'S FILES AND FOLDERS.
+        const std::size_t CPP_FILES_GROUP_INDEX = 0;
+        const std::size_t FOLDERS_GROUP_INDEX = 1;
+        const std::size_t HEADER_FILES_GROUP_INDEX = 2;
+        std::vector<ItemGroup> item_groups(3);
+        item_groups[CPP_FILES_GROUP_INDEX].ItemCount = cpp_files.size();
+        item_groups[CPP_FILES_GROUP_INDEX].WriteItems = [&code_folder, &cpp_files](
+            const std::size_t first_item_index,
+            const std::size_t end_item_index,
+            OutputFile& items_file)
+        {
+            std::string path;
+            std::string folder_path;
+            for (std::size_t item_index = first_item_index; item_index < end_item_index; ++item_index)
+            {
+                uint32_t cpp_file = cpp_files[item_index];
+                path.clear();
+                code_folder.AppendFilePath(cpp_file, path);
+                folder_path.clear();
+                code_folder.AppendFolderPath(code_folder.Files[cpp_file].FolderIndex, folder_path);
+                WriteCppFile(path, folder_path, items_file);
+            }
+        };
+        item_groups[FOLDERS_GROUP_INDEX].ItemCount = end_folder_index - first_folder_index;
+        item_groups[FOLDERS_GROUP_INDEX].WriteItems = [&code_folder, first_folder_index](
+            const std::size_t first_item_index,
+            const std::size_t end_item_index,
+            OutputFile& items_file)
+        {
+            std::string folder_path;
+            for (std::size_t item_index = first_item_index; item_index < end_item_index; ++item_index)
+            {
+                folder_path.clear();
+                code_folder.AppendFolderPath(first_folder_index + static_cast<uint32_t>(item_index), folder_path);
+                WriteFolder(folder_path, items_file);
+            }
+        };
+        item_groups[HEADER_FILES_GROUP_INDEX].ItemCount = header_files.size();
+        item_groups[HEADER_FILES_GROUP_INDEX].WriteItems = [&code_folder, &header_files](
+            const std::size_t first_item_index,
+            const std::size_t end_item_index,
+            OutputFile& items_file)
+        {
+            std::string path;
+            std::string folder_path;
+            for (std::size_t item_index = first_item_index; item_index < end_item_index; ++item_index)
+            {
+                uint32_t header_file = header_files[item_index];
+                path.clear();
+                code_folder.AppendFilePath(header_file, path);
+                folder_path.clear();
+                code_folder.AppendFolderPath(code_folder.Files[header_file].FolderIndex, folder_path);
+                WriteHeaderFile(path, folder_path, items_file);
+            }
+        };
+        ItemSections item_sections(thread_count, item_groups);
+
+        // WRITE THE PART OF THE FILE BEFORE THE CPP FILES.
+        WriteStart(file);
+
+        // WRITE THE CPP FILES.
+        item_sections.Append(CPP_FILES_GROUP_INDEX, file);
+
+        // WRITE THE PART OF THE FILE BETWEEN THE CPP FILES AND FOLDER FILTERS.
+        WriteBetweenCppFilesAndFolders(project, file);
+
+        // WRITE THE FOLDER FILTERS.
+        item_sections.Append(FOLDERS_GROUP_INDEX, file);
+
+        // WRITE THE HEADER FILES.
+        WriteBetweenFoldersAndHeaderFiles(file);
+        item_sections.Append(HEADER_FILES_GROUP_INDEX, file);
+
+        // WRITE THE REMAINDER OF THE FILE.
+        WriteEnd(file);
+    }
+
+    /// Writes a Visual Studio project filters file from sections of source files, folder filters, and header files
+    /// that were built separately (see WriteCppFile, WriteFolder, and WriteHeaderFile), such as while the code folder
+    /// was being scanned.
+    /// @param[in]  project - The project for the project filters file being generated.  Its code files aren't used.
+    /// @param[in,out]  cpp_files - The code folder's source files, which are released once appended.
+    /// @param[in,out]  folders - The folder filters, which are released once appended.
+    /// @param[in,out]  header_files - The header files, which are released once appended.
+    /// @param[in,out]  file - The file to write to.
+    static void Write(const Project& project, OutputFile& cpp_files, OutputFile& folders, OutputFile& header_files, OutputFile& file)
+    {
+        WriteStart(file);
+        file.AppendSection(cpp_files);
+        WriteBetweenCppFilesAndFolders(project, file);
+        file.AppendSection(folders);
+        WriteBetweenFoldersAndHeaderFiles(file);
+        file.AppendSection(header_files);
+        WriteEnd(file);
+    }
+
+    /// Writes a source file in a project filters file.
+    /// @param[in]  path - The path of the source file.
+    /// @param[in]  folder_path - The path of the folder containing the file, which is its filter.
+    /// @param[in,out]  file - The file (or section of a file) to write to.
+    static void WriteCppFile(const std::string& path, const std::string& folder_path, OutputFile& file)
+    {
+        XmlText::AppendRecord(
+            file,
+            TextFragment::From("    <ClCompile Include=\""),
+            path,
+            TextFragment::From(
+                "\">\r\n"
+                "      <Filter>"),
+            folder_path,
+            TextFragment::From(
+                "</Filter>\r\n"
+                "    </ClCompile>\r\n"));
+    }
+
+    /// Writes a folder filter in a project filters file.
+    /// @param[in]  folder_path - The path of the folder.
+    /// @param[in,out]  file - The file (or section of a file) to write to.
+    static void WriteFolder(const std::string& folder_path, OutputFile& file)
+    {
+        // Re-using the same unique IDs here does not seem to cause any problems.
+        XmlText::AppendRecord(
+            file,
+            TextFragment::From("    <Filter Include=\""),
+            folder_path,
+            TextFragment::From(
+                "\">\r\n"
+                "      <UniqueIdentifier>{96873809-db68-49b8-8a4b-a40a3c3972f6}</UniqueIdentifier>\r\n"
+                "    </Filter>\r\n"));
+    }
+
+    /// Writes a header file in a project filters file.
+    /// @param[in]  path - The path of the header file.
+    /// @param[in]  folder_path - The path of the folder containing the file, which is its filter.
+    /// @param[in,out]  file - The file (or section of a file) to write to.
+    static void WriteHeaderFile(const std::string& path, const std::string& folder_path, OutputFile& file)
+    {
+        XmlText::AppendRecord(
+            file,
+            TextFragment::From("    <ClInclude Include=\""),
+            path,
+            TextFragment::From(
+                "\">\r\n"
+                "      <Filter>"),
+            folder_path,
+            TextFragment::From(
+                "</Filter>\r\n"
+                "    </ClInclude>\r\n"));
+    }
+
+private:
+    /// Writes the part of a project filters file before the source files.
+    /// @param[in,out]  file - The file to write to.
+    static void WriteStart(OutputFile& file)
+    {
+        file << TextFragment::From(
+            "<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n"
+            "<Project ToolsVersion=\"4.0\" xmlns=\"http://schemas.microsoft.com/developer/msbuild/2003\">\r\n"
+            "  <ItemGroup>\r\n");
+    }
+
+    /// Writes the part of a project filters file after the source files in the code folder and before the folder
+    /// filters, starting with the additional source files in the current folder.
+    /// @param[in]  project - The project for the project filters file being generated.
+    /// @param[in,out]  file - The file to write to.
+    static void WriteBetweenCppFilesAndFolders(const Project& project, OutputFile& file)
+    {
+        for (const auto& project_folder_cpp_filename : project.ProjectFolderCppFilenames)
+        {
+            // Files in the current folder aren't in any filter.
+            const std::string NO_FILTER = "";
+            WriteCppFile(project_folder_cpp_filename, NO_FILTER, file);
+        }
+        XmlText::AppendRecord(
+            file,
+            TextFragment::From(
+                "  </ItemGroup>\r\n"
+                "  <ItemGroup>\r\n"
+                "    <None Include=\""),
+            project.BuildScriptFilename,
+            TextFragment::From(
+                "\" />\r\n"
+                "  </ItemGroup>\r\n"
+                "  <ItemGroup>\r\n"));
+    }
+
+    /// Writes the part of a project filters file between the folder filters and header files.
+    /// @param[in,out]  file - The file to write to.
+    static void WriteBetweenFoldersAndHeaderFiles(OutputFile& file)
+    {
+        file << TextFragment::From(
+            "  </ItemGroup>\r\n"
+            "  <ItemGroup>\r\n");
+    }
+
+    /// Writes the part of a project filters file after the header files.
+    /// @param[in,out]  file - The file to write to.
+    static void WriteEnd(OutputFile& file)
+    {
+        file << TextFragment::From(
+            "  </ItemGroup>\r\n"
+            "</Project>\r\n");
+    }
+};
+
+/// Patches existing project and filters files with newly generated items instead of replacing them, so that
+/// anything edited by hand (such as compiler settings or per-file properties) is kept.
+///
+/// Each file is read with XmlReader, and the item groups of source files (ClCompile), header files (ClInclude),
+/// and folder filters (Filter) are compared with the same groups in the generated file by each item's Include path.
+/// Groups with the same items are kept byte for byte.  Groups whose items changed are rewritten in the generated
+/// order, but items that were already present are still copied from the existing file (with any properties added
+/// to them), so only added and removed items differ.  Everything outside of these item groups is kept as-is.
+/// This keeps changes small and lets Visual Studio reload projects quickly.
+class ProjectFilePatch
+{
+public:
+    /// Patches the existing file for a generated project or filters file.  If there's no existing file, or it can't
+    /// be patched (such as if it isn't well-formed), the generated file is left as-is to replace it.
+    /// @param[in,out]  file - The generated file, which must be entirely in memory.  Its contents are replaced
+    ///     with the patched contents of the existing file.
+    static void Apply(OutputFile& file)
+    {
+        // READ THE EXISTING FILE.
+        MemoryMappedFile existing_file;
+        bool existing_file_mapped = existing_file.Open(file.Path) && existing_file.Data;
+        if (!existing_file_mapped)
+        {
+            return;
+        }
+        Document existing_document(existing_file.Data, existing_file.Size);
+        bool existing_document_read = XmlReader::Read(existing_file.Data, existing_file.Size, existing_document);
+        if (!existing_document_read)
+        {
+            std::cerr << "Failed to read " << file.Path << " to patch it, so it will be replaced" << std::endl;
+            return;
+        }
+
+        // FIND THE CHANGES TO EACH MANAGED ITEM GROUP.
+        Document generated_document(file.Contents.data(), file.Contents.size());
+        bool generated_document_read = XmlReader::Read(file.Contents.data(), file.Contents.size(), generated_document);
+        std::vector<Edit> edits;
+        bool edits_found = generated_document_read && FindEdits(existing_file.Data, existing_document, file.Contents.data(), generated_document, edits);
+        if (!edits_found)
+        {
+            std::cerr << "Failed to match the item groups in " << file.Path << " to patch it, so it will be replaced" << std::endl;
+            return;
+        }
+
+        // APPLY THE CHANGES.
+        // Insertions are made in the order they're found, so they stay in the generated order.
+        std::stable_sort(
+            edits.begin(),
+            edits.end(),
+            [](const Edit& left, const Edit& right) { return left.StartOffset < right.StartOffset; });
+        std::string patched_contents;
+        patched_contents.reserve(existing_file.Size + file.Contents.size() / 2);
+        std::size_t offset = 0;
+        for (const auto& edit : edits)
+        {
+            patched_contents.append(existing_file.Data + offset, edit.StartOffset - offset);
+            patched_contents.append(edit.Replacement);
+            offset = edit.EndOffset;
+        }
+        patched_contents.append(existing_file.Data + offset, existing_file.Size - offset);
+        file.Contents = std::move(patched_contents);
+    }
+
+private:
+    /// An item in an item group, such as a source file.
+    struct Item
+    {
+        /// The type of the item (the name of its element), which isn't null-terminated.
+        const char* Type;
+        /// The number of characters in the type.
+        std::size_t TypeLength;
+        /// Determines if the item includes the same path as another item.
+        /// @param[in]  other_item - The other item.
+        /// @return True if the items include the same path; false otherwise.
+        bool IncludeEquals(const Item& other_item) const
+        {
+            return (IncludeLength == other_item.IncludeLength) && (0 == std::memcmp(Include, other_item.Include, IncludeLength));
+        }
+
+        /// Determines if the item's included path comes before another item's.
+        /// @param[in]  other_item - The other item.
+        /// @return True if the item's included path comes first; false otherwise.
+        bool IncludeLessThan(const Item& other_item) const
+        {
+            int comparison = std::memcmp(Include, other_item.Include, std::min(IncludeLength, other_item.IncludeLength));
+            return (comparison < 0) || (0 == comparison && IncludeLength < other_item.IncludeLength);
+        }
+
+        /// The path (or other value) the item includes, with any references replaced.  It isn't null-terminated,
+        /// and it refers directly to the document unless it had references.
+        const char* Include;
+        /// The number of characters in the included path.
+        std::size_t IncludeLength;
+        /// The offset of the item, including the indentation on its line.
+        std::size_t StartOffset;
+        /// The offset just past the item, including the rest of its line.
+        std::size_t EndOffset;
+    };
+
+    /// A top-level item group in a project or filters file.
+    struct ItemGroup
+    {
+        /// Determines if every item in the group has the same type.
+        /// @return True if the group has a single type of item; false if it's empty or has several types.
+        bool HasSingleItemType() const
+        {
+            return !Items.empty() && std::all_of(
+                Items.cbegin(),
+                Items.cend(),
+                [this](const Item& item)
+                {
+                    return (Items.front().TypeLength == item.TypeLength) && (0 == std::memcmp(Items.front().Type, item.Type, item.TypeLength));
+                });
+        }
+
+        /// Determines if the group has any item of a type.
+        /// @param[in]  item_type - The type to check for.
+        /// @return True if the group has an item of the type; false otherwise.
+        bool HasItemType(const TextFragment& item_type) const
+        {
+            return std::any_of(
+                Items.cbegin(),
+                Items.cend(),
+                [&item_type](const Item& item)
+                {
+                    return (item_type.Length == item.TypeLength) && (0 == std::memcmp(item_type.Characters, item.Type, item.TypeLength));
+                });
+        }
+
+        /// The offset of the group, including the indentation on its line.
+        std::size_t StartOffset = 0;
+        /// The offset just past the group, including the rest of its line.
+        std::size_t EndOffset = 0;
+        /// The items in the group.
+        std::vector<Item> Items = {};
+    };
+
+    /// The item groups in a project or filters file, collected as the file is read (see XmlReader::Read).
+    struct Document
+    {
+        /// Constructor.
+        /// @param[in]  text - The characters of the document.
+        /// @param[in]  text_length - The number of characters in the document.
+        explicit Document(const char* text, const std::size_t text_length) :
+            Text(text),
+            TextLength(text_length)
+        {}
+
+        /// Handles the start of an element.
+        /// @param[in]  tag - The element's start tag.
+        void StartElement(const XmlReader::Tag& tag)
+        {
+            // START ANY ITEM GROUP.
+            // Item groups are children of the Project root element.
+            const std::size_t ITEM_GROUP_DEPTH = 1;
+            const std::size_t ITEM_DEPTH = 2;
+            bool is_item_group = (ITEM_GROUP_DEPTH == Depth) && tag.NameIs(TextFragment::From("ItemGroup"));
+            if (is_item_group)
+            {
+                ItemGroups.emplace_back();
+                ItemGroups.back().StartOffset = GetLineStart(tag.StartOffset);
+                InItemGroup = true;
+            }
+
+            // START ANY ITEM.
+            bool is_item = InItemGroup && (ITEM_DEPTH == Depth);
+            if (is_item)
+            {
+                // Paths almost never have references, so only those that do need to be copied.
+                const XmlReader::Attribute* include = tag.FindAttribute(TextFragment::From("Include"));
+                Item item;
+                item.Type = tag.Name;
+                item.TypeLength = tag.NameLength;
+                item.Include = include ? include->Value : "";
+                item.IncludeLength = include ? include->ValueLength : 0;
+                bool include_escaped = (nullptr != std::memchr(item.Include, '&', item.IncludeLength));
+                if (include_escaped)
+                {
+                    UnescapedIncludes.push_back(XmlReader::Unescape(item.Include, item.IncludeLength));
+                    item.Include = UnescapedIncludes.back().data();
+                    item.IncludeLength = UnescapedIncludes.back().size();
+                }
+                item.StartOffset = GetLineStart(tag.StartOffset);
+                item.EndOffset = item.StartOffset;
+                ItemGroups.back().Items.push_back(item);
+            }
+            ++Depth;
+        }
+
+        /// Handles the end of an element.
+        /// @param[in]  tag - The element's end tag, or its start tag if it's empty.
+        void EndElement(const XmlReader::Tag& tag)
+        {
+            // END ANY ITEM OR ITEM GROUP.
+            --Depth;
+            const std::size_t PROJECT_DEPTH = 0;
+            const std::size_t ITEM_GROUP_DEPTH = 1;
+            const std::size_t ITEM_DEPTH = 2;
+            bool is_item = InItemGroup && (ITEM_DEPTH == Depth);
+            bool is_item_group = InItemGroup && (ITEM_GROUP_DEPTH == Depth);
+            if (is_item)
+            {
+                ItemGroups.back().Items.back().EndOffset = GetLineEnd(tag.EndOffset);
+            }
+            else if (is_item_group)
+            {
+                ItemGroups.back().EndOffset = GetLineEnd(tag.EndOffset);
+                InItemGroup = false;
+            }
+            else if (PROJECT_DEPTH == Depth)
+            {
+                ProjectEndOffset = GetLineStart(tag.StartOffset);
+            }
+        }
+
+        /// Gets the start of the line containing markup if only indentation precedes it on its line.
+        /// @param[in]  offset - The offset of the markup.
+        /// @return The offset of the start of the line, or of the markup if anything else precedes it.
+        std::size_t GetLineStart(const std::size_t offset) const
+        {
+            std::size_t line_start = offset;
+            while (line_start > 0 && (' ' == Text[line_start - 1] || '\t' == Text[line_start - 1]))
+            {
+                --line_start;
+            }
+            bool line_starts_with_markup = (0 == line_start) || ('\n' == Text[line_start - 1]);
+            return line_starts_with_markup ? line_start : offset;
+        }
+
+        /// Gets the end of the line containing markup if nothing but whitespace follows it on its line.
+        /// @param[in]  offset - The offset just past the markup.
+        /// @return The offset just past the end of the line, or just past the markup if anything else follows it.
+        std::size_t GetLineEnd(const std::size_t offset) const
+        {
+            std::size_t line_end = offset;
+            while (line_end < TextLength && (' ' == Text[line_end] || '\t' == Text[line_end] || '\r' == Text[line_end]))
+            {
+                ++line_end;
+            }
+            bool line_ends_with_markup = (line_end < TextLength) && ('\n' == Text[line_end]);
+            return line_ends_with_markup ? (line_end + 1) : offset;
+        }
+
+        /// The characters of the document.
+        const char* Text;
+        /// The number of characters in the document.
+        std::size_t TextLength;
+        /// The top-level item groups in the document.
+        std::vector<ItemGroup> ItemGroups = {};
+        /// The included paths of items that had references replaced, which items refer to.
+        std::deque<std::string> UnescapedIncludes = {};
+        /// The offset of the root element's end tag, including the indentation on its line.
+        std::size_t ProjectEndOffset = 0;
+        /// The number of elements currently open.
+        std::size_t Depth = 0;
+        /// True if an item group is currently open; false otherwise.
+        bool InItemGroup = false;
+    };
+
+    /// A replacement of part of an existing file.
+    struct Edit
+    {
+        /// The offset of the first character to replace.
+        std::size_t StartOffset;
+        /// The offset just past the last character to replace.  The same as the start offset for insertions.
+        std::size_t EndOffset;
+        /// The text to replace the characters with.
+        std::string Replacement;
+    };
+
+    /// The types of items in the item groups that are patched.  Other item groups are left as they are.
+    static const TextFragment PATCHED_ITEM_TYPES[3];
+
+    /// Finds the edits to make to an existing file so that its patched item groups have the generated items.
+    /// @param[in]  existing_text - The characters of the existing file.
+    /// @param[in]  existing_document - The item groups in the existing file.
+    /// @param[in]  generated_text - The characters of the generated file.
+    /// @param[in]  generated_document - The item groups in the generated file.
+    /// @param[out]  edits - The edits to make, with insertions in the order they should be made.
+    /// @return True if the edits were found; false if the item groups in the existing file can't be matched
+    ///     to the generated ones (such as if some have several types of patched items).
+    static bool FindEdits(
+        const char* existing_text,
+        const Document& existing_document,
+        const char* generated_text,
+        const Document& generated_document,
+        std::vector<Edit>& edits)
+    {
+        // FIND THE GROUP FOR EACH TYPE OF PATCHED ITEM.
+        // Each type must be in a single group by itself in both files.
+        const std::size_t PATCHED_ITEM_TYPE_COUNT = sizeof(PATCHED_ITEM_TYPES) / sizeof(PATCHED_ITEM_TYPES[0]);
+        const ItemGroup* existing_item_groups[PATCHED_ITEM_TYPE_COUNT] = {};
+        const ItemGroup* generated_item_groups[PATCHED_ITEM_TYPE_COUNT] = {};
+        for (std::size_t item_type_index = 0; item_type_index < PATCHED_ITEM_TYPE_COUNT; ++item_type_index)
+        {
+            bool existing_item_group_found = FindItemGroup(existing_document, PATCHED_ITEM_TYPES[item_type_index], existing_item_groups[item_type_index]);
+            bool generated_item_group_found = FindItemGroup(generated_document, PATCHED_ITEM_TYPES[item_type_index], generated_item_groups[item_type_index]);
+            if (!existing_item_group_found || !generated_item_group_found)
+            {
+                return false;
+            }
+        }
+
+        // ORDER THE ITEM TYPES AS THEY ARE IN THE GENERATED FILE.
+        // This is where groups missing from the existing file are inserted.
+        std::vector<std::size_t> item_type_indices;
+        for (const auto& generated_item_group : generated_document.ItemGroups)
+        {
+            for (std::size_t item_type_index = 0; item_type_index < PATCHED_ITEM_TYPE_COUNT; ++item_type_index)
+            {
+                if (generated_item_groups[item_type_index] == &generated_item_group)
+                {
+                    item_type_indices.push_back(item_type_index);
+                }
+            }
+        }
+
+        // FIND THE EDITS FOR EACH TYPE OF ITEM.
+        for (std::size_t item_type_order_index = 0; item_type_order_index < item_type_indices.size(); ++item_type_order_index)
+        {
+            std::size_t item_type_index = item_type_indices[item_type_order_index];
+            const ItemGroup* existing_item_group = existing_item_groups[item_type_index];
+            const ItemGroup* generated_item_group = generated_item_groups[item_type_index];
+
+            // INSERT A NEW GROUP IF THE EXISTING FILE DOESN'T HAVE ONE.
+            // It goes before the group for the next type of item, or after the last item group.
+            if (!existing_item_group)
+            {
+                std::size_t insertion_offset = existing_document.ItemGroups.empty() ?
+                    existing_document.ProjectEndOffset :
+                    existing_document.ItemGroups.back().EndOffset;
+                for (std::size_t next_item_type_order_index = item_type_order_index + 1; next_item_type_order_index < item_type_indices.size(); ++next_item_type_order_index)
+                {
+                    const ItemGroup* next_existing_item_group = existing_item_groups[item_type_indices[next_item_type_order_index]];
+                    if (next_existing_item_group)
+                    {
+                        insertion_offset = next_existing_item_group->StartOffset;
+                        break;
+                    }
+                }
+                std::string item_group_text(generated_text + generated_item_group->StartOffset, generated_item_group->EndOffset - generated_item_group->StartOffset);
+                edits.push_back({ insertion_offset, insertion_offset, std::move(item_group_text) });
+                continue;
+            }
+
+            // KEEP THE EXISTING GROUP IF IT HAS THE SAME ITEMS.
+            bool items_unchanged = std::equal(
+                existing_item_group->Items.cbegin(),
+                existing_item_group->Items.cend(),
+                generated_item_group->Items.cbegin(),
+                generated_item_group->Items.cend(),
+                [](const Item& existing_item, const Item& generated_item) { return existing_item.IncludeEquals(generated_item); });
+            if (items_unchanged)
+            {
+                continue;
+            }
+
+            // REPLACE THE GROUP'S ITEMS.
+            // Items that were already there are kept as they were, and they're sorted by path to be found.
+            std::vector<const Item*> existing_items;
+            for (const auto& existing_item : existing_item_group->Items)
+            {
+                existing_items.push_back(&existing_item);
+            }
+            auto include_less_than = [](const Item* left, const Item* right) { return left->IncludeLessThan(*right); };
+            std::stable_sort(existing_items.begin(), existing_items.end(), include_less_than);
+            std::string items_text;
+            for (const auto& generated_item : generated_item_group->Items)
+            {
+                auto existing_item = std::lower_bound(existing_items.cbegin(), existing_items.cend(), &generated_item, include_less_than);
+                bool item_existed = (existing_items.cend() != existing_item) && (*existing_item)->IncludeEquals(generated_item);
+                if (item_existed)
+                {
+                    items_text.append(existing_text + (*existing_item)->StartOffset, (*existing_item)->EndOffset - (*existing_item)->StartOffset);
+                }
+                else
+                {
+                    items_text.append(generated_text + generated_item.StartOffset, generated_item.EndOffset - generated_item.StartOffset);
+                }
+            }
+            edits.push_back({ existing_item_group->Items.front().StartOffset, existing_item_group->Items.back().EndOffset, std::move(items_text) });
+        }
+
+        // REMOVE GROUPS FOR TYPES OF ITEMS THAT ARE NO LONGER GENERATED.
+        for (std::size_t item_type_index = 0; item_type_index < PATCHED_ITEM_TYPE_COUNT; ++item_type_index)
+        {
+            const ItemGroup* existing_item_group = existing_item_groups[item_type_index];
+            bool item_group_removed = existing_item_group && !generated_item_groups[item_type_index];
+            if (item_group_removed)
+            {
+                edits.push_back({ existing_item_group->StartOffset, existing_item_group->EndOffset, "" });
+            }
+        }
+        return true;
+    }
+
+    /// Finds the item group for a type of patched item.
+    /// @param[in]  document - The document to search.
+    /// @param[in]  item_type - The type of item to find the group for.
+    /// @param[out]  item_group - The group with the type of item, or null if there isn't one.
+    /// @return True if there's at most one group with the type of item and it doesn't have any other types; false otherwise.
+    static bool FindItemGroup(const Document& document, const TextFragment& item_type, const ItemGroup*& item_group)
+    {
+        item_group = nullptr;
+        for (const auto& candidate_item_group : document.ItemGroups)
+        {
+            bool has_item_type = candidate_item_group.HasItemType(item_type);
+            if (!has_item_type)
+            {
+                continue;
+            }
+            bool item_group_unique = !item_group && candidate_item_group.HasSingleItemType();
+            if (!item_group_unique)
+            {
+                return false;
+            }
+            item_group = &candidate_item_group;
+        }
+        return true;
+    }
+};
+
+const TextFragment ProjectFilePatch::PATCHED_ITEM_TYPES[3] =
+{
+    TextFragment::From("ClInclude"),
+    TextFragment::From("ClCompile"),
+    TextFragment::From("Filter")
+};
+
+/// Generates a project's project and filters files while its code folder is being scanned (see FolderStream),
+/// for code folders so large that the scanned tree or the generated files won't fit in memory.
+///
+/// Each section of the files that lists folders or files (the header files, source files, and folder filters) is built
+/// separately as each folder is visited, and once every folder has been visited, the sections are stitched together with
+/// the rest of each file.  The sections and the files themselves spill to temporary files once they outgrow their share
+/// of the memory budget (see OutputFile), so memory use stays within the budget no matter how large the code folder is.
+/// The generated files are identical to the ones generated from a fully scanned tree.
+class StreamedProjectFiles
+{
+public:
+    /// Generates the project and filters files for a project, scanning its code folder.
+    /// @param[in]  project - The project to generate files for.  Its code folder isn't scanned yet.
+    /// @param[in]  ignore_settings - The settings for which files and folders to leave out.
+    /// @param[in]  thread_count - The number of threads to use for scanning.
+    ///     Zero uses one thread per hardware core.
+    /// @param[in]  memory_budget_in_bytes - The maximum memory to use for listings and generated contents.
+    /// @param[in,out]  debug_output - The stream to print every scanned folder and file to, or null if they shouldn't be printed.
+    /// @param[in,out]  project_file - The project file to write.
+    /// @param[in,out]  project_filters_file - The project filters file to write.
+    /// @return The number of folders and files scanned.
+    static ScanCounts Write(
+        const Project& project,
+        const IgnoreSettings& ignore_settings,
+        const unsigned int thread_count,
+        const std::size_t memory_budget_in_bytes,
+        std::ostream* debug_output,
+        OutputFile& project_file,
+        OutputFile& project_filters_file)
+    {
+        // SPLIT THE MEMORY BUDGET.
+        // Listings only take up memory while scanning, and at most five sections and one file are in memory at once.
+        const std::size_t LISTING_BUDGET_DIVISOR = 4;
+        const std::size_t OUTPUT_BUDGET_DIVISOR = 8;
+        std::size_t max_buffered_listing_bytes = memory_budget_in_bytes / LISTING_BUDGET_DIVISOR;
+        std::size_t max_buffered_output_bytes = memory_budget_in_bytes / OUTPUT_BUDGET_DIVISOR;
+
+        // CREATE THE SECTIONS OF THE FILES.
+        // Each section is named after the file it's part of so that any spill file ends up next to the file.
+        OutputFile project_header_files(project_file.Path + ".ClInclude");
+        OutputFile project_cpp_files(project_file.Path + ".ClCompile");
+        OutputFile filters_cpp_files(project_filters_file.Path + ".ClCompile");
+        OutputFile filters_folders(project_filters_file.Path + ".Filter");
+        OutputFile filters_header_files(project_filters_file.Path + ".ClInclude");
+        std::vector<OutputFile*> sections = { &project_header_files, &project_cpp_files, &filters_cpp_files, &filters_folders, &filters_header_files };
+        for (OutputFile* section : sections)
+        {
+            section->LimitMemory(max_buffered_output_bytes);
+        }
+
+        // ADD EACH FOLDER AND ITS CODE FILES TO THE SECTIONS AS IT'S SCANNED.
+        ScanCounts scan_counts;
+        {
+            const bool IS_PHASE = true;
+            TraceSpan scan_span("scan", &project.CodeFolderPath, IS_PHASE);
+            std::string file_path;
+            FolderStream::Visit(
+                project.CodeFolderPath,
+                ignore_settings,
+                thread_count,
+                max_buffered_listing_bytes,
+                [&](const ScannedFolder& folder)
+                {
+                    // ADD THE FOLDER'S FILTER.
+                    ++scan_counts.FolderCount;
+                    const std::string& folder_path = folder.RelativePath;
+                    ProjectFiltersFile::WriteFolder(folder_path, filters_folders);
+                    if (debug_output)
+                    {
+                        *debug_output << "RelativePath: " << folder_path << '\n' << "Files: " << '\n';
+                    }
+
+                    // ADD THE FOLDER'S CODE FILES.
+                    for (uint32_t file_name_offset : folder.FileNameOffsets)
+                    {
+                        ++scan_counts.FileCount;
+                        const char* file_name = folder.GetEntryName(file_name_offset);
+                        std::size_t file_name_length = std::strlen(file_name);
+                        file_path.assign(folder_path).append(PATH_SEPARATOR).append(file_name, file_name_length);
+                        if (debug_output)
+                        {
+                            *debug_output << "\t" << file_path << '\n';
+                        }
+
+                        FileCategory category = CategorizedFileIndex::Categorize(file_name, file_name_length);
+                        switch (category)
+                        {
+                            case FileCategory::HEADER:
+                                ++scan_counts.HeaderFileCount;
+                                ProjectFile::WriteHeaderFile(file_path, project_header_files);
+                                ProjectFiltersFile::WriteHeaderFile(file_path, folder_path, filters_header_files);
+                                break;
+                            case FileCategory::CPP:
+                                ++scan_counts.CppFileCount;
+                                ProjectFile::WriteCppFile(file_path, project_cpp_files);
+                                ProjectFiltersFile::WriteCppFile(file_path, folder_path, filters_cpp_files);
+                                break;
+                            case FileCategory::OTHER:
+                                break;
+                        }
+                    }
+                    if (debug_output)
+                    {
+                        *debug_output << "Subfolders: " << '\n';
+                    }
+                });
+            if (debug_output)
+            {
+                debug_output->flush();
+            }
+        }
+
+        // STITCH THE SECTIONS TOGETHER INTO EACH FILE.
+        // The project file is written before the filters file is stitched together so that only one is in memory at once.
+        {
+            const bool IS_PHASE = true;
+            TraceSpan write_span("write", &project_file.Path, IS_PHASE);
+            project_file.LimitMemory(max_buffered_output_bytes);
+            ProjectFile::Write(project, project_header_files, project_cpp_files, project_file);
+            project_file.WriteIfChanged();
+            project_file.Contents = std::string();
+        }
+        {
+            const bool IS_PHASE = true;
+            TraceSpan write_span("write", &project_filters_file.Path, IS_PHASE);
+            project_filters_file.LimitMemory(max_buffered_output_bytes);
+            ProjectFiltersFile::Write(project, filters_cpp_files, filters_folders, filters_header_files, project_filters_file);
+            project_filters_file.WriteIfChanged();
+            project_filters_file.Contents = std::string();
+        }
+        return scan_counts;
+    }
+};
+
+/// A "unity" build file that includes one shard of a project's source files (see UnityBuild).
+class UnityShardFile
+{
+public:
+    /// Writes a unity build file.
+    /// @param[in]  project - The project whose source files have been split into shards.
+    /// @param[in]  shard_index - The index of the shard to write, which is the index of the C shard
+    ///     (one past the last of the other shards) to write the C shard.
+    /// @param[in,out]  file - The file to write to.
+    static void Write(const Project& project, const std::size_t shard_index, OutputFile& file)
+    {
+        // WRITE A HEADER EXPLAINING WHERE THE FILE CAME FROM.
+        const std::vector<std::size_t>& shard_start_indices = project.UnityShardStartIndices;
+        bool is_c_shard = (shard_index >= shard_start_indices.size());
+        if (is_c_shard)
+        {
+            file << "// Unity build file for the C files in " << project.Name << ", generated by GenerateProject." << NEWLINE;
+        }
+        else
+        {
+            file
+                << "// Unity build file " << std::to_string(shard_index + 1) << " of " << std::to_string(shard_start_indices.size())
+                << " for " << project.Name << ", generated by GenerateProject." << NEWLINE;
+        }
+        file << "// It's regenerated whenever files are added to or removed from the project, so don't edit it." << NEWLINE;
+
+        // INCLUDE EACH SOURCE FILE IN THE SHARD.
+        // Paths are relative to the current folder, which is where this file is, and use forward slashes so that any compiler can use them.
+        // The C shard has all C files, and the other shards have the rest of the files in their ranges.
+        const FolderTree& code_folder = *project.CodeFolderTree;
+        const std::vector<uint32_t>& cpp_files = project.CodeFiles.CppFiles;
+        bool is_last_shard = (shard_index + 1 >= shard_start_indices.size());
+        std::size_t first_cpp_file_index = is_c_shard ? 0 : shard_start_indices[shard_index];
+        std::size_t end_cpp_file_index = is_last_shard ? cpp_files.size() : shard_start_indices[shard_index + 1];
+        std::string path;
+        for (std::size_t cpp_file_index = first_cpp_file_index; cpp_file_index < end_cpp_file_index; ++cpp_file_index)
+        {
+            path.clear();
+            code_folder.AppendFilePath(cpp_files[cpp_file_index], path);
+            bool is_c_file = CategorizedFileIndex::IsCFile(path);
+            bool file_in_shard = (is_c_file == is_c_shard);
+            if (file_in_shard)
+            {
+                file << "#include \"" << DirectoryListing::ToIncludePath(path) << "\"" << NEWLINE;
+            }
+        }
+    }
+};
+
+/// A generated header that includes all headers to precompile for a project (see PrecompiledHeader).
+class PrecompiledHeaderFile
+{
+public:
+    /// Writes the precompiled header.
+    /// @param[in]  project - The project whose headers to precompile.
+    /// @param[in,out]  file - The file to write to.
+    static void Write(const Project& project, OutputFile& file)
+    {
+        // WRITE A HEADER EXPLAINING WHERE THE FILE CAME FROM.
+        file
+            << "// Precompiled header for " << project.Name << ", generated by GenerateProject." << NEWLINE
+            << "// It includes the headers that most of the project's source files include, and it's regenerated" << NEWLINE
+            << "// whenever the project is generated, so don't edit it." << NEWLINE
+            << "#pragma once" << NEWLINE;
+
+        // INCLUDE EACH HEADER.
+        // Paths are relative to the current folder, which is where this file is.
+        for (const auto& precompiled_header_include : project.PrecompiledHeaderIncludes)
+        {
+            file << "#include " << precompiled_header_include << NEWLINE;
+        }
+    }
+};
+
+/// A generated source file that's compiled to create the precompiled header for a project (see PrecompiledHeader).
+class PrecompiledHeaderSourceFile
+{
+public:
+    /// Writes the source file.
+    /// @param[in]  project - The project whose headers to precompile.
+    /// @param[in,out]  file - The file to write to.
+    static void Write(const Project& project, OutputFile& file)
+    {
+        file
+            << "// Creates the precompiled header for " << project.Name << ", generated by GenerateProject." << NEWLINE
+            << "#include \"" << PrecompiledHeader::GetHeaderFilename(project.Name) << "\"" << NEWLINE;
+    }
+};
+
+/// A Ninja (https://ninja-build.org) build file for all projects in a solution, as an alternative to build scripts.
+///
+/// Every translation unit is compiled separately, so Ninja only recompiles the ones affected by a change (using
+/// the dependencies the compiler reports for each one) and compiles them in parallel.  A project's translation units
+/// are its unity build files if its source files were split into shards (see UnityBuild); otherwise, they're its
+/// source files themselves.  The build file also reruns this program whenever any folder in the code folders changes,
+/// so added and removed files are picked up by the next build.  All paths are relative to the current folder, which
+/// is where the build file is and where Ninja runs commands from, and all outputs go in a build folder.
+class NinjaBuildFile
+{
+public:
+    /// The filename of the build file, which is in the current folder.
+    static const std::string FILENAME;
+
+    /// Gets the paths of the files that are compiled separately for a project.
+    /// @param[in]  project - The project to build.
+    /// @param[in]  unity_shards_used - True if the project's source files are split into unity build files, which are
+    ///     compiled instead of each source file.
+    /// @return The paths of the translation units, in the same order as the project's source files (or unity build files).
+    static std::vector<std::string> GetTranslationUnitPaths(const Project& project, const bool unity_shards_used)
+    {
+        if (unity_shards_used)
+        {
+            return project.ProjectFolderCppFilenames;
+        }
+
+        std::vector<std::string> source_paths;
+        std::string source_path;
+        for (uint32_t cpp_file : project.CodeFiles.CppFiles)
+        {
+            source_path.clear();
+            project.CodeFolderTree->AppendFilePath(cpp_file, source_path);
+            source_paths.push_back(source_path);
+        }
+        return source_paths;
+    }
+
+    /// Gets the path of the object file for a translation unit.
+    /// Object files mirror the layout of the source files within the project's output folder.
+    /// Parent folders are renamed so that object files always stay within the output folder.
+    /// @param[in]  project - The project that the translation unit is in.
+    /// @param[in]  source_path - The path of the translation unit's source file.
+    /// @param[in]  compiler - The compiler to use.
+    /// @return The native path of the object file.
+    static std::string GetObjectPath(const Project& project, const std::string& source_path, const Compiler compiler)
+    {
+        std::string object_path = source_path;
+        std::size_t parent_folder_position = 0;
+        const std::string PARENT_FOLDER = "..";
+        while (std::string::npos != (parent_folder_position = object_path.find(PARENT_FOLDER, parent_folder_position)))
+        {
+            object_path.replace(parent_folder_position, PARENT_FOLDER.size(), "__");
+        }
+        bool is_msvc = (Compiler::MSVC == compiler);
+        std::string object_file_extension = is_msvc ? ".obj" : ".o";
+        return GetOutputFolderPath(project) + DirectoryListing::ToNativePath(object_path) + object_file_extension;
+    }
+
+    /// Gets the path of the program that a project is linked into.  Programs are kept apart from object folders
+    /// since a program without an extension could have the same name as one.
+    /// @param[in]  program_name - The name of the program, which is the name of the project.
+    /// @param[in]  compiler - The compiler to use.
+    /// @return The path of the program, using the separator from Visual Studio project files.
+    static std::string GetProgramPath(const std::string& program_name, const Compiler compiler)
+    {
+#if defined(_WIN32)
+        (void)compiler;
+        const std::string PROGRAM_FILE_EXTENSION = ".exe";
+#else
+        bool is_msvc = (Compiler::MSVC == compiler);
+        const std::string PROGRAM_FILE_EXTENSION = is_msvc ? ".exe" : "";
+#endif
+        return "build" + PATH_SEPARATOR + "bin" + PATH_SEPARATOR + program_name + PROGRAM_FILE_EXTENSION;
+    }
+
+    /// Gets the path of the file that Clang writes the timing of compiling a translation unit to with -ftime-trace,
+    /// which is next to its object file.
+    /// @param[in]  project - The project that the translation unit is in.
+    /// @param[in]  source_path - The path of the translation unit's source file.
+    /// @return The native path of the time trace file.
+    static std::string GetTimeTracePath(const Project& project, const std::string& source_path)
+    {
+        std::string object_path = GetObjectPath(project, source_path, Compiler::CLANG);
+        const std::string OBJECT_FILE_EXTENSION = ".o";
+        object_path.resize(object_path.size() - OBJECT_FILE_EXTENSION.size());
+        return object_path + ".json";
+    }
+
+    /// Writes the Ninja build file.
+    /// @param[in]  projects - The projects to build.
+    /// @param[in]  compiler - The compiler to use.
+    /// @param[in]  compile_times_traced - True if Clang should write the time taken to compile each translation unit
+    ///     (see GetTimeTracePath) for a compile profile to read.
+    /// @param[in]  generator_command_line - The command line to rerun this program with to regenerate the build file.
+    /// @param[in]  generator_input_paths - Paths of files besides the code folders that regenerating depends on (such as a manifest).
+    /// @param[in,out]  file - The file to write to.
+    static void Write(
+        const std::vector<Project>& projects,
+        const Compiler compiler,
+        const bool compile_times_traced,
+        const std::string& generator_command_line,
+        const std::vector<std::string>& generator_input_paths,
+        OutputFile& file)
+    {
+        // WRITE THE RULES.
+        // Ninja accepts the same newlines as all other generated files, so they're used here too.
+        bool is_msvc = (Compiler::MSVC == compiler);
+        file
+            << "# Ninja build file generated by GenerateProject." << NEWLINE
+            << "# It's regenerated whenever the code folders change, so don't edit it." << NEWLINE
+            << "ninja_required_version = 1.5" << NEWLINE
+            << "builddir = build" << NEWLINE
+            << NEWLINE;
+        if (is_msvc)
+        {
+            // /showIncludes reports each file's dependencies, which Ninja reads and removes from the output.
+            // /FS allows parallel compiles to write debug info to the same file.
+            // C files are compiled without the C++ exception-handling option, which doesn't apply to them.
+            file
+                << "rule cxx" << NEWLINE
+                << "  command = cl.exe /nologo /showIncludes /c $in /Fo$out /Zi /EHa /WX /W4 /MTd /FS $flags" << NEWLINE
+                << "  deps = msvc" << NEWLINE
+                << "  description = Compiling $in" << NEWLINE
+                << NEWLINE
+                << "rule cc" << NEWLINE
+                << "  command = cl.exe /nologo /showIncludes /c $in /Fo$out /Zi /WX /W4 /MTd /FS $flags" << NEWLINE
+                << "  deps = msvc" << NEWLINE
+                << "  description = Compiling $in" << NEWLINE
+                << NEWLINE
+                << "rule cxx_pch" << NEWLINE
+                << "  command = cl.exe /nologo /showIncludes /c $in /Fo$out /Zi /EHa /WX /W4 /MTd /FS $flags /Yc$pch_header /Fp$pch" << NEWLINE
+                << "  deps = msvc" << NEWLINE
+                << "  description = Precompiling $pch_header" << NEWLINE
+                << NEWLINE
+                << "rule link" << NEWLINE
+                << "  command = link.exe /nologo /DEBUG /OUT:$out $in user32.lib gdi32.lib" << NEWLINE
+                << "  description = Linking $out" << NEWLINE
+                << NEWLINE;
+        }
+        else
+        {
+            // -ftime-trace writes how long each part of compiling took next to the object file.
+            // C files are compiled with the C compiler, since Clang's C++ compiler rejects them with -Werror.
+            file
+                << "cxx = clang++" << NEWLINE
+                << "cc = clang" << NEWLINE
+                << NEWLINE
+                << "rule cxx" << NEWLINE
+                << "  command = $cxx -MD -MF $out.d -g -Wall -Wextra -Werror" << (compile_times_traced ? " -ftime-trace" : "") << " $flags -c $in -o $out" << NEWLINE
+                << "  depfile = $out.d" << NEWLINE
+                << "  deps = gcc" << NEWLINE
+                << "  description = Compiling $in" << NEWLINE
+                << NEWLINE
+                << "rule cc" << NEWLINE
+                << "  command = $cc -MD -MF $out.d -g -Wall -Wextra -Werror" << (compile_times_traced ? " -ftime-trace" : "") << " $flags -c $in -o $out" << NEWLINE
+                << "  depfile = $out.d" << NEWLINE
+                << "  deps = gcc" << NEWLINE
+                << "  description = Compiling $in" << NEWLINE
+                << NEWLINE
+                << "rule cxx_pch" << NEWLINE
+                << "  command = $cxx -MD -MF $out.d -g -Wall -Wextra -Werror $flags -x c++-header -c $in -o $out" << NEWLINE
+                << "  depfile = $out.d" << NEWLINE
+                << "  deps = gcc" << NEWLINE
+                << "  description = Precompiling $in" << NEWLINE
+                << NEWLINE
+                << "rule link" << NEWLINE
+#if defined(_WIN32)
+                << "  command = $cxx -g $in -o $out -luser32 -lgdi32" << NEWLINE
+#else
+                << "  command = $cxx -g $in -o $out" << NEWLINE
+#endif
+                << "  description = Linking $out" << NEWLINE
+                << NEWLINE;
+        }
+
+        // WRITE THE RULE AND BUILD STATEMENT FOR REGENERATING THE BUILD FILE.
+        // Folders' modification times change whenever files are added to, removed from, or renamed within them.
+        // The build file is only rewritten if it changes, so the outputs are checked again after regenerating.
+        file
+            << "rule regenerate" << NEWLINE
+            << "  command = " << EscapeCommand(generator_command_line) << NEWLINE
+            << "  description = Regenerating " << FILENAME << NEWLINE
+            << "  generator = 1" << NEWLINE
+            << "  restat = 1" << NEWLINE
+            << NEWLINE
+            << "build " << FILENAME << ": regenerate |";
+        std::vector<const FolderTree*> code_folder_trees;
+        for (const Project& project : projects)
+        {
+            bool tree_already_added = (code_folder_trees.cend() != std::find(code_folder_trees.cbegin(), code_folder_trees.cend(), project.CodeFolderTree));
+            if (!tree_already_added)
+            {
+                code_folder_trees.push_back(project.CodeFolderTree);
+            }
+        }
+        std::string folder_path;
+        for (const FolderTree* code_folder_tree : code_folder_trees)
+        {
+            for (uint32_t folder_index = 0; folder_index < code_folder_tree->Folders.size(); ++folder_index)
+            {
+                folder_path.clear();
+                code_folder_tree->AppendFolderPath(folder_index, folder_path);
+                file << " $" << NEWLINE << "    " << EscapePath(folder_path);
+            }
+        }
+        for (const std::string& generator_input_path : generator_input_paths)
+        {
+            file << " $" << NEWLINE << "    " << EscapePath(generator_input_path);
+        }
+        file << NEWLINE << NEWLINE;
+
+        // WRITE THE BUILD STATEMENTS FOR EACH PROJECT.
+        std::string default_targets;
+        for (const Project& project : projects)
+        {
+            WriteProject(project, is_msvc, file);
+            default_targets += " " + EscapePath(project.Name);
+        }
+        file << "default" << default_targets << NEWLINE;
+    }
+
+private:
+    /// Writes the build statements for a project.
+    /// @param[in]  project - The project to build.
+    /// @param[in]  is_msvc - True if the Visual C++ compiler is used; false if Clang is used.
+    /// @param[in,out]  file - The file to write to.
+    static void WriteProject(const Project& project, const bool is_msvc, OutputFile& file)
+    {
+        // DETERMINE THE TRANSLATION UNITS.
+        bool unity_shards_used = !project.UnityShardStartIndices.empty();
+        std::vector<std::string> source_paths = GetTranslationUnitPaths(project, unity_shards_used);
+
+        // WRITE THE OPTIONS FOR COMPILING THE PROJECT'S FILES.
+        // Each project's options are in a variable that's named after it, with any characters not allowed in names replaced.
+        std::string project_variable_name = "flags_";
+        for (char character : project.Name)
+        {
+            bool is_letter = ('a' <= character && character <= 'z') || ('A' <= character && character <= 'Z');
+            bool is_digit = ('0' <= character && character <= '9');
+            bool allowed_in_name = (is_letter || is_digit || '_' == character || '-' == character);
+            project_variable_name.push_back(allowed_in_name ? character : '_');
+        }
+        std::string include_option = is_msvc ? "/I" : "-I";
+        std::string object_file_extension = is_msvc ? ".obj" : ".o";
+        std::string project_output_folder_path = GetOutputFolderPath(project);
+        file
+            << "# " << project.Name << NEWLINE
+            << project_variable_name << " = " << include_option << QuoteArgument(DirectoryListing::ToNativePath(project.CodeFolderPath));
+        if (is_msvc)
+        {
+            file << " /Fd" << QuoteArgument(project_output_folder_path + "compile.pdb");
+        }
+
+        // WRITE THE BUILD STATEMENT FOR THE PRECOMPILED HEADER.
+        // Every other C++ file depends on it, and it's included in them from the current folder.
+        // A C++ precompiled header can't be used by C files, so they're compiled with the project's other options.
+        std::string c_project_variable_name = project_variable_name;
+        std::vector<std::string> linked_file_paths;
+        std::string precompiled_header_path;
+        bool headers_precompiled = !project.PrecompiledHeaderIncludes.empty();
+        if (headers_precompiled)
+        {
+            std::string precompiled_header_filename = PrecompiledHeader::GetHeaderFilename(project.Name);
+            std::string current_folder_include = include_option + ".";
+            if (is_msvc)
+            {
+                precompiled_header_path = project_output_folder_path + project.Name + ".pch";
+                std::string precompiled_header_object_path = project_output_folder_path + PrecompiledHeader::GetSourceFilename(project.Name) + object_file_extension;
+                file
+                    << " " << current_folder_include << NEWLINE
+                    << "build " << EscapePath(precompiled_header_object_path) << " | " << EscapePath(precompiled_header_path)
+                    << ": cxx_pch " << EscapePath(PrecompiledHeader::GetSourceFilename(project.Name)) << NEWLINE
+                    << "  flags = $" << project_variable_name << NEWLINE
+                    << "  pch_header = " << QuoteArgument(precompiled_header_filename) << NEWLINE
+                    << "  pch = " << QuoteArgument(precompiled_header_path) << NEWLINE;
+                linked_file_paths.push_back(precompiled_header_object_path);
+                file << project_variable_name << "_pch = $" << project_variable_name
+                    << " /Yu" << QuoteArgument(precompiled_header_filename)
+                    << " /FI" << QuoteArgument(precompiled_header_filename)
+                    << " /Fp" << QuoteArgument(precompiled_header_path) << NEWLINE;
+            }
+            else
+            {
+                precompiled_header_path = project_output_folder_path + precompiled_header_filename + ".pch";
+                file
+                    << " " << current_folder_include << NEWLINE
+                    << "build " << EscapePath(precompiled_header_path) << ": cxx_pch " << EscapePath(precompiled_header_filename) << NEWLINE
+                    << "  flags = $" << project_variable_name << NEWLINE
+                    << project_variable_name << "_pch = $" << project_variable_name
+                    << " -include-pch " << QuoteArgument(precompiled_header_path) << NEWLINE;
+            }
+            project_variable_name += "_pch";
+        }
+        else
+        {
+            file << NEWLINE;
+        }
+
+        // WRITE A BUILD STATEMENT FOR EACH TRANSLATION UNIT.
+        // Translation units with the longest measured compile times (see CompileProfile) are written first so that
+        // Ninja starts them first instead of leaving them for last.  Object files are still linked in the usual order.
+        Compiler compiler = is_msvc ? Compiler::MSVC : Compiler::CLANG;
+        const std::vector<uint64_t>& compile_times = unity_shards_used ? project.ProjectFolderCppFileCompileTimes : project.CppFileCompileTimes;
+        std::vector<std::size_t> build_order(source_paths.size());
+        for (std::size_t source_index = 0; source_index < source_paths.size(); ++source_index)
+        {
+            build_order[source_index] = source_index;
+            linked_file_paths.push_back(GetObjectPath(project, source_paths[source_index], compiler));
+        }
+        bool compile_times_measured = (compile_times.size() == source_paths.size());
+        if (compile_times_measured)
+        {
+            std::stable_sort(
+                build_order.begin(),
+                build_order.end(),
+                [&compile_times](const std::size_t left, const std::size_t right) { return compile_times[left] > compile_times[right]; });
+        }
+        std::size_t first_object_index = linked_file_paths.size() - source_paths.size();
+        for (std::size_t source_index : build_order)
+        {
+            const std::string& source_path = source_paths[source_index];
+            const std::string& object_path = linked_file_paths[first_object_index + source_index];
+            bool is_c_file = CategorizedFileIndex::IsCFile(source_path);
+            file << "build " << EscapePath(object_path) << ": " << (is_c_file ? "cc " : "cxx ") << EscapePath(DirectoryListing::ToNativePath(source_path));
+            if (headers_precompiled && !is_c_file)
+            {
+                file << " | " << EscapePath(precompiled_header_path);
+            }
+            file
+                << NEWLINE
+                << "  flags = $" << (is_c_file ? c_project_variable_name : project_variable_name) << NEWLINE;
+        }
+
+        // WRITE THE BUILD STATEMENT FOR LINKING THE PROGRAM.
+        // The project's name can be used as a target to build just the project.
+        std::string program_path = DirectoryListing::ToNativePath(GetProgramPath(project.Name, compiler));
+        file << "build " << EscapePath(program_path) << ": link";
+        for (const std::string& linked_file_path : linked_file_paths)
+        {
+            file << " $" << NEWLINE << "    " << EscapePath(linked_file_path);
+        }
+        file
+            << NEWLINE
+            << "build " << EscapePath(project.Name) << ": phony " << EscapePath(program_path) << NEWLINE
+            << NEWLINE;
+    }
+
+    /// Gets the folder that a project's object files are built in.
+    /// @param[in]  project - The project to build.
+    /// @return The native path of the folder, with a trailing separator.
+    static std::string GetOutputFolderPath(const Project& project)
+    {
+        return DirectoryListing::ToNativePath("build" + PATH_SEPARATOR + "obj" + PATH_SEPARATOR + project.Name + PATH_SEPARATOR);
+    }
+
+    /// Escapes a path so that it can be used in a build statement.
+    /// @param[in]  path - The path to escape, which is converted to native path separators.
+    /// @return The escaped path.
+    static std::string EscapePath(const std::string& path)
+    {
+        std::string escaped_path;
+        for (char character : DirectoryListing::ToNativePath(path))
+        {
+            bool needs_escaping = ('$' == character || ' ' == character || ':' == character);
+            if (needs_escaping)
+            {
+                escaped_path.push_back('$');
+            }
+            escaped_path.push_back(character);
+        }
+        return escaped_path;
+    }
+
+    /// Escapes a command so that it can be used as a variable's value.
+    /// @param[in]  command - The command to escape.
+    /// @return The escaped command.
+    static std::string EscapeCommand(const std::string& command)
+    {
+        std::string escaped_command;
+        for (char character : command)
+        {
+            if ('$' == character)
+            {
+                escaped_command.push_back('$');
+            }
+            escaped_command.push_back(character);
+        }
+        return escaped_command;
+    }
+
+    /// Quotes a command line argument if it contains spaces, and escapes it so that it can be used as a variable's value.
+    /// @param[in]  argument - The argument to quote.
+    /// @return The quoted argument.
+    static std::string QuoteArgument(const std::string& argument)
+    {
+        bool needs_quotes = (std::string::npos != argument.find(' '));
+        std::string quoted_argument = needs_quotes ? ("\"" + argument + "\"") : argument;
+        return EscapeCommand(quoted_argument);
+    }
+};
+
+const std::string NinjaBuildFile::FILENAME = "build.ninja";
+
+/// A basic build script as a batch file for a project.
+class BuildScriptBatchFile
+{
+public:
+    /// Writes the build script batch file.
+    /// @param[in]  project - The project to build.  Its .cpp files in the current folder are compiled
+    ///     to build the entire project, as the main files for "unity" or "single translation unit" builds.
+    ///     If there are several (see UnityBuild), they're compiled in parallel.  The project's code folder
+    ///     will be added as an include path.  If the project has headers to precompile (see PrecompiledHeader),
+    ///     they're precompiled first and then used by all of the other files.
+    ///     If the project has a manifest of fingerprints (see FingerprintManifest), translation units are only compiled,
+    ///     and the program is only linked, if nothing they depend on changed since they were last built.
+    /// @param[in]  generator_command_line - The command line to rerun this program with to update the manifest of
+    ///     fingerprints before building.  Only needed if the project has a manifest of fingerprints.
+    /// @param[in,out]  file - The file to write to.
+    static void Write(const Project& project, const std::string& generator_command_line, OutputFile& file)
+    {
+        // WRITE A SCRIPT THAT SKIPS UNCHANGED BUILDS IF FINGERPRINTS ARE AVAILABLE.
+        bool fingerprints_used = !project.FingerprintManifestFilename.empty();
+        if (fingerprints_used)
+        {
+            WriteWithFingerprints(project, generator_command_line, file);
+            return;
+        }
+
+        // DETERMINE THE FILES TO COMPILE.
+        // The program is named after the first file by default, so it needs to be named explicitly if there are several.
+        // C files can't use the precompiled header, so they're compiled first, and their object files are linked in.
+        const std::vector<std::string>& project_cpp_filenames = project.ProjectFolderCppFilenames;
+        bool multiple_files_compiled = (project_cpp_filenames.size() > 1);
+        std::string compiled_files;
+        std::string compiled_c_files;
+        std::string c_object_files;
+        for (const auto& project_cpp_filename : project_cpp_filenames)
+        {
+            bool is_c_file = CategorizedFileIndex::IsCFile(project_cpp_filename);
+            if (is_c_file)
+            {
+                std::string object_filename = project_cpp_filename.substr(0, project_cpp_filename.rfind('.')) + ".obj";
+                compiled_c_files += " \"..\\" + project_cpp_filename + "\"";
+                c_object_files += " \"" + object_filename + "\"";
+                continue;
+            }
+            if (!compiled_files.empty())
+            {
+                compiled_files += " ";
+            }
+            compiled_files += "\"..\\" + project_cpp_filename + "\"";
+        }
+        compiled_files += c_object_files;
+        bool headers_precompiled = !project.PrecompiledHeaderIncludes.empty();
+        std::string precompiled_header_filename = PrecompiledHeader::GetHeaderFilename(project.Name);
+        std::string precompiled_header_output_filename = project.Name + ".pch";
+
+        file
+            << "@ECHO off" << NEWLINE
+            << NEWLINE
+            << "REM PUT THE COMPILER IN THE PATH." << NEWLINE
+            << "REM This isn't necessary and may cause problems if this file is run repeatedly in a command prompt." << NEWLINE
+            << "REM Remove it if you'd prefer to take care of this in some other way." << NEWLINE
+            << "REM Change the path if you'd prefer to use a different version of the Visual Studio compiler." << NEWLINE
+            << "CALL \"C:\\Program Files (x86)\\Microsoft Visual Studio 12.0\\VC\\vcvarsall.bat\" x64" << NEWLINE
+            << NEWLINE
+            << "REM MOVE INTO THE BUILD DIRECTORY." << NEWLINE
+            << "IF NOT EXIST \"build\" MKDIR \"build\"" << NEWLINE
+            << "PUSHD \"build\"" << NEWLINE
+            << NEWLINE;
+        if (headers_precompiled)
+        {
+            std::string precompiled_header_source_filename = PrecompiledHeader::GetSourceFilename(project.Name);
+            file
+                << "    REM BUILD THE PRECOMPILED HEADER." << NEWLINE
+                << "    REM It's built with the same options as the program, plus the following:" << NEWLINE
+                << "    REM /c - Compile without linking." << NEWLINE
+                << "    REM /Yc - Create a precompiled header from everything up to and including the given header." << NEWLINE
+                << "    REM /Fp - The precompiled header file." << NEWLINE
+                << "    cl.exe /c /Zi /EHa /WX /W4 /MTd /Yc\"" << precompiled_header_filename << "\" /Fp\"" << precompiled_header_output_filename << "\""
+                << " \"..\\" << precompiled_header_source_filename << "\" /I \"..\\" << project.CodeFolderPath << "\"" << NEWLINE
+                << NEWLINE;
+        }
+        bool c_files_compiled = !compiled_c_files.empty();
+        if (c_files_compiled)
+        {
+            file
+                << "    REM BUILD THE C FILES." << NEWLINE
+                << "    REM They're built with the same options as the program, except for C++ exception handling, plus the following:" << NEWLINE
+                << "    REM /c - Compile without linking." << NEWLINE
+                << "    REM Their object files are linked into the program along with the other files." << NEWLINE
+                << "    cl.exe /c /Zi /WX /W4 /MTd" << compiled_c_files << " /I \"..\\" << project.CodeFolderPath << "\"" << NEWLINE
+                << NEWLINE;
+        }
+        file
+            << "    REM BUILD THE PROGRAM." << NEWLINE
+            << "    REM See https://msdn.microsoft.com/en-us/library/fwkeyyhe.aspx for compiler options." << NEWLINE
+            << "    REM The compiler options listed here are just one set of options and definitively don't support much variability." << NEWLINE
+            << "    REM Support for more variability in this build script may be added later, but feel free to not use this basic template and" << NEWLINE
+            << "    REM just create your own build script as needed." << NEWLINE
+            << "    REM /Zi - debug info" << NEWLINE
+            << "    REM /EHa - The exception-handling model that catches both asynchronous (structured) and synchronous (C++) exceptions." << NEWLINE
+            << "    REM /WX - All warnings as errors" << NEWLINE
+            << "    REM /W4 - Warning level 4" << NEWLINE
+            << "    REM /MTd - Static linking with Visual C++ lib." << NEWLINE
+            << "    REM /I - Additional include directories." << NEWLINE;
+        if (multiple_files_compiled)
+        {
+            file
+                << "    REM /MP - Compile the files in parallel." << NEWLINE
+                << "    REM /FS - Allow the parallel compiles to write debug info to the same file." << NEWLINE
+                << "    REM /Fe - The name of the program." << NEWLINE;
+        }
+        if (headers_precompiled)
+        {
+            file
+                << "    REM /Yu - Use the precompiled header." << NEWLINE
+                << "    REM /FI - Include the precompiled header in every file, so that code files don't need to include it." << NEWLINE
+                << "    REM /Fp - The precompiled header file." << NEWLINE
+                << "    REM The object file for the precompiled header must also be linked in." << NEWLINE;
+        }
+        file
+            << "    REM user32.lib and gdi32.lib - Basic Windows functions.  Remove if not needed." << NEWLINE;
+        if (multiple_files_compiled)
+        {
+            file << "    cl.exe /MP /FS /Zi /EHa /WX /W4 /MTd " << compiled_files << " /Fe\"" << project.Name << ".exe\"";
+        }
+        else
+        {
+            file << "    cl.exe /Zi /EHa /WX /W4 /MTd " << compiled_files;
+        }
+        if (headers_precompiled)
+        {
+            std::string precompiled_header_object_filename = project.Name + "_Pch.obj";
+            file
+                << " /Yu\"" << precompiled_header_filename << "\" /FI\"" << precompiled_header_filename << "\" /Fp\"" << precompiled_header_output_filename << "\""
+                << " \"" << precompiled_header_object_filename << "\" /I \"..\"";
+        }
+        file
+            << " /I \"..\\" << project.CodeFolderPath << "\" user32.lib gdi32.lib" << NEWLINE
+            << "" << NEWLINE
+            << "POPD" << NEWLINE
+            << NEWLINE
+            << "@ECHO ON" << NEWLINE;
+    }
+
+    /// Gets the path of the program that a project's build script builds, which is in the build folder.
+    /// @param[in]  program_name - The name of the program, which is the name of the project.
+    /// @return The path of the program, using the separator from Visual Studio project files.
+    static std::string GetProgramPath(const std::string& program_name)
+    {
+        return "build" + PATH_SEPARATOR + program_name + ".exe";
+    }
+
+    /// The options that translation units are compiled with when object files are cached by fingerprint.
+    /// Debug info is put in each object file (/Z7) instead of a shared debug info file, so that cached
+    /// object files don't depend on anything else being kept.
+    static const std::string FINGERPRINTED_COMPILER_OPTIONS;
+    /// The options that C translation units are compiled with when object files are cached by fingerprint,
+    /// which are the same except that C has no exceptions to handle.
+    static const std::string FINGERPRINTED_C_COMPILER_OPTIONS;
+
+private:
+    /// Writes a build script that caches object files and programs by the fingerprints in the project's manifest
+    /// (see FingerprintManifest).  The script reruns this program to update the manifest first, reads each translation
+    /// unit's fingerprint from it, and only compiles the translation units without a cached object file with the same
+    /// fingerprint.  The program is then only linked if there's no cached program with the same fingerprint.
+    ///
+    /// The script's contents don't depend on the code files (everything that does is in the manifest),
+    /// so the script isn't rewritten by the program it reruns while it's running.
+    /// @param[in]  project - The project to build.
+    /// @param[in]  generator_command_line - The command line to rerun this program with to update the manifest.
+    /// @param[in,out]  file - The file to write to.
+    static void WriteWithFingerprints(const Project& project, const std::string& generator_command_line, OutputFile& file)
+    {
+        // ESCAPE THE GENERATOR COMMAND LINE FOR THE BATCH FILE.
+        // Percent signs would otherwise be read as variables.
+        std::string escaped_generator_command_line;
+        for (char character : generator_command_line)
+        {
+            escaped_generator_command_line += character;
+            if ('%' == character)
+            {
+                escaped_generator_command_line += character;
+            }
+        }
+
+        std::string manifest_path = "\"..\\" + project.FingerprintManifestFilename + "\"";
+        std::string precompiled_header_filename = PrecompiledHeader::GetHeaderFilename(project.Name);
+        std::string precompiled_header_source_filename = PrecompiledHeader::GetSourceFilename(project.Name);
+        std::string include_option = "/I \"..\\" + project.CodeFolderPath + "\"";
+        file
+            << "@ECHO off" << NEWLINE
+            << NEWLINE
+            << "REM PUT THE COMPILER IN THE PATH." << NEWLINE
+            << "REM This isn't necessary and may cause problems if this file is run repeatedly in a command prompt." << NEWLINE
+            << "REM Remove it if you'd prefer to take care of this in some other way." << NEWLINE
+            << "REM Change the path if you'd prefer to use a different version of the Visual Studio compiler." << NEWLINE
+            << "REM This also sets the INCLUDE environment variable, so it's done first so that the standard library" << NEWLINE
+            << "REM and platform headers that the code files include can be found and fingerprinted." << NEWLINE
+            << "CALL \"C:\\Program Files (x86)\\Microsoft Visual Studio 12.0\\VC\\vcvarsall.bat\" x64" << NEWLINE
+            << NEWLINE
+            << "REM UPDATE THE FINGERPRINTS OF THE CODE FILES." << NEWLINE
+            << "REM The project is generated again so that the fingerprints in " << project.FingerprintManifestFilename << " match the code files as they are now." << NEWLINE
+            << escaped_generator_command_line << NEWLINE
+            << "IF ERRORLEVEL 1 EXIT /B 1" << NEWLINE
+            << NEWLINE
+            << "REM MOVE INTO THE BUILD DIRECTORY." << NEWLINE
+            << "REM Object files and programs are cached in a cache folder within it, named after their fingerprints." << NEWLINE
+            << "IF NOT EXIST \"build\\cache\" MKDIR \"build\\cache\"" << NEWLINE
+            << "PUSHD \"build\"" << NEWLINE
+            << "SETLOCAL EnableDelayedExpansion" << NEWLINE
+            << NEWLINE
+            << "    REM READ THE FINGERPRINTS." << NEWLINE
+            << "    REM Translation units whose object files aren't cached yet are compiled below, so any object files" << NEWLINE
+            << "    REM left over from failed builds are deleted to keep them from being cached by mistake." << NEWLINE
+            << "    SET \"PCH_FINGERPRINT=\"" << NEWLINE
+            << "    SET \"PROGRAM_FINGERPRINT=\"" << NEWLINE
+            << "    REM C files can't use the precompiled header, so they're compiled separately." << NEWLINE
+            << "    SET \"PCH_FINGERPRINT=\"" << NEWLINE
+            << "    SET \"PROGRAM_FINGERPRINT=\"" << NEWLINE
+            << "    SET \"STALE_FILES=\"" << NEWLINE
+            << "    SET \"STALE_C_FILES=\"" << NEWLINE
+            << "    SET \"OBJECT_FILES=\"" << NEWLINE
+            << "    FOR /F \"usebackq tokens=1,2*\" %%A IN (" << manifest_path << ") DO (" << NEWLINE
+            << "        IF \"%%A\"==\"pch\" SET \"PCH_FINGERPRINT=%%B\"" << NEWLINE
+            << "        IF \"%%A\"==\"program\" SET \"PROGRAM_FINGERPRINT=%%B\"" << NEWLINE
+            << "        IF \"%%A\"==\"tu\" (" << NEWLINE
+            << "            SET OBJECT_FILES=!OBJECT_FILES! \"cache\\%%B.obj\"" << NEWLINE
+            << "            IF NOT EXIST \"cache\\%%B.obj\" (" << NEWLINE
+            << "                IF /I \"%%~xC\"==\".c\" (" << NEWLINE
+            << "                    SET STALE_C_FILES=!STALE_C_FILES! \"..\\%%C\"" << NEWLINE
+            << "                ) ELSE (" << NEWLINE
+            << "                    SET STALE_FILES=!STALE_FILES! \"..\\%%C\"" << NEWLINE
+            << "                )" << NEWLINE
+            << "                IF EXIST \"%%~nC.obj\" DEL \"%%~nC.obj\"" << NEWLINE
+            << "            )" << NEWLINE
+            << "        )" << NEWLINE
+            << "    )" << NEWLINE
+            << "    IF NOT DEFINED PROGRAM_FINGERPRINT GOTO FAILED" << NEWLINE
+            << NEWLINE
+            << "    REM BUILD THE PRECOMPILED HEADER IF IT CHANGED." << NEWLINE
+            << "    REM The manifest only has a fingerprint for it if headers are precompiled." << NEWLINE
+            << "    REM /c - Compile without linking." << NEWLINE
+            << "    REM /Yc - Create a precompiled header from everything up to and including the given header." << NEWLINE
+            << "    REM /Fp - The precompiled header file." << NEWLINE
+            << "    REM /Fo - The object file." << NEWLINE
+            << "    SET \"PRECOMPILED_HEADER_OPTIONS=\"" << NEWLINE
+            << "    SET \"PRECOMPILED_HEADER_OBJECT_FILE=\"" << NEWLINE
+            << "    IF DEFINED PCH_FINGERPRINT (" << NEWLINE
+            << "        IF NOT EXIST \"cache\\!PCH_FINGERPRINT!.pch\" (" << NEWLINE
+            << "            cl.exe /c " << FINGERPRINTED_COMPILER_OPTIONS
+            << " /Yc\"" << precompiled_header_filename << "\" /Fp\"cache\\!PCH_FINGERPRINT!.pch\" /Fo\"cache\\!PCH_FINGERPRINT!.obj\""
+            << " \"..\\" << precompiled_header_source_filename << "\" " << include_option << NEWLINE
+            << "            IF ERRORLEVEL 1 GOTO FAILED" << NEWLINE
+            << "        )" << NEWLINE
+            << "        SET PRECOMPILED_HEADER_OPTIONS=/Yu\"" << precompiled_header_filename << "\" /FI\"" << precompiled_header_filename << "\" /Fp\"cache\\!PCH_FINGERPRINT!.pch\" /I \"..\"" << NEWLINE
+            << "        SET PRECOMPILED_HEADER_OBJECT_FILE=\"cache\\!PCH_FINGERPRINT!.obj\"" << NEWLINE
+            << "    )" << NEWLINE
+            << NEWLINE
+            << "    REM BUILD THE TRANSLATION UNITS THAT CHANGED." << NEWLINE
+            << "    REM See https://msdn.microsoft.com/en-us/library/fwkeyyhe.aspx for compiler options." << NEWLINE
+            << "    REM /c - Compile without linking." << NEWLINE
+            << "    REM /MP - Compile the files in parallel." << NEWLINE
+            << "    REM /Z7 - Debug info in each object file." << NEWLINE
+            << "    REM /EHa - The exception-handling model that catches both asynchronous (structured) and synchronous (C++) exceptions." << NEWLINE
+            << "    REM /WX - All warnings as errors" << NEWLINE
+            << "    REM /W4 - Warning level 4" << NEWLINE
+            << "    REM /MTd - Static linking with Visual C++ lib." << NEWLINE
+            << "    REM /I - Additional include directories." << NEWLINE
+            << "    REM C files are compiled with the same options, except for C++ exception handling and the precompiled header." << NEWLINE
+            << "    REM Each object file is then moved into the cache, named after its translation unit's fingerprint." << NEWLINE
+            << "    IF DEFINED STALE_FILES (" << NEWLINE
+            << "        cl.exe /c /MP " << FINGERPRINTED_COMPILER_OPTIONS << " !STALE_FILES! !PRECOMPILED_HEADER_OPTIONS! " << include_option << NEWLINE
+            << "        IF ERRORLEVEL 1 GOTO FAILED" << NEWLINE
+            << "    )" << NEWLINE
+            << "    IF DEFINED STALE_C_FILES (" << NEWLINE
+            << "        cl.exe /c /MP " << FINGERPRINTED_C_COMPILER_OPTIONS << " !STALE_C_FILES! " << include_option << NEWLINE
+            << "        IF ERRORLEVEL 1 GOTO FAILED" << NEWLINE
+            << "    )" << NEWLINE
+            << "    FOR /F \"usebackq tokens=1,2*\" %%A IN (" << manifest_path << ") DO (" << NEWLINE
+            << "        IF \"%%A\"==\"tu\" IF NOT EXIST \"cache\\%%B.obj\" MOVE /Y \"%%~nC.obj\" \"cache\\%%B.obj\" >NUL" << NEWLINE
+            << "    )" << NEWLINE
+            << NEWLINE
+            << "    REM LINK THE PROGRAM IF ANY TRANSLATION UNITS CHANGED." << NEWLINE
+            << "    REM /DEBUG - Include the debug info from the object files." << NEWLINE
+            << "    REM user32.lib and gdi32.lib - Basic Windows functions.  Remove if not needed." << NEWLINE
+            << "    IF NOT EXIST \"cache\\!PROGRAM_FINGERPRINT!.exe\" (" << NEWLINE
+            << "        link.exe /nologo /DEBUG /OUT:\"cache\\!PROGRAM_FINGERPRINT!.exe\" !OBJECT_FILES! !PRECOMPILED_HEADER_OBJECT_FILE! user32.lib gdi32.lib" << NEWLINE
+            << "        IF ERRORLEVEL 1 GOTO FAILED" << NEWLINE
+            << "    )" << NEWLINE
+            << "    COPY /Y \"cache\\!PROGRAM_FINGERPRINT!.exe\" \"" << project.Name << ".exe\" >NUL" << NEWLINE
+            << NEWLINE
+            << "ENDLOCAL" << NEWLINE
+            << "POPD" << NEWLINE
+            << NEWLINE
+            << "@ECHO ON" << NEWLINE
+            << "@EXIT /B 0" << NEWLINE
+            << NEWLINE
+            << ":FAILED" << NEWLINE
+            << "ENDLOCAL" << NEWLINE
+            << "POPD" << NEWLINE
+            << "@ECHO ON" << NEWLINE
+            << "@EXIT /B 1" << NEWLINE;
+    }
+};
+
+const std::string BuildScriptBatchFile::FINGERPRINTED_COMPILER_OPTIONS = "/Z7 /EHa /WX /W4 /MTd";
+const std::string BuildScriptBatchFile::FINGERPRINTED_C_COMPILER_OPTIONS = "/Z7 /WX /W4 /MTd";
+
+/// A manifest of fingerprints of a project's code files and translation units, which the build script reads to
+/// skip compiling translation units (and linking the program) that haven't changed since they were last built
+/// (see BuildScriptBatchFile).
+///
+/// Each code file's fingerprint is a hash of its contents (see ContentHash), and every code file that any translation
+/// unit depends on is hashed in parallel every time the project is generated.  A translation unit's fingerprint combines
+/// everything that affects compiling it: the compiler options, the precompiled header (if any), the source files it
+/// compiles, and every file they include, directly or indirectly (see IncludeGraph).  That includes files that aren't
+/// headers (such as .inc files), headers outside the code folder, and headers in the folders that the compiler searches
+/// (such as standard library headers), so changing a file only changes the fingerprints of the translation units that
+/// include it.  Which file an include of a macro refers to can't be known without preprocessing, so a translation unit
+/// that includes a macro depends on every fingerprinted file instead.  The compiler itself isn't part of any fingerprint.
+/// The program's fingerprint combines its translation units'.
+///
+/// Each line of the manifest has a kind of entry, a fingerprint as 16 hexadecimal digits, and a path:
+/// - file <Fingerprint> <Path> - A code file that a translation unit depends on.
+/// - pch <Fingerprint> <ProjectName>_Pch.cpp - The precompiled header, if headers are precompiled.
+/// - tu <Fingerprint> <Filename> - A translation unit in the current folder (ProjectName.cpp or a unity build file).
+/// - program <Fingerprint> <ProjectName>.exe - The program.
+class FingerprintManifest
+{
+public:
+    /// Gets the filename of a project's manifest, which is in the current folder.
+    /// @param[in]  project_name - The name of the project.
+    /// @return The filename of the manifest.
+    static std::string GetFilename(const std::string& project_name)
+    {
+        return project_name + ".fingerprints";
+    }
+
+    /// Fingerprints all of the code files that a project's translation units depend on by hashing their contents
+    /// in parallel while finding their includes, and then fingerprints the precompiled header and translation units.
+    /// @param[in]  thread_count - The number of threads to use.  Zero uses one thread per hardware core.
+    /// @param[in,out]  project - The project, whose code files must already be categorized, and whose unity build shards
+    ///     and headers to precompile (if any) must already be chosen.  Its code file, precompiled header, and translation unit
+    ///     fingerprints are set.  Files that can't be read get a fingerprint of 0.
+    static void FingerprintCodeFiles(const unsigned int thread_count, Project& project)
+    {
+        const bool IS_PHASE = true;
+        TraceSpan fingerprint_span("fingerprint code files", &project.Name, IS_PHASE);
+
+        // FIND AND HASH EVERY FILE THAT THE TRANSLATION UNITS INCLUDE.
+        // Every file is hashed in parallel while it's scanned for includes.
+        const bool FINGERPRINT_FILES = true;
+        IncludeGraph include_graph = IncludeGraph::Build(thread_count, project, FINGERPRINT_FILES);
+
+        // LIST THE FINGERPRINTS OF THE FILES.
+        // The included files that were found come first, followed by the source files that weren't included by anything.
+        const FolderTree& code_folder = *project.CodeFolderTree;
+        std::vector<std::pair<std::string, uint64_t>>& code_file_fingerprints = project.CodeFileFingerprints;
+        code_file_fingerprints.clear();
+        std::vector<uint32_t> fingerprinted_headers;
+        std::unordered_map<std::string, std::size_t> code_file_indices_by_path;
+        for (uint32_t header_index = 0; header_index < include_graph.Headers.size(); ++header_index)
+        {
+            const std::string& header_path = include_graph.Headers[header_index].Path;
+            if (!header_path.empty())
+            {
+                code_file_indices_by_path.emplace(header_path, code_file_fingerprints.size());
+                code_file_fingerprints.emplace_back(header_path, include_graph.Headers[header_index].Fingerprint);
+                fingerprinted_headers.push_back(header_index);
+            }
+        }
+        std::vector<std::size_t> cpp_file_code_file_indices;
+        std::string path;
+        for (std::size_t cpp_file_index = 0; cpp_file_index < project.CodeFiles.CppFiles.size(); ++cpp_file_index)
+        {
+            path.clear();
+            code_folder.AppendFilePath(project.CodeFiles.CppFiles[cpp_file_index], path);
+            auto code_file_index = code_file_indices_by_path.find(path);
+            bool already_fingerprinted = (code_file_indices_by_path.cend() != code_file_index);
+            if (already_fingerprinted)
+            {
+                cpp_file_code_file_indices.push_back(code_file_index->second);
+                continue;
+            }
+            cpp_file_code_file_indices.push_back(code_file_fingerprints.size());
+            code_file_fingerprints.emplace_back(path, include_graph.SourceFingerprints[cpp_file_index]);
+        }
+
+        // COMBINE EACH FILE'S PATH AND FINGERPRINT INTO A RECORD.
+        // The records of included files are hashed so that sets of them can be combined in any order.
+        std::vector<std::string> code_file_records(code_file_fingerprints.size());
+        std::vector<uint64_t> code_file_record_hashes(code_file_fingerprints.size());
+        for (std::size_t file_index = 0; file_index < code_file_fingerprints.size(); ++file_index)
+        {
+            const std::pair<std::string, uint64_t>& code_file_fingerprint = code_file_fingerprints[file_index];
+            std::string& code_file_record = code_file_records[file_index];
+            code_file_record = code_file_fingerprint.first + " " + ContentHash::ToHex(code_file_fingerprint.second) + "\n";
+            code_file_record_hashes[file_index] = ContentHash::Hash(code_file_record.data(), code_file_record.size());
+        }
+        std::vector<uint64_t> header_record_hashes(include_graph.Headers.size(), 0);
+        for (std::size_t file_index = 0; file_index < fingerprinted_headers.size(); ++file_index)
+        {
+            header_record_hashes[fingerprinted_headers[file_index]] = code_file_record_hashes[file_index];
+        }
+
+        // DESCRIBE EVERYTHING THAT SOME FILES INCLUDE.
+        // If anything includes a macro, every file is described too, since any of them might be included.
+        // The fingerprint of every file is only calculated if it's needed.
+        std::string all_files_record;
+        auto get_included_files_record = [&](const std::vector<uint32_t>& directly_included_headers, bool includes_macros)
+        {
+            std::vector<uint32_t> included_headers = include_graph.FindIncludedHeaders(directly_included_headers);
+            std::vector<uint64_t> record_hashes;
+            for (uint32_t header_index : included_headers)
+            {
+                const IncludeGraph::Header& header = include_graph.Headers[header_index];
+                includes_macros = includes_macros || header.IncludesMacros;
+                bool header_found = !header.Path.empty();
+                if (header_found)
+                {
+                    record_hashes.push_back(header_record_hashes[header_index]);
+                }
+            }
+            std::string included_files_record = "includes " + ContentHash::ToHex(HashRecords(record_hashes)) + "\n";
+            if (includes_macros && all_files_record.empty())
+            {
+                std::vector<uint64_t> all_record_hashes = code_file_record_hashes;
+                all_files_record = "all " + ContentHash::ToHex(HashRecords(all_record_hashes)) + "\n";
+            }
+            if (includes_macros)
+            {
+                included_files_record += all_files_record;
+            }
+            return included_files_record;
+        };
+
+        // FINGERPRINT THE PRECOMPILED HEADER.
+        // The generated header is determined entirely by which headers it includes, in order.
+        std::string translation_unit_record_prefix = "options " + BuildScriptBatchFile::FINGERPRINTED_COMPILER_OPTIONS + " /I " + project.CodeFolderPath + "\n";
+        std::string c_translation_unit_record_prefix = "options " + BuildScriptBatchFile::FINGERPRINTED_C_COMPILER_OPTIONS + " /I " + project.CodeFolderPath + "\n";
+        project.PrecompiledHeaderFingerprint = 0;
+        bool headers_precompiled = !project.PrecompiledHeaderIncludes.empty();
+        if (headers_precompiled)
+        {
+            std::unordered_map<std::string, uint32_t> header_indices_by_include_text;
+            for (uint32_t header_index = 0; header_index < include_graph.Headers.size(); ++header_index)
+            {
+                const std::string& include_text = include_graph.Headers[header_index].IncludeText;
+                if (!include_text.empty())
+                {
+                    header_indices_by_include_text.emplace(include_text, header_index);
+                }
+            }
+            std::string precompiled_header_record = translation_unit_record_prefix + "pch\n";
+            std::vector<uint32_t> precompiled_headers;
+            for (const std::string& precompiled_header_include : project.PrecompiledHeaderIncludes)
+            {
+                precompiled_header_record.append(precompiled_header_include).append("\n");
+                auto precompiled_header = header_indices_by_include_text.find(precompiled_header_include);
+                if (header_indices_by_include_text.cend() != precompiled_header)
+                {
+                    precompiled_headers.push_back(precompiled_header->second);
+                }
+            }
+            const bool PRECOMPILED_HEADER_INCLUDES_MACROS = false;
+            precompiled_header_record += get_included_files_record(precompiled_headers, PRECOMPILED_HEADER_INCLUDES_MACROS);
+            project.PrecompiledHeaderFingerprint = ContentHash::Hash(precompiled_header_record.data(), precompiled_header_record.size());
+            translation_unit_record_prefix += "pch " + ContentHash::ToHex(project.PrecompiledHeaderFingerprint) + "\n";
+        }
+
+        // FINGERPRINT EACH TRANSLATION UNIT.
+        // Unity build files are determined entirely by the source files they include, in order.  A hand-written
+        // translation unit is just another file in the include graph.  C files are compiled without the precompiled header.
+        bool unity_shards_used = !project.UnityShardStartIndices.empty();
+        project.TranslationUnitFingerprints.clear();
+        for (std::size_t translation_unit_index = 0; translation_unit_index < project.ProjectFolderCppFilenames.size(); ++translation_unit_index)
+        {
+            const std::string& translation_unit_filename = project.ProjectFolderCppFilenames[translation_unit_index];
+            bool is_c_translation_unit = CategorizedFileIndex::IsCFile(translation_unit_filename);
+            const std::string& record_prefix = is_c_translation_unit ? c_translation_unit_record_prefix : translation_unit_record_prefix;
+            std::string translation_unit_record = record_prefix + "tu " + translation_unit_filename + "\n";
+            std::vector<uint32_t> directly_included_headers;
+            bool includes_macros = false;
+            if (unity_shards_used)
+            {
+                bool is_last_shard = (translation_unit_index + 1 >= project.UnityShardStartIndices.size());
+                std::size_t first_cpp_file_index = is_c_translation_unit ? 0 : project.UnityShardStartIndices[translation_unit_index];
+                std::size_t end_cpp_file_index = is_last_shard ? project.CodeFiles.CppFiles.size() : project.UnityShardStartIndices[translation_unit_index + 1];
+                for (std::size_t cpp_file_index = first_cpp_file_index; cpp_file_index < end_cpp_file_index; ++cpp_file_index)
+                {
+                    const std::string& cpp_file_path = code_file_fingerprints[cpp_file_code_file_indices[cpp_file_index]].first;
+                    bool file_in_translation_unit = (CategorizedFileIndex::IsCFile(cpp_file_path) == is_c_translation_unit);
+                    if (!file_in_translation_unit)
+                    {
+                        continue;
+                    }
+                    translation_unit_record += code_file_records[cpp_file_code_file_indices[cpp_file_index]];
+                    const std::vector<uint32_t>& source_included_headers = include_graph.SourceIncludedHeaders[cpp_file_index];
+                    directly_included_headers.insert(directly_included_headers.end(), source_included_headers.cbegin(), source_included_headers.cend());
+                    includes_macros = includes_macros || (0 != include_graph.SourceIncludesMacros[cpp_file_index]);
+                }
+            }
+            else
+            {
+                directly_included_headers.push_back(include_graph.ProjectFolderCppFileHeaders[translation_unit_index]);
+            }
+            translation_unit_record += get_included_files_record(directly_included_headers, includes_macros);
+            project.TranslationUnitFingerprints.push_back(ContentHash::Hash(translation_unit_record.data(), translation_unit_record.size()));
+        }
+    }
+
+    /// Writes the manifest for a project.
+    /// @param[in]  project - The project, whose code files must already be fingerprinted.
+    /// @param[in,out]  file - The file to write to.
+    static void Write(const Project& project, OutputFile& file)
+    {
+        // WRITE THE FINGERPRINTS OF THE CODE FILES.
+        file
+            << "# Fingerprints of the code files and translation units of " << project.Name << ", generated by GenerateProject." << NEWLINE
+            << "# The build script reads them to skip compiling and linking what hasn't changed, so don't edit this file." << NEWLINE;
+        for (const std::pair<std::string, uint64_t>& code_file_fingerprint : project.CodeFileFingerprints)
+        {
+            file << "file " << ContentHash::ToHex(code_file_fingerprint.second) << " " << code_file_fingerprint.first << NEWLINE;
+        }
+
+        // WRITE THE FINGERPRINT OF THE PRECOMPILED HEADER.
+        // Its object file is linked into the program too.
+        std::string program_record = "program " + project.Name + "\n";
+        bool headers_precompiled = !project.PrecompiledHeaderIncludes.empty();
+        if (headers_precompiled)
+        {
+            std::string precompiled_header_fingerprint_text = ContentHash::ToHex(project.PrecompiledHeaderFingerprint);
+            file << "pch " << precompiled_header_fingerprint_text << " " << PrecompiledHeader::GetSourceFilename(project.Name) << NEWLINE;
+            program_record += "pch " + precompiled_header_fingerprint_text + "\n";
+        }
+
+        // WRITE THE FINGERPRINT OF EACH TRANSLATION UNIT.
+        for (std::size_t translation_unit_index = 0; translation_unit_index < project.ProjectFolderCppFilenames.size(); ++translation_unit_index)
+        {
+            std::string translation_unit_fingerprint_text = ContentHash::ToHex(project.TranslationUnitFingerprints[translation_unit_index]);
+            file << "tu " << translation_unit_fingerprint_text << " " << project.ProjectFolderCppFilenames[translation_unit_index] << NEWLINE;
+            program_record += translation_unit_fingerprint_text + "\n";
+        }
+
+        // WRITE THE FINGERPRINT OF THE PROGRAM.
+        uint64_t program_fingerprint = ContentHash::Hash(program_record.data(), program_record.size());
+        file << "program " << ContentHash::ToHex(program_fingerprint) << " " << project.Name << ".exe" << NEWLINE;
+    }
+
+private:
+    /// Combines the hashes of a set of records into a single hash, regardless of their order.
+    /// @param[in,out]  record_hashes - The hashes of the records, which are sorted.
+    /// @return The combined hash.
+    static uint64_t HashRecords(std::vector<uint64_t>& record_hashes)
+    {
+        std::sort(record_hashes.begin(), record_hashes.end());
+        return ContentHash::Hash(reinterpret_cast<const char*>(record_hashes.data()), record_hashes.size() * sizeof(uint64_t));
+    }
+};
+
+/// A database of how long compiling each translation unit took, and how long each file it included took, as measured
+/// by the compiler: Clang with -ftime-trace, or Visual C++ with /Bt+ and /d1reportTime.  Measurements from earlier builds
+/// are kept in a profile file so that they can guide later generations, such as by balancing unity build files by cost
+/// (see UnityBuild) and starting the slowest translation units first (see NinjaBuildFile), and so that the most expensive
+/// translation units and headers can be reported (see CompileTimeReportFile).
+///
+/// Each line of the profile file is one of:
+///     latest-trace <ModificationTime> - The modification time of the newest time trace read from the Ninja build.
+///     unit <Microseconds> <Path> - The time to compile a translation unit.
+///     include <Microseconds> <Path> - The time spent on a file included by the translation unit above it.
+/// Lines starting with # are comments.  Measuring a translation unit again replaces everything recorded for it.
+///
+/// The compiler may refer to files by paths relative to somewhere else or by full paths, so measured files are
+/// matched to a project's files by their trailing path components, without regard to case.
+class CompileProfile
+{
+public:
+    /// A measured translation unit.
+    struct TranslationUnit
+    {
+        /// The path of the translation unit's source file, as the compiler referred to it.
+        std::string Path = "";
+        /// The time to compile the translation unit, in microseconds.
+        uint64_t CompileTimeInMicroseconds = 0;
+        /// The path of each file included while compiling the translation unit (as the compiler referred to it) and
+        /// the time spent on it in microseconds, including the files it included.  Files included several times have
+        /// their times summed.
+        std::vector<std::pair<std::string, uint64_t>> Includes = {};
+    };
+
+    /// The extension of Clang's time trace files.
+    static const std::string TIME_TRACE_FILE_EXTENSION;
+
+    /// Loads a profile file.  A profile that doesn't exist yet is simply empty, and lines that can't be read are skipped.
+    /// @param[in]  profile_path - The path of the profile file.
+    /// @param[out]  profile - The loaded profile.
+    static void Load(const std::string& profile_path, CompileProfile& profile)
+    {
+        const bool IS_PHASE = true;
+        TraceSpan load_span("load compile profile", &profile_path, IS_PHASE);
+
+        profile = CompileProfile();
+        std::string profile_text;
+        bool profile_read = ReadFileText(profile_path, profile_text);
+        if (!profile_read)
+        {
+            return;
+        }
+
+        // READ EACH LINE OF THE PROFILE.
+        TranslationUnit translation_unit;
+        for (std::size_t line_start = 0; line_start < profile_text.size();)
+        {
+            // GET THE NEXT LINE.
+            std::size_t line_end = profile_text.find('\n', line_start);
+            if (std::string::npos == line_end)
+            {
+                line_end = profile_text.size();
+            }
+            std::string line = profile_text.substr(line_start, line_end - line_start);
+            line_start = line_end + 1;
+            if (!line.empty() && '\r' == line.back())
+            {
+                line.pop_back();
+            }
+
+            // SPLIT THE LINE INTO ITS KIND, NUMBER, AND PATH.
+            // The path is everything after the number, so it may contain spaces.
+            std::size_t kind_end = line.find(' ');
+            bool line_has_number = (std::string::npos != kind_end && '#' != line.front());
+            if (!line_has_number)
+            {
+                continue;
+            }
+            std::string kind = line.substr(0, kind_end);
+            const char* number_start = line.c_str() + kind_end + 1;
+            char* number_end = nullptr;
+            const int DECIMAL_BASE = 10;
+            uint64_t number = std::strtoull(number_start, &number_end, DECIMAL_BASE);
+            bool number_valid = (number_end != number_start && std::isdigit(static_cast<unsigned char>(*number_start)));
+            if (!number_valid)
+            {
+                continue;
+            }
+            std::string path = (' ' == *number_end) ? std::string(number_end + 1) : std::string();
+
+            // ADD WHAT THE LINE DESCRIBES TO THE PROFILE.
+            // Each translation unit is recorded once all of its includes have been read.
+            if ("latest-trace" == kind)
+            {
+                profile.LatestTraceModificationTime = number;
+            }
+            else if ("unit" == kind && !path.empty())
+            {
+                if (!translation_unit.Path.empty())
+                {
+                    profile.Record(translation_unit);
+                }
+                translation_unit = TranslationUnit();
+                translation_unit.Path = path;
+                translation_unit.CompileTimeInMicroseconds = number;
+            }
+            else if ("include" == kind && !path.empty() && !translation_unit.Path.empty())
+            {
+                translation_unit.Includes.emplace_back(path, number);
+            }
+        }
+        if (!translation_unit.Path.empty())
+        {
+            profile.Record(translation_unit);
+        }
+    }
+
+    /// Reads the compile times measured in a timing file, or in every timing file within a folder, into the profile.
+    ///
+    /// Files ending in .json are read as Clang time traces (from -ftime-trace), which are named after their object
+    /// files.  A trace is matched to its translation unit by its path without the .json extension, so traces are only
+    /// matched if their object files are named after the whole source filename (such as a.cpp.o, as CMake names them).
+    /// Other files are read as Visual C++ build output from /Bt+ and /d1reportTime, which names each translation unit.
+    /// Within a folder, only .json, .log, and .txt files are read, and files without any timings are skipped.
+    /// @param[in]  thread_count - The number of threads to read timing files with.  Zero uses one thread per hardware core.
+    /// @param[in]  timing_path - The path of the timing file or folder.
+    /// @return True if any compile times were read; false otherwise (which is reported to standard error).
+    bool ReadTimings(const unsigned int thread_count, const std::string& timing_path)
+    {
+        const bool IS_PHASE = true;
+        TraceSpan read_span("read compile timings", &timing_path, IS_PHASE);
+
+        // FIND THE TIMING FILES.
+        std::vector<std::string> timing_file_paths;
+        MemoryMappedFile timing_file;
+        bool is_timing_file = timing_file.Open(DirectoryListing::ToNativePath(timing_path));
+        timing_file.Close();
+        if (is_timing_file)
+        {
+            timing_file_paths.push_back(timing_path);
+        }
+        else
+        {
+            // Build folders may have ignore files that leave out everything in them, so nothing is ignored.
+            IgnoreSettings ignore_settings;
+            ignore_settings.VersionControlIgnored = false;
+            FolderTree timing_folder = FolderTree::Get(timing_path, ignore_settings, thread_count);
+            std::string file_path;
+            for (uint32_t file_index = 0; file_index < timing_folder.Files.size(); ++file_index)
+            {
+                file_path.clear();
+                timing_folder.AppendFilePath(file_index, file_path);
+                bool is_possible_timing_file = (
+                    EndsWith(file_path, TIME_TRACE_FILE_EXTENSION) ||
+                    EndsWith(file_path, ".log") ||
+                    EndsWith(file_path, ".txt"));
+                if (is_possible_timing_file)
+                {
+                    timing_file_paths.push_back(DirectoryListing::ToNativePath(file_path));
+                }
+            }
+        }
+
+        // READ THE TIMING FILES IN PARALLEL.
+        std::vector<std::vector<TranslationUnit>> timing_file_translation_units(timing_file_paths.size());
+        std::vector<std::function<void()>> read_tasks;
+        for (std::size_t timing_file_index = 0; timing_file_index < timing_file_paths.size(); ++timing_file_index)
+        {
+            read_tasks.push_back([&timing_file_paths, &timing_file_translation_units, timing_file_index]()
+            {
+                const std::string& timing_file_path = timing_file_paths[timing_file_index];
+                std::string timing_text;
+                bool timing_file_read = ReadFileText(timing_file_path, timing_text);
+                if (!timing_file_read)
+                {
+                    return;
+                }
+
+                std::vector<TranslationUnit>& translation_units = timing_file_translation_units[timing_file_index];
+                bool is_time_trace = EndsWith(timing_file_path, TIME_TRACE_FILE_EXTENSION);
+                if (is_time_trace)
+                {
+                    TranslationUnit translation_unit;
+                    bool time_trace_parsed = ParseTimeTrace(timing_text, translation_unit);
+                    if (time_trace_parsed)
+                    {
+                        translation_unit.Path = timing_file_path.substr(0, timing_file_path.size() - TIME_TRACE_FILE_EXTENSION.size());
+                        translation_units.push_back(std::move(translation_unit));
+                    }
+                }
+                else
+                {
+                    ParseBuildOutput(timing_text, translation_units);
+                }
+            });
+        }
+        ParallelTasks::Run(FolderScanner::ResolveThreadCount(thread_count), read_tasks);
+
+        // RECORD THE MEASURED TRANSLATION UNITS.
+        std::size_t translation_unit_count = 0;
+        for (const auto& translation_units : timing_file_translation_units)
+        {
+            for (const TranslationUnit& translation_unit : translation_units)
+            {
+                Record(translation_unit);
+                ++translation_unit_count;
+            }
+        }
+        bool compile_times_read = (translation_unit_count > 0);
+        if (!compile_times_read)
+        {
+            std::cerr << "No compile times found in " << timing_path << std::endl;
+        }
+        return compile_times_read;
+    }
+
+    /// Reads the time traces that Clang wrote while building projects with the Ninja build file (see NinjaBuildFile),
+    /// skipping any read before.  Time traces that don't exist (such as for translation units that haven't been built
+    /// yet) are also skipped, so this only costs checking the modification time of each trace if nothing was rebuilt.
+    /// @param[in]  thread_count - The number of threads to use.  Zero uses one thread per hardware core.
+    /// @param[in]  unity_shards_used - True if the projects' source files are split into unity build files.
+    /// @param[in]  projects - The projects built with the Ninja build file, whose code files must already be categorized.
+    void ReadNinjaTimeTraces(const unsigned int thread_count, const bool unity_shards_used, const std::vector<Project>& projects)
+    {
+        const bool IS_PHASE = true;
+        TraceSpan read_span("read ninja time traces", nullptr, IS_PHASE);
+
+        // FIND WHERE EACH TRANSLATION UNIT'S TIME TRACE WOULD BE.
+        std::vector<std::string> source_paths;
+        std::vector<std::string> time_trace_paths;
+        for (const Project& project : projects)
+        {
+            for (const std::string& source_path : NinjaBuildFile::GetTranslationUnitPaths(project, unity_shards_used))
+            {
+                source_paths.push_back(source_path);
+                time_trace_paths.push_back(NinjaBuildFile::GetTimeTracePath(project, source_path));
+            }
+        }
+
+        // FIND THE TIME TRACES WRITTEN SINCE THE PROFILE WAS LAST UPDATED.
+        std::vector<uint64_t> sizes_in_bytes;
+        std::vector<uint64_t> modification_times;
+        FileMetadataReader::Read(
+            thread_count,
+            time_trace_paths.size(),
+            [&time_trace_paths](const std::size_t file_index, std::string& path) { path.append(time_trace_paths[file_index]); },
+            sizes_in_bytes,
+            modification_times);
+        std::vector<std::size_t> new_time_trace_indices;
+        uint64_t latest_modification_time = LatestTraceModificationTime;
+        for (std::size_t time_trace_index = 0; time_trace_index < time_trace_paths.size(); ++time_trace_index)
+        {
+            bool time_trace_new = (modification_times[time_trace_index] > LatestTraceModificationTime);
+            if (time_trace_new)
+            {
+                new_time_trace_indices.push_back(time_trace_index);
+                latest_modification_time = std::max(latest_modification_time, modification_times[time_trace_index]);
+            }
+        }
+
+        // READ THE NEW TIME TRACES IN PARALLEL.
+        std::vector<TranslationUnit> translation_units(new_time_trace_indices.size());
+        std::vector<uint8_t> time_traces_parsed(new_time_trace_indices.size(), 0);
+        std::vector<std::function<void()>> read_tasks;
+        for (std::size_t new_time_trace_index = 0; new_time_trace_index < new_time_trace_indices.size(); ++new_time_trace_index)
+        {
+            read_tasks.push_back([&source_paths, &time_trace_paths, &new_time_trace_indices, &translation_units, &time_traces_parsed, new_time_trace_index]()
+            {
+                std::size_t time_trace_index = new_time_trace_indices[new_time_trace_index];
+                std::string time_trace_text;
+                TranslationUnit& translation_unit = translation_units[new_time_trace_index];
+                bool time_trace_parsed = (
+                    ReadFileText(time_trace_paths[time_trace_index], time_trace_text) &&
+                    ParseTimeTrace(time_trace_text, translation_unit));
+                translation_unit.Path = DirectoryListing::ToNativePath(source_paths[time_trace_index]);
+                time_traces_parsed[new_time_trace_index] = time_trace_parsed ? 1 : 0;
+            });
+        }
+        ParallelTasks::Run(FolderScanner::ResolveThreadCount(thread_count), read_tasks);
+
+        // RECORD THE MEASURED TRANSLATION UNITS.
+        for (std::size_t new_time_trace_index = 0; new_time_trace_index < new_time_trace_indices.size(); ++new_time_trace_index)
+        {
+            if (time_traces_parsed[new_time_trace_index])
+            {
+                Record(translation_units[new_time_trace_index]);
+            }
+        }
+        LatestTraceModificationTime = latest_modification_time;
+    }
+
+    /// Finds the measured translation unit for each of a project's source files and for each of the source files
+    /// in the current folder that it builds (such as unity build files).
+    /// @param[in]  project - The project, whose code files must already be categorized.
+    /// @param[out]  cpp_file_translation_units - The measured translation unit for each source file, in the same order
+    ///     as the project's source files (CodeFiles.CppFiles), or null if the file wasn't measured on its own.
+    /// @param[out]  project_folder_cpp_file_translation_units - The measured translation unit for each source file in
+    ///     the current folder, in the same order as the project's ProjectFolderCppFilenames, or null if not measured.
+    void FindTranslationUnits(
+        const Project& project,
+        std::vector<const TranslationUnit*>& cpp_file_translation_units,
+        std::vector<const TranslationUnit*>& project_folder_cpp_file_translation_units) const
+    {
+        // INDEX THE PROJECT'S SOURCE FILES BY PATH.
+        // Source files in the current folder are listed after the ones in the code folder.
+        std::unordered_map<std::string, std::size_t> source_file_indices_by_path = GetCppFileIndicesByPath(project);
+        std::size_t cpp_file_count = project.CodeFiles.CppFiles.size();
+        for (std::size_t project_folder_cpp_file_index = 0; project_folder_cpp_file_index < project.ProjectFolderCppFilenames.size(); ++project_folder_cpp_file_index)
+        {
+            std::string path = NormalizePath(project.ProjectFolderCppFilenames[project_folder_cpp_file_index]);
+            source_file_indices_by_path[path] = cpp_file_count + project_folder_cpp_file_index;
+        }
+
+        // MATCH EACH MEASURED TRANSLATION UNIT TO A SOURCE FILE.
+        // If several were measured under different paths, the one measured most recently is used.
+        cpp_file_translation_units.assign(cpp_file_count, nullptr);
+        project_folder_cpp_file_translation_units.assign(project.ProjectFolderCppFilenames.size(), nullptr);
+        for (const TranslationUnit& translation_unit : TranslationUnits)
+        {
+            const std::size_t* source_file_index = FindByPathSuffix(source_file_indices_by_path, NormalizePath(translation_unit.Path));
+            if (!source_file_index)
+            {
+                continue;
+            }
+            bool is_project_folder_cpp_file = (*source_file_index >= cpp_file_count);
+            if (is_project_folder_cpp_file)
+            {
+                project_folder_cpp_file_translation_units[*source_file_index - cpp_file_count] = &translation_unit;
+            }
+            else
+            {
+                cpp_file_translation_units[*source_file_index] = &translation_unit;
+            }
+        }
+    }
+
+    /// Gets the measured compile times of a project's files.  The time to compile a unity build file is split among
+    /// the source files it includes in proportion to the time spent on each of them, though any source file that was
+    /// also measured on its own uses that time instead.
+    /// @param[in,out]  project - The project, whose code files must already be categorized.  Its compile times are set.
+    void GetCompileTimes(Project& project) const
+    {
+        // FIND THE MEASURED TRANSLATION UNITS.
+        std::vector<const TranslationUnit*> cpp_file_translation_units;
+        std::vector<const TranslationUnit*> project_folder_cpp_file_translation_units;
+        FindTranslationUnits(project, cpp_file_translation_units, project_folder_cpp_file_translation_units);
+
+        // SPLIT THE TIMES OF SOURCE FILES IN THE CURRENT FOLDER AMONG THE SOURCE FILES THEY INCLUDE.
+        std::unordered_map<std::string, std::size_t> cpp_file_indices_by_path = GetCppFileIndicesByPath(project);
+        project.CppFileCompileTimes.assign(project.CodeFiles.CppFiles.size(), 0);
+        project.ProjectFolderCppFileCompileTimes.assign(project.ProjectFolderCppFilenames.size(), 0);
+        std::vector<std::pair<std::size_t, uint64_t>> included_cpp_file_times;
+        for (std::size_t project_folder_cpp_file_index = 0; project_folder_cpp_file_index < project_folder_cpp_file_translation_units.size(); ++project_folder_cpp_file_index)
+        {
+            const TranslationUnit* translation_unit = project_folder_cpp_file_translation_units[project_folder_cpp_file_index];
+            if (!translation_unit)
+            {
+                continue;
+            }
+            project.ProjectFolderCppFileCompileTimes[project_folder_cpp_file_index] = translation_unit->CompileTimeInMicroseconds;
+
+            included_cpp_file_times.clear();
+            uint64_t total_included_cpp_file_time = 0;
+            for (const auto& include : translation_unit->Includes)
+            {
+                const std::size_t* cpp_file_index = FindByPathSuffix(cpp_file_indices_by_path, NormalizePath(include.first));
+                if (cpp_file_index)
+                {
+                    included_cpp_file_times.emplace_back(*cpp_file_index, include.second);
+                    total_included_cpp_file_time += include.second;
+                }
+            }
+            bool included_cpp_files_measured = (total_included_cpp_file_time > 0);
+            if (!included_cpp_files_measured)
+            {
+                continue;
+            }
+            double compile_time_per_included_time = static_cast<double>(translation_unit->CompileTimeInMicroseconds) / static_cast<double>(total_included_cpp_file_time);
+            for (const auto& included_cpp_file_time : included_cpp_file_times)
+            {
+                project.CppFileCompileTimes[included_cpp_file_time.first] += static_cast<uint64_t>(static_cast<double>(included_cpp_file_time.second) * compile_time_per_included_time);
+            }
+        }
+
+        // USE THE TIMES OF SOURCE FILES MEASURED ON THEIR OWN.
+        for (std::size_t cpp_file_index = 0; cpp_file_index < cpp_file_translation_units.size(); ++cpp_file_index)
+        {
+            const TranslationUnit* translation_unit = cpp_file_translation_units[cpp_file_index];
+            if (translation_unit)
+            {
+                project.CppFileCompileTimes[cpp_file_index] = translation_unit->CompileTimeInMicroseconds;
+            }
+        }
+    }
+
+    /// Writes the profile file.
+    /// @param[in,out]  file - The file to write to.
+    void Write(OutputFile& file) const
+    {
+        file
+            << "# Measured compile times in microseconds, generated by GenerateProject from compiler timings." << NEWLINE
+            << "# Each unit is a translation unit, followed by the files it included." << NEWLINE
+            << "latest-trace " << std::to_string(LatestTraceModificationTime) << NEWLINE;
+        for (const TranslationUnit& translation_unit : TranslationUnits)
+        {
+            file << "unit " << std::to_string(translation_unit.CompileTimeInMicroseconds) << " " << translation_unit.Path << NEWLINE;
+            for (const auto& include : translation_unit.Includes)
+            {
+                file << "include " << std::to_string(include.second) << " " << include.first << NEWLINE;
+            }
+        }
+    }
+
+    /// Normalizes a path for matching against other paths: it's lowercase, has single forward slashes, and doesn't start
+    /// with any . or .. folders.
+    /// @param[in]  path - The path to normalize.
+    /// @return The normalized path.
+    static std::string NormalizePath(const std::string& path)
+    {
+        std::string normalized_path;
+        normalized_path.reserve(path.size());
+        for (char character : path)
+        {
+            bool is_separator = ('\\' == character || '/' == character);
+            if (!is_separator)
+            {
+                normalized_path.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(character))));
+                continue;
+            }
+            bool follows_separator = (!normalized_path.empty() && '/' == normalized_path.back());
+            if (!follows_separator)
+            {
+                normalized_path.push_back('/');
+            }
+        }
+
+        std::size_t relative_folders_end = 0;
+        for (;;)
+        {
+            bool starts_with_current_folder = (0 == normalized_path.compare(relative_folders_end, 2, "./"));
+            bool starts_with_parent_folder = (0 == normalized_path.compare(relative_folders_end, 3, "../"));
+            if (starts_with_current_folder)
+            {
+                relative_folders_end += 2;
+            }
+            else if (starts_with_parent_folder)
+            {
+                relative_folders_end += 3;
+            }
+            else
+            {
+                break;
+            }
+        }
+        return normalized_path.substr(relative_folders_end);
+    }
+
+    // MEMBER VARIABLES.
+    /// The modification time of the newest time trace read from the Ninja build, in the file system's native units.
+    uint64_t LatestTraceModificationTime = 0;
+    /// The measured translation units, in the order they were first measured.
+    std::vector<TranslationUnit> TranslationUnits = {};
+
+private:
+    /// Records a measured translation unit, replacing anything measured for it before.
+    /// @param[in]  translation_unit - The measured translation unit.
+    void Record(const TranslationUnit& translation_unit)
+    {
+        std::string path = NormalizePath(translation_unit.Path);
+        auto translation_unit_index = TranslationUnitIndicesByPath.find(path);
+        bool measured_before = (TranslationUnitIndicesByPath.cend() != translation_unit_index);
+        if (measured_before)
+        {
+            TranslationUnits[translation_unit_index->second] = translation_unit;
+        }
+        else
+        {
+            TranslationUnitIndicesByPath[path] = TranslationUnits.size();
+            TranslationUnits.push_back(translation_unit);
+        }
+    }
+
+    /// Indexes a project's source files by their normalized paths (see NormalizePath).
+    /// @param[in]  project - The project, whose code files must already be categorized.
+    /// @return The index of each source file within the project's source files (CodeFiles.CppFiles), by path.
+    static std::unordered_map<std::string, std::size_t> GetCppFileIndicesByPath(const Project& project)
+    {
+        std::unordered_map<std::string, std::size_t> cpp_file_indices_by_path;
+        std::string path;
+        for (std::size_t cpp_file_index = 0; cpp_file_index < project.CodeFiles.CppFiles.size(); ++cpp_file_index)
+        {
+            path.clear();
+            project.CodeFolderTree->AppendFilePath(project.CodeFiles.CppFiles[cpp_file_index], path);
+            cpp_file_indices_by_path[NormalizePath(path)] = cpp_file_index;
+        }
+        return cpp_file_indices_by_path;
+    }
+
+    /// Finds the value for the longest trailing part of a path that's in a map, only considering whole path components.
+    /// @param[in]  values_by_path - The values to find, by normalized path (see NormalizePath).
+    /// @param[in]  path - The normalized path to find.
+    /// @return The value for the longest matching trailing part of the path, or null if no part of it is in the map.
+    template <typename Value>
+    static const Value* FindByPathSuffix(const std::unordered_map<std::string, Value>& values_by_path, const std::string& path)
+    {
+        for (std::size_t suffix_start = 0; suffix_start < path.size();)
+        {
+            auto value = values_by_path.find(path.substr(suffix_start));
+            bool value_found = (values_by_path.cend() != value);
+            if (value_found)
+            {
+                return &value->second;
+            }
+            std::size_t separator_position = path.find('/', suffix_start);
+            if (std::string::npos == separator_position)
+            {
+                break;
+            }
+            suffix_start = separator_position + 1;
+        }
+        return nullptr;
+    }
+
+    /// Parses a Clang time trace (in the Chrome trace event format).  The translation unit's time is taken from the
+    /// ExecuteCompiler event, and the time spent on each included file from its Source events.
+    /// @param[in]  time_trace_text - The text of the time trace.
+    /// @param[out]  translation_unit - The measured translation unit, except for its path.
+    /// @return True if the text was a time trace with the time to compile the translation unit; false otherwise.
+    static bool ParseTimeTrace(const std::string& time_trace_text, TranslationUnit& translation_unit)
+    {
+        // GET THE TRACE EVENTS.
+        JsonValue time_trace;
+        bool time_trace_parsed = JsonValue::Parse(time_trace_text, time_trace);
+        if (!time_trace_parsed)
+        {
+            return false;
+        }
+        const JsonValue* events = time_trace.GetMember("traceEvents");
+        bool events_found = (events && JsonValue::Type::ARRAY == events->ValueType);
+        if (!events_found)
+        {
+            return false;
+        }
+
+        // ADD UP THE DURATIONS OF THE EVENTS.
+        // Older versions of Clang only have the summarized "Total ExecuteCompiler" event, and the total
+        // can be estimated from the frontend and backend if neither is found.
+        double execute_compiler_duration = 0.0;
+        double total_execute_compiler_duration = 0.0;
+        double frontend_and_backend_duration = 0.0;
+        std::unordered_map<std::string, std::size_t> include_indices_by_path;
+        for (const JsonValue& event : events->Elements)
+        {
+            const JsonValue* name = event.GetMember("name");
+            const JsonValue* duration = event.GetMember("dur");
+            bool is_timed_event = (
+                name && JsonValue::Type::STRING == name->ValueType &&
+                duration && JsonValue::Type::NUMBER == duration->ValueType && duration->Number >= 0.0);
+            if (!is_timed_event)
+            {
+                continue;
+            }
+
+            if ("Source" == name->String)
+            {
+                const JsonValue* arguments = event.GetMember("args");
+                const JsonValue* detail = arguments ? arguments->GetMember("detail") : nullptr;
+                bool included_path_found = (detail && JsonValue::Type::STRING == detail->ValueType && !detail->String.empty());
+                if (!included_path_found)
+                {
+                    continue;
+                }
+                auto include_index = include_indices_by_path.find(detail->String);
+                bool included_before = (include_indices_by_path.cend() != include_index);
+                if (included_before)
+                {
+                    translation_unit.Includes[include_index->second].second += static_cast<uint64_t>(duration->Number);
+                }
+                else
+                {
+                    include_indices_by_path[detail->String] = translation_unit.Includes.size();
+                    translation_unit.Includes.emplace_back(detail->String, static_cast<uint64_t>(duration->Number));
+                }
+            }
+            else if ("ExecuteCompiler" == name->String)
+            {
+                execute_compiler_duration += duration->Number;
+            }
+            else if ("Total ExecuteCompiler" == name->String)
+            {
+                total_execute_compiler_duration += duration->Number;
+            }
+            else if ("Frontend" == name->String || "Backend" == name->String)
+            {
+                frontend_and_backend_duration += duration->Number;
+            }
+        }
+
+        // DETERMINE THE TIME TO COMPILE THE TRANSLATION UNIT.
+        double compile_time = execute_compiler_duration;
+        if (compile_time <= 0.0)
+        {
+            compile_time = total_execute_compiler_duration;
+        }
+        if (compile_time <= 0.0)
+        {
+            compile_time = frontend_and_backend_duration;
+        }
+        translation_unit.CompileTimeInMicroseconds = static_cast<uint64_t>(compile_time);
+        bool compile_time_found = (translation_unit.CompileTimeInMicroseconds > 0);
+        return compile_time_found;
+    }
+
+    /// Parses Visual C++ build output with the timings from /Bt+ and /d1reportTime.  /Bt+ prints a line for each
+    /// part of the compiler that ran on a translation unit, such as:
+    ///     time(C:\...\c1xx.dll)=0.52347s < 1024589137 - 1025933405 > BB [C:\Code\File.cpp]
+    /// The times of all parts are added up.  /d1reportTime prints the time spent on each included file before
+    /// the frontend's line, indented within an "Include Headers:" section:
+    ///     Include Headers:
+    ///         Count: 2
+    ///             C:\Code\Header.h: 0.021365s
+    /// Lines may have prefixes (such as from MSBuild), which are skipped.
+    /// @param[in]  build_output - The build output.
+    /// @param[in,out]  translation_units - The measured translation units, in the order they're first timed,
+    ///     which are appended to.
+    static void ParseBuildOutput(const std::string& build_output, std::vector<TranslationUnit>& translation_units)
+    {
+        const double MICROSECONDS_PER_SECOND = 1000000.0;
+        std::unordered_map<std::string, std::size_t> translation_unit_indices_by_path;
+        std::vector<std::pair<std::string, uint64_t>> pending_includes;
+        bool in_include_section = false;
+        for (std::size_t line_start = 0; line_start < build_output.size();)
+        {
+            // GET THE NEXT LINE.
+            std::size_t line_end = build_output.find('\n', line_start);
+            if (std::string::npos == line_end)
+            {
+                line_end = build_output.size();
+            }
+            std::string line = build_output.substr(line_start, line_end - line_start);
+            line_start = line_end + 1;
+            while (!line.empty() && ('\r' == line.back() || ' ' == line.back()))
+            {
+                line.pop_back();
+            }
+
+            // ADD THE TIME OF ANY PART OF THE COMPILER TO ITS TRANSLATION UNIT.
+            const std::string TIME_PREFIX = "time(";
+            std::size_t time_start = line.find(TIME_PREFIX);
+            std::size_t time_end = line.find(")=", time_start);
+            std::size_t path_start = line.rfind('[');
+            bool is_compiler_time = (
+                std::string::npos != time_start &&
+                std::string::npos != time_end &&
+                std::string::npos != path_start &&
+                path_start > time_end &&
+                !line.empty() && ']' == line.back());
+            if (is_compiler_time)
+            {
+                in_include_section = false;
+                double seconds = std::strtod(line.c_str() + time_end + 2, nullptr);
+                std::string path = line.substr(path_start + 1, line.size() - path_start - 2);
+                if (path.empty())
+                {
+                    continue;
+                }
+
+                auto translation_unit_index = translation_unit_indices_by_path.find(path);
+                bool timed_before = (translation_unit_indices_by_path.cend() != translation_unit_index);
+                if (!timed_before)
+                {
+                    translation_unit_indices_by_path[path] = translation_units.size();
+                    translation_units.emplace_back();
+                    translation_units.back().Path = path;
+                }
+                TranslationUnit& translation_unit = translation_units[translation_unit_indices_by_path[path]];
+                translation_unit.CompileTimeInMicroseconds += static_cast<uint64_t>(std::max(0.0, seconds) * MICROSECONDS_PER_SECOND);
+
+                // Included files are reported by the frontend, which runs first.
+                bool is_frontend = (std::string::npos != line.find("c1xx.dll", time_start) || std::string::npos != line.find("c1.dll", time_start));
+                if (is_frontend)
+                {
+                    translation_unit.Includes.insert(translation_unit.Includes.end(), pending_includes.cbegin(), pending_includes.cend());
+                    pending_includes.clear();
+                }
+                continue;
+            }
+
+            // START AND END THE SECTION OF INCLUDED FILES.
+            // Other sections (such as "Class Definitions:") aren't indented.
+            std::size_t text_start = line.find_first_not_of(" \t");
+            bool line_empty = (std::string::npos == text_start);
+            if (line_empty)
+            {
+                continue;
+            }
+            const std::string INCLUDE_SECTION_HEADING = "Include Headers:";
+            bool is_include_section_heading = EndsWith(line, INCLUDE_SECTION_HEADING);
+            if (is_include_section_heading)
+            {
+                in_include_section = true;
+                continue;
+            }
+            bool is_section_heading = (0 == text_start && ':' == line.back());
+            if (is_section_heading)
+            {
+                in_include_section = false;
+                continue;
+            }
+
+            // READ THE TIME SPENT ON AN INCLUDED FILE.
+            const std::string TIME_SEPARATOR = ": ";
+            std::size_t time_separator_position = line.rfind(TIME_SEPARATOR);
+            bool is_included_file_time = (
+                in_include_section &&
+                text_start > 0 &&
+                std::string::npos != time_separator_position &&
+                time_separator_position > text_start &&
+                's' == line.back());
+            if (!is_included_file_time)
+            {
+                continue;
+            }
+            std::string path = line.substr(text_start, time_separator_position - text_start);
+            double seconds = std::strtod(line.c_str() + time_separator_position + TIME_SEPARATOR.size(), nullptr);
+            pending_includes.emplace_back(path, static_cast<uint64_t>(std::max(0.0, seconds) * MICROSECONDS_PER_SECOND));
+        }
+    }
+
+    /// Reads the whole text of a file.
+    /// @param[in]  path - The path of the file.
+    /// @param[out]  text - The text of the file.
+    /// @return True if the file was read; false otherwise.
+    static bool ReadFileText(const std::string& path, std::string& text)
+    {
+        MemoryMappedFile file;
+        bool file_read = file.Open(DirectoryListing::ToNativePath(path));
+        if (!file_read)
+        {
+            return false;
+        }
+        text.assign(file.Data ? file.Data : "", file.Size);
+        return true;
+    }
+
+    /// Checks if a string ends with another string.
+    /// @param[in]  text - The string to check.
+    /// @param[in]  suffix - The string that the text may end with.
+    /// @return True if the text ends with the suffix; false otherwise.
+    static bool EndsWith(const std::string& text, const std::string& suffix)
+    {
+        return text.size() >= suffix.size() && 0 == text.compare(text.size() - suffix.size(), suffix.size(), suffix);
+    }
+
+    // MEMBER VARIABLES.
+    /// The index of each measured translation unit, by normalized path (see NormalizePath).
+    std::unordered_map<std::string, std::size_t> TranslationUnitIndicesByPath = {};
+};
+
+const std::string CompileProfile::TIME_TRACE_FILE_EXTENSION = ".json";
+
+/// A report of the translation units, headers, and source files of a project that took the longest to compile,
+/// as measured in a compile profile (see CompileProfile).
+class CompileTimeReportFile
+{
+public:
+    /// The most entries to list in each section of the report.
+    static const std::size_t MAX_ENTRY_COUNT = 100;
+
+    /// Gets the filename of the report for a project, which is in the current folder.
+    /// @param[in]  project_name - The name of the project.
+    /// @return The filename of the report.
+    static std::string GetFilename(const std::string& project_name)
+    {
+        return project_name + "_CompileTimes.txt";
+    }
+
+    /// Writes the report for a project.
+    /// @param[in]  profile - The measured compile times.
+    /// @param[in]  project - The project, whose compile times must already be set from the profile.
+    /// @param[in,out]  file - The file to write to.
+    static void Write(const CompileProfile& profile, const Project& project, OutputFile& file)
+    {
+        // FIND THE PROJECT'S MEASURED TRANSLATION UNITS.
+        std::vector<const CompileProfile::TranslationUnit*> cpp_file_translation_units;
+        std::vector<const CompileProfile::TranslationUnit*> project_folder_cpp_file_translation_units;
+        profile.FindTranslationUnits(project, cpp_file_translation_units, project_folder_cpp_file_translation_units);
+        std::vector<std::string> cpp_file_paths(project.CodeFiles.CppFiles.size());
+        for (std::size_t cpp_file_index = 0; cpp_file_index < cpp_file_paths.size(); ++cpp_file_index)
+        {
+            project.CodeFolderTree->AppendFilePath(project.CodeFiles.CppFiles[cpp_file_index], cpp_file_paths[cpp_file_index]);
+            cpp_file_paths[cpp_file_index] = DirectoryListing::ToNativePath(cpp_file_paths[cpp_file_index]);
+        }
+        std::vector<std::pair<std::string, const CompileProfile::TranslationUnit*>> translation_units;
+        for (std::size_t index = 0; index < project_folder_cpp_file_translation_units.size(); ++index)
+        {
+            if (project_folder_cpp_file_translation_units[index])
+            {
+                translation_units.emplace_back(project.ProjectFolderCppFilenames[index], project_folder_cpp_file_translation_units[index]);
+            }
+        }
+        for (std::size_t cpp_file_index = 0; cpp_file_index < cpp_file_translation_units.size(); ++cpp_file_index)
+        {
+            if (cpp_file_translation_units[cpp_file_index])
+            {
+                translation_units.emplace_back(cpp_file_paths[cpp_file_index], cpp_file_translation_units[cpp_file_index]);
+            }
+        }
+
+        // ADD UP THE TIME SPENT ON EACH HEADER ACROSS ALL TRANSLATION UNITS.
+        // Source files included by unity build files aren't headers, so they're left out.
+        std::vector<HeaderTime> header_times;
+        std::unordered_map<std::string, std::size_t> header_time_indices_by_path;
+        for (const auto& translation_unit : translation_units)
+        {
+            for (const auto& include : translation_unit.second->Includes)
+            {
+                bool is_cpp_file = (FileCategory::CPP == CategorizedFileIndex::Categorize(include.first.c_str(), include.first.size()));
+                if (is_cpp_file)
+                {
+                    continue;
+                }
+                std::string path = CompileProfile::NormalizePath(include.first);
+                auto header_time_index = header_time_indices_by_path.find(path);
+                bool header_seen_before = (header_time_indices_by_path.cend() != header_time_index);
+                if (!header_seen_before)
+                {
+                    header_time_index = header_time_indices_by_path.emplace(path, header_times.size()).first;
+                    header_times.push_back(HeaderTime{ include.first, 0, 0 });
+                }
+                HeaderTime& header_time = header_times[header_time_index->second];
+                header_time.TotalTimeInMicroseconds += include.second;
+                ++header_time.IncludeCount;
+            }
+        }
+
+        // RANK EVERYTHING FROM SLOWEST TO FASTEST.
+        // Ties are kept in their original order so that the report doesn't change needlessly.
+        std::stable_sort(
+            translation_units.begin(),
+            translation_units.end(),
+            [](const std::pair<std::string, const CompileProfile::TranslationUnit*>& left, const std::pair<std::string, const CompileProfile::TranslationUnit*>& right)
+            {
+                return left.second->CompileTimeInMicroseconds > right.second->CompileTimeInMicroseconds;
+            });
+        std::stable_sort(
+            header_times.begin(),
+            header_times.end(),
+            [](const HeaderTime& left, const HeaderTime& right) { return left.TotalTimeInMicroseconds > right.TotalTimeInMicroseconds; });
+        std::vector<std::size_t> cpp_file_indices;
+        for (std::size_t cpp_file_index = 0; cpp_file_index < project.CppFileCompileTimes.size(); ++cpp_file_index)
+        {
+            bool compile_time_measured = (project.CppFileCompileTimes[cpp_file_index] > 0);
+            if (compile_time_measured)
+            {
+                cpp_file_indices.push_back(cpp_file_index);
+            }
+        }
+        std::stable_sort(
+            cpp_file_indices.begin(),
+            cpp_file_indices.end(),
+            [&project](const std::size_t left, const std::size_t right) { return project.CppFileCompileTimes[left] > project.CppFileCompileTimes[right]; });
+
+        // WRITE THE SLOWEST TRANSLATION UNITS.
+        file
+            << "Compile times for " << project.Name << ", generated by GenerateProject from measured compiler timings." << NEWLINE
+            << NEWLINE
+            << "Slowest translation units:" << NEWLINE;
+        for (std::size_t rank = 0; rank < translation_units.size() && rank < MAX_ENTRY_COUNT; ++rank)
+        {
+            file << FormatTime(translation_units[rank].second->CompileTimeInMicroseconds) << "  " << translation_units[rank].first << NEWLINE;
+        }
+
+        // WRITE THE SLOWEST HEADERS.
+        file
+            << NEWLINE
+            << "Slowest headers (total time across translation units, times included):" << NEWLINE;
+        for (std::size_t rank = 0; rank < header_times.size() && rank < MAX_ENTRY_COUNT; ++rank)
+        {
+            const HeaderTime& header_time = header_times[rank];
+            file << FormatTime(header_time.TotalTimeInMicroseconds) << "  " << std::to_string(header_time.IncludeCount) << "  " << header_time.Path << NEWLINE;
+        }
+
+        // WRITE THE SLOWEST SOURCE FILES.
+        // Source files compiled within unity build files get their shares of the unity build files' times.
+        file
+            << NEWLINE
+            << "Slowest source files (including their shares of unity build files):" << NEWLINE;
+        for (std::size_t rank = 0; rank < cpp_file_indices.size() && rank < MAX_ENTRY_COUNT; ++rank)
+        {
+            std::size_t cpp_file_index = cpp_file_indices[rank];
+            file << FormatTime(project.CppFileCompileTimes[cpp_file_index]) << "  " << cpp_file_paths[cpp_file_index] << NEWLINE;
+        }
+    }
+
+private:
+    /// The time spent on a header across translation units.
+    struct HeaderTime
+    {
+        /// The path of the header, as the compiler first referred to it.
+        std::string Path;
+        /// The total time spent on the header, in microseconds.
+        uint64_t TotalTimeInMicroseconds;
+        /// The number of times the header was included.
+        uint64_t IncludeCount;
+    };
+
+    /// Formats a time for the report, aligned in a column.
+    /// @param[in]  time_in_microseconds - The time to format.
+    /// @return The time in milliseconds.
+    static std::string FormatTime(const uint64_t time_in_microseconds)
+    {
+        const double MICROSECONDS_PER_MILLISECOND = 1000.0;
+        char time_text[32];
+        std::snprintf(time_text, sizeof(time_text), "%12.3f ms", static_cast<double>(time_in_microseconds) / MICROSECONDS_PER_MILLISECOND);
+        return time_text;
+    }
+};
+
+const std::size_t CompileTimeReportFile::MAX_ENTRY_COUNT;
+
+/// A summary of how much work the program did and how long each phase took, as collected by Instrumentation.
+class Statistics
+{
+public:
+    /// Counts how many folders and files were scanned for projects.
+    /// @param[in]  code_folders - The scanned code folders.
+    /// @param[in]  projects - The generated projects.
+    /// @return The number of folders and files scanned.
+    static ScanCounts Count(const std::vector<std::unique_ptr<FolderTree>>& code_folders, const std::vector<Project>& projects)
+    {
+        ScanCounts scan_counts;
+        for (const auto& code_folder : code_folders)
+        {
+            scan_counts.FolderCount += code_folder->Folders.size();
+            scan_counts.FileCount += code_folder->Files.size();
+        }
+        for (const Project& project : projects)
+        {
+            scan_counts.HeaderFileCount += project.CodeFiles.HeaderFiles.size();
+            scan_counts.CppFileCount += project.CodeFiles.CppFiles.size();
+        }
+        return scan_counts;
+    }
+
+    /// Prints the statistics.
+    /// @param[in]  scan_counts - The number of folders and files scanned.
+    /// @param[in,out]  output - The stream to print to.
+    static void Print(const ScanCounts& scan_counts, std::ostream& output)
+    {
+        // PRINT HOW MUCH WAS SCANNED.
+        output
+            << "Folders: " << scan_counts.FolderCount << '\n'
+            << "Files: " << scan_counts.FileCount
+            << " (" << scan_counts.HeaderFileCount << " headers, " << scan_counts.CppFileCount << " sources)" << '\n'
+            << "Directory listings: " << Instrumentation::DirectoryListingCount << '\n'
+            << "File system calls: " << Instrumentation::FileSystemCallCount << '\n'
+            << "Files written: " << Instrumentation::FilesWrittenCount << " (" << Instrumentation::BytesWrittenCount << " bytes)" << '\n';
+
+        // PRINT HOW LONG EACH PHASE TOOK.
+        // Phases that ran concurrently (such as writing files) overlap, so their times can add up to more than the total.
+        output << "Phases:" << '\n';
+        const double MICROSECONDS_PER_MILLISECOND = 1000.0;
+        for (const Instrumentation::Phase& phase : Instrumentation::Phases)
+        {
+            double duration_in_milliseconds = static_cast<double>(phase.DurationInMicroseconds) / MICROSECONDS_PER_MILLISECOND;
+            output << "\t" << phase.Name;
+            if (!phase.Detail.empty())
+            {
+                output << " " << phase.Detail;
+            }
+            output << ": " << duration_in_milliseconds << " ms" << '\n';
+        }
+        double total_duration_in_milliseconds = static_cast<double>(Instrumentation::GetTimeInMicroseconds()) / MICROSECONDS_PER_MILLISECOND;
+        output << "Total: " << total_duration_in_milliseconds << " ms" << std::endl;
+    }
+};
+
+/// How much the program reports about what it's doing.  Errors are always reported.
+enum class LogLevel
+{
+    /// Only errors are reported.
+    QUIET,
+    /// Progress (such as files updated while watching) is also reported.
+    NORMAL,
+    /// Everything scanned in the code folders is also printed.
+    VERBOSE
+};
+
+ProjectGenerator::ProjectGenerator(const GeneratorSettings& settings) :
+    Settings(settings),
+    ThreadCount(FolderScanner::ResolveThreadCount(settings.ThreadCount)),
+    CodeFolders(),
+    ListedCodeFolders(),
+    SolutionName(),
+    Projects(),
+    ProjectParts(),
+    Profile(new CompileProfile())
+{}
+
+ProjectGenerator::~ProjectGenerator()
+{}
+
+void ProjectGenerator::AddScannedCodeFolder(FolderTree& code_folder)
+{
+    CodeFolders.emplace_back(new FolderTree(std::move(code_folder)));
+}
+
+const GeneratorSettings& ProjectGenerator::GetSettings() const
+{
+    return Settings;
+}
+
+FolderTree* ProjectGenerator::FindScannedCodeFolder(const std::string& code_folder_path)
+{
+    const uint32_t ROOT_FOLDER_INDEX = 0;
+    for (const auto& code_folder : CodeFolders)
+    {
+        std::string root_folder_path;
+        code_folder->AppendFolderPath(ROOT_FOLDER_INDEX, root_folder_path);
+        if (code_folder_path == root_folder_path)
+        {
+            return code_folder.get();
+        }
+    }
+    return nullptr;
+}
+
+std::vector<std::string> ProjectGenerator::RemoveScannedCodeFolders(const std::string& folder_path)
+{
+    const uint32_t ROOT_FOLDER_INDEX = 0;
+    std::vector<std::string> removed_code_folder_paths;
+    std::string folder_prefix = folder_path + PATH_SEPARATOR;
+    auto code_folder = CodeFolders.begin();
+    while (CodeFolders.end() != code_folder)
+    {
+        std::string root_folder_path;
+        (*code_folder)->AppendFolderPath(ROOT_FOLDER_INDEX, root_folder_path);
+        bool code_folder_is_folder = (folder_path == root_folder_path);
+        bool code_folder_within_folder = (0 == root_folder_path.compare(0, folder_prefix.size(), folder_prefix));
+        if (code_folder_is_folder || code_folder_within_folder)
+        {
+            removed_code_folder_paths.push_back(root_folder_path);
+            code_folder = CodeFolders.erase(code_folder);
+        }
+        else
+        {
+            ++code_folder;
+        }
+    }
+    return removed_code_folder_paths;
+}
+
+std::vector<std::string> ProjectGenerator::RemoveAllScannedCodeFolders()
+{
+    const uint32_t ROOT_FOLDER_INDEX = 0;
+    std::vector<std::string> removed_code_folder_paths;
+    for (const auto& code_folder : CodeFolders)
+    {
+        removed_code_folder_paths.emplace_back();
+        code_folder->AppendFolderPath(ROOT_FOLDER_INDEX, removed_code_folder_paths.back());
+    }
+    CodeFolders.clear();
+    return removed_code_folder_paths;
+}
+
+bool ProjectGenerator::Generate(const GenerationRequest& request, GenerationResult& result)
+{
+    // GET THE PROJECTS TO GENERATE.
+    result = GenerationResult();
+    Projects.assign(request.Projects.size(), Project());
+    for (std::size_t project_index = 0; project_index < Projects.size(); ++project_index)
+    {
+        Projects[project_index].Name = request.Projects[project_index].Name;
+        Projects[project_index].CodeFolderPath = request.Projects[project_index].CodeFolderPath;
+    }
+    bool ninja_used = (BuildSystem::NINJA == Settings.ProjectBuildSystem);
+    bool unity_shards_enabled = (Settings.UnityShardCount > 0);
+    for (auto& project : Projects)
+    {
+        // Projects with their own build scripts need them to be named differently since they're all in the current folder.
+        // With Ninja, all projects share a single build file instead, and each is built by its own target.
+        project.Guid = ProjectGuid::FromName(project.Name);
+        if (ninja_used)
+        {
+            project.BuildScriptFilename = NinjaBuildFile::FILENAME;
+            project.BuildCommandLine = "ninja " + project.Name;
+            project.ProgramPath = NinjaBuildFile::GetProgramPath(project.Name, Settings.ProjectCompiler);
+        }
+        else
+        {
+            project.BuildScriptFilename = request.BuildScriptsNamedByProject ? ("build_" + project.Name + ".bat") : "build.bat";
+            project.BuildCommandLine = project.BuildScriptFilename;
+            project.ProgramPath = BuildScriptBatchFile::GetProgramPath(project.Name);
+            // Unity build shards are only worth compiling if they changed, so their build scripts use fingerprints
+            // whenever the scripts can rerun this program to update them.
+            bool generator_rerunnable = !request.GeneratorCommandLine.empty();
+            bool fingerprints_used = Settings.WriteFingerprints || (unity_shards_enabled && generator_rerunnable);
+            if (fingerprints_used)
+            {
+                project.FingerprintManifestFilename = FingerprintManifest::GetFilename(project.Name);
+            }
+        }
+
+        // Include the main CPP file for the project for the build script.
+        // There may be a better way to handle this, but that hasn't been
+        // too critical to think about at this stage of development.
+        // If source files are split into shards, the shards are generated instead.
+        project.ProjectFolderCppFilenames.clear();
+        for (std::size_t shard_index = 0; shard_index < Settings.UnityShardCount; ++shard_index)
+        {
+            project.ProjectFolderCppFilenames.push_back(UnityBuild::GetShardFilename(project.Name, shard_index));
+        }
+        if (project.ProjectFolderCppFilenames.empty())
+        {
+            project.ProjectFolderCppFilenames = { project.Name + CPP_FILE_EXTENSION };
+        }
+    }
+
+    // BUILD THE CODE FOLDERS WHOSE FILES WERE PROVIDED.
+    const uint32_t ROOT_FOLDER_INDEX = 0;
+    ListedCodeFolders.clear();
+    for (auto& project : Projects)
+    {
+        auto file_paths = request.CodeFolderFilePaths.find(project.CodeFolderPath);
+        bool file_paths_provided = (request.CodeFolderFilePaths.cend() != file_paths);
+        if (file_paths_provided)
+        {
+            ListedCodeFolders.emplace_back(new FolderTree(GitIndex::FromFilePaths(project.CodeFolderPath, file_paths->second)));
+            ListedCodeFolders.back()->BuildFolderPaths();
+            project.CodeFolderTree = ListedCodeFolders.back().get();
+            project.CodeFolderIndex = ROOT_FOLDER_INDEX;
+        }
+    }
+
+    // SCAN THE OTHER CODE FOLDERS.
+    // Projects with overlapping code folders share a single scan, and folders scanned before are only rescanned.
+    // With a memory budget, each code folder is only scanned while its project is generated.
+    std::vector<std::unique_ptr<FolderTree>> scanned_code_folders;
+    bool memory_budget_provided = (Settings.MemoryBudgetInBytes > 0);
+    if (!memory_budget_provided)
+    {
+        scanned_code_folders = ProjectCodeFolders::Scan(
+            Settings.IgnoreRuleSettings,
+            Settings.GitIndexUsage,
+            Settings.ThreadCount,
+            CodeFolders,
+            Projects);
+    }
+    if (Settings.DebugOutput)
+    {
+        for (const auto& code_folder : ListedCodeFolders)
+        {
+            code_folder->DebugPrint(*Settings.DebugOutput);
+        }
+        for (const auto& code_folder : scanned_code_folders)
+        {
+            code_folder->DebugPrint(*Settings.DebugOutput);
+        }
+    }
+
+    // GET THE CODE FILES FOR THE PROJECTS.
+    // All files for each project are categorized in a single pass, and the writers use the resulting lists without copying them.
+    std::vector<std::function<void()>> categorize_tasks;
+    for (auto& project : Projects)
+    {
+        // Projects generated while their code folders are scanned don't have scanned trees to categorize.
+        if (!project.CodeFolderTree)
+        {
+            continue;
+        }
+        categorize_tasks.push_back([&project]()
+        {
+            project.CodeFiles = CategorizedFileIndex::Build(*project.CodeFolderTree, project.CodeFolderIndex);
+        });
+    }
+    ParallelTasks::Run(ThreadCount, categorize_tasks);
+
+    // GET THE MEASURED COMPILE TIMES IF REQUESTED.
+    // They're needed before anything that weighs files by how long they take to compile.
+    bool compile_profile_used = !Settings.CompileProfilePath.empty();
+    bool compile_timings_read = true;
+    if (compile_profile_used)
+    {
+        CompileProfile::Load(Settings.CompileProfilePath, *Profile);
+        for (const std::string& timing_path : Settings.CompileTimingPaths)
+        {
+            bool timings_read = Profile->ReadTimings(Settings.ThreadCount, timing_path);
+            compile_timings_read = (compile_timings_read && timings_read);
+        }
+        bool time_traces_written = (ninja_used && Compiler::CLANG == Settings.ProjectCompiler);
+        if (time_traces_written)
+        {
+            Profile->ReadNinjaTimeTraces(Settings.ThreadCount, unity_shards_enabled, Projects);
+        }
+        for (auto& project : Projects)
+        {
+            Profile->GetCompileTimes(project);
+        }
+    }
+
+    // SPLIT THE SOURCE FILES INTO UNITY BUILD SHARDS IF REQUESTED.
+    if (unity_shards_enabled)
+    {
+        for (auto& project : Projects)
+        {
+            UnityBuild::Partition(Settings.ThreadCount, Settings.UnityShardCount, project);
+        }
+    }
+
+    // CHOOSE HEADERS TO PRECOMPILE IF REQUESTED.
+    if (Settings.PrecompileHeaders)
+    {
+        for (auto& project : Projects)
+        {
+            PrecompiledHeader::Select(Settings.ThreadCount, project);
+        }
+    }
+
+    // FINGERPRINT THE CODE FILES IF REQUESTED.
+    for (auto& project : Projects)
+    {
+        bool fingerprints_used = !project.FingerprintManifestFilename.empty();
+        if (fingerprints_used)
+        {
+            FingerprintManifest::FingerprintCodeFiles(Settings.ThreadCount, project);
+        }
+    }
+
+    // SPLIT PROJECTS WITH TOO MANY CODE FILES IF REQUESTED.
+    // The parts of a split project replace it in the solution, with their own project and filters files.
+    SolutionName = request.SolutionName;
+    SplitProjects();
+    std::vector<const Project*> solution_projects = GetSolutionProjects();
+
+    // WRITE ALL OF THE FILES CONCURRENTLY.
+    // Each file is built in memory and only written if its contents changed.
+    // All output files are created before any tasks refer to them so that they never move.
+    OutputFile solution_file(request.SolutionName + SOLUTION_FILE_EXTENSION);
+    std::vector<OutputFile> project_files;
+    std::vector<OutputFile> project_filters_files;
+    OutputFile ninja_file(NinjaBuildFile::FILENAME);
+    std::vector<OutputFile> build_script_files;
+    std::vector<OutputFile> fingerprint_manifest_files;
+    std::vector<OutputFile> unity_shard_files;
+    std::vector<OutputFile> precompiled_header_files;
+    std::vector<OutputFile> precompiled_header_source_files;
+    OutputFile compile_profile_file(Settings.CompileProfilePath);
+    std::vector<OutputFile> compile_time_report_files;
+    for (const Project* project : solution_projects)
+    {
+        project_files.emplace_back(project->Name + PROJECT_FILE_EXTENSION);
+        project_filters_files.emplace_back(project->Name + PROJECT_FILTERS_FILE_EXTENSION);
+    }
+    for (const auto& project : Projects)
+    {
+        if (!ninja_used)
+        {
+            build_script_files.emplace_back(project.BuildScriptFilename);
+        }
+        bool fingerprints_used = !project.FingerprintManifestFilename.empty();
+        if (fingerprints_used)
+        {
+            fingerprint_manifest_files.emplace_back(project.FingerprintManifestFilename);
+        }
+        bool unity_shards_used = !project.UnityShardStartIndices.empty();
+        if (unity_shards_used)
+        {
+            for (const std::string& shard_filename : project.ProjectFolderCppFilenames)
+            {
+                unity_shard_files.emplace_back(shard_filename);
+            }
+        }
+        bool headers_precompiled = !project.PrecompiledHeaderIncludes.empty();
+        if (headers_precompiled)
+        {
+            precompiled_header_files.emplace_back(PrecompiledHeader::GetHeaderFilename(project.Name));
+            precompiled_header_source_files.emplace_back(PrecompiledHeader::GetSourceFilename(project.Name));
+        }
+        if (compile_profile_used)
+        {
+            compile_time_report_files.emplace_back(CompileTimeReportFile::GetFilename(project.Name));
+        }
+    }
+    ScanCounts streamed_scan_counts;
+    std::mutex streamed_scan_counts_mutex;
+    std::vector<std::function<void()>> write_tasks =
+    {
+        [&]()
+        {
+            const bool IS_PHASE = true;
+            TraceSpan write_span("write", &solution_file.Path, IS_PHASE);
+            SolutionFile::Write(solution_projects, solution_file);
+            solution_file.WriteIfChanged();
+        }
+    };
+    if (ninja_used)
+    {
+        write_tasks.push_back([&]()
+        {
+            const bool IS_PHASE = true;
+            TraceSpan write_span("write", &ninja_file.Path, IS_PHASE);
+            NinjaBuildFile::Write(
+                Projects,
+                Settings.ProjectCompiler,
+                compile_profile_used,
+                request.GeneratorCommandLine,
+                request.GeneratorInputPaths,
+                ninja_file);
+            ninja_file.WriteIfChanged();
+        });
+    }
+    if (compile_profile_used)
+    {
+        write_tasks.push_back([&]()
+        {
+            const bool IS_PHASE = true;
+            TraceSpan write_span("write", &compile_profile_file.Path, IS_PHASE);
+            Profile->Write(compile_profile_file);
+            compile_profile_file.WriteIfChanged();
+        });
+    }
+    // A solution with a single project has its project and filters files written after the other files,
+    // so that their items can be formatted on all threads without starting threads within threads.
+    const unsigned int SINGLE_THREAD = 1;
+    bool single_project_written_alone = (1 == solution_projects.size()) && (nullptr != solution_projects.front()->CodeFolderTree);
+    std::vector<std::function<void()>> single_project_write_tasks;
+    std::size_t fingerprint_manifest_file_index = 0;
+    std::size_t unity_shard_file_index = 0;
+    std::size_t precompiled_header_file_index = 0;
+    for (std::size_t project_index = 0; project_index < solution_projects.size(); ++project_index)
+    {
+        const Project& project = *solution_projects[project_index];
+        OutputFile& project_file = project_files[project_index];
+        OutputFile& project_filters_file = project_filters_files[project_index];
+        if (!project.CodeFolderTree)
+        {
+            // The project and filters files are generated together while the code folder is scanned.
+            write_tasks.push_back([&]()
+            {
+                ScanCounts project_scan_counts = StreamedProjectFiles::Write(
+                    project,
+                    Settings.IgnoreRuleSettings,
+                    Settings.ThreadCount,
+                    Settings.MemoryBudgetInBytes,
+                    Settings.DebugOutput,
+                    project_file,
+                    project_filters_file);
+                std::lock_guard<std::mutex> lock(streamed_scan_counts_mutex);
+                streamed_scan_counts.FolderCount += project_scan_counts.FolderCount;
+                streamed_scan_counts.FileCount += project_scan_counts.FileCount;
+                streamed_scan_counts.HeaderFileCount += project_scan_counts.HeaderFileCount;
+                streamed_scan_counts.CppFileCount += project_scan_counts.CppFileCount;
+            });
+        }
+        else if (single_project_written_alone)
+        {
+            single_project_write_tasks.push_back([this, &project, &project_file]() { WriteProjectFile(ThreadCount, project, project_file); });
+            single_project_write_tasks.push_back([this, &project, &project_filters_file]() { WriteProjectFiltersFile(ThreadCount, project, project_filters_file); });
+        }
+        else
+        {
+            write_tasks.push_back([this, &project, &project_file]() { WriteProjectFile(SINGLE_THREAD, project, project_file); });
+            write_tasks.push_back([this, &project, &project_filters_file]() { WriteProjectFiltersFile(SINGLE_THREAD, project, project_filters_file); });
+        }
+    }
+    for (std::size_t project_index = 0; project_index < Projects.size(); ++project_index)
+    {
+        const Project& project = Projects[project_index];
+        if (!ninja_used)
+        {
+            OutputFile& build_script_file = build_script_files[project_index];
+            write_tasks.push_back([&project, &request, &build_script_file]()
+            {
+                const bool IS_PHASE = true;
+                TraceSpan write_span("write", &build_script_file.Path, IS_PHASE);
+                BuildScriptBatchFile::Write(project, request.GeneratorCommandLine, build_script_file);
+                build_script_file.WriteIfChanged();
+            });
+        }
+        bool fingerprints_used = !project.FingerprintManifestFilename.empty();
+        if (fingerprints_used)
+        {
+            OutputFile& fingerprint_manifest_file = fingerprint_manifest_files[fingerprint_manifest_file_index];
+            ++fingerprint_manifest_file_index;
+            write_tasks.push_back([&project, &fingerprint_manifest_file]()
+            {
+                const bool IS_PHASE = true;
+                TraceSpan write_span("write", &fingerprint_manifest_file.Path, IS_PHASE);
+                FingerprintManifest::Write(project, fingerprint_manifest_file);
+                fingerprint_manifest_file.WriteIfChanged();
+            });
+        }
+        bool unity_shards_used = !project.UnityShardStartIndices.empty();
+        std::size_t unity_shard_file_count = unity_shards_used ? project.ProjectFolderCppFilenames.size() : 0;
+        for (std::size_t shard_index = 0; shard_index < unity_shard_file_count; ++shard_index)
+        {
+            OutputFile& unity_shard_file = unity_shard_files[unity_shard_file_index];
+            ++unity_shard_file_index;
+            write_tasks.push_back([&project, shard_index, &unity_shard_file]() { WriteUnityShardFile(project, shard_index, unity_shard_file); });
+        }
+        bool headers_precompiled = !project.PrecompiledHeaderIncludes.empty();
+        if (headers_precompiled)
+        {
+            OutputFile& precompiled_header_file = precompiled_header_files[precompiled_header_file_index];
+            OutputFile& precompiled_header_source_file = precompiled_header_source_files[precompiled_header_file_index];
+            ++precompiled_header_file_index;
+            write_tasks.push_back([&project, &precompiled_header_file]()
+            {
+                const bool IS_PHASE = true;
+                TraceSpan write_span("write", &precompiled_header_file.Path, IS_PHASE);
+                PrecompiledHeaderFile::Write(project, precompiled_header_file);
+                precompiled_header_file.WriteIfChanged();
+            });
+            write_tasks.push_back([&project, &precompiled_header_source_file]()
+            {
+                const bool IS_PHASE = true;
+                TraceSpan write_span("write", &precompiled_header_source_file.Path, IS_PHASE);
+                PrecompiledHeaderSourceFile::Write(project, precompiled_header_source_file);
+                precompiled_header_source_file.WriteIfChanged();
+            });
+        }
+        if (compile_profile_used)
+        {
+            OutputFile& compile_time_report_file = compile_time_report_files[project_index];
+            write_tasks.push_back([this, &project, &compile_time_report_file]()
+            {
+                const bool IS_PHASE = true;
+                TraceSpan write_span("write", &compile_time_report_file.Path, IS_PHASE);
+                CompileTimeReportFile::Write(*Profile, project, compile_time_report_file);
+                compile_time_report_file.WriteIfChanged();
+            });
+        }
+    }
+    ParallelTasks::Run(ThreadCount, write_tasks);
+    for (const auto& single_project_write_task : single_project_write_tasks)
+    {
+        single_project_write_task();
+    }
+
+    // COUNT WHAT WAS SCANNED.
+    result.Counts = Statistics::Count(scanned_code_folders, Projects);
+    for (const auto& code_folder : ListedCodeFolders)
+    {
+        result.Counts.FolderCount += code_folder->Folders.size();
+        result.Counts.FileCount += code_folder->Files.size();
+    }
+    result.Counts.FolderCount += streamed_scan_counts.FolderCount;
+    result.Counts.FileCount += streamed_scan_counts.FileCount;
+    result.Counts.HeaderFileCount += streamed_scan_counts.HeaderFileCount;
+    result.Counts.CppFileCount += streamed_scan_counts.CppFileCount;
+
+    // KEEP THE SCANNED CODE FOLDERS FOR LATER SOLUTIONS.
+    // Earlier scans of the same folders (or of folders within them) are replaced, since the new scans cover them.
+    for (auto& code_folder : scanned_code_folders)
+    {
+        std::string root_folder_path;
+        code_folder->AppendFolderPath(ROOT_FOLDER_INDEX, root_folder_path);
+        RemoveScannedCodeFolders(root_folder_path);
+        CodeFolders.push_back(std::move(code_folder));
+    }
+
+    // REPORT WHAT WAS WRITTEN.
+    std::vector<const OutputFile*> output_files = { &solution_file };
+    for (std::size_t project_index = 0; project_index < solution_projects.size(); ++project_index)
+    {
+        output_files.push_back(&project_files[project_index]);
+        output_files.push_back(&project_filters_files[project_index]);
+    }
+    for (const OutputFile& build_script_file : build_script_files)
+    {
+        output_files.push_back(&build_script_file);
+    }
+    for (const OutputFile& fingerprint_manifest_file : fingerprint_manifest_files)
+    {
+        output_files.push_back(&fingerprint_manifest_file);
+    }
+    if (ninja_used)
+    {
+        output_files.push_back(&ninja_file);
+    }
+    for (const OutputFile& unity_shard_file : unity_shard_files)
+    {
+        output_files.push_back(&unity_shard_file);
+    }
+    for (std::size_t precompiled_header_index = 0; precompiled_header_index < precompiled_header_files.size(); ++precompiled_header_index)
+    {
+        output_files.push_back(&precompiled_header_files[precompiled_header_index]);
+        output_files.push_back(&precompiled_header_source_files[precompiled_header_index]);
+    }
+    if (compile_profile_used)
+    {
+        output_files.push_back(&compile_profile_file);
+    }
+    for (const OutputFile& compile_time_report_file : compile_time_report_files)
+    {
+        output_files.push_back(&compile_time_report_file);
+    }
+    bool all_files_written = AddGeneratedFiles(output_files, result);
+    return all_files_written && compile_timings_read;
+}
+
+bool ProjectGenerator::Update(const FolderTreeChanges& changes, GenerationResult& result)
+{
+    // DETERMINE WHICH FILES ARE AFFECTED BY THE CHANGES.
+    // The project only lists code files, but the filters also have a filter for every folder.
+    result = GenerationResult();
+    auto is_code_file = [](const std::string& path)
+    {
+        return FileCategory::OTHER != CategorizedFileIndex::Categorize(path.c_str(), path.size());
+    };
+    bool code_files_changed = (
+        std::any_of(changes.AddedFilePaths.cbegin(), changes.AddedFilePaths.cend(), is_code_file) ||
+        std::any_of(changes.RemovedFilePaths.cbegin(), changes.RemovedFilePaths.cend(), is_code_file));
+    bool folders_changed = (!changes.AddedFolderPaths.empty() || !changes.RemovedFolderPaths.empty());
+    bool project_filters_file_affected = (code_files_changed || folders_changed);
+    if (!project_filters_file_affected)
+    {
+        return true;
+    }
+
+    // SPLIT THE PROJECT AGAIN IF IT'S SPLIT.
+    // Its folders and files may have moved between parts, and the solution lists the parts.
+    Project& project = Projects.front();
+    project.CodeFiles = CategorizedFileIndex::Build(*project.CodeFolderTree, project.CodeFolderIndex);
+    bool compile_profile_used = !Settings.CompileProfilePath.empty();
+    if (compile_profile_used)
+    {
+        // Files may have been added or removed, so the measured compile times are matched to the files again.
+        Profile->GetCompileTimes(project);
+    }
+    // Partitioning may add or remove the C shard, which the parts list along with the other shards.
+    bool unity_shards_enabled = (Settings.UnityShardCount > 0);
+    if (unity_shards_enabled && code_files_changed)
+    {
+        UnityBuild::Partition(Settings.ThreadCount, Settings.UnityShardCount, project);
+    }
+    SplitProjects();
+    std::vector<const Project*> solution_projects = GetSolutionProjects();
+
+    // REGENERATE THE AFFECTED FILES.
+    OutputFile solution_file(SolutionName + SOLUTION_FILE_EXTENSION);
+    std::vector<OutputFile> project_filters_files;
+    std::vector<OutputFile> project_files;
+    for (const Project* solution_project : solution_projects)
+    {
+        project_filters_files.emplace_back(solution_project->Name + PROJECT_FILTERS_FILE_EXTENSION);
+        project_files.emplace_back(solution_project->Name + PROJECT_FILE_EXTENSION);
+    }
+    std::vector<OutputFile> unity_shard_files;
+    std::vector<const OutputFile*> updated_files;
+    std::vector<std::function<void()>> update_tasks;
+    // As when generating, an unsplit project has its project and filters files written after the other files,
+    // so that their items can be formatted on all threads without starting threads within threads.
+    const unsigned int SINGLE_THREAD = 1;
+    bool single_project_written_alone = (1 == solution_projects.size());
+    unsigned int project_file_thread_count = single_project_written_alone ? ThreadCount : SINGLE_THREAD;
+    std::vector<std::function<void()>> single_project_update_tasks;
+    std::vector<std::function<void()>>& project_update_tasks = single_project_written_alone ? single_project_update_tasks : update_tasks;
+    bool project_split = !ProjectParts.front().empty();
+    if (project_split)
+    {
+        updated_files.push_back(&solution_file);
+        update_tasks.push_back([&solution_projects, &solution_file]()
+        {
+            const bool IS_PHASE = true;
+            TraceSpan write_span("write", &solution_file.Path, IS_PHASE);
+            SolutionFile::Write(solution_projects, solution_file);
+            solution_file.WriteIfChanged();
+        });
+    }
+    for (std::size_t project_index = 0; project_index < solution_projects.size(); ++project_index)
+    {
+        const Project& solution_project = *solution_projects[project_index];
+        OutputFile& project_filters_file = project_filters_files[project_index];
+        updated_files.push_back(&project_filters_file);
+        project_update_tasks.push_back([this, project_file_thread_count, &solution_project, &project_filters_file]()
+        {
+            WriteProjectFiltersFile(project_file_thread_count, solution_project, project_filters_file);
+        });
+    }
+    if (code_files_changed)
+    {
+        for (std::size_t project_index = 0; project_index < solution_projects.size(); ++project_index)
+        {
+            const Project& solution_project = *solution_projects[project_index];
+            OutputFile& project_file = project_files[project_index];
+            updated_files.push_back(&project_file);
+            project_update_tasks.push_back([this, project_file_thread_count, &solution_project, &project_file]()
+            {
+                WriteProjectFile(project_file_thread_count, solution_project, project_file);
+            });
+        }
+
+        // Only the shards whose files were added or removed will actually change.
+        if (unity_shards_enabled)
+        {
+            for (const std::string& shard_filename : project.ProjectFolderCppFilenames)
+            {
+                unity_shard_files.emplace_back(shard_filename);
+            }
+            for (std::size_t shard_index = 0; shard_index < unity_shard_files.size(); ++shard_index)
+            {
+                OutputFile& unity_shard_file = unity_shard_files[shard_index];
+                updated_files.push_back(&unity_shard_file);
+                update_tasks.push_back([&project, shard_index, &unity_shard_file]() { WriteUnityShardFile(project, shard_index, unity_shard_file); });
+            }
+        }
+    }
+    ParallelTasks::Run(ThreadCount, update_tasks);
+    for (const auto& single_project_update_task : single_project_update_tasks)
+    {
+        single_project_update_task();
+    }
+
+    // REPORT WHAT WAS WRITTEN.
+    bool all_files_written = AddGeneratedFiles(updated_files, result);
+    return all_files_written;
+}
+
+void ProjectGenerator::SplitProjects()
+{
+    ProjectParts.assign(Projects.size(), std::vector<Project>());
+    bool projects_split = (Settings.MaxProjectItemCount > 0);
+    if (!projects_split)
+    {
+        return;
+    }
+
+    // FIND WHICH NAMES ARE ALREADY TAKEN.
+    // Previous parts are found by name in the existing solution, and parts can't be named the same as other projects.
+    std::unordered_set<std::string> previous_project_names = ProjectPartition::ReadPreviousProjectNames(SolutionName + SOLUTION_FILE_EXTENSION);
+    std::unordered_set<std::string> used_project_names;
+    for (const auto& project : Projects)
+    {
+        used_project_names.insert(project.Name);
+    }
+
+    // SPLIT EACH PROJECT.
+    for (std::size_t project_index = 0; project_index < Projects.size(); ++project_index)
+    {
+        // Projects generated while their code folders are scanned don't have scanned trees to split.
+        const Project& project = Projects[project_index];
+        if (!project.CodeFolderTree)
+        {
+            continue;
+        }
+        ProjectParts[project_index] = ProjectPartition::Split(Settings.MaxProjectItemCount, previous_project_names, used_project_names, project);
+    }
+}
+
+std::vector<const Project*> ProjectGenerator::GetSolutionProjects() const
+{
+    std::vector<const Project*> solution_projects;
+    for (std::size_t project_index = 0; project_index < Projects.size(); ++project_index)
+    {
+        const std::vector<Project>& project_parts = ProjectParts[project_index];
+        bool project_split = !project_parts.empty();
+        if (!project_split)
+        {
+            solution_projects.push_back(&Projects[project_index]);
+            continue;
+        }
+        for (const Project& project_part : project_parts)
+        {
+            solution_projects.push_back(&project_part);
+        }
+    }
+    return solution_projects;
+}
+
+void ProjectGenerator::WriteProjectFile(const unsigned int thread_count, const Project& project, OutputFile& project_file) const
+{
+    const bool IS_PHASE = true;
+    TraceSpan write_span("write", &project_file.Path, IS_PHASE);
+    ProjectFile::Write(thread_count, project, project_file);
+    if (Settings.PatchExistingFiles)
+    {
+        ProjectFilePatch::Apply(project_file);
+    }
+    project_file.WriteIfChanged();
+}
+
+void ProjectGenerator::WriteProjectFiltersFile(const unsigned int thread_count, const Project& project, OutputFile& project_filters_file) const
+{
+    const bool IS_PHASE = true;
+    TraceSpan write_span("write", &project_filters_file.Path, IS_PHASE);
+    ProjectFiltersFile::Write(thread_count, project, project_filters_file);
+    if (Settings.PatchExistingFiles)
+    {
+        ProjectFilePatch::Apply(project_filters_file);
+    }
+    project_filters_file.WriteIfChanged();
+}
+
+void ProjectGenerator::WriteUnityShardFile(const Project& project, const std::size_t shard_index, OutputFile& unity_shard_file)
+{
+    const bool IS_PHASE = true;
+    TraceSpan write_span("write", &unity_shard_file.Path, IS_PHASE);
+    UnityShardFile::Write(project, shard_index, unity_shard_file);
+    unity_shard_file.WriteIfChanged();
+}
+
+bool ProjectGenerator::AddGeneratedFiles(const std::vector<const OutputFile*>& output_files, GenerationResult& result)
+{
+    bool all_files_written = true;
+    for (const OutputFile* output_file : output_files)
+    {
+        result.Files.push_back({ output_file->Path, output_file->WriteResult });
+        bool write_failed = (OutputFileWriteResult::FAILED == output_file->WriteResult);
+        if (write_failed)
+        {
+            std::cerr << "Failed to write " << output_file->Path << std::endl;
+            all_files_written = false;
+        }
+    }
+    return all_files_written;
+}
+
+/// Generates solutions on request from a long-running process, so that a build tool can regenerate projects many
+/// times without starting the program again for each one.  Code folders stay scanned between requests (see
+/// ProjectGenerator), so each request only lists the folders that changed since the last request to use them.
+///
+/// Requests and responses are JSON-RPC 2.0 messages (see https://www.jsonrpc.org/specification), one per line.
+/// They're read from standard input with responses written to standard output, or read from connections to
+/// a Unix domain socket, which are served one at a time.  Requests are handled in the order they're received.
+/// The following methods are supported:
+/// - generate - Generates a solution, with parameters like:
+///     {"solution": "SolutionName", "projects": [{"name": "ProjectName", "codeFolder": "CodeFolderRelativePath"}]}
+///     A project may also have a "files" array of file paths relative to its code folder, which are used instead
+///     of scanning it.  With Ninja, a "regenerateCommand" for the build file to regenerate itself with is required,
+///     as it is with fingerprints for the build scripts to update them with.  Unity build scripts only use fingerprints if it's given.
+///     Projects get their own build_ProjectName.bat scripts if there's more than one.  The result lists the paths
+///     of the generated files by what happened to them: {"written": [...], "unchanged": [...], "failed": [...]}.
+/// - release - Frees the code folders kept scanned from earlier requests, so that they're scanned from scratch the next
+///     time they're used.  A "codeFolders" array of relative paths limits this to code folders at or within them:
+///     {"codeFolders": ["CodeFolderRelativePath"]}.  The result lists the paths of the freed code folders: {"released": [...]}.
+/// - shutdown - Stops the server once the response has been sent.
+class GeneratorServer
+{
+public:
+    /// Constructor.
+    /// @param[in,out]  generator - The generator to generate solutions with.
+    explicit GeneratorServer(ProjectGenerator& generator) :
+        Generator(&generator),
+        ShutdownRequested(false)
+    {}
+
+    /// Serves requests read from standard input, writing responses to standard output,
+    /// until the input ends or the server is shut down.
+    void ServeStandardStreams()
+    {
+        std::string message;
+        while (!ShutdownRequested && std::getline(std::cin, message))
+        {
+            std::string response = HandleMessage(message);
+            if (!response.empty())
+            {
+                std::cout << response << std::endl;
+            }
+        }
+    }
+
+    /// Serves requests from connections to a Unix domain socket until the server is shut down.
+    /// Any problems are reported to standard error.
+    /// @param[in]  socket_path - The path of the socket, which is created (replacing any socket left behind
+    ///     at the path) and removed once the server is shut down.
+    /// @return True if the socket was served until the server was shut down; false if an error occurred.
+    bool ServeSocket(const std::string& socket_path)
+    {
+#if defined(_WIN32)
+        std::cerr << "Serving on a socket isn't supported on Windows, so serve standard input instead: " << socket_path << std::endl;
+        return false;
+#else
+        // MAKE SURE THE PATH FITS IN A SOCKET ADDRESS.
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        bool path_fits = (!socket_path.empty() && socket_path.size() < sizeof(address.sun_path));
+        if (!path_fits)
+        {
+            std::cerr << "Invalid socket path: " << socket_path << std::endl;
+            return false;
+        }
+        std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+        // REMOVE ANY SOCKET LEFT BEHIND BY A SERVER THAT DIDN'T SHUT DOWN.
+        // Anything else at the path is left alone, so the socket simply can't be created.
+        struct stat existing_file_information;
+        bool socket_left_behind = (0 == lstat(socket_path.c_str(), &existing_file_information) && S_ISSOCK(existing_file_information.st_mode));
+        if (socket_left_behind)
+        {
+            unlink(socket_path.c_str());
+        }
+
+        // LISTEN ON THE SOCKET.
+        int listening_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+        bool socket_listening = (
+            listening_socket >= 0 &&
+            0 == bind(listening_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) &&
+            0 == listen(listening_socket, SOMAXCONN));
+        if (!socket_listening)
+        {
+            std::cerr << "Failed to listen on socket " << socket_path << ": " << std::strerror(errno) << std::endl;
+            if (listening_socket >= 0)
+            {
+                close(listening_socket);
+            }
+            return false;
+        }
+
+        // SERVE EACH CONNECTION IN TURN.
+        bool served = true;
+        while (!ShutdownRequested)
+        {
+            int connection = accept(listening_socket, nullptr, nullptr);
+            if (connection < 0)
+            {
+                if (EINTR == errno)
+                {
+                    continue;
+                }
+                std::cerr << "Failed to accept a connection on socket " << socket_path << ": " << std::strerror(errno) << std::endl;
+                served = false;
+                break;
+            }
+            ServeConnection(connection);
+            close(connection);
+        }
+        close(listening_socket);
+        unlink(socket_path.c_str());
+        return served;
+#endif
+    }
+
+private:
+#if !defined(_WIN32)
+    /// Serves requests from a connection to the socket until the connection is closed or the server is shut down.
+    /// @param[in]  connection - The connected socket.
+    void ServeConnection(const int connection)
+    {
+        // Closed connections raise a signal when written to unless this flag is available to prevent it.
+#if defined(MSG_NOSIGNAL)
+        const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+        const int SEND_FLAGS = 0;
+#endif
+        std::string received_text;
+        bool connection_open = true;
+        while (connection_open && !ShutdownRequested)
+        {
+            // READ MORE OF THE CONNECTION.
+            // Whatever is left when the connection is closed is handled as a final message.
+            const std::size_t READ_SIZE_IN_BYTES = 64 * 1024;
+            std::size_t received_size = received_text.size();
+            received_text.resize(received_size + READ_SIZE_IN_BYTES);
+            ssize_t read_size = recv(connection, &received_text[received_size], READ_SIZE_IN_BYTES, 0);
+            if (read_size < 0 && EINTR == errno)
+            {
+                received_text.resize(received_size);
+                continue;
+            }
+            connection_open = (read_size > 0);
+            received_text.resize(received_size + (connection_open ? static_cast<std::size_t>(read_size) : 0));
+            if (!connection_open && !received_text.empty())
+            {
+                received_text.push_back('\n');
+            }
+
+            // HANDLE EACH COMPLETE MESSAGE.
+            std::size_t message_start = 0;
+            for (std::size_t message_end = received_text.find('\n', received_size);
+                std::string::npos != message_end && !ShutdownRequested;
+                message_end = received_text.find('\n', message_start))
+            {
+                std::string response = HandleMessage(received_text.substr(message_start, message_end - message_start));
+                message_start = message_end + 1;
+                if (response.empty())
+                {
+                    continue;
+                }
+                response.push_back('\n');
+                for (std::size_t sent_size = 0; sent_size < response.size();)
+                {
+                    ssize_t send_size = send(connection, response.data() + sent_size, response.size() - sent_size, SEND_FLAGS);
+                    if (send_size < 0 && EINTR == errno)
+                    {
+                        continue;
+                    }
+                    if (send_size <= 0)
+                    {
+                        return;
+                    }
+                    sent_size += static_cast<std::size_t>(send_size);
+                }
+            }
+            received_text.erase(0, message_start);
+        }
+    }
+#endif
+
+    /// Handles a single message.
+    /// @param[in]  message - The message, which should be a JSON-RPC request.
+    /// @return The response to send, or an empty string if the message was a notification (which gets no response).
+    std::string HandleMessage(const std::string& message)
+    {
+        // IGNORE BLANK LINES.
+        const char* WHITESPACE = " \t\r\n";
+        bool message_blank = (std::string::npos == message.find_first_not_of(WHITESPACE));
+        if (message_blank)
+        {
+            return std::string();
+        }
+
+        // READ THE REQUEST.
+        // Error codes are the ones that JSON-RPC defines.
+        JsonValue request;
+        JsonValue request_id;
+        bool message_parsed = JsonValue::Parse(message, request);
+        if (!message_parsed)
+        {
+            const int PARSE_ERROR = -32700;
+            return FormatError(request_id, PARSE_ERROR, "Parse error");
+        }
+        // Requests can only be identified by strings, numbers, or null, so any other ID is invalid and isn't echoed back.
+        const JsonValue* id = request.GetMember("id");
+        bool id_valid = (
+            !id ||
+            JsonValue::Type::STRING == id->ValueType ||
+            JsonValue::Type::NUMBER == id->ValueType ||
+            JsonValue::Type::NULL_VALUE == id->ValueType);
+        if (id && id_valid)
+        {
+            request_id = *id;
+        }
+        const JsonValue* method = request.GetMember("method");
+        bool request_valid = (JsonValue::Type::OBJECT == request.ValueType && id_valid && method && JsonValue::Type::STRING == method->ValueType);
+        if (!request_valid)
+        {
+            const int INVALID_REQUEST = -32600;
+            return FormatError(request_id, INVALID_REQUEST, "Invalid request");
+        }
+
+        // HANDLE THE METHOD.
+        std::string result;
+        std::string error_message;
+        const int INVALID_PARAMS = -32602;
+        const JsonValue NO_PARAMS;
+        const JsonValue* params = request.GetMember("params");
+        if ("generate" == method->String)
+        {
+            bool solution_generated = Generate(params ? *params : NO_PARAMS, result, error_message);
+            if (!solution_generated)
+            {
+                return id ? FormatError(request_id, INVALID_PARAMS, error_message) : std::string();
+            }
+        }
+        else if ("release" == method->String)
+        {
+            bool code_folders_released = Release(params ? *params : NO_PARAMS, result, error_message);
+            if (!code_folders_released)
+            {
+                return id ? FormatError(request_id, INVALID_PARAMS, error_message) : std::string();
+            }
+        }
+        else if ("shutdown" == method->String)
+        {
+            ShutdownRequested = true;
+            result = "null";
+        }
+        else
+        {
+            const int METHOD_NOT_FOUND = -32601;
+            return id ? FormatError(request_id, METHOD_NOT_FOUND, "Method not found: " + method->String) : std::string();
+        }
+
+        // FORMAT THE RESPONSE.
+        if (!id)
+        {
+            return std::string();
+        }
+        std::string response = "{\"jsonrpc\":\"2.0\",\"id\":";
+        request_id.AppendTo(response);
+        response += ",\"result\":";
+        response += result;
+        response += "}";
+        return response;
+    }
+
+    /// Generates a solution for a request.
+    /// @param[in]  params - The parameters of the request.
+    /// @param[out]  result - The result of the request, as JSON.
+    /// @param[out]  error_message - Why the parameters were invalid, if they were.
+    /// @return True if the parameters were valid; false otherwise.
+    bool Generate(const JsonValue& params, std::string& result, std::string& error_message)
+    {
+        // READ THE SOLUTION.
+        GenerationRequest request;
+        const JsonValue* solution_name = params.GetMember("solution");
+        bool solution_name_valid = (solution_name && JsonValue::Type::STRING == solution_name->ValueType && !solution_name->String.empty());
+        if (!solution_name_valid)
+        {
+            error_message = "Missing solution name";
+            return false;
+        }
+        request.SolutionName = solution_name->String;
+        const JsonValue* regenerate_command = params.GetMember("regenerateCommand");
+        if (regenerate_command && JsonValue::Type::STRING == regenerate_command->ValueType)
+        {
+            request.GeneratorCommandLine = regenerate_command->String;
+        }
+        bool ninja_used = (BuildSystem::NINJA == Generator->GetSettings().ProjectBuildSystem);
+        if (ninja_used && request.GeneratorCommandLine.empty())
+        {
+            error_message = "Missing regenerate command for the Ninja build file";
+            return false;
+        }
+        bool fingerprints_used = (!ninja_used && Generator->GetSettings().WriteFingerprints);
+        if (fingerprints_used && request.GeneratorCommandLine.empty())
+        {
+            error_message = "Missing regenerate command for the build scripts to update fingerprints with";
+            return false;
+        }
+
+        // READ EACH PROJECT.
+        const JsonValue* projects = params.GetMember("projects");
+        bool projects_provided = (projects && JsonValue::Type::ARRAY == projects->ValueType && !projects->Elements.empty());
+        if (!projects_provided)
+        {
+            error_message = "Missing projects";
+            return false;
+        }
+        for (const JsonValue& project_value : projects->Elements)
+        {
+            // READ THE PROJECT NAME AND CODE FOLDER PATH.
+            const JsonValue* name = project_value.GetMember("name");
+            const JsonValue* code_folder_path = project_value.GetMember("codeFolder");
+            bool project_valid = (
+                name && JsonValue::Type::STRING == name->ValueType && !name->String.empty() &&
+                code_folder_path && JsonValue::Type::STRING == code_folder_path->ValueType && !code_folder_path->String.empty());
+            if (!project_valid)
+            {
+                error_message = "Missing project name or code folder";
+                return false;
+            }
+            RequestedProject project;
+            project.Name = name->String;
+            project.CodeFolderPath = DirectoryListing::ToProjectPath(code_folder_path->String);
+
+            // MAKE SURE THE PROJECT IS UNIQUE.
+            // Projects with the same name would overwrite each other's files.
+            bool duplicate_project = std::any_of(
+                request.Projects.cbegin(),
+                request.Projects.cend(),
+                [&project](const RequestedProject& existing_project) { return existing_project.Name == project.Name; });
+            if (duplicate_project)
+            {
+                error_message = "Duplicate project " + project.Name;
+                return false;
+            }
+
+            // READ THE FILES IN THE CODE FOLDER IF THEY'RE PROVIDED.
+            const JsonValue* file_paths = project_value.GetMember("files");
+            if (file_paths)
+            {
+                bool file_paths_valid = (JsonValue::Type::ARRAY == file_paths->ValueType);
+                std::vector<std::string>& code_folder_file_paths = request.CodeFolderFilePaths[project.CodeFolderPath];
+                code_folder_file_paths.clear();
+                for (const JsonValue& file_path : file_paths->Elements)
+                {
+                    file_paths_valid = file_paths_valid && (JsonValue::Type::STRING == file_path.ValueType);
+                    code_folder_file_paths.push_back(file_path.String);
+                }
+                if (!file_paths_valid)
+                {
+                    error_message = "Invalid files for project " + project.Name;
+                    return false;
+                }
+            }
+            request.Projects.push_back(project);
+        }
+        request.BuildScriptsNamedByProject = (request.Projects.size() > 1);
+
+        // GENERATE THE SOLUTION.
+        GenerationResult generation_result;
+        Generator->Generate(request, generation_result);
+
+        // LIST THE GENERATED FILES BY WHAT HAPPENED TO THEM.
+        std::string written_paths;
+        std::string unchanged_paths;
+        std::string failed_paths;
+        for (const GeneratedFile& generated_file : generation_result.Files)
+        {
+            std::string* paths = &written_paths;
+            if (OutputFileWriteResult::UNCHANGED == generated_file.WriteResult)
+            {
+                paths = &unchanged_paths;
+            }
+            else if (OutputFileWriteResult::FAILED == generated_file.WriteResult)
+            {
+                paths = &failed_paths;
+            }
+            *paths += paths->empty() ? "\"" : ",\"";
+            JsonValue::AppendEscaped(generated_file.Path, *paths);
+            paths->push_back('"');
+        }
+        result = "{\"written\":[" + written_paths + "],\"unchanged\":[" + unchanged_paths + "],\"failed\":[" + failed_paths + "]}";
+        return true;
+    }
+
+    /// Releases code folders kept scanned from earlier requests.
+    /// @param[in]  params - The parameters of the request.
+    /// @param[out]  result - The result of the request, as JSON.
+    /// @param[out]  error_message - Why the parameters were invalid, if they were.
+    /// @return True if the parameters were valid; false otherwise.
+    bool Release(const JsonValue& params, std::string& result, std::string& error_message)
+    {
+        // READ THE CODE FOLDERS TO RELEASE.
+        // Without any, every code folder is released.
+        const JsonValue* code_folder_paths = params.GetMember("codeFolders");
+        if (code_folder_paths)
+        {
+            bool code_folder_paths_valid = (JsonValue::Type::ARRAY == code_folder_paths->ValueType);
+            for (const JsonValue& code_folder_path : code_folder_paths->Elements)
+            {
+                code_folder_paths_valid = code_folder_paths_valid && (JsonValue::Type::STRING == code_folder_path.ValueType && !code_folder_path.String.empty());
+            }
+            if (!code_folder_paths_valid)
+            {
+                error_message = "Invalid code folders";
+                return false;
+            }
+        }
+
+        // RELEASE THE CODE FOLDERS.
+        std::vector<std::string> released_code_folder_paths;
+        if (code_folder_paths)
+        {
+            for (const JsonValue& code_folder_path : code_folder_paths->Elements)
+            {
+                std::vector<std::string> removed_code_folder_paths = Generator->RemoveScannedCodeFolders(
+                    DirectoryListing::ToProjectPath(code_folder_path.String));
+                released_code_folder_paths.insert(released_code_folder_paths.end(), removed_code_folder_paths.begin(), removed_code_folder_paths.end());
+            }
+        }
+        else
+        {
+            released_code_folder_paths = Generator->RemoveAllScannedCodeFolders();
+        }
+
+        // LIST THE RELEASED CODE FOLDERS.
+        std::string released_paths;
+        for (const std::string& released_code_folder_path : released_code_folder_paths)
+        {
+            released_paths += released_paths.empty() ? "\"" : ",\"";
+            JsonValue::AppendEscaped(released_code_folder_path, released_paths);
+            released_paths.push_back('"');
+        }
+        result = "{\"released\":[" + released_paths + "]}";
+        return true;
+    }
+
+    /// Formats an error response.
+    /// @param[in]  request_id - The ID of the request, which is null if it couldn't be read.
+    /// @param[in]  code - The error code.
+    /// @param[in]  message - The error message.
+    /// @return The response.
+    static std::string FormatError(const JsonValue& request_id, const int code, const std::string& message)
+    {
+        std::string response = "{\"jsonrpc\":\"2.0\",\"id\":";
+        request_id.AppendTo(response);
+        response += ",\"error\":{\"code\":";
+        response += std::to_string(code);
+        response += ",\"message\":\"";
+        JsonValue::AppendEscaped(message, response);
+        response += "\"}}";
+        return response;
+    }
+
+    // MEMBER VARIABLES.
+    /// The generator to generate solutions with.
+    ProjectGenerator* Generator;
+    /// True once the server has been asked to shut down.
+    bool ShutdownRequested;
+};
+
+/// The command line arguments for the program.
+class CommandLineArguments
+{
+public:
+    /// Prints the usage information for the program.
+    /// @param[in,out]  output - The stream to print to.
+    static void PrintUsage(std::ostream& output)
+    {
+        output
+            << "Usage: " << std::endl
+            << "\t GenerateProject.exe [options] <ProjectName> <CodeFolderRelativePath>" << std::endl
+            << "\t GenerateProject.exe [options] --manifest <ManifestPath> <SolutionName>" << std::endl
+            << "\t GenerateProject.exe [options] --serve <-|SocketPath>" << std::endl
+            << "Options: " << std::endl
+            << "\t --manifest <ManifestPath> - Generate all projects listed in a manifest file into a single solution." << std::endl
+            << "\t\t Each line of the manifest is <ProjectName> <CodeFolderRelativePath>." << std::endl
+            << "\t --threads <Count> - The number of threads to scan the code folder with (default: one per core)." << std::endl
+            << "\t --scan-cache <CacheFilePath> - A file to cache the scanned code folder in, so that later runs" << std::endl
+            << "\t\t only need to re-list folders that changed." << std::endl
+            << "\t --ignore-rules <RulesPath> - A file of .gitignore-style rules for files and folders to leave out," << std::endl
+            << "\t\t relative to the code folder.  They take priority over .gitignore files." << std::endl
+            << "\t --no-vcs-ignore - Don't leave out version control folders (.git, .hg, .svn) or read .gitignore files." << std::endl
+            << "\t --follow-links <never|once|always> - Which folders reached through symbolic links or junctions to include" << std::endl
+            << "\t\t (default: always).  Links leading back to a folder containing them are always left out." << std::endl
+            << "\t --git-index <tracked|changed> - Find the files in the code folder from its git repository's index instead" << std::endl
+            << "\t\t of scanning it.  changed also lists the folders with tracked files on disk for untracked files." << std::endl
+            << "\t --unity-shards <Count> - Split the project's source files into this many generated unity build files," << std::endl
+            << "\t\t balanced by size, and compile them in parallel." << std::endl
+            << "\t --max-project-items <Count> - Split projects with more code files than this into several projects in the solution," << std::endl
+            << "\t\t each with a range of the code folder's subfolders, so that Visual Studio can load them quickly." << std::endl
+            << "\t --build-system <batch|ninja> - How to build the projects (default: batch).  ninja generates a build.ninja file" << std::endl
+            << "\t\t that compiles each translation unit separately and regenerates itself when the code folder changes." << std::endl
+            << "\t --compiler <msvc|clang> - The compiler for the build.ninja file to use (default: msvc)." << std::endl
+            << "\t --memory-budget <Megabytes> - Generate the project while scanning the code folder, keeping memory use within" << std::endl
+            << "\t\t this budget however large the code folder is, by spilling generated files to temporary files." << std::endl
+            << "\t --pch - Precompile the headers that most source files include, found by scanning their #include directives." << std::endl
+            << "\t --patch - Only update the file items in existing project and filters files, keeping any other changes to them." << std::endl
+            << "\t --fingerprints - Write a manifest of hashes of the code files, which the build script updates and uses to skip" << std::endl
+            << "\t\t compiling and linking when nothing changed since a cached build." << std::endl
+            << "\t --compile-profile <ProfilePath> - A file of measured compile times to balance unity build files and order the" << std::endl
+            << "\t\t build.ninja file by, and to report the slowest translation units and headers from.  With --compiler clang," << std::endl
+            << "\t\t build.ninja writes -ftime-trace timings that are read into the profile the next time the project is generated." << std::endl
+            << "\t --compile-timings <TimingPath> - A Clang -ftime-trace .json file, a Visual C++ build log with /Bt+ and /d1reportTime" << std::endl
+            << "\t\t output, or a folder of them, to read into the compile profile.  May be used more than once." << std::endl
+            << "\t --watch - Keep running after generating the files, updating them whenever the code folder changes." << std::endl
+            << "\t --serve <-|SocketPath> - Keep running as a server that generates solutions on request, keeping code folders scanned" << std::endl
+            << "\t\t between requests.  Requests are JSON-RPC messages, one per line, from standard input (-) or a Unix socket." << std::endl
+            << "\t --trace <TracePath> - Write a trace of each phase and folder listing in the Chrome trace event format." << std::endl
+            << "\t --stats - Print how many folders and files were scanned and written, and how long each phase took." << std::endl
+            << "\t --log-level <quiet|normal|verbose> - How much to print (default: normal).  verbose prints all scanned folders and files." << std::endl;
+    }
+
+    /// Parses the command line arguments.  Any problems are reported to standard error.
+    /// @param[in]  argument_count - The number of command line arguments.
+    /// @param[in]  arguments - The command line arguments.
+    /// @param[out]  parsed_arguments - The parsed arguments.
+    /// @return True if the arguments were successfully parsed; false otherwise.
+    static bool Parse(const int argument_count, char* arguments[], CommandLineArguments& parsed_arguments)
+    {
+        // READ EACH ARGUMENT.
+        // The first argument should be the program name/path.
+        // The command line is also recorded so that the program can be rerun to regenerate the files,
+        // except for watching, which should only happen when explicitly requested.
+        std::vector<std::string> positional_arguments;
+        const int PROGRAM_PATH_ARGUMENT_INDEX = 0;
+        parsed_arguments.GeneratorCommandLine = QuoteArgument(arguments[PROGRAM_PATH_ARGUMENT_INDEX]);
+        const int FIRST_ARGUMENT_INDEX = 1;
+        for (int argument_index = FIRST_ARGUMENT_INDEX; argument_index < argument_count; ++argument_index)
+        {
+            bool is_watch_option = ("--watch" == std::string(arguments[argument_index]));
+            if (!is_watch_option)
+            {
+                parsed_arguments.GeneratorCommandLine += " " + QuoteArgument(arguments[argument_index]);
+            }
+        }
+        for (int argument_index = FIRST_ARGUMENT_INDEX; argument_index < argument_count; ++argument_index)
+        {
+            // HANDLE ARGUMENTS THAT AREN'T OPTIONS.
+            std::string argument = arguments[argument_index];
+            const std::string OPTION_PREFIX = "--";
+            bool is_option = (0 == argument.compare(0, OPTION_PREFIX.size(), OPTION_PREFIX));
+            if (!is_option)
+            {
+                positional_arguments.push_back(argument);
+                continue;
+            }
+
+            // READ OPTIONS WITHOUT VALUES.
+            if ("--watch" == argument)
+            {
+                parsed_arguments.Watch = true;
+                continue;
+            }
+            if ("--stats" == argument)
+            {
+                parsed_arguments.Stats = true;
+                continue;
+            }
+            if ("--pch" == argument)
+            {
+                parsed_arguments.PrecompileHeaders = true;
+                continue;
+            }
+            if ("--patch" == argument)
+            {
+                parsed_arguments.PatchExistingFiles = true;
+                continue;
+            }
+            if ("--fingerprints" == argument)
+            {
+                parsed_arguments.WriteFingerprints = true;
+                continue;
+            }
+            if ("--no-vcs-ignore" == argument)
+            {
+                parsed_arguments.VersionControlIgnored = false;
+                continue;
+            }
+
+            // MAKE SURE THE OPTION HAS A VALUE.
+            // All other options require a value.
+            int value_index = argument_index + 1;
+            bool value_provided = (value_index < argument_count);
+            if (!value_provided)
+            {
+                std::cerr << "Missing value for option " << argument << std::endl;
+                return false;
+            }
+            std::string value = arguments[value_index];
+            argument_index = value_index;
+
+            // READ THE OPTION.
+            if ("--threads" == argument)
+            {
+                char* value_end = nullptr;
+                const int DECIMAL_BASE = 10;
+                unsigned long thread_count = std::strtoul(value.c_str(), &value_end, DECIMAL_BASE);
+                bool thread_count_valid = (!value.empty() && '\0' == *value_end);
+                if (!thread_count_valid)
+                {
+                    std::cerr << "Invalid thread count: " << value << std::endl;
+                    return false;
+                }
+                parsed_arguments.ThreadCount = static_cast<unsigned int>(thread_count);
+            }
+            else if ("--unity-shards" == argument)
+            {
+                char* value_end = nullptr;
+                const int DECIMAL_BASE = 10;
+                unsigned long unity_shard_count = std::strtoul(value.c_str(), &value_end, DECIMAL_BASE);
+                bool unity_shard_count_valid = (!value.empty() && '\0' == *value_end && unity_shard_count > 0);
+                if (!unity_shard_count_valid)
+                {
+                    std::cerr << "Invalid unity shard count: " << value << std::endl;
+                    return false;
+                }
+                parsed_arguments.UnityShardCount = static_cast<std::size_t>(unity_shard_count);
+            }
+            else if ("--max-project-items" == argument)
+            {
+                char* value_end = nullptr;
+                const int DECIMAL_BASE = 10;
+                unsigned long max_project_item_count = std::strtoul(value.c_str(), &value_end, DECIMAL_BASE);
+                bool max_project_item_count_valid = (!value.empty() && '\0' == *value_end && max_project_item_count > 0);
+                if (!max_project_item_count_valid)
+                {
+                    std::cerr << "Invalid maximum project item count: " << value << std::endl;
+                    return false;
+                }
+                parsed_arguments.MaxProjectItemCount = static_cast<std::size_t>(max_project_item_count);
+            }
+            else if ("--memory-budget" == argument)
+            {
+                char* value_end = nullptr;
+                const int DECIMAL_BASE = 10;
+                unsigned long memory_budget_in_megabytes = std::strtoul(value.c_str(), &value_end, DECIMAL_BASE);
+                const std::size_t MAX_MEMORY_BUDGET_IN_MEGABYTES = std::numeric_limits<std::size_t>::max() / BYTES_PER_MEGABYTE;
+                bool memory_budget_valid = (
+                    !value.empty() &&
+                    '\0' == *value_end &&
+                    memory_budget_in_megabytes > 0 &&
+                    memory_budget_in_megabytes <= MAX_MEMORY_BUDGET_IN_MEGABYTES);
+                if (!memory_budget_valid)
+                {
+                    std::cerr << "Invalid memory budget: " << value << std::endl;
+                    return false;
+                }
+                parsed_arguments.MemoryBudgetInBytes = static_cast<std::size_t>(memory_budget_in_megabytes) * BYTES_PER_MEGABYTE;
+            }
+            else if ("--scan-cache" == argument)
+            {
+                parsed_arguments.ScanCachePath = value;
+            }
+            else if ("--manifest" == argument)
+            {
+                parsed_arguments.ManifestPath = value;
+            }
+            else if ("--compile-profile" == argument)
+            {
+                parsed_arguments.CompileProfilePath = value;
+            }
+            else if ("--compile-timings" == argument)
+            {
+                parsed_arguments.CompileTimingPaths.push_back(value);
+            }
+            else if ("--ignore-rules" == argument)
+            {
+                parsed_arguments.IgnoreRulesPath = value;
+            }
+            else if ("--follow-links" == argument)
+            {
+                if ("never" == value)
+                {
+                    parsed_arguments.LinkedFolders = LinkPolicy::NEVER;
+                }
+                else if ("once" == value)
+                {
+                    parsed_arguments.LinkedFolders = LinkPolicy::ONCE;
+                }
+                else if ("always" == value)
+                {
+                    parsed_arguments.LinkedFolders = LinkPolicy::ALWAYS;
+                }
+                else
+                {
+                    std::cerr << "Invalid link policy: " << value << std::endl;
+                    return false;
+                }
+            }
+            else if ("--git-index" == argument)
+            {
+                if ("tracked" == value)
+                {
+                    parsed_arguments.GitIndexUsage = GitIndexUse::TRACKED_FILES;
+                }
+                else if ("changed" == value)
+                {
+                    parsed_arguments.GitIndexUsage = GitIndexUse::TRACKED_AND_UNTRACKED_FILES;
+                }
+                else
+                {
+                    std::cerr << "Invalid git index use: " << value << std::endl;
+                    return false;
+                }
+            }
+            else if ("--build-system" == argument)
+            {
+                if ("batch" == value)
+                {
+                    parsed_arguments.ProjectBuildSystem = BuildSystem::BATCH;
+                }
+                else if ("ninja" == value)
+                {
+                    parsed_arguments.ProjectBuildSystem = BuildSystem::NINJA;
+                }
+                else
+                {
+                    std::cerr << "Invalid build system: " << value << std::endl;
+                    return false;
+                }
+            }
+            else if ("--compiler" == argument)
+            {
+                if ("msvc" == value)
+                {
+                    parsed_arguments.ProjectCompiler = Compiler::MSVC;
+                }
+                else if ("clang" == value)
+                {
+                    parsed_arguments.ProjectCompiler = Compiler::CLANG;
+                }
+                else
+                {
+                    std::cerr << "Invalid compiler: " << value << std::endl;
+                    return false;
+                }
+            }
+            else if ("--serve" == argument)
+            {
+                parsed_arguments.ServePath = value;
+            }
+            else if ("--trace" == argument)
+            {
+                parsed_arguments.TracePath = value;
+            }
+            else if ("--log-level" == argument)
+            {
+                if ("quiet" == value)
+                {
+                    parsed_arguments.LoggingLevel = LogLevel::QUIET;
+                }
+                else if ("normal" == value)
+                {
+                    parsed_arguments.LoggingLevel = LogLevel::NORMAL;
+                }
+                else if ("verbose" == value)
+                {
+                    parsed_arguments.LoggingLevel = LogLevel::VERBOSE;
+                }
+                else
+                {
+                    std::cerr << "Invalid log level: " << value << std::endl;
+                    return false;
+                }
+            }
+            else
+            {
+                std::cerr << "Unknown option: " << argument << std::endl;
+                return false;
+            }
+        }
+
+        // MAKE SURE A MEMORY BUDGET IS ONLY USED WITH OPTIONS THAT DON'T NEED THE WHOLE CODE FOLDER IN MEMORY.
+        // With a memory budget, files are generated while the code folder is scanned (see StreamedProjectFiles).
+        bool memory_budget_provided = (parsed_arguments.MemoryBudgetInBytes > 0);
+        bool whole_code_folder_options_provided = (
+            !parsed_arguments.ManifestPath.empty() ||
+            !parsed_arguments.ScanCachePath.empty() ||
+            parsed_arguments.Watch ||
+            parsed_arguments.UnityShardCount > 0 ||
+            parsed_arguments.MaxProjectItemCount > 0 ||
+            parsed_arguments.PrecompileHeaders ||
+            parsed_arguments.PatchExistingFiles ||
+            parsed_arguments.WriteFingerprints ||
+            !parsed_arguments.CompileProfilePath.empty() ||
+            BuildSystem::NINJA == parsed_arguments.ProjectBuildSystem);
+        if (memory_budget_provided && whole_code_folder_options_provided)
+        {
+            std::cerr << "--manifest, --scan-cache, --watch, --unity-shards, --max-project-items, --pch, --patch, --fingerprints, --compile-profile, and --build-system ninja can't be used with --memory-budget" << std::endl;
+            return false;
+        }
+
+        // MAKE SURE COMPILE TIMINGS HAVE A PROFILE TO BE READ INTO.
+        bool compile_timings_provided = !parsed_arguments.CompileTimingPaths.empty();
+        if (compile_timings_provided && parsed_arguments.CompileProfilePath.empty())
+        {
+            std::cerr << "--compile-timings can't be used without --compile-profile" << std::endl;
+            return false;
+        }
+
+        // MAKE SURE FINGERPRINTS ARE ONLY WRITTEN FOR BUILD SCRIPTS.
+        // Ninja already tracks what needs to be rebuilt itself.
+        bool ninja_used = (BuildSystem::NINJA == parsed_arguments.ProjectBuildSystem);
+        if (parsed_arguments.WriteFingerprints && ninja_used)
+        {
+            std::cerr << "--fingerprints can't be used with --build-system ninja" << std::endl;
+            return false;
+        }
+        bool folders_included_once = (LinkPolicy::ONCE == parsed_arguments.LinkedFolders);
+        if (memory_budget_provided && folders_included_once)
+        {
+            std::cerr << "--follow-links once can't be used with --memory-budget" << std::endl;
+            return false;
+        }
+
+        // MAKE SURE THE GIT INDEX IS ONLY USED WITH OPTIONS THAT DON'T SCAN FOLDERS THEMSELVES.
+        bool git_index_used = (GitIndexUse::NONE != parsed_arguments.GitIndexUsage);
+        bool folder_scanning_options_provided = (
+            !parsed_arguments.ScanCachePath.empty() ||
+            parsed_arguments.Watch ||
+            memory_budget_provided);
+        if (git_index_used && folder_scanning_options_provided)
+        {
+            std::cerr << "--scan-cache, --watch, and --memory-budget can't be used with --git-index" << std::endl;
+            return false;
+        }
+
+        // MAKE SURE THE SERVER IS ONLY RUN WITH OPTIONS THAT APPLY TO EVERY REQUEST.
+        // Projects are provided with each request instead, and a trace would keep growing for as long as the server runs.
+        bool serving = !parsed_arguments.ServePath.empty();
+        if (serving)
+        {
+            bool single_run_options_provided = (
+                !parsed_arguments.ManifestPath.empty() ||
+                !parsed_arguments.ScanCachePath.empty() ||
+                parsed_arguments.Watch ||
+                memory_budget_provided ||
+                !parsed_arguments.TracePath.empty() ||
+                parsed_arguments.Stats);
+            if (single_run_options_provided)
+            {
+                std::cerr << "--manifest, --scan-cache, --watch, --memory-budget, --trace, and --stats can't be used with --serve" << std::endl;
+                return false;
+            }
+            bool projects_provided = !positional_arguments.empty();
+            if (projects_provided)
+            {
+                std::cerr << "Projects are provided with each request to the server, not on the command line" << std::endl;
+                return false;
+            }
+            return true;
+        }
+
+        // READ THE SOLUTION NAME IF PROJECTS ARE LISTED IN A MANIFEST.
+        bool manifest_provided = !parsed_arguments.ManifestPath.empty();
+        if (manifest_provided)
+        {
+            // The scan cache and watching only support a single code folder.
+            bool single_project_options_provided = (!parsed_arguments.ScanCachePath.empty() || parsed_arguments.Watch);
+            if (single_project_options_provided)
+            {
+                std::cerr << "--scan-cache and --watch can't be used with --manifest" << std::endl;
+                return false;
+            }
+
+            const std::size_t EXPECTED_MANIFEST_POSITIONAL_ARGUMENT_COUNT = 1;
+            bool expected_manifest_arguments_provided = (EXPECTED_MANIFEST_POSITIONAL_ARGUMENT_COUNT == positional_arguments.size());
+            if (!expected_manifest_arguments_provided)
+            {
+                std::cerr << "Missing command line arguments!" << std::endl;
+                return false;
+            }
+
+            const std::size_t SOLUTION_NAME_ARGUMENT_INDEX = 0;
+            parsed_arguments.SolutionName = positional_arguments[SOLUTION_NAME_ARGUMENT_INDEX];
+            return true;
+        }
+
+        // READ THE REQUIRED ARGUMENTS.
+        const std::size_t EXPECTED_POSITIONAL_ARGUMENT_COUNT = 2;
+        bool expected_arguments_provided = (EXPECTED_POSITIONAL_ARGUMENT_COUNT == positional_arguments.size());
+        if (!expected_arguments_provided)
+        {
+            std::cerr << "Missing command line arguments!" << std::endl;
+            return false;
+        }
+
+        const std::size_t PROJECT_NAME_ARGUMENT_INDEX = 0;
+        parsed_arguments.ProjectName = positional_arguments[PROJECT_NAME_ARGUMENT_INDEX];
+        parsed_arguments.SolutionName = parsed_arguments.ProjectName;
+
+        // Paths within the generated files always use the Visual Studio path separator,
+        // regardless of how the code folder path was provided.
+        const std::size_t CODE_FOLDER_PATH_ARGUMENT_INDEX = 1;
+        parsed_arguments.CodeFolderPath = DirectoryListing::ToProjectPath(positional_arguments[CODE_FOLDER_PATH_ARGUMENT_INDEX]);
+
+        return true;
+    }
+
+    // MEMBER VARIABLES.
+    /// The command line to rerun the program with to regenerate the same files, without watching.
+    std::string GeneratorCommandLine = "";
+    /// The name of the project to generate.  Empty if projects are listed in a manifest.
+    std::string ProjectName = "";
+    /// The relative path to the folder containing all code for the project.  Empty if projects are listed in a manifest.
+    std::string CodeFolderPath = "";
+    /// The path of the manifest listing the projects to generate.  Empty if a single project is generated.
+    std::string ManifestPath = "";
+    /// The name of the solution to generate.  The same as the project name if a single project is generated.
+    std::string SolutionName = "";
+    /// The number of threads to use for scanning.  Zero uses one thread per hardware core.
+    unsigned int ThreadCount = 0;
+    /// The path of the file to cache the scanned code folder in.  Empty if no cache should be used.
+    std::string ScanCachePath = "";
+    /// The path of a file of rules for which files and folders to leave out of the code folder.  Empty if there isn't one.
+    std::string IgnoreRulesPath = "";
+    /// True if version control folders should be left out and .gitignore files should be read.
+    bool VersionControlIgnored = true;
+    /// Which folders reached through links should be included.
+    LinkPolicy LinkedFolders = LinkPolicy::ALWAYS;
+    /// How the git index should be used to find the files in the code folders instead of scanning them.
+    GitIndexUse GitIndexUsage = GitIndexUse::NONE;
+    /// The number of unity build files to split each project's source files into.  Zero if the project's
+    /// source files are built with a single hand-written unity build file instead.
+    std::size_t UnityShardCount = 0;
+    /// The most code files to put in a single project file before splitting the project.  Zero if projects should never be split.
+    std::size_t MaxProjectItemCount = 0;
+    /// True if widely included headers should be precompiled.
+    bool PrecompileHeaders = false;
+    /// True if existing project and filters files should only have their items updated instead of being replaced.
+    bool PatchExistingFiles = false;
+    /// True if a manifest of fingerprints of each project's code files should be written for its build script.
+    bool WriteFingerprints = false;
+    /// The path of the profile of measured compile times to read and update.  Empty if compile times shouldn't be measured.
+    std::string CompileProfilePath = "";
+    /// The paths of timing files, or folders of them, to read into the compile profile.
+    std::vector<std::string> CompileTimingPaths = {};
+    /// The maximum memory to use for generating the project while its code folder is scanned.  Zero if the
+    /// whole code folder should be scanned into memory first instead.
+    std::size_t MemoryBudgetInBytes = 0;
+    /// How the generated projects should be built.
+    BuildSystem ProjectBuildSystem = BuildSystem::BATCH;
+    /// The compiler that the Ninja build file should use.
+    Compiler ProjectCompiler = Compiler::MSVC;
+    /// True if the program should keep running and update the generated files whenever the code folder changes.
+    bool Watch = false;
+    /// Where to read requests from if the program should keep running as a server (see GeneratorServer):
+    /// "-" for standard input, or the path of a Unix domain socket.  Empty if the program isn't a server.
+    std::string ServePath = "";
+    /// The path of the file to write a trace to.  Empty if no trace should be written.
+    std::string TracePath = "";
+    /// True if statistics should be printed once the files are generated.
+    bool Stats = false;
+    /// How much the program should report about what it's doing.
+    LogLevel LoggingLevel = LogLevel::NORMAL;
+
+private:
+    /// The number of bytes in a megabyte, which memory budgets are provided in.
+    static const std::size_t BYTES_PER_MEGABYTE = 1024 * 1024;
+
+    /// Quotes a command line argument if it contains spaces, so that it can be passed on a command line again.
+    /// @param[in]  argument - The argument to quote.
+    /// @return The quoted argument.
+    static std::string QuoteArgument(const std::string& argument)
+    {
+        bool needs_quotes = (std::string::npos != argument.find(' '));
+        std::string quoted_argument = needs_quotes ? ("\"" + argument + "\"") : argument;
+        return quoted_argument;
+    }
+};
+
+const std::size_t CommandLineArguments::BYTES_PER_MEGABYTE;
+
+// The benchmark (see Benchmark.cpp) includes this file to measure each part of the program directly,
+// so it provides its own entry point instead.
+#if !defined(GENERATE_PROJECT_NO_MAIN)
+
+/// The entry point for the Visual Studio project file generator.  The goal of this program is to make it
+/// easy to generate Visual Studio project files, given a folder of code files, that allows building
+/// a project using a simple build.bat script for a "unity" or "single translation unit" build.
+///
+/// Assuming this was compiled using the accompanying build script, the program should be run as follows:
+///     GenerateProject.exe [options] <ProjectName> <CodeFolderRelativePath>
+///
+/// Alternatively, several projects can be generated at once into a single solution:
+///     GenerateProject.exe [options] --manifest <ManifestPath> <SolutionName>
+///
+/// Or the program can keep running as a server that generates solutions on request:
+///     GenerateProject.exe [options] --serve <-|SocketPath>
+///
+/// The following options are supported:
+/// - --manifest <ManifestPath> - A file listing projects to generate, one per line as <ProjectName> <CodeFolderRelativePath>.
+///     All projects are generated in parallel into a SolutionName.sln file, each with its own project, filters, and
+///     build_ProjectName.bat files.  Projects whose code folders overlap share a single scan of the outermost folder.
+/// - --threads <Count> - The number of threads to scan the code folder with.  By default, one thread
+///     is used per hardware core.  The items of large project and filters files are also formatted on them.
+/// - --scan-cache <CacheFilePath> - A file to cache the scanned code folder in.  On later runs, only folders
+///     whose modification times changed are listed again, and everything else is loaded from the cache.
+/// - --ignore-rules <RulesPath> - A file of rules for files and folders to leave out of the code folder, in the same
+///     format as .gitignore files and relative to the code folder.  These rules take priority over .gitignore files.
+///     By default, version control folders (.git, .hg, and .svn) are left out, and .gitignore files are read from the
+///     code folder, every folder within it, and the folders containing it up to the root of its git repository (along
+///     with the repository's .git/info/exclude file), just like git does.  Ignored folders are never listed at all.
+///     If any rules change, every folder is listed again on the next scan (such as with --scan-cache or --watch).
+/// - --no-vcs-ignore - Don't leave out version control folders or read .gitignore files.
+/// - --follow-links <never|once|always> - Which folders reached through symbolic links (or junctions) to include.
+///     always (the default) includes them everywhere they're reached, but each folder is only listed once, and every
+///     other place it's reached gets a copy of its entries.  once only includes each folder once, leaving out links to
+///     folders that are also reached without links (or through a link whose path comes first).  never leaves out all
+///     of them.  Links leading back to a folder containing them are always left out, so they can't be followed forever.
+///     once can't be used with --memory-budget.
+/// - --git-index <tracked|changed> - Find the files in the code folders from the index of the git repository containing them
+///     (.git/index) instead of listing every folder, which is much faster for large repositories.  tracked only includes
+///     the files tracked by git, without listing any folders at all.  changed also includes untracked files, by listing
+///     each folder with tracked files on disk and scanning any untracked folders within them, which takes about as long
+///     as scanning.  The same ignore rules apply either way.  With tracked, folders without any tracked files are left
+///     out, and tracked files that have been deleted are still included until the deletion is staged.  If the index can't
+///     be read (such as for a code folder outside of a git repository), the code folder is scanned instead.  This can't be
+///     used with --scan-cache, --watch, or --memory-budget.
+/// - --unity-shards <Count> - Split the project's source files into this many unity build files
+///     (ProjectName_Unity1.cpp, ProjectName_Unity2.cpp, and so on), which are generated instead of using a
+///     hand-written ProjectName.cpp file and are compiled in parallel by the build script.  Each file includes a
+///     contiguous range of source files, balanced by size.  Files are only moved between unity build files when
+///     they've become too unbalanced, so adding or removing a source file usually only changes one of them.
+/// - --max-project-items <Count> - Split each project with more header and source files than this into several projects
+///     in the solution, since Visual Studio is slow to load (and index) projects with tens of thousands of files.
+///     Each part gets a contiguous range of the code folder's subfolders, cut only between folders, filled up to
+///     this many files.  The first part keeps the project's name, and each other part is named after its first folder
+///     (such as ProjectName_Subfolder_Nested).  Only the first part is built with the solution, but each part's build
+///     command builds the whole program.  Parts are found again from the existing solution file and kept, with only
+///     parts that grew too large split further, so adding or removing a file never moves other files between parts.
+/// - --memory-budget <Megabytes> - Generate the project and filters files while scanning the code folder instead of
+///     scanning it all into memory first, keeping the memory used for folder listings and generated contents within
+///     this budget no matter how large the code folder is.  Generated contents that don't fit in the budget are spilled
+///     to temporary files next to the generated files, which are stitched together at the end.  The generated files
+///     are the same either way.  This can't be used with --manifest, --scan-cache, --watch, --unity-shards,
+///     --max-project-items, --pch, --patch, --fingerprints, --compile-profile, or --build-system ninja, which all
+///     need the whole code folder in memory.
+/// - --patch - Update existing project and filters files in place instead of replacing them, so that any changes made
+///     to them by hand (such as compiler settings or properties of individual files) are kept.  Only the item groups of
+///     source files, header files, and folder filters are compared with the generated items, and only the groups whose
+///     items were added or removed are rewritten.  Items that were already present keep their existing text, and
+///     everything else in the files is kept byte for byte, including settings that would otherwise be generated (such
+///     as the build command).  Files that can't be read as XML, or whose item groups mix these types of items, are replaced.
+/// - --pch - Precompile the headers that at least half of the project's source files include, directly or indirectly.
+///     Every header and source file is scanned for #include directives to find out which headers are widely used,
+///     including headers outside the project included with angle brackets (such as standard library headers).
+///     A ProjectName_Pch.h header including them and a ProjectName_Pch.cpp file to create the precompiled header from
+///     are generated, and the build script precompiles the header and uses it for all other files.  Headers that were
+///     previously precompiled stay precompiled as long as a quarter of the source files include them, so that the
+///     precompiled header (which everything depends on) rarely changes.  Headers aren't chosen again while watching.
+///     With --unity-shards, headers are counted by how many of the unity build files include them instead,
+///     since those are the only files compiled against the precompiled header.
+/// - --fingerprints - Hash the contents of every header and source file in parallel and write a ProjectName.fingerprints
+///     manifest of the hashes, along with a fingerprint of each translation unit (ProjectName.cpp or each unity build file)
+///     combining the hashes of everything it depends on, and of the program combining those.  The build script first
+///     reruns this program to update the manifest, then only compiles translation units without an object file cached
+///     under the same fingerprint in build/cache, and only links the program if it isn't cached either.  Since which
+///     headers each file includes isn't tracked, changing any header in the project recompiles everything.  Headers outside
+///     the project (such as standard library headers) aren't fingerprinted.  This can't be used with --build-system ninja.
+/// - --compile-profile <ProfilePath> - Keep a profile of how long each translation unit took to compile, and how long
+///     each header it included took, in ProfilePath, and use it to weigh source files by their measured compile times
+///     instead of their sizes: unity build files are balanced by measured time, and build.ninja lists the slowest
+///     translation units first so that Ninja starts them first.  A unity build file's time is split among the source files
+///     it includes in proportion to the time spent on each.  A ProjectName_CompileTimes.txt report ranks the slowest
+///     translation units, the headers that took the longest across all of them (including headers outside the project),
+///     and the slowest source files.  With --build-system ninja and --compiler clang, build.ninja compiles with -ftime-trace,
+///     and the traces written next to the object files since the profile was last updated are read into it whenever the
+///     project is generated again.  This can't be used with --memory-budget.
+/// - --compile-timings <TimingPath> - Read compile times into the --compile-profile from a Clang -ftime-trace .json file,
+///     a Visual C++ build log with the output of /Bt+ and /d1reportTime, or a folder of them (only .json, .log, and .txt files
+///     are read).  Measured files are matched to the project's files by their trailing path components, without regard to
+///     case.  A .json trace is matched by its path without the extension, so it must be named after the whole source filename
+///     (such as code/File.cpp.json, as with CMake's object file names).  Translation units measured again replace their
+///     earlier measurements.  This may be used more than once.
+/// - --build-system <batch|ninja> - What to build the projects with.  batch (the default) generates a build script
+///     for each project.  ninja generates a single build.ninja file for all projects instead, which compiles each
+///     source file (or unity build file) separately and in parallel, only recompiles files whose source or included
+///     headers changed, and regenerates itself by running this program again whenever the code folders change.
+///     Each project is built by running "ninja ProjectName", into build/bin.
+/// - --compiler <msvc|clang> - The compiler that build.ninja uses.  msvc (the default) uses cl.exe and link.exe,
+///     and clang uses clang++.
+/// - --watch - Keep running after generating the files, and update them whenever files or folders are added to,
+///     removed from, or renamed within the code folder.  Only the folders that changed are listed again,
+///     and only the project and filters files are regenerated (and only when their contents would change).
+/// - --serve <-|SocketPath> - Keep running as a server that generates solutions on request instead of generating
+///     a single solution, so that build tools can regenerate projects many times without starting this program again.
+///     Code folders stay scanned between requests, and only the folders that changed since the last request using them
+///     are listed again.  Requests are JSON-RPC 2.0 messages, one per line, read from standard input (-) with responses
+///     written to standard output, or read from connections to a Unix domain socket at SocketPath (not on Windows).
+///     See GeneratorServer for the methods supported.  Projects can also list the files in their code folders instead
+///     of having them scanned.  This can't be used with --manifest, --scan-cache, --watch, --memory-budget, --trace, or --stats.
+/// - --trace <TracePath> - Write a trace of the program in the Chrome trace event format (viewable in chrome://tracing),
+///     with a span for scanning, listing each folder, categorizing files, and writing each file.
+/// - --stats - Print the number of folders and files scanned, directory listings, file system calls, and files and bytes
+///     written, along with the time spent in each phase.
+/// - --log-level <quiet|normal|verbose> - How much to print.  quiet only prints errors, normal (the default) also prints
+///     progress while watching, and verbose also prints every folder and file scanned.
+///
+/// This program will then generate the following files in the current folder:
+/// - ProjectName.sln - A Visual Studio solution file containing the generated project file.
+/// - ProjectName.vcxproj - A Visual Studio project file containing all header (.h, .hpp, .hxx, .inl) and
+///     source (.cpp, .cc, .cxx, .c) files in the code folder,
+///     along with the build.bat script generated in the current folder that is used to build the project.
+/// - ProjectName.vcxproj.filters - A Visual Studio project filters file containing the files in the project file,
+///     along with the build.bat script.  Filters are added according to the folder hierarchy in the code folder.
+/// - ProjectName_Subfolder.vcxproj and ProjectName_Subfolder.vcxproj.filters, etc. - The project and filters files
+///     for the other parts of the project, if --max-project-items is used and the project has too many files.
+/// - build.bat - A basic build.bat script for building the project by building a "ProjectName.cpp" file
+///     (or the generated unity build files, if --unity-shards is used).  If --pch is used, it also builds the precompiled header.
+///     The code folder will be added as an additional include directory.  This is one of the most incomplete parts
+///     of this program so far.  It doesn't support a wide variety of options, so you'll likely need to
+///     make modifications (or not use it altogether).  See the generated file (or this source code) for details.
+///     IMPORTANT: THIS WILL OVERWRITE ANY BUILD.BAT FILE IN THE CURRENT DIRECTORY, SO MAKE SURE YOU DON'T
+///     USE THIS PROGRAM IF YOU HAVE A CUSTOM BUILD.BAT FILE!
+/// - build.ninja - A Ninja build file for all projects, generated instead of the build scripts if --build-system ninja is used.
+/// - ProjectName.fingerprints - The fingerprints of the project's code files and translation units, if --fingerprints is used.
+/// - ProjectName_CompileTimes.txt - The slowest translation units, headers, and source files, if --compile-profile is used.
+///
+/// Note that this program is still in its very early stages, and there is very little need for it
+/// to be super robust or feature rich.  The goal was to just get a program working to get the bulk
+/// of some mundane work taken care of.  Updates will be made as desired and as time permits.
+///
+/// @param[in]  argument_count - The number of command line arguments.
+/// @param[in]  arguments - The command line arguments.
+/// @return 0 if the program completed successfully; another value if an error occurred.
+int main(int argument_count, char* arguments[])
+{
+    // READ THE COMMAND LINE ARGUMENTS.
+    CommandLineArguments command_line_arguments;
+    bool arguments_parsed = CommandLineArguments::Parse(argument_count, arguments, command_line_arguments);
+    if (!arguments_parsed)
+    {
+        CommandLineArguments::PrintUsage(std::cerr);
+        return EXIT_FAILURE;
+    }
+    bool trace_enabled = !command_line_arguments.TracePath.empty();
+    if (trace_enabled)
+    {
+        Instrumentation::EnableTracing();
+    }
+
+    // READ THE RULES FOR WHAT TO LEAVE OUT OF THE CODE FOLDERS.
+    IgnoreSettings ignore_settings;
+    ignore_settings.VersionControlIgnored = command_line_arguments.VersionControlIgnored;
+    ignore_settings.LinkedFolders = command_line_arguments.LinkedFolders;
+    bool ignore_rules_provided = !command_line_arguments.IgnoreRulesPath.empty();
+    if (ignore_rules_provided)
+    {
+        bool ignore_rules_read = IgnoreRuleFiles::Read(command_line_arguments.IgnoreRulesPath, ignore_settings.RulesText);
+        if (!ignore_rules_read)
+        {
+            std::cerr << "Failed to read ignore rules " << command_line_arguments.IgnoreRulesPath << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // SET UP THE GENERATOR.
+    GeneratorSettings generator_settings;
+    generator_settings.IgnoreRuleSettings = ignore_settings;
+    generator_settings.GitIndexUsage = command_line_arguments.GitIndexUsage;
+    generator_settings.ThreadCount = command_line_arguments.ThreadCount;
+    generator_settings.UnityShardCount = command_line_arguments.UnityShardCount;
+    generator_settings.MaxProjectItemCount = command_line_arguments.MaxProjectItemCount;
+    generator_settings.PrecompileHeaders = command_line_arguments.PrecompileHeaders;
+    generator_settings.PatchExistingFiles = command_line_arguments.PatchExistingFiles;
+    generator_settings.WriteFingerprints = command_line_arguments.WriteFingerprints;
+    generator_settings.CompileProfilePath = command_line_arguments.CompileProfilePath;
+    generator_settings.CompileTimingPaths = command_line_arguments.CompileTimingPaths;
+    generator_settings.MemoryBudgetInBytes = command_line_arguments.MemoryBudgetInBytes;
+    generator_settings.ProjectBuildSystem = command_line_arguments.ProjectBuildSystem;
+    generator_settings.ProjectCompiler = command_line_arguments.ProjectCompiler;
+    bool serving = !command_line_arguments.ServePath.empty();
+    bool verbose = (LogLevel::VERBOSE == command_line_arguments.LoggingLevel);
+    if (verbose)
+    {
+        // Standard output carries the server's responses when serving standard input.
+        generator_settings.DebugOutput = serving ? &std::cerr : &std::cout;
+    }
+    ProjectGenerator generator(generator_settings);
+
+    // SERVE REQUESTS IF REQUESTED.
+    if (serving)
+    {
+        GeneratorServer server(generator);
+        const std::string STANDARD_STREAMS_PATH = "-";
+        bool standard_streams_served = (STANDARD_STREAMS_PATH == command_line_arguments.ServePath);
+        if (standard_streams_served)
+        {
+            server.ServeStandardStreams();
+            return EXIT_SUCCESS;
+        }
+        bool socket_served = server.ServeSocket(command_line_arguments.ServePath);
+        return socket_served ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // GET THE PROJECTS TO GENERATE.
+    GenerationRequest request;
+    request.GeneratorCommandLine = command_line_arguments.GeneratorCommandLine;
+    bool manifest_provided = !command_line_arguments.ManifestPath.empty();
+    if (manifest_provided)
+    {
+        bool manifest_loaded = ProjectManifest::Load(command_line_arguments.ManifestPath, request.Projects);
+        if (!manifest_loaded)
+        {
+            return EXIT_FAILURE;
+        }
+
+        // Each project in a manifest needs its own build script since they're all in the current folder.
+        // The Ninja build file is regenerated by Ninja itself if the manifest changes, so it's an input of the build file.
+        request.BuildScriptsNamedByProject = true;
+        request.GeneratorInputPaths.push_back(command_line_arguments.ManifestPath);
+    }
+    else
+    {
+        RequestedProject project;
+        project.Name = command_line_arguments.ProjectName;
+        project.CodeFolderPath = command_line_arguments.CodeFolderPath;
+        request.Projects.push_back(project);
+    }
+    request.SolutionName = command_line_arguments.SolutionName;
+
+    // LOAD THE SCAN CACHE IF ONE IS AVAILABLE.
+    // Only folders that changed since it was saved need to be listed.
+    bool scan_cache_enabled = !command_line_arguments.ScanCachePath.empty();
+    if (scan_cache_enabled)
+    {
+        FolderTree cached_code_folder;
+        bool scan_cache_loaded = ScanCache::Load(
+            command_line_arguments.ScanCachePath,
+            command_line_arguments.CodeFolderPath,
+            ignore_settings,
+            cached_code_folder);
+        if (scan_cache_loaded)
+        {
+            generator.AddScannedCodeFolder(cached_code_folder);
+        }
+    }
+
+    // GENERATE ALL OF THE FILES.
+    GenerationResult generation_result;
+    bool all_files_written = generator.Generate(request, generation_result);
+
+    // SAVE THE SCAN CACHE.
+    // Failing to save the cache only makes the next run slower, so it isn't treated as an error.
+    if (scan_cache_enabled)
+    {
+        const FolderTree* code_folder = generator.FindScannedCodeFolder(command_line_arguments.CodeFolderPath);
+        OutputFileWriteResult scan_cache_write_result = ScanCache::Save(*code_folder, command_line_arguments.ScanCachePath);
+        bool scan_cache_saved = (OutputFileWriteResult::FAILED != scan_cache_write_result);
+        if (!scan_cache_saved)
+        {
+            std::cerr << "Failed to save scan cache " << command_line_arguments.ScanCachePath << std::endl;
+        }
+    }
+    if (!all_files_written)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // REPORT WHAT THE PROGRAM DID IF REQUESTED.
+    // Only the initial generation is covered, even when watching, and the trace file itself isn't counted.
+    if (command_line_arguments.Stats)
+    {
+        Statistics::Print(generation_result.Counts, std::cout);
+    }
+    if (trace_enabled)
+    {
+        OutputFile trace_file(command_line_arguments.TracePath);
+        trace_file << Instrumentation::GetTraceJson(command_line_arguments.SolutionName);
+        OutputFileWriteResult trace_write_result = trace_file.WriteIfChanged();
+        bool trace_written = (OutputFileWriteResult::FAILED != trace_write_result);
+        if (!trace_written)
+        {
+            std::cerr << "Failed to write trace " << command_line_arguments.TracePath << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // FINISH UNLESS THE CODE FOLDER SHOULD BE WATCHED.
+    if (!command_line_arguments.Watch)
+    {
+        return EXIT_SUCCESS;
+    }
+
+    // UPDATE THE PROJECT WHENEVER THE CODE FOLDER CHANGES.
+    // Watching is only supported for a single project.  This continues until the program is terminated.
+    bool progress_reported = (LogLevel::QUIET != command_line_arguments.LoggingLevel);
+    if (progress_reported)
+    {
+        std::cout << "Watching " << command_line_arguments.CodeFolderPath << " for changes..." << std::endl;
+    }
+    FolderTree& code_folder = *generator.FindScannedCodeFolder(command_line_arguments.CodeFolderPath);
+    FolderWatcher folder_watcher;
+    folder_watcher.Update(code_folder);
+    for (;;)
+    {
+        // WAIT FOR THE CODE FOLDER TO CHANGE.
+        std::vector<uint8_t> changed_folders = folder_watcher.WaitForChanges(command_line_arguments.ThreadCount, code_folder);
+
+        // RESCAN THE CHANGED FOLDERS.
+        FolderTreeChanges changes = folder_watcher.RescanChangedFolders(command_line_arguments.ThreadCount, changed_folders, code_folder);
+
+        // REGENERATE THE AFFECTED FILES.
+        GenerationResult update_result;
+        generator.Update(changes, update_result);
+
+        // REPORT THE UPDATED FILES.
+        // The time is from when the changes were first seen, so it includes waiting for the folders to be quiet.
+        auto update_duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - folder_watcher.GetFirstChangeTime());
+        for (const GeneratedFile& updated_file : update_result.Files)
+        {
+            if (progress_reported && OutputFileWriteResult::WRITTEN == updated_file.WriteResult)
+            {
+                std::cout << "Updated " << updated_file.Path << " (" << update_duration.count() << " ms)" << std::endl;
+            }
+        }
+    }
+}
+
+#endif
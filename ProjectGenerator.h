@@ -0,0 +1,314 @@
+// The interface for generating projects from other programs, such as build tools that regenerate projects often.
+// Build GenerateProject.cpp with GENERATE_PROJECT_NO_MAIN defined along with the program using this header.
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// Which folders reached through symbolic links (or junctions, on Windows) are included when scanning.
+/// Links that lead back to a folder containing them are never followed, since they would never end.
+enum class LinkPolicy
+{
+    /// Folders reached through links are left out.
+    NEVER,
+    /// Each folder is only included once.  Folders reached through links are left out if they're
+    /// also reached without links, or through a link whose path comes first.
+    ONCE,
+    /// Folders reached through links are included everywhere they're reached.  Each folder is still
+    /// only listed once, and every other place it's reached gets a copy of its entries.
+    ALWAYS
+};
+
+
+/// Settings for which files and folders to leave out when scanning.
+struct IgnoreSettings
+{
+    /// True if version control folders are ignored and .gitignore files are read; false otherwise.
+    bool VersionControlIgnored = true;
+    /// Additional rules in the .gitignore format, relative to each scanned folder.  They take priority
+    /// over all rules from .gitignore files.
+    std::string RulesText = "";
+    /// Which folders reached through symbolic links or junctions to include.
+    LinkPolicy LinkedFolders = LinkPolicy::ALWAYS;
+};
+
+
+/// How the git index is used to find the files in code folders (see GitIndex).
+enum class GitIndexUse
+{
+    /// The git index isn't used, and code folders are scanned on disk.
+    NONE,
+    /// Only the files tracked in the git index are included, and no folders are listed.
+    TRACKED_FILES,
+    /// The files tracked in the git index are included, along with any untracked files, which are found
+    /// by listing the folders on disk.
+    TRACKED_AND_UNTRACKED_FILES
+};
+
+
+/// The ways that generated projects can be built.
+enum class BuildSystem
+{
+    /// A build script batch file for each project (see BuildScriptBatchFile).
+    BATCH,
+    /// A Ninja build file for all projects (see NinjaBuildFile).
+    NINJA
+};
+
+
+/// The compilers that generated Ninja build files can use.
+enum class Compiler
+{
+    /// The Visual C++ compiler (cl.exe).
+    MSVC,
+    /// Clang (clang++), or any compiler with compatible options.
+    CLANG
+};
+
+
+/// The settings for generating projects, which apply to every solution that a ProjectGenerator generates.
+struct GeneratorSettings
+{
+    /// The settings for which files and folders to leave out of scanned code folders.
+    IgnoreSettings IgnoreRuleSettings = {};
+    /// How the git index should be used to find the files in scanned code folders.
+    GitIndexUse GitIndexUsage = GitIndexUse::NONE;
+    /// The number of threads to use.  Zero uses one thread per hardware core.
+    unsigned int ThreadCount = 0;
+    /// The number of unity build files to split each project's source files into (see UnityBuild).  Zero if
+    /// each project's source files are built with a single hand-written unity build file instead.
+    std::size_t UnityShardCount = 0;
+    /// True if widely included headers should be precompiled (see PrecompiledHeader).
+    bool PrecompileHeaders = false;
+    /// True if existing project and filters files should only have their items updated instead of being replaced.
+    bool PatchExistingFiles = false;
+    /// The most code files to put in a single project file before splitting the project into several (see ProjectPartition).
+    /// Zero if projects should never be split.  Projects generated while their code folders are scanned aren't split.
+    std::size_t MaxProjectItemCount = 0;
+    /// True if a manifest of fingerprints of each project's code files should be written for its build script
+    /// to skip compiling unchanged translation units (see FingerprintManifest).  Only used with build scripts.
+    bool WriteFingerprints = false;
+    /// The path of the profile of measured compile times to read and update (see CompileProfile), or empty if compile
+    /// times shouldn't be measured.  With Clang and Ninja, the build also writes time traces to read into the profile.
+    std::string CompileProfilePath = "";
+    /// The paths of timing files, or folders of them, to read into the compile profile (see CompileProfile::ReadTimings).
+    /// Only used with a compile profile.
+    std::vector<std::string> CompileTimingPaths = {};
+    /// The maximum memory to use for generating each project while its code folder is scanned (see StreamedProjectFiles).
+    /// Zero if code folders should be scanned into memory first instead.  Only the project and filters files are
+    /// generated while scanning, so this doesn't work with unity build files, split projects, precompiled headers,
+    /// patching, fingerprints, compile profiles, or Ninja.
+    std::size_t MemoryBudgetInBytes = 0;
+    /// How the generated projects should be built.
+    BuildSystem ProjectBuildSystem = BuildSystem::BATCH;
+    /// The compiler that the Ninja build file should use.
+    Compiler ProjectCompiler = Compiler::MSVC;
+    /// The stream to print every scanned folder and file to, or null if they shouldn't be printed.
+    std::ostream* DebugOutput = nullptr;
+};
+
+
+/// A project in a solution for a ProjectGenerator to generate.
+struct RequestedProject
+{
+    /// The name of the project.
+    std::string Name = "";
+    /// The relative path to the folder containing all code for the project.
+    std::string CodeFolderPath = "";
+};
+
+/// A solution for a ProjectGenerator to generate.
+struct GenerationRequest
+{
+    /// The name of the solution, which its file is named after.
+    std::string SolutionName = "";
+    /// The projects in the solution.
+    std::vector<RequestedProject> Projects = {};
+    /// The files in code folders that are provided instead of scanning the folders, by the code folder's path
+    /// (see GitIndex::FromFilePaths).  Projects whose code folders aren't listed here have their code folders scanned.
+    std::unordered_map<std::string, std::vector<std::string>> CodeFolderFilePaths = {};
+    /// True if each project gets its own build script named after it (as for a manifest); false if
+    /// the solution only has one project, whose build script is simply build.bat.
+    bool BuildScriptsNamedByProject = false;
+    /// The command line that the Ninja build file runs to regenerate itself, or that build scripts run to update
+    /// their fingerprints.  Only needed for Ninja or fingerprints.
+    std::string GeneratorCommandLine = "";
+    /// Paths of files besides the code folders that regenerating the Ninja build file depends on (such as a manifest).
+    std::vector<std::string> GeneratorInputPaths = {};
+};
+
+
+/// The result of writing an output file.
+enum class OutputFileWriteResult
+{
+    /// The file already had the same contents, so it wasn't written.
+    UNCHANGED,
+    /// The file was written.
+    WRITTEN,
+    /// The file couldn't be written.
+    FAILED
+};
+
+
+/// A file generated by a ProjectGenerator.
+struct GeneratedFile
+{
+    /// The path of the file.
+    std::string Path;
+    /// Whether the file was written.
+    OutputFileWriteResult WriteResult;
+};
+
+
+/// How many folders and files were scanned for the generated projects.
+struct ScanCounts
+{
+    /// The number of folders scanned.
+    std::size_t FolderCount = 0;
+    /// The number of files scanned, including files that aren't code files.
+    std::size_t FileCount = 0;
+    /// The number of header files in the projects.
+    std::size_t HeaderFileCount = 0;
+    /// The number of source files in the projects.
+    std::size_t CppFileCount = 0;
+};
+
+
+/// What a ProjectGenerator did for a solution.
+struct GenerationResult
+{
+    /// All of the files generated, whether they were written or not.
+    std::vector<GeneratedFile> Files = {};
+    /// How many folders and files were scanned.
+    ScanCounts Counts = {};
+};
+
+
+// The generator's internal types are only defined in GenerateProject.cpp.
+class CompileProfile;
+class FolderTree;
+struct FolderTreeChanges;
+class OutputFile;
+struct Project;
+
+/// Generates the files for solutions of projects, keeping every code folder it scans in memory so that later
+/// solutions using the same code folders only need to list the folders that changed since then.  This is everything
+/// the program does besides reading its command line, so a build tool can generate projects itself, or run the
+/// program as a server (see GeneratorServer in GenerateProject.cpp), instead of starting the program and scanning
+/// code folders from scratch every time.
+///
+/// Projects can either have their code folders scanned or have the files in them provided, such as by a build
+/// tool that already knows them.  Solutions are generated one at a time, and the files generated for each
+/// are only written if their contents changed, so regenerating an unchanged solution doesn't write anything.
+class ProjectGenerator
+{
+public:
+    /// Constructor.
+    /// @param[in]  settings - The settings for generating projects.
+    explicit ProjectGenerator(const GeneratorSettings& settings);
+    /// Destructor.
+    ~ProjectGenerator();
+
+    /// Adds a code folder scanned before (such as one loaded from a scan cache), so that it only needs to be
+    /// rescanned the next time a project uses it.  It must have been scanned with the same ignore settings.
+    /// @param[in,out]  code_folder - The scanned code folder, which is moved into the generator.
+    void AddScannedCodeFolder(FolderTree& code_folder);
+
+    /// Gets the settings for generating projects.
+    /// @return The settings.
+    const GeneratorSettings& GetSettings() const;
+
+    /// Finds a scanned code folder.
+    /// @param[in]  code_folder_path - The relative path to the code folder.
+    /// @return The code folder's tree, or null if it hasn't been scanned.
+    FolderTree* FindScannedCodeFolder(const std::string& code_folder_path);
+
+    /// Removes scanned code folders, freeing their memory, such as once a server's clients stop using them.
+    /// A project that uses a removed code folder again has it scanned from scratch.
+    /// @param[in]  folder_path - The relative path to the folder whose scanned code folders to remove.
+    ///     Code folders scanned at or within it are removed.
+    /// @return The relative paths of the removed code folders.
+    std::vector<std::string> RemoveScannedCodeFolders(const std::string& folder_path);
+
+    /// Removes every scanned code folder, freeing their memory.
+    /// @return The relative paths of the removed code folders.
+    std::vector<std::string> RemoveAllScannedCodeFolders();
+
+    /// Generates all files for a solution.  Any files that couldn't be written (or compile timings that couldn't be read)
+    /// are reported to standard error.
+    /// @param[in]  request - The solution to generate.
+    /// @param[out]  result - What was generated.
+    /// @return True if all files were generated and all compile timings were read; false otherwise.
+    bool Generate(const GenerationRequest& request, GenerationResult& result);
+
+    /// Updates the files generated for the last solution after its project's code folder was rescanned, such as
+    /// while watching it.  Only the files affected by the changes are regenerated: the filters file if any code
+    /// files or folders were added or removed, and the project and unity build files if any code files were.
+    /// If the project is split into parts, the solution and the files for every part are regenerated instead,
+    /// though only the parts that changed are actually written.
+    /// Any files that couldn't be written are reported to standard error.
+    /// @param[in]  changes - The changes to the code folder.  The last solution must have had a single project,
+    ///     whose code folder was scanned and has since been rescanned in place.
+    /// @param[out]  result - What was generated.  No files are listed if none were affected.
+    /// @return True if all affected files were generated; false otherwise.
+    bool Update(const FolderTreeChanges& changes, GenerationResult& result);
+
+private:
+    /// Splits the projects in the last solution into parts if they have too many code files and splitting was
+    /// requested (see ProjectPartition).  Any parts from before are replaced.
+    void SplitProjects();
+
+    /// Gets the projects to list in the last solution, with the parts of any split projects in place of them.
+    /// @return The projects in the solution, in order.
+    std::vector<const Project*> GetSolutionProjects() const;
+
+    /// Writes a project file.
+    /// @param[in]  thread_count - The maximum number of threads to format the file's items on.  Files written
+    ///     alongside other files should use a single thread, since they're already written in parallel.
+    /// @param[in]  project - The project to write the file for.
+    /// @param[in,out]  project_file - The file to write.
+    void WriteProjectFile(const unsigned int thread_count, const Project& project, OutputFile& project_file) const;
+
+    /// Writes a project filters file.
+    /// @param[in]  thread_count - The maximum number of threads to format the file's items on.  Files written
+    ///     alongside other files should use a single thread, since they're already written in parallel.
+    /// @param[in]  project - The project to write the file for.
+    /// @param[in,out]  project_filters_file - The file to write.
+    void WriteProjectFiltersFile(const unsigned int thread_count, const Project& project, OutputFile& project_filters_file) const;
+
+    /// Writes a unity build file.
+    /// @param[in]  project - The project to write the file for.
+    /// @param[in]  shard_index - The index of the shard that the file is for.
+    /// @param[in,out]  unity_shard_file - The file to write.
+    static void WriteUnityShardFile(const Project& project, const std::size_t shard_index, OutputFile& unity_shard_file);
+
+    /// Adds generated files to a result, reporting any that couldn't be written to standard error.
+    /// @param[in]  output_files - The generated files.
+    /// @param[in,out]  result - The result to add the files to.
+    /// @return True if all of the files were written (or didn't need to be); false otherwise.
+    static bool AddGeneratedFiles(const std::vector<const OutputFile*>& output_files, GenerationResult& result);
+
+    // MEMBER VARIABLES.
+    /// The settings for generating projects.
+    GeneratorSettings Settings;
+    /// The number of threads to use, resolved from the settings.
+    unsigned int ThreadCount;
+    /// Every code folder scanned so far (without overlapping ones), which later solutions rescan instead of scanning them from scratch.
+    std::vector<std::unique_ptr<FolderTree>> CodeFolders;
+    /// The code folders of the last solution whose files were provided instead of scanned.
+    std::vector<std::unique_ptr<FolderTree>> ListedCodeFolders;
+    /// The name of the last solution.
+    std::string SolutionName;
+    /// The projects in the last solution.
+    std::vector<Project> Projects;
+    /// The parts of each project in the last solution, in the same order as the projects.
+    /// Empty for projects that aren't split.
+    std::vector<std::vector<Project>> ProjectParts;
+    /// The measured compile times from the last solution (see CompileProfile).  Empty if compile times aren't used.
+    std::unique_ptr<CompileProfile> Profile;
+};
+
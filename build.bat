@@ -18,6 +18,13 @@ PUSHD "build"
     REM user32.lib - Basic Windows functions.
     cl.exe /Zi /EHa /WX /W4 /MTd "..\GenerateProject.cpp" user32.lib
 
+    REM BUILD THE BENCHMARK.
+    REM It's optimized since it measures performance.
+    REM /O2 - Maximize speed
+    REM /MT - Static linking with Visual C++ lib.
+    REM psapi.lib - Process memory information.
+    cl.exe /O2 /EHa /WX /W4 /MT "..\Benchmark.cpp" user32.lib psapi.lib
+
 POPD
 
 @ECHO ON
@@ -0,0 +1,20 @@
+#!/bin/sh
+# Builds the program and its benchmark on Linux and other POSIX systems (for example, to generate
+# project files from a shared checkout or to measure performance).  An optimized build is created.
+# Set CXX to use a different compiler.
+
+# STOP ON ANY ERRORS.
+set -e
+
+# MOVE INTO THE BUILD DIRECTORY.
+mkdir -p build
+cd build
+
+    # BUILD THE PROGRAMS.
+    # -std=c++14 - The C++ standard supported by the Visual Studio build.
+    # -O2 - Optimizations.
+    # -Wall -Wextra -Werror - All common warnings as errors.
+    # -pthread - Threads for the parallel folder scanning and file writing.
+    CXX="${CXX:-c++}"
+    "$CXX" -std=c++14 -O2 -Wall -Wextra -Werror -pthread ../GenerateProject.cpp -o GenerateProject
+    "$CXX" -std=c++14 -O2 -Wall -Wextra -Werror -pthread ../Benchmark.cpp -o Benchmark
@@ -0,0 +1,177 @@
+#!/bin/sh
+# Runs end-to-end checks of the program on Linux and other POSIX systems, after it's been built with build.sh.
+# Each check generates a project for a small code folder, changes the code folder, and regenerates the project
+# the way the checked feature does, and the generated files then have to match the files generated from scratch
+# for the changed code folder.  The checks are done in build/test, which is left behind for investigating failures.
+
+# STOP ON ANY ERRORS.
+set -e
+
+# FIND THE PROGRAM.
+PROGRAM="$(pwd)/build/GenerateProject"
+TEST_FOLDER="$(pwd)/build/test"
+if [ ! -x "$PROGRAM" ]; then
+    echo "Missing $PROGRAM; run build.sh first."
+    exit 1
+fi
+FAILURE_COUNT=0
+
+# Writes the code folder for the checks in the current folder.
+# C files are in the last folder so that changing them doesn't affect which C++ files are in which unity build file.
+write_code_folder()
+{
+    mkdir -p code/app code/common code/c
+    printf '#pragma once\n#include "value.h"\nint Add(int a, int b);\n' > code/common/math.h
+    printf '#define VALUE 1\n' > code/common/value.h
+    printf '#include "math.h"\nint Add(int a, int b) { return a + b + VALUE; }\n' > code/common/math.cpp
+    printf '#include "common/math.h"\nint main() { return Add(1, 2); }\n' > code/app/main.cpp
+    printf '#include "common/math.h"\nint Twice(int a) { return Add(a, a); }\n' > code/app/twice.cpp
+    printf 'int Old(void) { return 1; }\n' > code/c/old.c
+}
+
+# Changes the code folder in the current folder: a header's contents change, a C file is renamed, and a folder is added.
+# The header keeps its size so that unity build files stay balanced the same way.
+change_code_folder()
+{
+    printf '#define VALUE 2\n' > code/common/value.h
+    mv code/c/old.c code/c/renamed.c
+    mkdir -p code/extra
+    printf '#pragma once\n' > code/extra/extra.h
+}
+
+# Generates the Test project for the code folder in the current folder, with the options in OPTIONS.
+generate()
+{
+    "$PROGRAM" $OPTIONS Test code >/dev/null
+}
+
+# Changes the code folder in the current folder and then generates the project again.
+change_and_generate()
+{
+    change_code_folder
+    generate
+}
+
+# Waits for the program's output in a file in the current folder to contain some text, failing after 10 seconds.
+# wait_for_output <OutputFilename> <Text>
+wait_for_output()
+{
+    WAIT_COUNT=0
+    while ! grep -q "$2" "$1"; do
+        WAIT_COUNT=$((WAIT_COUNT + 1))
+        if [ "$WAIT_COUNT" -gt 100 ]; then
+            echo "Timed out waiting for \"$2\" from the program."
+            return 1
+        fi
+        sleep 0.1
+    done
+}
+
+# Changes the code folder in the current folder while the program watches it, and stops the program once the
+# project has been updated.  Changes are collected for a fraction of a second before updating (see FolderWatcher),
+# so a second is plenty of time for all of them.
+watch_and_change()
+{
+    "$PROGRAM" $OPTIONS --watch Test code >watch.log &
+    WATCH_PROCESS_ID=$!
+    wait_for_output watch.log "Watching"
+    change_code_folder
+    wait_for_output watch.log "Updated"
+    sleep 1
+    kill "$WATCH_PROCESS_ID"
+    wait "$WATCH_PROCESS_ID" 2>/dev/null || true
+    rm watch.log
+}
+
+# Has the program generate the project as a server, changes the code folder, and has the same server regenerate it,
+# so that the server rescans the code folder it kept from the first request.  Requests are written to a named pipe
+# that the server reads as its standard input.
+serve_and_change()
+{
+    GENERATE_PARAMS='"params": {"solution": "Test", "projects": [{"name": "Test", "codeFolder": "code"}]}'
+    mkfifo requests
+    "$PROGRAM" $OPTIONS --serve - <requests >serve.log &
+    SERVE_PROCESS_ID=$!
+    exec 3>requests
+    echo "{\"jsonrpc\": \"2.0\", \"id\": 1, \"method\": \"generate\", $GENERATE_PARAMS}" >&3
+    wait_for_output serve.log '"id":1'
+    change_code_folder
+    echo "{\"jsonrpc\": \"2.0\", \"id\": 2, \"method\": \"generate\", $GENERATE_PARAMS}" >&3
+    wait_for_output serve.log '"id":2'
+    echo '{"jsonrpc": "2.0", "id": 3, "method": "shutdown"}' >&3
+    exec 3>&-
+    wait "$SERVE_PROCESS_ID"
+    rm requests serve.log
+}
+
+# Adds the code folder in the current folder to a new git repository, with all of its files tracked in the index.
+track_code_folder()
+{
+    git init -q code
+    git -C code add .
+}
+
+# Changes the code folder in the current folder, has git rewrite its index without tracking the new files,
+# and then generates the project again.  The rewritten index is newer than the folders with untracked files,
+# which still have to be found.
+change_and_generate_from_index()
+{
+    change_code_folder
+    git -C code add common/value.h
+    git -C code status >/dev/null
+    generate
+}
+
+# Checks that regenerating a project after its code folder changes matches generating it from scratch.
+# check_regeneration <CheckName> <Options> [RegenerateFunction] [PrepareFunction]
+# The regenerate function changes the code folder and regenerates the project.  By default, the program is just rerun.
+# The prepare function sets up a newly written code folder before the project is first generated for it.
+check_regeneration()
+{
+    # GENERATE THE PROJECT, CHANGE THE CODE FOLDER, AND REGENERATE THE PROJECT.
+    CHECK_FOLDER="$TEST_FOLDER/$1"
+    OPTIONS="$2"
+    REGENERATE="${3:-change_and_generate}"
+    PREPARE="${4:-true}"
+    rm -rf "$CHECK_FOLDER"
+    mkdir -p "$CHECK_FOLDER/regenerated" "$CHECK_FOLDER/fresh"
+    cd "$CHECK_FOLDER/regenerated"
+    write_code_folder
+    "$PREPARE"
+    generate
+    "$REGENERATE"
+
+    # GENERATE THE PROJECT FROM SCRATCH FOR THE CHANGED CODE FOLDER.
+    cp -R code "$CHECK_FOLDER/fresh/code"
+    rm -rf "$CHECK_FOLDER/fresh/code/.git"
+    cd "$CHECK_FOLDER/fresh"
+    "$PREPARE"
+    generate
+
+    # COMPARE THE GENERATED FILES.
+    if diff -r -x .git "$CHECK_FOLDER/regenerated" "$CHECK_FOLDER/fresh"; then
+        echo "PASSED: $1"
+    else
+        echo "FAILED: $1"
+        FAILURE_COUNT=$((FAILURE_COUNT + 1))
+    fi
+}
+
+# CHECK EACH FEATURE.
+check_regeneration unity "--unity-shards 2 --pch"
+check_regeneration ninja "--build-system ninja"
+check_regeneration fingerprints "--fingerprints"
+check_regeneration watch "" watch_and_change
+check_regeneration server "" serve_and_change
+if command -v git >/dev/null; then
+    check_regeneration git-index "--git-index changed" change_and_generate_from_index track_code_folder
+else
+    echo "SKIPPED: git-index (git wasn't found)"
+fi
+
+# REPORT ANY FAILURES.
+if [ "$FAILURE_COUNT" -ne 0 ]; then
+    echo "$FAILURE_COUNT check(s) failed."
+    exit 1
+fi
+echo "All checks passed."